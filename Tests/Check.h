@@ -0,0 +1,51 @@
+#pragma once
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+
+// Checks for the console test targets, a failed check is reported and counted instead of stopping the run
+class CCheck
+{
+	public:
+		// Record a check, false if it failed
+		static bool That(bool condition, const char* expression, const char* file, int line) {
+			checks++;
+			if (!condition) {
+				failures++;
+				printf("FAILED %s:%d: %s\n", file, line, expression);
+			}
+			return condition;
+		}
+
+		// Print the summary, the exit code for main
+		static int Result(const char* name) {
+			printf("%s: %d checks, %d failed\n", name, checks, failures);
+			return failures == 0 ? 0 : 1;
+		}
+
+		// Iterations for the throughput loops, the first argument overrides the default
+		static int Iterations(int argc, char** argv, int fallback) {
+			return argc > 1 ? atoi(argv[1]) : fallback;
+		}
+
+	private:
+		static inline int checks = 0;
+		static inline int failures = 0;
+};
+
+#define CHECK(condition) CCheck::That((condition), #condition, __FILE__, __LINE__)
+
+// Wall clock timer for the throughput loops
+class CStopwatch
+{
+	public:
+		CStopwatch() : start(std::chrono::steady_clock::now()) {}
+
+		// Milliseconds since construction
+		double ElapsedMs() const {
+			return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		}
+
+	private:
+		std::chrono::steady_clock::time_point start;
+};
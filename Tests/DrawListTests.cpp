@@ -0,0 +1,207 @@
+#include "Check.h"
+#include "HeadlessScreen.h"
+#include "DrawList.h"
+#include "HeadlessBackend.h"
+#include "Projection.h"
+#include <vector>
+
+using namespace std;
+
+// Segments that carry on from each other in the same pen become one polyline
+static void TestMerging() {
+	CHeadlessBackend backend;
+	CDrawList list;
+	list.Begin(&backend);
+	int pen = list.Style(0xFFFFFFFF, 2);
+	int other = list.Style(0xFFFF8000, 2);
+
+	list.Line(pen, { 0, 0 }, { 10, 0 });
+	list.Line(pen, { 10, 0 }, { 10, 10 }); // Carries on
+	list.Line(pen, { 10, 10 }, { 20, 10 }); // Carries on
+	list.Line(other, { 20, 10 }, { 30, 10 }); // New pen
+	list.Line(other, { 50, 50 }, { 60, 60 }); // Doesn't join up
+	CDrawPoint points[3] = { { 60, 60 }, { 70, 70 }, { 80, 60 } };
+	list.Polyline(other, points, 3); // Carries on
+
+	CHECK(list.Commands().size() == 3);
+	CHECK(list.Commands()[0].Op == CDrawOp::POLYLINE && list.Commands()[0].Count == 4);
+	CHECK(list.Commands()[1].Op == CDrawOp::LINE);
+	CHECK(list.Commands()[2].Op == CDrawOp::POLYLINE && list.Commands()[2].Count == 4);
+	CHECK(list.Merged() == 3);
+
+	list.Submit();
+	const CDrawStats& stats = backend.GetStats();
+	CHECK(stats.Lists == 1);
+	CHECK(stats.Lines == 3);
+	CHECK(stats.Segments == 7);
+	CHECK(stats.Merged == 3);
+	CHECK(stats.Invalid == 0);
+	CHECK(list.Commands().empty());
+}
+
+// The same style or font gets the same index, a clear forgets them
+static void TestStylesAndFonts() {
+	CDrawList list;
+	list.Begin(nullptr);
+	int a = list.Style(0xFF00FF00, 1);
+	int b = list.Style(0xFF00FF00, 2);
+	CHECK(a != b);
+	CHECK(list.Style(0xFF00FF00, 1) == a);
+	CHECK(list.Style(0xFF00FF00, 1, 1) != a);
+	int mono = list.Font(CDrawFontFamily::MONO, 12);
+	CHECK(list.Font(CDrawFontFamily::MONO, 12) == mono);
+	CHECK(list.Font(CDrawFontFamily::MONO, 12, CDrawAlign::CENTER) != mono);
+	CHECK(list.Styles().size() == 3);
+	CHECK(list.Fonts().size() == 2);
+
+	list.Clear();
+	CHECK(list.Styles().empty() && list.Fonts().empty());
+}
+
+// Text runs share one buffer, empty runs and short shapes are dropped
+static void TestTextAndFills() {
+	CHeadlessBackend backend;
+	CDrawList list;
+	list.Begin(&backend);
+	int font = list.Font(CDrawFontFamily::MONO, 10);
+	int brush = list.Style(0xFFFFFFFF);
+
+	CDrawSize size = list.MeasureText(font, "GAATS");
+	CHECK(size.Width == 30 && size.Height == 10);
+	CHECK(list.MeasureText(-1, "GAATS").Width == 0);
+
+	list.Text(font, brush, { 5, 5 }, "NAT A");
+	list.Text(font, brush, { 5, 20 }, "");
+	list.Text(font, brush, { 5, 35 }, "F350");
+	list.FillRect(brush, { 0, 0 }, { 10, 10 });
+	list.FillEllipse(brush, { 0, 0 }, { 6, 6 });
+	CDrawPoint triangle[3] = { { 0, 0 }, { 10, 0 }, { 5, 8 } };
+	list.FillPolygon(brush, triangle, 3);
+	list.FillPolygon(brush, triangle, 2);
+	list.Polyline(brush, triangle, 1);
+	CHECK(list.TextBuffer() == "NAT AF350");
+	CHECK(list.Commands().size() == 5);
+
+	list.Submit();
+	const CDrawStats& stats = backend.GetStats();
+	CHECK(stats.Texts == 2);
+	CHECK(stats.Fills == 3);
+	CHECK(stats.Invalid == 0);
+
+	// Nothing to replay without a backend, the list still clears
+	list.Begin(nullptr);
+	list.Text(font, brush, { 0, 0 }, "X");
+	list.Submit();
+	CHECK(list.Commands().empty());
+	CHECK(backend.GetStats().Lists == 1);
+}
+
+// The affine path lands where EuroScope would put the points, and culls past the margin
+static void TestProjection() {
+	CHeadlessScreen screen({ 0, 0, 1920, 1080 }, 50.0, -35.0, 20.0);
+	CProjection::BeginFrame(&screen);
+
+	vector<CPosition> positions(3);
+	positions[0].m_Latitude = 50.0; positions[0].m_Longitude = -35.0;
+	positions[1].m_Latitude = 55.5; positions[1].m_Longitude = -20.0;
+	positions[2].m_Latitude = 44.0; positions[2].m_Longitude = -100.0;
+	vector<POINT> points;
+	CProjection::ToPixels(&screen, positions, points);
+	CHECK(points.size() == 3);
+	for (size_t i = 0; i < points.size(); i++) {
+		POINT expected = screen.ToPixel(positions[i]);
+		CHECK(abs(points[i].x - expected.x) <= 1 && abs(points[i].y - expected.y) <= 1);
+	}
+	CHECK(CProjection::IsVisible(points[0]));
+	CHECK(!CProjection::IsVisible(points[2]));
+}
+
+// One NAT frame: tracks with their letters, then routes emitted leg by leg with a dot and label per fix
+static void BuildFrame(CDrawList& list, CHeadlessScreen& screen, const vector<vector<CPosition>>& tracks, const vector<vector<CPosition>>& routes) {
+	CProjection::BeginFrame(&screen);
+	vector<POINT> points;
+	vector<CDrawPoint> line;
+
+	// Tracks
+	int trackPen = list.Style(0xFFFFFFFF, 2);
+	int trackFont = list.Font(CDrawFontFamily::MONO, 14, CDrawAlign::CENTER);
+	for (size_t i = 0; i < tracks.size(); i++) {
+		CProjection::ToPixels(&screen, tracks[i], points);
+		if (!CProjection::IsVisible(points)) continue;
+		line.clear();
+		for (const POINT& point : points) line.push_back({ (int)point.x, (int)point.y });
+		list.Text(trackFont, trackPen, { line[0].X - 12, line[0].Y - 5 }, string(1, (char)('A' + i)));
+		list.Polyline(trackPen, line.data(), (int)line.size());
+	}
+
+	// Routes
+	int routePen = list.Style(0xFFFF8000, 2);
+	int routeBrush = list.Style(0xFFFF8000);
+	int routeFont = list.Font(CDrawFontFamily::MONO, 12);
+	for (const auto& route : routes) {
+		CProjection::ToPixels(&screen, route, points);
+		for (size_t j = 1; j < points.size(); j++) {
+			if (CProjection::IsVisible(points[j - 1], points[j])) {
+				list.Line(routePen, { (int)points[j - 1].x, (int)points[j - 1].y }, { (int)points[j].x, (int)points[j].y });
+			}
+		}
+		for (const POINT& point : points) {
+			if (!CProjection::IsVisible(point)) continue;
+			list.FillEllipse(routeBrush, { (int)point.x - 3, (int)point.y - 3 }, { (int)point.x + 3, (int)point.y + 3 });
+			CDrawSize extent = list.MeasureText(routeFont, "5030N");
+			list.Text(routeFont, routeBrush, { (int)point.x - extent.Width / 2, (int)point.y + 6 }, "5030N");
+		}
+	}
+}
+
+// Frame building and replay throughput
+static void BenchFrames(int frames) {
+	// Ten tracks and three hundred routes across the NAT
+	vector<vector<CPosition>> tracks(10);
+	for (int i = 0; i < 10; i++) {
+		for (int j = 0; j <= 12; j++) {
+			CPosition position;
+			position.m_Latitude = 44.0 + i + (j % 3) * 0.5;
+			position.m_Longitude = -60.0 + j * 4.0;
+			tracks[i].push_back(position);
+		}
+	}
+	vector<vector<CPosition>> routes(300);
+	for (int i = 0; i < 300; i++) {
+		for (int j = 0; j < 8; j++) {
+			CPosition position;
+			position.m_Latitude = 42.0 + (i % 20) + j * 0.5;
+			position.m_Longitude = -65.0 + (i % 7) + j * 7.0;
+			routes[i].push_back(position);
+		}
+	}
+
+	CHeadlessScreen screen({ 0, 0, 1920, 1080 }, 50.0, -35.0, 20.0);
+	CHeadlessBackend backend;
+	CDrawList list;
+	CStopwatch timer;
+	for (int frame = 0; frame < frames; frame++) {
+		// The controller pans every so often, which drops the projection cache
+		if (frame % 50 == 49) screen.Pan(0.0, 0.5);
+		list.Begin(&backend);
+		BuildFrame(list, screen, tracks, routes);
+		list.Submit();
+	}
+	double elapsed = timer.ElapsedMs();
+
+	const CDrawStats& stats = backend.GetStats();
+	CHECK(stats.Lists == frames);
+	CHECK(stats.Invalid == 0);
+	CHECK(stats.Merged > 0);
+	printf("%d frames in %.1fms (%.3fms a frame), %d commands and %d segments a frame, %d segments merged a frame\n",
+		frames, elapsed, elapsed / frames, stats.Commands / frames, stats.Segments / frames, stats.Merged / frames);
+}
+
+int main(int argc, char** argv) {
+	TestMerging();
+	TestStylesAndFonts();
+	TestTextAndFills();
+	TestProjection();
+	BenchFrames(CCheck::Iterations(argc, argv, 200));
+	return CCheck::Result("DrawListTests");
+}
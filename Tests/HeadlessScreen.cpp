@@ -0,0 +1,33 @@
+#include "HeadlessScreen.h"
+#include <cmath>
+
+CHeadlessScreen::CHeadlessScreen(RECT area, double centreLatitude, double centreLongitude, double pixelsPerDegree) {
+	Area = area;
+	this->centreLatitude = centreLatitude;
+	this->centreLongitude = centreLongitude;
+	scale = pixelsPerDegree;
+}
+
+void CHeadlessScreen::Pan(double latitude, double longitude) {
+	centreLatitude += latitude;
+	centreLongitude += longitude;
+}
+
+POINT CHeadlessScreen::ToPixel(const CPosition& position) const {
+	POINT point;
+	point.x = (Area.left + Area.right) / 2 + (LONG)lround((position.m_Longitude - centreLongitude) * scale);
+	point.y = (Area.top + Area.bottom) / 2 - (LONG)lround((position.m_Latitude - centreLatitude) * scale);
+	return point;
+}
+
+// The parts of the EuroScope screen the headless targets link against
+CRadarScreen::CRadarScreen(void) {
+}
+
+RECT CRadarScreen::GetRadarArea(void) {
+	return static_cast<CHeadlessScreen*>(this)->Area;
+}
+
+POINT CRadarScreen::ConvertCoordFromPositionToPixel(CPosition Pos) {
+	return static_cast<CHeadlessScreen*>(this)->ToPixel(Pos);
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include "EuroScopePlugIn.h"
+
+using namespace EuroScopePlugIn;
+
+// Stand-in for an ASR, an equirectangular view answering the screen calls the projection makes
+class CHeadlessScreen : public CRadarScreen
+{
+	public:
+		CHeadlessScreen(RECT area, double centreLatitude, double centreLongitude, double pixelsPerDegree);
+
+		// Move the view centre
+		void Pan(double latitude, double longitude);
+
+		// Where a position lands in the view
+		POINT ToPixel(const CPosition& position) const;
+
+		RECT Area;
+
+		void OnAsrContentToBeClosed(void) {}
+
+	private:
+		double centreLatitude;
+		double centreLongitude;
+		double scale; // Pixels per degree
+};
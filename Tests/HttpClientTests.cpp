@@ -0,0 +1,205 @@
+#include "Check.h"
+#include "StubHttpClient.h"
+#include "Lifecycle.h"
+#include <thread>
+#include <chrono>
+
+using namespace std;
+
+// Clients Instance made itself
+static int madeClients = 0;
+
+// The test target's transport
+CHttpClient* CHttpClient::MakeClient() {
+	madeClients++;
+	return new CStubHttpClient();
+}
+
+static CHttpRequest MakeRequest(const string& url, int timeoutMs = HTTP_TIMEOUT) {
+	CHttpRequest request;
+	request.Url = url;
+	request.TimeoutMs = timeoutMs;
+	return request;
+}
+
+// Sleep until a condition holds, false if it never did
+template <typename T>
+static bool WaitFor(T condition) {
+	for (int i = 0; i < 500 && !condition(); i++) {
+		this_thread::sleep_for(chrono::milliseconds(2));
+	}
+	return condition();
+}
+
+// Requests are spread over every worker and no more, both forms of Send complete
+static void TestWorkers() {
+	CStubHttpClient client(4);
+	vector<future<CHttpResponse>> responses;
+	for (int i = 0; i < 16; i++) {
+		responses.push_back(client.Send(MakeRequest("http://api.test/slow")));
+	}
+	int ok = 0;
+	for (auto& response : responses) {
+		if (response.get().Status == 200) ok++;
+	}
+	CHECK(ok == 16);
+	CHECK(client.PeakActive == 4);
+
+	// Callbacks run on the workers
+	atomic<int> called(0);
+	thread::id caller = this_thread::get_id();
+	atomic<bool> isOnWorker(true);
+	client.Route("/ok", 200, "ok");
+	for (int i = 0; i < 8; i++) {
+		client.Send(MakeRequest("http://api.test/ok"), [&](const CHttpResponse& response) {
+			if (this_thread::get_id() == caller) isOnWorker = false;
+			if (response.Status == 200 && response.Body == "ok") called++;
+		});
+	}
+	CHECK(WaitFor([&] { return called == 8; }));
+	CHECK(isOnWorker);
+
+	// A throwing callback doesn't take the worker down
+	client.Send(MakeRequest("http://api.test/ok"), [](const CHttpResponse& response) { throw runtime_error("callback"); });
+	CHECK(client.Send(MakeRequest("http://api.test/missing")).get().Status == 404);
+}
+
+// One connection per host and port, shared by every request to it
+static void TestKeepAlive() {
+	CStubHttpClient client(2);
+	client.Route("/ok", 200, "ok");
+	vector<future<CHttpResponse>> responses;
+	for (int i = 0; i < 20; i++) {
+		responses.push_back(client.Send(MakeRequest("https://api.test/ok")));
+	}
+	for (auto& response : responses) response.wait();
+	CHECK(client.Opened == 1);
+
+	client.Send(MakeRequest("https://other.test/ok")).wait();
+	client.Send(MakeRequest("https://api.test:8443/ok")).wait();
+	client.Send(MakeRequest("https://api.test/ok")).wait();
+	CHECK(client.Opened == 3);
+	CHECK(client.Requests().size() == 23);
+
+	client.Shutdown();
+	CHECK(client.Closed == 3);
+}
+
+// Timeouts reach the transport, less whatever was spent waiting for a worker
+static void TestTimeouts() {
+	CStubHttpClient client(1);
+	client.Route("/ok", 200, "ok");
+
+	// The transport gives up
+	CStopwatch timer;
+	CHttpResponse response = client.Send(MakeRequest("http://api.test/hang", 100)).get();
+	double elapsed = timer.ElapsedMs();
+	CHECK(response.Status == 0 && response.Error == "Timed out");
+	CHECK(elapsed >= 90 && elapsed < 1000);
+
+	// Queued behind it, the budget left is passed on
+	future<CHttpResponse> hung = client.Send(MakeRequest("http://api.test/hang", 150));
+	future<CHttpResponse> queued = client.Send(MakeRequest("http://api.test/ok", 1000));
+	CHECK(queued.get().Status == 200);
+	vector<int> timeouts = client.Timeouts();
+	CHECK(timeouts.size() == 3 && timeouts[2] <= 1000 - 140 && timeouts[2] > 0);
+
+	// Run out while queued, never sent
+	hung = client.Send(MakeRequest("http://api.test/hang", 150));
+	response = client.Send(MakeRequest("http://api.test/ok", 50)).get();
+	CHECK(response.Status == 0 && response.Error == "Timed out waiting for a worker");
+	CHECK(client.Requests().size() == 4);
+}
+
+// Requests in flight are cancelled, queued ones fail, later ones fail straight away
+static void TestShutdown() {
+	CStubHttpClient client(2);
+	client.Route("/ok", 200, "ok");
+	vector<future<CHttpResponse>> inFlight;
+	for (int i = 0; i < 2; i++) {
+		inFlight.push_back(client.Send(MakeRequest("http://api.test/hang", 60000)));
+	}
+	CHECK(WaitFor([&] { return client.Active == 2; }));
+
+	atomic<int> abandoned(0);
+	for (int i = 0; i < 5; i++) {
+		client.Send(MakeRequest("http://api.test/ok"), [&abandoned](const CHttpResponse& response) {
+			if (response.Status == 0 && response.Error == "Client shut down") abandoned++;
+		});
+	}
+
+	CStopwatch timer;
+	client.Shutdown();
+	CHECK(timer.ElapsedMs() < 1000);
+	CHECK(abandoned == 5);
+	for (auto& response : inFlight) {
+		CHECK(response.get().Error == "Connection closed");
+	}
+	CHECK(client.Requests().size() == 2);
+
+	// Late
+	future<CHttpResponse> late = client.Send(MakeRequest("http://api.test/ok"));
+	CHECK(late.wait_for(chrono::seconds(0)) == future_status::ready);
+	CHECK(late.get().Error == "Client shut down");
+	client.Shutdown();
+}
+
+// The shared client, swapped, released and asked for too late
+static void TestInstance() {
+	int destroyed = CStubHttpClient::Destroyed;
+
+	// Made on first use
+	CHttpClient* made = CHttpClient::Instance();
+	CHECK(madeClients == 1 && CHttpClient::Instance() == made);
+
+	// Swapping shuts the old one down and deletes it
+	CStubHttpClient* stub = new CStubHttpClient(2);
+	stub->Route("/ok", 200, "ok");
+	CHttpClient::SetInstance(stub);
+	CHECK(CStubHttpClient::Destroyed == destroyed + 1);
+	CHECK(CHttpClient::Instance() == stub);
+	CHECK(CHttpClient::Get("http://api.test/ok").Body == "ok");
+
+	// Unloading, nothing new is made
+	CHttpClient::SetInstance(nullptr);
+	CHECK(CStubHttpClient::Destroyed == destroyed + 2);
+	CLifecycle::RequestShutdown();
+	CHttpClient* late = CHttpClient::Instance();
+	CHECK(late != nullptr && madeClients == 1);
+
+	// Released, the stopped client answers straight away, for everyone
+	CHttpClient::Release();
+	CHECK(CHttpClient::Instance() == late);
+	CStopwatch timer;
+	CHttpResponse response = CHttpClient::Get("http://api.test/ok");
+	CHECK(response.Status == 0 && response.Error == "Client shut down");
+	bool isCalled = false;
+	late->Send(MakeRequest("http://api.test/ok"), [&isCalled](const CHttpResponse& r) { isCalled = r.Error == "Client shut down"; });
+	CHECK(isCalled);
+	CHECK(timer.ElapsedMs() < 100);
+	CHECK(madeClients == 1);
+}
+
+// Round trips through the pool
+static void BenchRequests(int iterations) {
+	CStubHttpClient client(HTTP_WORKERS);
+	client.Route("/ok", 200, "ok");
+	CStopwatch timer;
+	atomic<int> done(0);
+	for (int i = 0; i < iterations; i++) {
+		client.Send(MakeRequest("http://api.test/ok"), [&done](const CHttpResponse& response) { done++; });
+	}
+	CHECK(WaitFor([&] { return done == iterations; }));
+	double elapsed = timer.ElapsedMs();
+	printf("%d requests through %d workers in %.1fms (%.1f us a request)\n", iterations, HTTP_WORKERS, elapsed, elapsed * 1000.0 / iterations);
+}
+
+int main(int argc, char** argv) {
+	TestWorkers();
+	TestKeepAlive();
+	TestTimeouts();
+	TestShutdown();
+	BenchRequests(CCheck::Iterations(argc, argv, 20000));
+	TestInstance();
+	return CCheck::Result("HttpClientTests");
+}
@@ -0,0 +1,25 @@
+#include "Lifecycle.h"
+
+// The plugin's token is a Win32 event, the test targets only need the flag and the stop routines
+static atomic<bool> isStopping(false);
+static vector<function<void()>> stopRoutines;
+
+bool CLifecycle::IsShuttingDown() {
+	return isStopping;
+}
+
+void CLifecycle::OnShutdown(function<void()> callback) {
+	if (isStopping) {
+		callback();
+		return;
+	}
+	stopRoutines.push_back(callback);
+}
+
+void CLifecycle::RequestShutdown() {
+	isStopping = true;
+	for (auto it = stopRoutines.rbegin(); it != stopRoutines.rend(); it++) {
+		(*it)();
+	}
+	stopRoutines.clear();
+}
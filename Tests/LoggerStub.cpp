@@ -0,0 +1,4 @@
+#include "Logger.h"
+
+// The log file lives next to the plugin DLL, the test targets just drop what would go in it
+void CLogger::Log(CLogType type, string text, string invokedBy) {}
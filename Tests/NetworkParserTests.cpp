@@ -0,0 +1,291 @@
+#include "Check.h"
+#include "NetworkParser.h"
+#include "TrackIngest.h"
+#include <json.hpp>
+#include <fstream>
+#include <sstream>
+
+using json = nlohmann::json;
+using namespace std;
+
+// A sample payload from Tests/Data
+static string ReadPayload(const char* name) {
+	ifstream file(string("Data/") + name, ios::binary);
+	stringstream contents;
+	contents << file.rdbuf();
+	return contents.str();
+}
+
+// The DOM parse the plugin used before the SAX parsers, kept as the reference
+static void DomFlightPlan(const json& object, CNetworkFlightPlan& netFP) {
+	netFP.Callsign = object.at("callsign");
+	netFP.Type = object.at("type");
+	netFP.AssignedLevel = object.at("assignedLevel");
+	netFP.AssignedMach = object.at("assignedMach");
+	netFP.Track = object.at("track");
+	netFP.Route = object.at("route");
+	netFP.RouteEtas = object.at("routeEtas");
+	netFP.Departure = object.at("departure");
+	netFP.Arrival = object.at("arrival");
+	netFP.Direction = object.at("direction");
+	netFP.Etd = object.at("etd");
+	netFP.Selcal = object.at("selcal");
+	netFP.DatalinkConnected = object.at("datalinkConnected");
+	netFP.IsEquipped = object.at("isEquipped");
+	netFP.State = object.at("state");
+	netFP.Relevant = object.at("relevant");
+	netFP.TrackedBy = object.at("trackedBy");
+	netFP.TrackedById = object.at("trackedById");
+	netFP.TargetMode = object.at("targetMode");
+	netFP.LastUpdated = object.at("lastUpdated");
+}
+
+static int DomFlightPlans(const string& response, vector<CNetworkFlightPlan>& flights) {
+	try {
+		json jsonArray = json::parse(response);
+		if (!jsonArray.is_array()) return 1;
+		for (size_t i = 0; i < jsonArray.size(); i++) {
+			CNetworkFlightPlan netFP;
+			DomFlightPlan(jsonArray[i], netFP);
+			flights.push_back(netFP);
+		}
+	}
+	catch (exception&) {
+		return 1;
+	}
+	return 0;
+}
+
+static int DomTracks(const string& response, vector<pair<CTrack, bool>>& tracks) {
+	try {
+		json jsonArray = json::parse(response);
+		if (!jsonArray.is_array()) return 1;
+		for (size_t i = 0; i < jsonArray.size(); i++) {
+			CTrack track;
+			track.Identifier = jsonArray[i].at("id");
+			track.TMI = jsonArray[i].at("tmi");
+			int direction = jsonArray[i].at("direction");
+			track.Direction = direction == 0 ? CTrackDirection::UNKNOWN : direction == 1 ? CTrackDirection::WEST : CTrackDirection::EAST;
+			const json& route = jsonArray[i].at("route");
+			bool pointsValid = true;
+			for (size_t j = 0; j < route.size(); j++) {
+				string name = route[j].at("name");
+				CPosition position;
+				if (!CTrackIngest::MakeTrackPoint(name, route[j].at("latitude"), route[j].at("longitude"), position)) {
+					pointsValid = false;
+					break;
+				}
+				track.Route.push_back(name);
+				track.RouteRaw.push_back(position);
+			}
+			for (size_t j = 0; j < jsonArray[i].at("flightLevels").size(); j++) {
+				track.FlightLevels.push_back((int)jsonArray[i].at("flightLevels")[j]);
+			}
+			track.validFrom = string(jsonArray[i].at("validFrom"));
+			track.validTo = string(jsonArray[i].at("validTo"));
+			tracks.push_back(make_pair(track, pointsValid));
+		}
+	}
+	catch (exception&) {
+		return 1;
+	}
+	return 0;
+}
+
+static bool IsSameFlight(const CNetworkFlightPlan& a, const CNetworkFlightPlan& b) {
+	return a.Callsign == b.Callsign && a.Type == b.Type && a.AssignedLevel == b.AssignedLevel && a.AssignedMach == b.AssignedMach
+		&& a.Track == b.Track && a.Route == b.Route && a.RouteEtas == b.RouteEtas && a.Departure == b.Departure && a.Arrival == b.Arrival
+		&& a.Direction == b.Direction && a.Etd == b.Etd && a.Selcal == b.Selcal && a.DatalinkConnected == b.DatalinkConnected
+		&& a.IsEquipped == b.IsEquipped && a.State == b.State && a.Relevant == b.Relevant && a.TargetMode == b.TargetMode
+		&& a.TrackedBy == b.TrackedBy && a.TrackedById == b.TrackedById && a.LastUpdated == b.LastUpdated;
+}
+
+static bool IsSameTrack(const CTrack& a, const CTrack& b) {
+	if (a.Identifier != b.Identifier || a.TMI != b.TMI || a.Direction != b.Direction || a.Route != b.Route || a.FlightLevels != b.FlightLevels
+		|| a.validFrom != b.validFrom || a.validTo != b.validTo || a.RouteRaw.size() != b.RouteRaw.size()) {
+		return false;
+	}
+	for (size_t i = 0; i < a.RouteRaw.size(); i++) {
+		if (a.RouteRaw[i].m_Latitude != b.RouteRaw[i].m_Latitude || a.RouteRaw[i].m_Longitude != b.RouteRaw[i].m_Longitude) return false;
+	}
+	return true;
+}
+
+static int SaxFlightPlans(const string& response, vector<CNetworkFlightPlan>& flights, string& error) {
+	return CNetworkParser::ParseFlightPlans(response, [&flights](CNetworkFlightPlan& netFP) { flights.push_back(move(netFP)); }, error);
+}
+
+static int SaxTracks(const string& response, vector<pair<CTrack, bool>>& tracks, string& error) {
+	return CNetworkParser::ParseTracks(response, [&tracks](CTrack& track, bool pointsValid) { tracks.push_back(make_pair(move(track), pointsValid)); }, error);
+}
+
+// The streamed records match the DOM ones field for field
+static void TestFlightPlans() {
+	string payload = ReadPayload("FlightData.json");
+	CHECK(!payload.empty());
+
+	vector<CNetworkFlightPlan> sax, dom;
+	string error;
+	CHECK(SaxFlightPlans(payload, sax, error) == 0 && error.empty());
+	CHECK(DomFlightPlans(payload, dom) == 0);
+	CHECK(sax.size() == 5 && sax.size() == dom.size());
+	for (size_t i = 0; i < sax.size() && i < dom.size(); i++) {
+		CHECK(IsSameFlight(sax[i], dom[i]));
+	}
+
+	// A few values by hand
+	CHECK(sax.size() == 5 && sax[0].Callsign == "BAW117" && sax[0].AssignedLevel == 370 && sax[0].TargetMode == CRadarTargetMode::ADS_B);
+	CHECK(sax.size() == 5 && sax[1].Direction && !sax[1].DatalinkConnected && sax[3].Route == "H6350 63N40 6230N 61N20");
+
+	// No flights is still a good payload
+	sax.clear();
+	CHECK(SaxFlightPlans("[]", sax, error) == 0 && sax.empty());
+}
+
+// Every way a flight payload can be wrong fails the parse, as the DOM conversions threw
+static void ExpectFlightError(const string& payload, const char* expected) {
+	vector<CNetworkFlightPlan> sax, dom;
+	string error;
+	bool isFailed = SaxFlightPlans(payload, sax, error) == 1;
+	if (!isFailed || error.find(expected) == string::npos) printf("  expected \"%s\", got \"%s\"\n", expected, error.c_str());
+	CHECK(isFailed && error.find(expected) != string::npos);
+	CHECK(DomFlightPlans(payload, dom) == 1);
+}
+
+static void TestFlightPlanErrors() {
+	json records = json::parse(ReadPayload("FlightData.json"));
+
+	json missing = records;
+	missing[2].erase("selcal");
+	ExpectFlightError(missing.dump(), "missing selcal");
+
+	json wrongType = records;
+	wrongType[1]["assignedLevel"] = "350";
+	ExpectFlightError(wrongType.dump(), "assignedLevel is not a number");
+
+	wrongType = records;
+	wrongType[0]["callsign"] = 117;
+	ExpectFlightError(wrongType.dump(), "callsign is not a string");
+
+	wrongType = records;
+	wrongType[4]["relevant"] = "yes";
+	ExpectFlightError(wrongType.dump(), "relevant is not a boolean");
+
+	ExpectFlightError(records[0].dump(), "not an array");
+	ExpectFlightError("\"BAW117\"", "not an array");
+	ExpectFlightError("[1, 2]", "not an object");
+	ExpectFlightError("[[]]", "not an object");
+
+	string truncated = records.dump();
+	ExpectFlightError(truncated.substr(0, truncated.size() / 2), "parse error");
+	ExpectFlightError("", "parse error");
+}
+
+// Tracks match the DOM and the ingest keeps the good ones
+static void TestTracks() {
+	string payload = ReadPayload("Tracks.json");
+	CHECK(!payload.empty());
+
+	vector<pair<CTrack, bool>> sax, dom;
+	string error;
+	CHECK(SaxTracks(payload, sax, error) == 0 && error.empty());
+	CHECK(DomTracks(payload, dom) == 0);
+	CHECK(sax.size() == 5 && sax.size() == dom.size());
+	for (size_t i = 0; i < sax.size() && i < dom.size(); i++) {
+		CHECK(sax[i].second == dom[i].second);
+		CHECK(!sax[i].second || IsSameTrack(sax[i].first, dom[i].first));
+	}
+
+	// Half degree names and DDMM numbers both land on the right spot
+	CHECK(sax.size() == 5 && sax[1].first.RouteRaw[1].m_Latitude == 60.5 && sax[1].first.RouteRaw[1].m_Longitude == -30.0);
+	CHECK(sax.size() == 5 && sax[2].first.RouteRaw[4].m_Latitude == 59.5 && sax[2].first.RouteRaw[4].m_Longitude == -60.0);
+	CHECK(sax.size() == 5 && sax[3].first.Direction == CTrackDirection::EAST && sax[3].first.FlightLevels.size() == 9);
+	CHECK(sax.size() == 5 && !sax[4].second);
+
+	// The bad track is dropped, the rest are staged
+	CTrackSet staging;
+	CHECK(CTrackIngest::ParseTracks(payload, staging, error) == 0);
+	CHECK(staging.Tracks.size() == 4 && staging.TMI == "292" && staging.Tracks.count("Z") == 0);
+}
+
+static void ExpectTrackError(const string& payload, const char* expected) {
+	vector<pair<CTrack, bool>> sax;
+	string error;
+	bool isFailed = SaxTracks(payload, sax, error) == 1;
+	if (!isFailed || error.find(expected) == string::npos) printf("  expected \"%s\", got \"%s\"\n", expected, error.c_str());
+	CHECK(isFailed && error.find(expected) != string::npos);
+}
+
+static void TestTrackErrors() {
+	json tracks = json::parse(ReadPayload("Tracks.json"));
+
+	json missing = tracks;
+	missing[0].erase("validTo");
+	ExpectTrackError(missing.dump(), "missing validTo");
+
+	missing = tracks;
+	missing[1]["route"][2].erase("latitude");
+	ExpectTrackError(missing.dump(), "missing latitude");
+
+	json wrongType = tracks;
+	wrongType[0]["direction"] = "1";
+	ExpectTrackError(wrongType.dump(), "direction is not a number");
+
+	wrongType = tracks;
+	wrongType[0]["route"] = "ERAKA 6130N";
+	ExpectTrackError(wrongType.dump(), "route is not an array");
+
+	wrongType = tracks;
+	wrongType[3]["flightLevels"][0] = "F320";
+	ExpectTrackError(wrongType.dump(), "flightLevels is not a number");
+
+	ExpectTrackError(tracks[0].dump(), "not an array");
+	ExpectTrackError("[\"A\"]", "not an object");
+
+	// Nothing usable is an ingest error, not a parse error
+	CTrackSet staging;
+	string error;
+	CHECK(CTrackIngest::ParseTracks("[]", staging, error) == 1 && error == "No valid tracks were found.");
+}
+
+// A busy network day, parsed both ways
+static void BenchFlightPlans(int iterations) {
+	json records = json::parse(ReadPayload("FlightData.json"));
+	json day = json::array();
+	for (int i = 0; i < 2000; i++) {
+		json record = records[i % records.size()];
+		record["callsign"] = record["callsign"].get<string>() + to_string(i);
+		day.push_back(record);
+	}
+	string payload = day.dump();
+
+	size_t saxCount = 0;
+	CStopwatch saxTimer;
+	for (int i = 0; i < iterations; i++) {
+		string error;
+		CNetworkParser::ParseFlightPlans(payload, [&saxCount](CNetworkFlightPlan& netFP) { saxCount++; }, error);
+	}
+	double saxElapsed = saxTimer.ElapsedMs();
+
+	size_t domCount = 0;
+	CStopwatch domTimer;
+	for (int i = 0; i < iterations; i++) {
+		vector<CNetworkFlightPlan> flights;
+		DomFlightPlans(payload, flights);
+		domCount += flights.size();
+	}
+	double domElapsed = domTimer.ElapsedMs();
+
+	CHECK(saxCount == (size_t)iterations * 2000 && domCount == saxCount);
+	printf("%d parses of %zu KB (2000 records): SAX %.2fms, DOM %.2fms a parse\n",
+		iterations, payload.size() / 1024, saxElapsed / iterations, domElapsed / iterations);
+}
+
+int main(int argc, char** argv) {
+	TestFlightPlans();
+	TestFlightPlanErrors();
+	TestTracks();
+	TestTrackErrors();
+	BenchFlightPlans(CCheck::Iterations(argc, argv, 20));
+	return CCheck::Result("NetworkParserTests");
+}
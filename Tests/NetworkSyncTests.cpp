@@ -0,0 +1,208 @@
+#include "Check.h"
+#include "StubHttpClient.h"
+#include "NetworkSync.h"
+#include "NetworkParser.h"
+#include <json.hpp>
+#include <fstream>
+#include <sstream>
+
+using json = nlohmann::json;
+using namespace std;
+
+// The test target's transport
+CHttpClient* CHttpClient::MakeClient() {
+	return new CStubHttpClient();
+}
+
+static const string BASE_URL = "https://api.test/GetAllFlightData";
+
+static string ReadPayload(const char* name) {
+	ifstream file(string("Data/") + name, ios::binary);
+	stringstream contents;
+	contents << file.rdbuf();
+	return contents.str();
+}
+
+// A flight we hold, as the last sync left it
+static shared_ptr<const CAircraftFlightPlan> MakeFlight(const json& record, bool isFirstUpdate) {
+	CNetworkFlightPlan netFP;
+	string error;
+	CNetworkParser::ParseFlightPlans("[" + record.dump() + "]", [&netFP](CNetworkFlightPlan& parsed) { netFP = parsed; }, error);
+	CAircraftFlightPlan fp;
+	fp.Callsign = netFP.Callsign;
+	vector<string> route;
+	CNetworkSync::SplitRoute(netFP.Route, route);
+	CNetworkSync::ApplyRecord(fp, netFP, route);
+	fp.IsFirstUpdate = isFirstUpdate;
+	return make_shared<CAircraftFlightPlan>(fp);
+}
+
+// Apply a sync result the way the UI thread does
+static void ApplyResult(CFlightIndex& index, const CNetworkSyncResult& result) {
+	for (const auto& changed : result.Changed) {
+		CAircraftFlightPlan fp = *index.Flights[changed.first.Callsign];
+		CNetworkSync::ApplyRecord(fp, changed.first, changed.second);
+		index.Flights[changed.first.Callsign] = make_shared<CAircraftFlightPlan>(fp);
+	}
+	for (const string& callsign : result.Unsynced) {
+		CAircraftFlightPlan fp = *index.Flights[callsign];
+		fp.IsFirstUpdate = true;
+		index.Flights[callsign] = make_shared<CAircraftFlightPlan>(fp);
+	}
+	index.Version++;
+}
+
+static bool HasChanged(const CNetworkSyncResult& result, const string& callsign) {
+	for (const auto& changed : result.Changed) {
+		if (changed.first.Callsign == callsign) return true;
+	}
+	return false;
+}
+
+// Full sync, the diff, applying it, then deltas from the watermark
+static void TestSync() {
+	CStubHttpClient* stub = new CStubHttpClient(2);
+	CHttpClient::SetInstance(stub);
+	string payload = ReadPayload("FlightData.json");
+	json records = json::parse(payload);
+	stub->Route("/GetAllFlightData", 200, payload);
+
+	// BAW117 matches the network, ACA850 has been given a new level, DAL44 has never been synced, EIN105 isn't on the network
+	CFlightIndex local;
+	local.Flights["BAW117"] = MakeFlight(records[0], true);
+	json stale = records[1];
+	stale["assignedLevel"] = 330;
+	local.Flights["ACA850"] = MakeFlight(stale, true);
+	json unsynced = records[2];
+	unsynced["route"] = "OYSTR 53/50 DOGAL";
+	local.Flights["DAL44"] = MakeFlight(unsynced, false);
+	json unknown = records[0];
+	unknown["callsign"] = "EIN105";
+	local.Flights["EIN105"] = MakeFlight(unknown, false);
+
+	// Nothing to go from, so a full sync
+	CSyncWatermark watermark;
+	CNetworkSyncResult result;
+	CHECK(!CNetworkSync::IsDeltaDue(watermark, local));
+	CHECK(CNetworkSync::Sync(BASE_URL, local, watermark, result) == 0);
+	CHECK(!result.IsDelta && result.Url == BASE_URL);
+	CHECK(stub->Requests().size() == 1 && stub->Requests()[0] == BASE_URL);
+	CHECK(result.Records == 5 && result.Received.size() == 5 && result.Bytes == payload.size());
+	CHECK(result.Changed.size() == 2 && HasChanged(result, "ACA850") && HasChanged(result, "DAL44"));
+	CHECK(result.Unsynced.size() == 1 && result.Unsynced[0] == "EIN105");
+	CHECK(watermark.Value == "2026-10-19T11:45:30.250Z");
+
+	// Apply it, the new route is reported so the flight gets re-expanded
+	CAircraftFlightPlan dal = *local.Flights["DAL44"];
+	for (const auto& changed : result.Changed) {
+		if (changed.first.Callsign == "DAL44") {
+			CHECK(changed.second.size() == 6 && changed.second[0] == "OYSTR" && changed.second[5] == "DOGAL");
+			CHECK(CNetworkSync::ApplyRecord(dal, changed.first, changed.second));
+			CHECK(!CNetworkSync::ApplyRecord(dal, changed.first, changed.second));
+		}
+	}
+	CHECK(dal.IsFirstUpdate && dal.RouteRaw.size() == 6 && dal.State == "REQUESTED");
+	ApplyResult(local, result);
+	CHECK(local.Flights["ACA850"]->FlightLevel == "350");
+	CHECK(local.Flights["EIN105"]->IsFirstUpdate);
+
+	// Everything is synced and the watermark is fresh, so only changes are asked for
+	CHECK(CNetworkSync::IsDeltaDue(watermark, local));
+	json changes = json::array();
+	json climbed = records[0];
+	climbed["assignedLevel"] = 390;
+	climbed["lastUpdated"] = "2026-10-19T11:52:10.000Z";
+	changes.push_back(climbed);
+	stub->Route("/GetAllFlightData?since=2026-10-19T11%3A45%3A30.250Z", 200, changes.dump());
+	CHECK(CNetworkSync::Sync(BASE_URL, local, watermark, result) == 0);
+	CHECK(result.IsDelta && result.Url == BASE_URL + "?since=2026-10-19T11%3A45%3A30.250Z");
+	CHECK(stub->Requests().size() == 2 && stub->Requests()[1] == result.Url);
+	CHECK(result.Records == 1 && result.Changed.size() == 1 && HasChanged(result, "BAW117"));
+	CHECK(result.Unsynced.empty());
+	CHECK(watermark.Value == "2026-10-19T11:52:10.000Z");
+	ApplyResult(local, result);
+	CHECK(local.Flights["BAW117"]->FlightLevel == "390");
+
+	// Nothing new, the watermark and its age stay put
+	stub->Route("/GetAllFlightData?since=2026-10-19T11%3A52%3A10.000Z", 200, "[]");
+	clock_t moved = watermark.Time;
+	CHECK(CNetworkSync::Sync(BASE_URL, local, watermark, result) == 0);
+	CHECK(result.IsDelta && result.Records == 0 && result.Changed.empty());
+	CHECK(watermark.Value == "2026-10-19T11:52:10.000Z" && watermark.Time == moved);
+
+	// A full sync of the first payload only puts BAW117 back, everything else already matches
+	CSyncWatermark fresh;
+	stub->Route("/GetAllFlightData", 200, payload);
+	CHECK(CNetworkSync::Sync(BASE_URL, local, fresh, result) == 0);
+	CHECK(!result.IsDelta && result.Changed.size() == 1 && HasChanged(result, "BAW117"));
+	CHECK(result.Unsynced.empty());
+
+	// A stale watermark or a flight not yet synced means a full sync
+	CSyncWatermark old = watermark;
+	old.Time = clock() - (NETWORK_RESYNC_TIME + 1) * CLOCKS_PER_SEC;
+	CHECK(!CNetworkSync::IsDeltaDue(old, local));
+	json added = records[3];
+	local.Flights["ICE631"] = MakeFlight(added, false);
+	CHECK(!CNetworkSync::IsDeltaDue(watermark, local));
+}
+
+// Failed downloads and bad payloads leave the watermark alone
+static void TestErrors() {
+	CStubHttpClient* stub = new CStubHttpClient(1);
+	CHttpClient::SetInstance(stub);
+	stub->Route("/GetAllFlightData", 500, "");
+
+	CFlightIndex local;
+	CSyncWatermark watermark;
+	CNetworkSyncResult result;
+	CHECK(CNetworkSync::Sync(BASE_URL, local, watermark, result) == 1);
+	CHECK(result.Error == "500" && watermark.Value == "");
+
+	stub->Route("/GetAllFlightData", 200, "{\"callsign\": \"BAW117\"}");
+	CHECK(CNetworkSync::Sync(BASE_URL, local, watermark, result) == 2);
+	CHECK(result.Error == "Flight data is not an array." && watermark.Value == "");
+
+	// Nobody answering
+	CHttpClient::Release();
+	CHECK(CNetworkSync::Sync(BASE_URL, local, watermark, result) == 1);
+	CHECK(result.Error == "Client shut down");
+}
+
+// The diff on its own
+static void TestPlanChanged() {
+	json records = json::parse(ReadPayload("FlightData.json"));
+	CNetworkFlightPlan netFP;
+	string error;
+	CNetworkParser::ParseFlightPlans(records.dump(), [&netFP](CNetworkFlightPlan& parsed) { if (parsed.Callsign == "UAL920") netFP = parsed; }, error);
+	vector<string> route;
+	CNetworkSync::SplitRoute(netFP.Route, route);
+	CHECK(route.size() == 4 && route[2] == "57N050W");
+
+	CAircraftFlightPlan fp;
+	CHECK(CNetworkSync::IsPlanChanged(fp, netFP, route));
+	CNetworkSync::ApplyRecord(fp, netFP, route);
+	CHECK(!CNetworkSync::IsPlanChanged(fp, netFP, route));
+	CHECK(fp.IsCleared && fp.FlightLevel == "340" && fp.Mach == "80" && fp.Dest == "KIAD" && fp.DLStatus == "1");
+
+	// Whitespace in the network route doesn't make it differ
+	vector<string> spaced;
+	CNetworkSync::SplitRoute("  N5530 5640N\t57N050W  5860N ", spaced);
+	CHECK(!CNetworkSync::IsPlanChanged(fp, netFP, spaced));
+
+	CAircraftFlightPlan other = fp;
+	other.Track = "D";
+	CHECK(CNetworkSync::IsPlanChanged(other, netFP, route));
+	other = fp;
+	other.IsCleared = false;
+	CHECK(CNetworkSync::IsPlanChanged(other, netFP, route));
+	vector<string> rerouted = route;
+	rerouted.pop_back();
+	CHECK(CNetworkSync::IsPlanChanged(fp, netFP, rerouted));
+}
+
+int main(int argc, char** argv) {
+	TestPlanChanged();
+	TestSync();
+	TestErrors();
+	return CCheck::Result("NetworkSyncTests");
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+// Just enough of Win32 for the EuroScope header and the platform neutral sources to build off Windows
+// Force included by the test targets, the plugin itself never sees this
+#ifndef _WIN32
+// Standard headers first, so none of them puts NULL back afterwards
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <cwchar>
+#include <cmath>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <set>
+#include <deque>
+#include <unordered_map>
+#include <memory>
+#include <functional>
+#include <algorithm>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <future>
+#include <condition_variable>
+#include <chrono>
+
+#define DllSpecEuroScope
+#define ESINDEX void *
+#define __declspec(x)
+
+// The EuroScope header declares its pure virtuals as "= NULL"
+#undef NULL
+#define NULL 0
+
+// MSVC lets the EuroScope header use these before they are declared
+namespace EuroScopePlugIn {
+	class CRadarTarget;
+	class CController;
+	class CFlightPlan;
+	class CFlightPlanList;
+	class CSectorElement;
+	class CGrountToAirChannel;
+	class CPlugIn;
+}
+
+// MFC device context, only passed through by pointer
+class CDC;
+
+#define _MAX_PATH 260
+
+typedef int BOOL;
+typedef long LONG;
+typedef unsigned long DWORD;
+typedef unsigned long COLORREF;
+typedef void* HDC;
+typedef void* HWND;
+typedef void* HANDLE;
+typedef const char* LPCSTR;
+
+typedef struct tagPOINT {
+	LONG x;
+	LONG y;
+} POINT;
+
+typedef struct tagRECT {
+	LONG left;
+	LONG top;
+	LONG right;
+	LONG bottom;
+} RECT;
+#endif
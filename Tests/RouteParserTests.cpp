@@ -0,0 +1,211 @@
+#include "Check.h"
+#include "RouteParser.h"
+#include <cmath>
+#include <string>
+
+using namespace std;
+
+// Close enough for minutes written out and read back
+static bool IsSame(double a, double b) {
+	return abs(a - b) < 1e-9;
+}
+
+// Parse a coordinate and check where it lands
+static void ExpectCoordinate(const char* text, double latitude, double longitude) {
+	double lat = 0.0, lon = 0.0;
+	bool isParsed = CRouteParser::ParseCoordinate(text, lat, lon);
+	if (!isParsed || !IsSame(lat, latitude) || !IsSame(lon, longitude)) {
+		printf("  %s parsed %s as %f %f\n", text, isParsed ? "ok" : "failed", lat, lon);
+	}
+	CHECK(isParsed && IsSame(lat, latitude) && IsSame(lon, longitude));
+}
+
+static void ExpectRejected(const char* text) {
+	double lat = 0.0, lon = 0.0;
+	bool isParsed = CRouteParser::ParseCoordinate(text, lat, lon);
+	if (isParsed) printf("  %s should not parse\n", text);
+	CHECK(!isParsed);
+}
+
+// Whitespace of any kind splits tokens, the views point into the route
+static void TestTokens() {
+	string route = "  MALOT\t53/20 53N030W\r\n5230N  N0480F350 ";
+	const char* expected[] = { "MALOT", "53/20", "53N030W", "5230N", "N0480F350" };
+	size_t cursor = 0;
+	string_view token;
+	int count = 0;
+	while (CRouteParser::NextToken(route, cursor, token)) {
+		CHECK(count < 5 && token == expected[count]);
+		CHECK(token.data() >= route.data() && token.data() < route.data() + route.size());
+		count++;
+	}
+	CHECK(count == 5);
+	CHECK(!CRouteParser::NextToken(route, cursor, token));
+
+	cursor = 0;
+	CHECK(!CRouteParser::NextToken("", cursor, token));
+	CHECK(!CRouteParser::NextToken(" \t ", cursor, token));
+}
+
+static void TestTokenTypes() {
+	CRouteToken token;
+	CHECK(CRouteParser::ParseToken("MALOT", token) && token.Type == CRouteTokenType::FIX);
+	CHECK(CRouteParser::ParseToken("DCT", token) && token.Type == CRouteTokenType::FIX);
+	CHECK(CRouteParser::ParseToken("5530N", token) && token.Type == CRouteTokenType::COORDINATE);
+	CHECK(IsSame(token.Latitude, 55.0) && IsSame(token.Longitude, -30.0));
+	CHECK(CRouteParser::ParseToken("N0480F350", token) && token.Type == CRouteTokenType::OTHER);
+	CHECK(CRouteParser::ParseToken("UN615", token) && token.Type == CRouteTokenType::OTHER);
+	CHECK(!CRouteParser::ParseToken("ABC-1", token) && token.Type == CRouteTokenType::INVALID);
+	CHECK(!CRouteParser::ParseToken("", token) && token.Type == CRouteTokenType::INVALID);
+
+	CHECK(CRouteParser::IsFix("MALOT"));
+	CHECK(!CRouteParser::IsFix("MALOTS"));
+	CHECK(!CRouteParser::IsFix("M"));
+	CHECK(!CRouteParser::IsFix("MAL0T"));
+}
+
+// Every form in the grammar, with the quadrant letters
+static void TestForms() {
+	// Slash, always north and west
+	ExpectCoordinate("50/30", 50.0, -30.0);
+	ExpectCoordinate("50/130", 50.0, -130.0);
+	ExpectCoordinate("5030/45", 50.5, -45.0);
+	ExpectCoordinate("50/04530", 50.0, -45.5);
+	ExpectCoordinate("5015/04545", 50.25, -45.75);
+
+	// DDDDN, quadrant last
+	ExpectCoordinate("5030N", 50.0, -30.0);
+	ExpectCoordinate("5030E", 50.0, 30.0);
+	ExpectCoordinate("5030S", -50.0, 30.0);
+	ExpectCoordinate("5030W", -50.0, -30.0);
+	ExpectCoordinate("5030n", 50.0, -30.0);
+
+	// DDNDD, quadrant in the middle and longitude plus 100
+	ExpectCoordinate("50N30", 50.0, -130.0);
+	ExpectCoordinate("50E30", 50.0, 130.0);
+	ExpectCoordinate("35S50", -35.0, 150.0);
+	ExpectCoordinate("35W00", -35.0, -100.0);
+
+	// NDDDD and HDDDD, half degree latitude
+	ExpectCoordinate("N5030", 50.5, -30.0);
+	ExpectCoordinate("H5030", 50.5, -30.0);
+	ExpectCoordinate("E5030", 50.5, 30.0);
+	ExpectCoordinate("S3550", -35.5, 50.0);
+	ExpectCoordinate("W3550", -35.5, -50.0);
+
+	// Full hemisphere
+	ExpectCoordinate("50N030W", 50.0, -30.0);
+	ExpectCoordinate("5030N04530W", 50.5, -45.5);
+	ExpectCoordinate("35S150E", -35.0, 150.0);
+	ExpectCoordinate("3515S15045E", -35.25, 150.75);
+
+	// Not coordinates
+	ExpectRejected("");
+	ExpectRejected("5/30");
+	ExpectRejected("50/3");
+	ExpectRejected("5060/30");
+	ExpectRejected("50/030600");
+	ExpectRejected("5030X");
+	ExpectRejected("50X30");
+	ExpectRejected("X5030");
+	ExpectRejected("MALOT");
+	ExpectRejected("95N030W");
+	ExpectRejected("50N18030W");
+	ExpectRejected("50N030X");
+	ExpectRejected("5N030W");
+}
+
+// Write every position out in each format, read it back and land in the same place
+static void TestRoundTrip() {
+	CRouteToken token;
+	char buffer[16];
+	int forms[4] = { 0, 0, 0, 0 }; // DDDDN, DDNDD, NDDDD, full hemisphere
+	int checked = 0;
+	int failed = 0;
+
+	for (int latHalf = -179; latHalf <= 179; latHalf++) {
+		for (int lon = -179; lon <= 179; lon++) {
+			for (int minutes : { 0, 15, 30 }) {
+				double latitude = latHalf / 2.0;
+				double longitude = lon + (lon < 0 ? -minutes : minutes) / 60.0;
+				for (int format = 0; format <= 2; format++) {
+					// Slash format has no hemispheres, it is north and west only
+					if (format == 0 && (latitude < 0 || longitude > 0)) continue;
+
+					size_t length = CRouteParser::FormatCoordinate(latitude, longitude, format, buffer, sizeof(buffer));
+					string_view text(buffer, length);
+					bool isSame = length > 0 && CRouteParser::ParseToken(text, token) && token.Type == CRouteTokenType::COORDINATE
+						&& IsSame(token.Latitude, latitude) && IsSame(token.Longitude, longitude);
+					if (!isSame && failed++ < 10) {
+						printf("  %f %f format %d wrote %.*s, read %f %f\n", latitude, longitude, format, (int)length, buffer, token.Latitude, token.Longitude);
+					}
+					checked++;
+
+					// Which ARINC form it took
+					if (format == 1 && length > 0) {
+						if (length != 5) forms[3]++;
+						else if (buffer[4] >= 'A') forms[0]++;
+						else if (buffer[2] >= 'A') forms[1]++;
+						else forms[2]++;
+					}
+				}
+			}
+		}
+	}
+
+	CHECK(failed == 0);
+	CHECK(forms[0] > 0 && forms[1] > 0 && forms[2] > 0 && forms[3] > 0);
+	printf("%d round trips, ARINC %d DDDDN, %d DDNDD, %d NDDDD, %d fell back to full\n", checked, forms[0], forms[1], forms[2], forms[3]);
+
+	// What it falls back to and where it gives up
+	CHECK(CRouteParser::FormatCoordinate(50.5, -130.0, 1) == "5030N13000W");
+	CHECK(CRouteParser::FormatCoordinate(50.5, -30.0, 1) == "N5030");
+	CHECK(CRouteParser::FormatCoordinate(50.0, -130.0, 1) == "50N30");
+	CHECK(CRouteParser::FormatCoordinate(50.0, -30.0, 0) == "50/30");
+	CHECK(CRouteParser::FormatCoordinate(50.0, -30.0, 0, buffer, 5) == 0);
+	CHECK(CRouteParser::FormatCoordinate(50.0, -30.0, 0, nullptr, 16) == 0);
+}
+
+// Lexing and parsing a day of NAT routes
+static void BenchRoutes(int iterations) {
+	string route = "N0482F350 DOTEN 5530N 5640N 5750N 5860N 59N070W OYSTR DCT 50/20 5030/30 51/40 H5150 N5260 53N50 5420N04530W RESNO NETKI";
+	CRouteToken token;
+	size_t tokens = 0;
+	size_t coordinates = 0;
+	CStopwatch timer;
+	for (int i = 0; i < iterations; i++) {
+		size_t cursor = 0;
+		string_view text;
+		while (CRouteParser::NextToken(route, cursor, text)) {
+			CRouteParser::ParseToken(text, token);
+			tokens++;
+			if (token.Type == CRouteTokenType::COORDINATE) coordinates++;
+		}
+	}
+	double elapsed = timer.ElapsedMs();
+	CHECK(coordinates == (size_t)iterations * 12);
+
+	// And back out for the windows
+	char buffer[16];
+	size_t written = 0;
+	CStopwatch formatTimer;
+	for (int i = 0; i < iterations; i++) {
+		for (int lon = 10; lon <= 60; lon += 10) {
+			written += CRouteParser::FormatCoordinate(50.0 + (i % 10), -lon, i % 3, buffer, sizeof(buffer));
+		}
+	}
+	double formatElapsed = formatTimer.ElapsedMs();
+	CHECK(written > 0);
+
+	printf("%zu tokens in %.1fms (%.0f ns a token), %d coordinates formatted in %.1fms\n",
+		tokens, elapsed, elapsed * 1e6 / tokens, iterations * 6, formatElapsed);
+}
+
+int main(int argc, char** argv) {
+	TestTokens();
+	TestTokenTypes();
+	TestForms();
+	TestRoundTrip();
+	BenchRoutes(CCheck::Iterations(argc, argv, 20000));
+	return CCheck::Result("RouteParserTests");
+}
@@ -0,0 +1,3 @@
+#pragma once
+
+// Stands in for <windows.h> off Windows, Platform.h has already declared what the plugin headers use
@@ -0,0 +1,124 @@
+#include "StubHttpClient.h"
+#include <thread>
+#include <chrono>
+
+atomic<int> CStubHttpClient::Destroyed(0);
+
+CStubHttpClient::CStubHttpClient(int workers) {
+	Start(workers);
+}
+
+CStubHttpClient::~CStubHttpClient() {
+	Shutdown();
+	Destroyed++;
+}
+
+void CStubHttpClient::Route(const string& url, int status, const string& body) {
+	lock_guard<mutex> lock(stubLock);
+	routes[url] = make_pair(status, body);
+}
+
+vector<string> CStubHttpClient::Requests() {
+	lock_guard<mutex> lock(stubLock);
+	return requests;
+}
+
+vector<int> CStubHttpClient::Timeouts() {
+	lock_guard<mutex> lock(stubLock);
+	return timeouts;
+}
+
+CHttpResponse CStubHttpClient::Perform(const CHttpRequest& request) {
+	CHttpResponse response;
+
+	// Split the URL (scheme://host[:port]/path)
+	size_t hostStart = request.Url.find("://");
+	if (hostStart == string::npos) {
+		response.Error = "Invalid URL";
+		return response;
+	}
+	hostStart += 3;
+	size_t pathStart = request.Url.find('/', hostStart);
+	if (pathStart == string::npos) pathStart = request.Url.size();
+	string host = request.Url.substr(hostStart, pathStart - hostStart);
+	string path = pathStart < request.Url.size() ? request.Url.substr(pathStart) : "/";
+	int port = request.Url.compare(0, 5, "https") == 0 ? 443 : 80;
+	size_t colon = host.find(':');
+	if (colon != string::npos) {
+		port = atoi(host.c_str() + colon + 1);
+		host = host.substr(0, colon);
+	}
+
+	// Connection
+	CStubConnection* connection = (CStubConnection*)GetConnection(host, port);
+	if (connection == nullptr) {
+		response.Error = "Could not connect to " + host;
+		return response;
+	}
+
+	int active = ++Active;
+	int peak = PeakActive;
+	while (active > peak && !PeakActive.compare_exchange_weak(peak, active)) {}
+
+	{
+		unique_lock<mutex> lock(stubLock);
+		requests.push_back(request.Url);
+		timeouts.push_back(request.TimeoutMs);
+
+		if (path == "/hang") {
+			// Nothing comes back, closing the connection cancels it
+			if (closedSignal.wait_for(lock, chrono::milliseconds(request.TimeoutMs), [connection] { return connection->IsClosed; })) {
+				response.Error = "Connection closed";
+			}
+			else {
+				response.Error = "Timed out";
+			}
+		}
+		else if (path == "/slow") {
+			lock.unlock();
+			this_thread::sleep_for(chrono::milliseconds(20));
+			response.Status = 200;
+			response.Body = "slow";
+		}
+		else {
+			auto route = routes.find(path);
+			if (route != routes.end()) {
+				response.Status = route->second.first;
+				response.Body = route->second.second;
+			}
+			else {
+				response.Status = 404;
+			}
+		}
+	}
+
+	Active--;
+	return response;
+}
+
+void* CStubHttpClient::OpenConnection(const string& host, int port) {
+	lock_guard<mutex> lock(stubLock);
+	CStubConnection* connection = new CStubConnection();
+	connection->Host = host;
+	opened.push_back(connection);
+	Opened++;
+	return connection;
+}
+
+void CStubHttpClient::CloseConnection(void* connection) {
+	{
+		lock_guard<mutex> lock(stubLock);
+		((CStubConnection*)connection)->IsClosed = true;
+		Closed++;
+	}
+	closedSignal.notify_all();
+}
+
+void CStubHttpClient::OnStopped() {
+	// The workers have stopped, nothing holds a connection now
+	lock_guard<mutex> lock(stubLock);
+	for (CStubConnection* connection : opened) {
+		delete connection;
+	}
+	opened.clear();
+}
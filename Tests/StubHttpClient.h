@@ -0,0 +1,53 @@
+#pragma once
+#include "HttpClient.h"
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <condition_variable>
+
+using namespace std;
+
+// In-memory transport for the pooled client, answers from canned routes instead of the network
+// Paths: /hang waits until its connection is closed or its timeout runs out, /slow takes a little while, anything in Routes is served, the rest are 404
+class CStubHttpClient : public CPooledHttpClient
+{
+	public:
+		CStubHttpClient(int workers = HTTP_WORKERS);
+		virtual ~CStubHttpClient();
+
+		// Serve a body for a URL (path and query)
+		void Route(const string& url, int status, const string& body);
+
+		// URLs performed, in order
+		vector<string> Requests();
+
+		// Timeout each request reached the transport with
+		vector<int> Timeouts();
+
+		atomic<int> Opened{ 0 }; // Connections opened
+		atomic<int> Closed{ 0 }; // Connections closed
+		atomic<int> Active{ 0 }; // Requests being performed
+		atomic<int> PeakActive{ 0 }; // Most performed at once
+
+		static atomic<int> Destroyed; // Clients destroyed
+
+	protected:
+		CHttpResponse Perform(const CHttpRequest& request);
+		void* OpenConnection(const string& host, int port);
+		void CloseConnection(void* connection);
+		void OnStopped();
+
+	private:
+		// A fake connection, closing it cancels a request waiting on it
+		struct CStubConnection {
+			string Host;
+			bool IsClosed = false;
+		};
+
+		map<string, pair<int, string>> routes;
+		vector<string> requests;
+		vector<int> timeouts;
+		vector<CStubConnection*> opened;
+		mutex stubLock;
+		condition_variable closedSignal;
+};
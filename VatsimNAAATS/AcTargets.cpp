@@ -4,6 +4,10 @@
 #include "ConflictDetection.h"
 #include "MenuBar.h"
 #include "Logger.h"
+#include "Profiler.h"
+#include "Projection.h"
+#include "TextCache.h"
+#include "CallsignTable.h"
 
 using namespace Colours;
 
@@ -22,26 +26,37 @@ void CAcTargets::Initialise() {
 	ButtonStates["Refuse"] = false;
 }
 
+CRadarTargetMode CAcTargets::UpdateTargetMode(CRadarTarget* target) {
+	// Only touch the flight data when they change
+	CRadarTargetMode targetMode = CUtils::GetTargetMode(target->GetPosition().GetRadarFlags());
+	shared_ptr<const CAircraftFlightPlan> acFP = CDataHandler::GetFlightSnapshot(target->GetCallsign());
+	if (acFP != nullptr && acFP->TargetMode != targetMode) {
+		CDataHandler::GetFlightData(target->GetCallsign())->TargetMode = targetMode;
+		CDataHandler::MarkFlightChanged(target->GetCallsign());
+	}
+	return targetMode;
+}
+
 void CAcTargets::RenderTarget(Graphics* g, CDC* dc, CRadarScreen* screen, CRadarTarget* target, bool tagsOn, map<int, CWinButton>* toggleData, bool halo, bool ptl, CSTCAStatus* status) {
 	// 2 second timer
 	double twoSecT = (double)(clock() - twoSecondTimer) / ((double)CLOCKS_PER_SEC);
 
 	// Performance timer
-	double functionClock = clock();
+	CFrameProfiler::CScope profile(PRF_TARGETS);
+	CFrameProfiler::CountTarget();
 
 	// Get the aircraft's position and heading
-	POINT acPoint = screen->ConvertCoordFromPositionToPixel(target->GetPosition().GetPosition());
+	POINT acPoint = CProjection::ToPixel(screen, target->GetPosition().GetPosition());
 
 	// Callsign
 	string cs = target->GetCallsign();
 
 	// Flight plan
 	CFlightPlan fp = screen->GetPlugIn()->FlightPlanSelect(cs.c_str());
-	CAircraftFlightPlan* acFP = CDataHandler::GetFlightData(cs);
+	shared_ptr<const CAircraftFlightPlan> acFP = CDataHandler::GetFlightSnapshot(cs);
 
-	// Radar flags	
-	acFP->TargetMode = CUtils::GetTargetMode(target->GetPosition().GetRadarFlags());
-	CRadarTargetMode targetMode = acFP->TargetMode;
+	// Radar flags
+	CRadarTargetMode targetMode = UpdateTargetMode(target);
 
 	// Check if there is an active handoff to client 
 	bool isHandoffToMe = string(fp.GetHandoffTargetControllerCallsign()) == string(screen->GetPlugIn()->ControllerMyself().GetCallsign());
@@ -52,17 +67,17 @@ void CAcTargets::RenderTarget(Graphics* g, CDC* dc, CRadarScreen* screen, CRadar
 	// Save context for later
 	int sDC = dc->SaveDC();
 
-	// Define brushes and a container for the target
-	SolidBrush orangeBrush(TargetOrange);
-	SolidBrush blueBrush(TargetBlue);
-	SolidBrush yellowBrush(WarningYellow);
-	SolidBrush redBrush(CriticalRed);
-	SolidBrush whiteBrush(TextWhite);
-	Pen bluePen(&blueBrush, 1.5);
-	Pen orangePen(&orangeBrush, 1.5);
-	Pen whitePen(&whiteBrush, 1.5);
-	Pen redPen(&redBrush, 1.5);
-	Pen yellowPen(&yellowBrush, 1.5);
+	// Shared brushes and pens, and a container for the target
+	SolidBrush* orangeBrush = StyleCache::GetBrush(TargetOrange);
+	SolidBrush* blueBrush = StyleCache::GetBrush(TargetBlue);
+	SolidBrush* yellowBrush = StyleCache::GetBrush(WarningYellow);
+	SolidBrush* redBrush = StyleCache::GetBrush(CriticalRed);
+	SolidBrush* whiteBrush = StyleCache::GetBrush(TextWhite);
+	Pen* bluePen = StyleCache::GetPen(TargetBlue, 1.5);
+	Pen* orangePen = StyleCache::GetPen(TargetOrange, 1.5);
+	Pen* whitePen = StyleCache::GetPen(TextWhite, 1.5);
+	Pen* redPen = StyleCache::GetPen(CriticalRed, 1.5);
+	Pen* yellowPen = StyleCache::GetPen(WarningYellow, 1.5);
 	GraphicsContainer gContainer;
 
 	// Begin drawing
@@ -122,7 +137,7 @@ void CAcTargets::RenderTarget(Graphics* g, CDC* dc, CRadarScreen* screen, CRadar
 	g->TranslateTransform(acPoint.x, acPoint.y, MatrixOrderAppend);
 	// Change targets depending on mode
 	if (targetMode == CRadarTargetMode::ADS_B) {	
-		if (acFP->IsCleared) {
+		if (acFP != nullptr && acFP->IsCleared) {
 			// Rotate the graphics object and set the middle to the aircraft position
 			g->RotateTransform(target->GetPosition().GetReportedHeadingTrueNorth());
 
@@ -153,32 +168,31 @@ void CAcTargets::RenderTarget(Graphics* g, CDC* dc, CRadarScreen* screen, CRadar
 			if (status->ConflictStatus == CConflictStatus::CRITICAL) {
 				// Critical conflict status, so flash white and red every second
 				if (twoSecT >= 1.1) {
-					g->FillPolygon(&whiteBrush, points, 19);
+					g->FillPolygon(whiteBrush, points, 19);
 				}
 				else {
-					g->FillPolygon(&redBrush, points, 19);
+					g->FillPolygon(redBrush, points, 19);
 				}
 			}
 			else if (status->ConflictStatus == CConflictStatus::WARNING) {
 				// Warning status, turn target yellow
-				g->FillPolygon(&yellowBrush, points, 19);
+				g->FillPolygon(yellowBrush, points, 19);
 			}
 			else {
 				// No conflict, draw orange if tracked and blue if not
 				if (isHandoffToMe) {
-					g->FillPolygon(&whiteBrush, points, 19);
+					g->FillPolygon(whiteBrush, points, 19);
 				}
 				else {
 					if (fp.GetTrackingControllerIsMe())
-						g->FillPolygon(&orangeBrush, points, 19);
+						g->FillPolygon(orangeBrush, points, 19);
 					else
-						g->FillPolygon(&blueBrush, points, 19);
+						g->FillPolygon(blueBrush, points, 19);
 				}
 			}
 
 			// Cleanup
 			g->EndContainer(gContainer);
-			DeleteObject(&points);
 		}
 		else {
 			// Make diamond with line
@@ -193,40 +207,39 @@ void CAcTargets::RenderTarget(Graphics* g, CDC* dc, CRadarScreen* screen, CRadar
 			if (status->ConflictStatus == CConflictStatus::CRITICAL) {
 				// Critical conflict status, so flash white and red every second
 				if (twoSecT >= 1.1) {
-					g->DrawPolygon(&whitePen, diamond, 4);
-					g->DrawLine(&whitePen, Point(0, 6), Point(0, -6));
+					g->DrawPolygon(whitePen, diamond, 4);
+					g->DrawLine(whitePen, Point(0, 6), Point(0, -6));
 				}
 				else {
-					g->DrawPolygon(&redPen, diamond, 4);
-					g->DrawLine(&redPen, Point(0, 6), Point(0, -6));
+					g->DrawPolygon(redPen, diamond, 4);
+					g->DrawLine(redPen, Point(0, 6), Point(0, -6));
 				}
 			}
 			else if (status->ConflictStatus == CConflictStatus::WARNING) {
 				// Warning status, turn target yellow
-				g->DrawPolygon(&yellowPen, diamond, 4);
-				g->DrawLine(&yellowPen, Point(0, 6), Point(0, -6));
+				g->DrawPolygon(yellowPen, diamond, 4);
+				g->DrawLine(yellowPen, Point(0, 6), Point(0, -6));
 			}
 			else {
 				// No conflict, draw orange if tracked and blue if not
 				if (isHandoffToMe) {
-					g->DrawPolygon(&whitePen, diamond, 4);
-					g->DrawLine(&whitePen, Point(0, 6), Point(0, -6));
+					g->DrawPolygon(whitePen, diamond, 4);
+					g->DrawLine(whitePen, Point(0, 6), Point(0, -6));
 				}
 				else {
 					if (fp.GetTrackingControllerIsMe()) {
-						g->DrawPolygon(&orangePen, diamond, 4);
-						g->DrawLine(&orangePen, Point(0, 6), Point(0, -6));
+						g->DrawPolygon(orangePen, diamond, 4);
+						g->DrawLine(orangePen, Point(0, 6), Point(0, -6));
 					}
 					else {
-						g->DrawPolygon(&bluePen, diamond, 4);
-						g->DrawLine(&bluePen, Point(0, 6), Point(0, -6));
+						g->DrawPolygon(bluePen, diamond, 4);
+						g->DrawLine(bluePen, Point(0, 6), Point(0, -6));
 					}
 				}
 			}
 
 			// Cleanup
 			g->EndContainer(gContainer);
-			DeleteObject(&diamond);
 		}
 	}
 	else {
@@ -250,37 +263,36 @@ void CAcTargets::RenderTarget(Graphics* g, CDC* dc, CRadarScreen* screen, CRadar
 		if (status->ConflictStatus == CConflictStatus::CRITICAL) {
 			// Critical conflict status, so flash white and red every second
 			if (twoSecT >= 1.1) {
-				g->DrawPolygon(&whitePen, points, 12);
+				g->DrawPolygon(whitePen, points, 12);
 			}
 			else {
-				g->DrawPolygon(&redPen, points, 12);
+				g->DrawPolygon(redPen, points, 12);
 			}
 		}
 		else if (status->ConflictStatus == CConflictStatus::WARNING) {
 			// Warning status, turn target yellow
-			g->DrawPolygon(&yellowPen, points, 12);
+			g->DrawPolygon(yellowPen, points, 12);
 		}
 		else {
 			// No conflict, draw orange if tracked and blue if not
 			if (isHandoffToMe) {
-				g->DrawPolygon(&whitePen, points, 12);
-				g->DrawLine(&whitePen, Point(0, 6), Point(0, -6));
+				g->DrawPolygon(whitePen, points, 12);
+				g->DrawLine(whitePen, Point(0, 6), Point(0, -6));
 			}
 			else {
 				if (fp.GetTrackingControllerIsMe()) {
-					g->DrawPolygon(&orangePen, points, 12);
-					g->DrawLine(&orangePen, Point(0, 6), Point(0, -6));
+					g->DrawPolygon(orangePen, points, 12);
+					g->DrawLine(orangePen, Point(0, 6), Point(0, -6));
 				}
 				else {
-					g->DrawPolygon(&bluePen, points, 12);
-					g->DrawLine(&bluePen, Point(0, 6), Point(0, -6));
+					g->DrawPolygon(bluePen, points, 12);
+					g->DrawLine(bluePen, Point(0, 6), Point(0, -6));
 				}
 			}
 		}
 
 		// Cleanup
 		g->EndContainer(gContainer);
-		DeleteObject(&points);
 	}
 
 	// Check if leader lines are selected
@@ -321,16 +333,8 @@ void CAcTargets::RenderTarget(Graphics* g, CDC* dc, CRadarScreen* screen, CRadar
 		POINT ptlPoint = screen->ConvertCoordFromPositionToPixel(CUtils::GetPointDistanceBearing(target->GetPosition().GetPosition(), distance, target->GetPosition().GetReportedHeadingTrueNorth()));
 
 		// Draw leader
-		Pen pen(Colours::TargetOrange, 1);
-		Pen pen2(Colours::TargetBlue, 1);
-		if (fp.GetTrackingControllerIsMe())
-			g->DrawLine(&pen, acPoint.x, acPoint.y, ptlPoint.x, ptlPoint.y);
-		else
-			g->DrawLine(&pen2, acPoint.x, acPoint.y, ptlPoint.x, ptlPoint.y);
-
-		// Cleanup
-		DeleteObject(&pen);
-		DeleteObject(&pen2);
+		Pen* pen = StyleCache::GetPen(fp.GetTrackingControllerIsMe() ? TargetOrange : TargetBlue, 1);
+		g->DrawLine(pen, acPoint.x, acPoint.y, ptlPoint.x, ptlPoint.y);
 	}
 
 	// Draw halos
@@ -379,39 +383,15 @@ void CAcTargets::RenderTarget(Graphics* g, CDC* dc, CRadarScreen* screen, CRadar
 		// Draw halo
 		Rect temp(acPoint.x - radius, acPoint.y - radius, radius * 2, radius * 2);
 		// Draw leader
-		Pen pen(Colours::TargetOrange, 1);
-		Pen pen2(Colours::TargetBlue, 1);
-		if (fp.GetTrackingControllerIsMe())
-			g->DrawEllipse(&pen, temp);
-		else
-			g->DrawEllipse(&pen2, temp);
-		
-
-		// Cleanup
-		DeleteObject(&pen);
-		DeleteObject(&pen2);
+		Pen* pen = StyleCache::GetPen(fp.GetTrackingControllerIsMe() ? TargetOrange : TargetBlue, 1);
+		g->DrawEllipse(pen, temp);
 	}
 	
 	// Restore context
 	dc->RestoreDC(sDC);
 
-	// Deallocate
-	DeleteObject(&orangeBrush);
-	DeleteObject(&yellowBrush);
-	DeleteObject(&redBrush);
-	DeleteObject(&whiteBrush);
-	DeleteObject(&blueBrush);
-	DeleteObject(&gContainer);
-	DeleteObject(&acPoint);
-	DeleteObject(&bluePen);
-	DeleteObject(&whitePen);
-	DeleteObject(&orangePen);
-	DeleteObject(&redPen);
-	DeleteObject(&yellowPen);
-
-	// Compute render time and store it
-	clock_t t = clock();
-	double lastRenderTimeMs = (t - functionClock) / (CLOCKS_PER_SEC / 1000);
+	// Compute render time (only while profiling)
+	double lastRenderTimeMs = profile.Stop();
 
 	// Log if render time was greater than 4ms
 	if (lastRenderTimeMs >= 4) {
@@ -424,13 +404,15 @@ POINT CAcTargets::RenderTag(Graphics* g, CDC* dc, CRadarScreen* screen, CRadarTa
 	double twoSecT = (double)(clock() - twoSecondTimer) / ((double)CLOCKS_PER_SEC);
 
 	// Performance timer
-	double functionClock = clock();
+	CFrameProfiler::CScope profile(PRF_TAGS);
+	CFrameProfiler::CountTag();
 
 	// Get the aircraft's position and flight plan
-	POINT acPoint = screen->ConvertCoordFromPositionToPixel(target->GetPosition().GetPosition());
+	POINT acPoint = CProjection::ToPixel(screen, target->GetPosition().GetPosition());
 	CFlightPlan acFP = screen->GetPlugIn()->FlightPlanSelect(target->GetCallsign());
-	CAircraftFlightPlan fp;
-	CDataHandler::GetFlightData(acFP.GetCallsign(), fp);
+	CFlightHotData fp;
+	CDataHandler::GetFlightHotData(acFP.GetCallsign(), fp);
+	int acId = CCallsignTable::Intern(target->GetCallsign());
 
 	// Check if there is an active handoff to client controller
 	bool isHandoffToMe = string(acFP.GetHandoffTargetControllerCallsign()) == string(screen->GetPlugIn()->ControllerMyself().GetCallsign());
@@ -562,22 +544,19 @@ POINT CAcTargets::RenderTag(Graphics* g, CDC* dc, CRadarScreen* screen, CRadarTa
 
 		FontSelector::SelectMonoFont(12, dc);
 		dc->SetTextColor(textColour);
-		text = to_string(target->GetPosition().GetFlightLevel() / 100);
-		dc->TextOutA(tagRect.left, tagRect.top + offsetY, text.c_str());
+		dc->TextOutA(tagRect.left, tagRect.top + offsetY, CTextCache::FlightLevel(target->GetPosition().GetFlightLevel()).c_str());
 		offsetX += 50;
 
 		// Mach
 		int gs = target->GetPosition().GetReportedGS();
-		text = "N" + to_string(gs);
-
-		dc->TextOutA(tagRect.left + offsetX, tagRect.top + offsetY, text.c_str());
+		dc->TextOutA(tagRect.left + offsetX, tagRect.top + offsetY, CTextCache::GroundSpeed(acId, gs).c_str());
 		offsetX = 2;
 
 		// Handoff initiated
 		if (isHandoffToMe) {
 			offsetY += 15;
 			text = "H/O";
-			dc->TextOutA(tagRect.right - dc->GetTextExtent("H/O").cx - 12, tagRect.top + offsetY, text.c_str());
+			dc->TextOutA(tagRect.right - CTextCache::GetTextExtent(dc, text).cx - 12, tagRect.top + offsetY, text.c_str());
 			offsetY += 15;
 		}
 		else {
@@ -617,12 +596,10 @@ POINT CAcTargets::RenderTag(Graphics* g, CDC* dc, CRadarScreen* screen, CRadarTa
 		}
 				
 		/// Tag line
-		CSize txtExtent = dc->GetTextExtent(acFP.GetCallsign()); // Get callsign length
+		CSize txtExtent = CTextCache::GetTextExtent(dc, acFP.GetCallsign()); // Get callsign length
 
 		// Pen
-		CPen pen(PS_SOLID, 1, textColour);
-		SolidBrush white(TextWhite);
-		dc->SelectObject(pen);
+		dc->SelectObject(StyleCache::GetGdiPen(textColour));
 		int tagMiddle = tagRect.left + ((tagRect.right - tagRect.left) / 2);
 
 		// Dog leg
@@ -677,20 +654,14 @@ POINT CAcTargets::RenderTag(Graphics* g, CDC* dc, CRadarScreen* screen, CRadarTa
 		screen->AddScreenObject(SCREEN_TAG, acFP.GetCallsign(), tagRect, true, (string(acFP.GetPilotName()) + " - " + string(acFP.GetFlightPlanData().GetRoute())).c_str());
 
 		// Now create screen object for callsign
-		CRect callsignRect(tagRect.left, tagRect.top, tagRect.left + dc->GetTextExtent(acFP.GetCallsign()).cx, tagRect.top + dc->GetTextExtent(acFP.GetCallsign()).cy);
+		CRect callsignRect(tagRect.left, tagRect.top, tagRect.left + txtExtent.cx, tagRect.top + txtExtent.cy);
 		screen->AddScreenObject(SCREEN_TAG_CS, acFP.GetCallsign(), callsignRect, true, (string(acFP.GetPilotName()) + " - " + string(acFP.GetFlightPlanData().GetRoute())).c_str());
 
 		// Restore context
 		dc->RestoreDC(sDC);
 
-		// Clean up
-		DeleteObject(pen);
-		DeleteObject(&white);
-		DeleteObject(&textColour);
-
-		// Compute render time and store it
-		clock_t t = clock();
-		double lastRenderTimeMs = (t - functionClock) / (CLOCKS_PER_SEC / 1000);
+		// Compute render time (only while profiling)
+		double lastRenderTimeMs = profile.Stop();
 
 		// Log if render time was greater than 4ms
 		if (lastRenderTimeMs >= 4) {
@@ -820,19 +791,12 @@ void CAcTargets::RenderCoordTagItem(CDC* dc, CRadarScreen* screen, string callsi
 }
 
 void CAcTargets::RenderSelectionHalo(Graphics* g, CRadarScreen* screen, CRadarTarget* target) {
-	// Brush
-	SolidBrush white(TextWhite);
-
-	POINT acPoint = screen->ConvertCoordFromPositionToPixel(target->GetPosition().GetPosition());
+	POINT acPoint = CProjection::ToPixel(screen, target->GetPosition().GetPosition());
 
 	// Anti aliasing
 	g->SetSmoothingMode(SmoothingModeAntiAlias);
 
 	// Draw halo
 	Rect temp(acPoint.x - 50, acPoint.y - 50, 50 * 2, 50 * 2);
-	Pen pen(&white, 1);
-	g->DrawEllipse(&pen, temp);
-
-	// Cleanup
-	DeleteObject(&pen);
+	g->DrawEllipse(StyleCache::GetPen(TextWhite, 1), temp);
 }
@@ -20,6 +20,9 @@ class CAcTargets
 		// Initialisation for button states
 		static void Initialise();
 
+		// Bring the radar flags in the flight data up to date, returns the target mode (run for every target, drawn or not)
+		static CRadarTargetMode UpdateTargetMode(CRadarTarget* target);
+
 		// Render the airplane icon
 		static void RenderTarget(Graphics* g, CDC* dc, CRadarScreen* screen, CRadarTarget* target, bool tagsOn, map<int, CWinButton>* toggleData, bool halo, bool ptl, CSTCAStatus* status);
 
@@ -0,0 +1,72 @@
+#include "pch.h"
+#include "CallsignTable.h"
+
+unordered_map<string, int> CCallsignTable::ids;
+vector<string> CCallsignTable::callsigns;
+
+int CCallsignTable::Intern(const string& callsign) {
+	// Already seen
+	auto id = ids.find(callsign);
+	if (id != ids.end()) {
+		return id->second;
+	}
+
+	// Assign the next id
+	int newId = (int)callsigns.size();
+	callsigns.push_back(callsign);
+	ids.insert(make_pair(callsign, newId));
+	return newId;
+}
+
+int CCallsignTable::Find(const string& callsign) {
+	auto id = ids.find(callsign);
+	return id != ids.end() ? id->second : -1;
+}
+
+const string& CCallsignTable::GetCallsign(int id) {
+	static const string empty = "";
+	if (id < 0 || id >= (int)callsigns.size()) {
+		return empty;
+	}
+	return callsigns[id];
+}
+
+int CCallsignTable::Count() {
+	return (int)callsigns.size();
+}
+
+void CAircraftIdSet::Insert(int id) {
+	if (id < 0 || Contains(id)) {
+		return;
+	}
+
+	// Grow the slot table to fit
+	if (id >= (int)slots.size()) {
+		slots.resize(id + 1, -1);
+	}
+	slots[id] = (int)members.size();
+	members.push_back(id);
+}
+
+void CAircraftIdSet::Erase(int id) {
+	if (!Contains(id)) {
+		return;
+	}
+
+	// Move the last member into the hole
+	int slot = slots[id];
+	int last = members.back();
+	members[slot] = last;
+	slots[last] = slot;
+	members.pop_back();
+	slots[id] = -1;
+}
+
+bool CAircraftIdSet::Contains(int id) const {
+	return id >= 0 && id < (int)slots.size() && slots[id] != -1;
+}
+
+void CAircraftIdSet::Clear() {
+	members.clear();
+	slots.clear();
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+using namespace std;
+
+// Interns callsigns to small stable ids, assigned when an aircraft is first seen (UI thread only)
+// Ids are never reused, so per aircraft state can live in arrays indexed by id
+class CCallsignTable
+{
+	public:
+		// Get the id for a callsign, assigning a new one if it has not been seen before
+		static int Intern(const string& callsign);
+
+		// Get the id for a callsign, -1 if it has not been seen before
+		static int Find(const string& callsign);
+
+		// Get the callsign for an id (EuroScope API and display only)
+		static const string& GetCallsign(int id);
+
+		// Number of ids assigned
+		static int Count();
+
+	private:
+		static unordered_map<string, int> ids;
+		static vector<string> callsigns;
+};
+
+// A set of callsign ids, constant time insert, erase and lookup with dense iteration
+class CAircraftIdSet
+{
+	public:
+		// Add an id
+		void Insert(int id);
+
+		// Remove an id (invalidates iteration)
+		void Erase(int id);
+
+		// Check if an id is in the set
+		bool Contains(int id) const;
+
+		// Remove all ids
+		void Clear();
+
+		// Ids in the set (unordered)
+		const vector<int>& Members() const { return members; }
+		bool Empty() const { return members.empty(); }
+		size_t Size() const { return members.size(); }
+
+	private:
+		vector<int> members; // Ids in the set
+		vector<int> slots; // Index into members for each id, -1 if not in the set
+};
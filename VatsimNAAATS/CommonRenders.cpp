@@ -1,6 +1,8 @@
 #include "pch.h"
 #include "CommonRenders.h"
 #include "Styles.h"
+#include "Projection.h"
+#include "TextCache.h"
 
 using namespace Colours;
 
@@ -98,9 +100,8 @@ CRect CCommonRenders::RenderCheckBox(CDC* dc, Graphics* g, CRadarScreen* screen,
 	// Save context for later
 	int sDC = dc->SaveDC();
 
-	// Pens
-	Pen white(TextWhite, 2);
-	Pen grey(Grey, 2);
+	// Pen
+	Pen* white = StyleCache::GetPen(TextWhite, 2);
 
 	// Create rectangle
 	CRect rect(topLeft.x, topLeft.y, topLeft.x + height, topLeft.y + height);
@@ -110,8 +111,8 @@ CRect CCommonRenders::RenderCheckBox(CDC* dc, Graphics* g, CRadarScreen* screen,
 		InflateRect(rect, -1, -1);
 		dc->Draw3dRect(rect, BevelDark.ToCOLORREF(), BevelLight.ToCOLORREF());
 		dc->FillSolidRect(rect, ButtonPressed.ToCOLORREF());
-		g->DrawLine(&white, rect.left + 1, rect.top + 1, rect.right - 2, rect.bottom - 2);
-		g->DrawLine(&white, rect.left + 1, rect.bottom - 2, rect.right - 2, rect.top + 1);
+		g->DrawLine(white, rect.left + 1, rect.top + 1, rect.right - 2, rect.bottom - 2);
+		g->DrawLine(white, rect.left + 1, rect.bottom - 2, rect.right - 2, rect.top + 1);
 	}
 	else {
 		dc->Draw3dRect(rect, BevelLight.ToCOLORREF(), BevelDark.ToCOLORREF());
@@ -122,10 +123,6 @@ CRect CCommonRenders::RenderCheckBox(CDC* dc, Graphics* g, CRadarScreen* screen,
 	// Restore device context
 	dc->RestoreDC(sDC);
 
-	// Clean up
-	DeleteObject(&white);
-	DeleteObject(&grey);
-
 	// Add object
 	screen->AddScreenObject(obj->Type, to_string(obj->Id).c_str(), rect, false, "");
 
@@ -140,7 +137,7 @@ void CCommonRenders::RenderDropDown(CDC* dc, Graphics* g, CRadarScreen* screen,
 	CRect dropDown(topLeft.x, topLeft.y, topLeft.x + width - 15, topLeft.y + height);
 
 	// Pen
-	Pen white(TextWhite, 2);
+	Pen* white = StyleCache::GetPen(TextWhite, 2);
 
 	// Fill
 	dc->FillSolidRect(dropDown, ScreenBlue.ToCOLORREF());
@@ -188,8 +185,8 @@ void CCommonRenders::RenderDropDown(CDC* dc, Graphics* g, CRadarScreen* screen,
 				dc->FillSolidRect(object, ButtonPressed.ToCOLORREF());
 			if (kv.second.IsCheckItem && kv.second.State == CInputState::ACTIVE) {
 				CRect rect(object.right - 20, object.top, object.right, object.bottom);
-				g->DrawLine(&white, rect.left + 4, rect.top + 4, rect.right - 4, rect.bottom - 4);
-				g->DrawLine(&white, rect.left + 4, rect.bottom - 4, rect.right - 4, rect.top + 4);
+				g->DrawLine(white, rect.left + 4, rect.top + 4, rect.right - 4, rect.bottom - 4);
+				g->DrawLine(white, rect.left + 4, rect.bottom - 4, rect.right - 4, rect.top + 4);
 			}
 			dc->TextOutA(area.left + 2, area.top + offsetY + 2, kv.second.Label.c_str());
 			screen->AddScreenObject(kv.second.Type, to_string(kv.second.Id).c_str(), object, false, "");
@@ -210,31 +207,26 @@ void CCommonRenders::RenderDropDown(CDC* dc, Graphics* g, CRadarScreen* screen,
 	dc->TextOutA(dropDown.left + 2, dropDown.top + 1, obj->Value.c_str());
 
 	// Button triangle
-	SolidBrush brush(Grey);
+	SolidBrush* brush = StyleCache::GetBrush(Grey);
 	g->SetSmoothingMode(SmoothingModeAntiAlias);
 	// Coz GDI+ doesn't like GDI
 	Rect rectangle(topLeft.x + width - 15, topLeft.y, topLeft.x + width, topLeft.y + height);
 	Point points[3] = { Point(rectangle.X + 2, rectangle.Y + 4),
 		Point(rectangle.X + 12, rectangle.Y + 4),
 		Point(rectangle.X + 7, rectangle.Y + 14) };
-	g->FillPolygon(&brush, points, 3);
+	g->FillPolygon(brush, points, 3);
 	// Button bevel
 	dc->Draw3dRect(button, BevelLight.ToCOLORREF(), BevelDark.ToCOLORREF());
 	InflateRect(button, -1, -1);
 	dc->Draw3dRect(button, BevelLight.ToCOLORREF(), BevelDark.ToCOLORREF());
 
 	// '3d' border trick
-	Pen darkerPen(BevelDark, 1.5);
-	g->DrawLine(&darkerPen, points[1], points[2]);
+	Pen* darkerPen = StyleCache::GetPen(BevelDark, 1.5);
+	g->DrawLine(darkerPen, points[1], points[2]);
 
 	// Restore device context
 	dc->RestoreDC(sDC);
 
-	// Clean up
-	DeleteObject(&brush);
-	DeleteObject(&darkerPen);
-	DeleteObject(&white);
-
 	// Add object
 	screen->AddScreenObject(obj->Type, to_string(obj->Id).c_str(), button, false, "");
 }
@@ -263,19 +255,19 @@ void CCommonRenders::RenderScrollBar(CDC* dc, Graphics* g, CRadarScreen* screen,
 	CRect buttonRect1;
 	CRect buttonRect2;
 	CRect grip;
-	SolidBrush brush(ScreenBlue);
-	Pen lighterPen(BevelLight, 1.5);
-	Pen darkerPen(BevelDark, 1.5);
+	SolidBrush* brush = StyleCache::GetBrush(ScreenBlue);
+	Pen* lighterPen = StyleCache::GetPen(BevelLight, 1.5);
+	Pen* darkerPen = StyleCache::GetPen(BevelDark, 1.5);
 	g->SetSmoothingMode(SmoothingModeAntiAlias);
 	if (scrollView->IsHorizontal) {
 		Point btnA[3] = { Point(scrollBarTrack.left + 1, scrollBarTrack.top + 4),
 				Point(scrollBarTrack.left + 9, scrollBarTrack.top),
 				Point(scrollBarTrack.left + 9, scrollBarTrack.bottom - 2) };
-		g->FillPolygon(&brush, btnA, 3);
+		g->FillPolygon(brush, btnA, 3);
 		Point btnB[3] = { Point(scrollBarTrack.right - 2, scrollBarTrack.top + 4),
 			Point(scrollBarTrack.right - 10, scrollBarTrack.top),
 			Point(scrollBarTrack.right - 10, scrollBarTrack.bottom - 2) };
-		g->FillPolygon(&brush, btnB, 3);
+		g->FillPolygon(brush, btnB, 3);
 
 		// Set rectangles
 		buttonRect1 = CRect(scrollBarTrack.left, scrollBarTrack.top, scrollBarTrack.left + 11, scrollBarTrack.bottom);
@@ -289,22 +281,22 @@ void CCommonRenders::RenderScrollBar(CDC* dc, Graphics* g, CRadarScreen* screen,
 		dc->Draw3dRect(grip, BevelLight.ToCOLORREF(), BevelDark.ToCOLORREF());
 
 		// '3d' border trick
-		g->DrawLine(&lighterPen, btnA[0], btnA[1]);
-		g->DrawLine(&darkerPen, btnA[1], btnA[2]);
-		g->DrawLine(&darkerPen, btnA[0], btnA[2]);
-		g->DrawLine(&lighterPen, btnB[0], btnB[1]);
-		g->DrawLine(&darkerPen, btnB[1], btnB[2]);
-		g->DrawLine(&darkerPen, btnB[0], btnB[2]);
+		g->DrawLine(lighterPen, btnA[0], btnA[1]);
+		g->DrawLine(darkerPen, btnA[1], btnA[2]);
+		g->DrawLine(darkerPen, btnA[0], btnA[2]);
+		g->DrawLine(lighterPen, btnB[0], btnB[1]);
+		g->DrawLine(darkerPen, btnB[1], btnB[2]);
+		g->DrawLine(darkerPen, btnB[0], btnB[2]);
 	}
 	else {
 		Point btnA[3] = { Point(scrollBarTrack.left + 3, scrollBarTrack.top + 1),
 			Point(scrollBarTrack.left - 1, scrollBarTrack.top + 9),
 			Point(scrollBarTrack.right - 2, scrollBarTrack.top + 9) };
-		g->FillPolygon(&brush, btnA, 3);
+		g->FillPolygon(brush, btnA, 3);
 		Point btnB[3] = { Point(scrollBarTrack.left + 3, scrollBarTrack.bottom - 2),
 			Point(scrollBarTrack.left - 1, scrollBarTrack.bottom - 10),
 			Point(scrollBarTrack.right - 2, scrollBarTrack.bottom - 10) };
-		g->FillPolygon(&brush, btnB, 3);
+		g->FillPolygon(brush, btnB, 3);
 
 		// Grip
 		grip = CRect(scrollBarTrack.left, scrollBarTrack.top + 11 + (!isnan(scrollView->PositionDelta) ? scrollView->WindowPos : 0), scrollBarTrack.right - 1, scrollBarTrack.top + 11 + (!isnan(scrollView->PositionDelta) ? scrollView->WindowPos : 0) + scrollView->GripSize);
@@ -314,43 +306,31 @@ void CCommonRenders::RenderScrollBar(CDC* dc, Graphics* g, CRadarScreen* screen,
 		dc->Draw3dRect(grip, BevelLight.ToCOLORREF(), BevelDark.ToCOLORREF());
 
 		// '3d' border trick
-		g->DrawLine(&lighterPen, btnA[0], btnA[2]);
-		g->DrawLine(&darkerPen, btnA[1], btnA[2]);
-		g->DrawLine(&darkerPen, btnA[0], btnA[1]);
-		g->DrawLine(&lighterPen, btnB[0], btnB[2]);
-		g->DrawLine(&darkerPen, btnB[1], btnB[2]);
-		g->DrawLine(&darkerPen, btnB[0], btnB[1]);
+		g->DrawLine(lighterPen, btnA[0], btnA[2]);
+		g->DrawLine(darkerPen, btnA[1], btnA[2]);
+		g->DrawLine(darkerPen, btnA[0], btnA[1]);
+		g->DrawLine(lighterPen, btnB[0], btnB[2]);
+		g->DrawLine(darkerPen, btnB[1], btnB[2]);
+		g->DrawLine(darkerPen, btnB[0], btnB[1]);
 	}
 
 	// Screen objects
 	screen->AddScreenObject(scrollView->Type, to_string(scrollView->Id).c_str(), grip, true, "");
 
-	// Cleanup
-	DeleteObject(&brush);
-	DeleteObject(&lighterPen);
-	DeleteObject(&darkerPen);
-
 	// Restore device context
 	dc->RestoreDC(sDC);
 }
 
-void CCommonRenders::RenderTracks(CDC* dc, Graphics* g, CRadarScreen* screen, COverlayType type, CMenuBar* menubar) {
-	// Save context
-	int iDC = dc->SaveDC();
-
-	// Pen
-	Pen pen(TextWhite, 2);
-
-	// Font
-	FontSelector::SelectMonoFont(14, dc);
-	dc->SetTextColor(TextWhite.ToCOLORREF());
-	dc->SetTextAlign(TA_CENTER);
-
-	// Anti-aliasing
-	g->SetSmoothingMode(SmoothingModeAntiAlias);
+void CCommonRenders::RenderTracks(CDrawList* list, CRadarScreen* screen, COverlayType type, CMenuBar* menubar) {
+	// Pen & font
+	int pen = list->Style(TextWhite.GetValue(), 2);
+	int font = list->Font(CDrawFontFamily::MONO, 14, CDrawAlign::CENTER);
 
 	// Loop tracks
-	for (auto kv : CRoutesHelper::CurrentTracks) {
+	shared_ptr<const CTrackSet> trackSet = CRoutesHelper::GetTracks();
+	vector<POINT> trackPoints;
+	vector<CDrawPoint> linePoints;
+	for (const auto& kv : trackSet->Tracks) {
 		// Show eastbound/eastbound only if that type is selected
 		if (type == COverlayType::TCKS_EAST && kv.second.Direction != CTrackDirection::EAST) {
 			continue;
@@ -374,46 +354,34 @@ void CCommonRenders::RenderTracks(CDC* dc, Graphics* g, CRadarScreen* screen, CO
 			}
 		}
 
+		// Project the whole track, skip it if none of it is on screen
+		CProjection::ToPixels(screen, kv.second.RouteRaw, trackPoints);
+		if (!CProjection::IsVisible(trackPoints)) {
+			continue;
+		}
+
 		// Move to start and draw 
-		POINT pointCoord = screen->ConvertCoordFromPositionToPixel(kv.second.RouteRaw[0]);
-		string id = kv.first;
 		if (kv.second.Direction == CTrackDirection::EAST) {
-			dc->TextOutA(pointCoord.x - 12, pointCoord.y - 5, id.c_str());
+			list->Text(font, pen, { trackPoints[0].x - 12, trackPoints[0].y - 5 }, kv.first);
 		}
 		else {
-			dc->TextOutA(pointCoord.x + 12, pointCoord.y - 5, id.c_str());
+			list->Text(font, pen, { trackPoints[0].x + 12, trackPoints[0].y - 5 }, kv.first);
 		}
 
 		// Draw lines
-		for (int i = 0; i < kv.second.RouteRaw.size(); i++) {
-			g->DrawLine(&pen, pointCoord.x, pointCoord.y, screen->ConvertCoordFromPositionToPixel(kv.second.RouteRaw[i]).x, (screen->ConvertCoordFromPositionToPixel(kv.second.RouteRaw[i]).y));
-			pointCoord = screen->ConvertCoordFromPositionToPixel(kv.second.RouteRaw[i]);
+		linePoints.clear();
+		for (const POINT& point : trackPoints) {
+			linePoints.push_back({ point.x, point.y });
 		}
+		list->Polyline(pen, linePoints.data(), (int)linePoints.size());
 	}
-
-	// Cleanup
-	DeleteObject(&pen);
-
-	// Restore context
-	dc->RestoreDC(iDC);
 }
 
-void CCommonRenders::RenderRoutes(CDC* dc, Graphics* g, CRadarScreen* screen) {
-	// Save context
-	int iDC = dc->SaveDC();
-
-	// Pen & brush
-	Pen pen(TargetOrange, 2);
-	SolidBrush brush(TargetOrange);
-
-	// Font
-	FontSelector::SelectMonoFont(12, dc);
-	dc->SetTextColor(TargetOrange.ToCOLORREF());
-	dc->SetTextAlign(TA_LEFT);
-
-	// Anti-aliasing
-	g->SetSmoothingMode(SmoothingModeAntiAlias);
-
+void CCommonRenders::RenderRoutes(CDrawList* list, CRadarScreen* screen) {
+	// Pen, brush & font
+	int pen = list->Style(TargetOrange.GetValue(), 2);
+	int brush = list->Style(TargetOrange.GetValue());
+	int font = list->Font(CDrawFontFamily::MONO, 12);
 
 	// Loop through each aircraft in the vector
 	for (int i = 0; i < CRoutesHelper::ActiveRoutes.size(); i++) {
@@ -426,48 +394,68 @@ void CCommonRenders::RenderRoutes(CDC* dc, Graphics* g, CRadarScreen* screen) {
 			continue;
 		}
 
-		// Now we loop through each waypoint and draw the route
-		POINT lastPoint = screen->ConvertCoordFromPositionToPixel(route.at(0).PositionRaw);
+		// Now we loop through each waypoint and draw the route (in one go so the legs merge into one polyline)
+		POINT lastPoint = CProjection::ToPixel(screen, route.at(0).PositionRaw);
+		for (int j = 0; j < route.size(); j++) {
+			// Draw line to (great circle if we have the leg)
+			POINT point = CProjection::ToPixel(screen, route.at(j).PositionRaw);
+			RenderRouteLeg(list, screen, pen, route.at(j).Leg.get(), lastPoint, point);
+			lastPoint = point;
+		}
+
+		// Then the fixes on top
 		for (int j = 0; j < route.size(); j++) {
 			// Get point, text rectangle & define y offset
-			string text = route.at(j).Fix; // To get TextExtent & check if AIRCRAFT
+			POINT point = CProjection::ToPixel(screen, route.at(j).PositionRaw);
+			const string& text = route.at(j).Fix; // To get TextExtent & check if AIRCRAFT
 
-			// Only draw text if not aircraft position
-			if (text != "AIRCRAFT") { 
-				POINT point = screen->ConvertCoordFromPositionToPixel(route.at(j).PositionRaw);
-				CRect box(point.x - (dc->GetTextExtent(text.c_str()).cx / 2), point.y + 10, point.x + (dc->GetTextExtent(text.c_str()).cx), point.y + 50);
+			// Only draw text if not aircraft position, and on screen
+			if (text != "AIRCRAFT" && CProjection::IsVisible(point)) { 
+				CDrawSize extent = list->MeasureText(font, text);
+				CRect box(point.x - (extent.Width / 2), point.y + 10, point.x + extent.Width, point.y + 50);
 				int offsetY = 0;
 
 				// Draw dot
-				Rect pointRect(point.x - 3, point.y - 3, 6, 6);
-				g->FillEllipse(&brush, pointRect);
+				list->FillEllipse(brush, { point.x - 3, point.y - 3 }, { point.x + 3, point.y + 3 });
 
 				// Print text for fix
-				dc->TextOutA(box.left, box.top, text.c_str());
+				list->Text(font, brush, { box.left, box.top }, text);
 				offsetY += 14;
 
 				// Print text for estimate
-				text = route.at(j).Estimate;
-				dc->TextOutA(box.left, box.top + offsetY, text.c_str());
+				list->Text(font, brush, { box.left, box.top + offsetY }, route.at(j).Estimate);
 				offsetY += 14;
 
 				// Print text for flight level
-				text = to_string(route.at(j).FlightLevel);
-				dc->TextOutA(box.left, box.top + offsetY, text.c_str());
+				list->Text(font, brush, { box.left, box.top + offsetY }, CTextCache::FlightLevel(route.at(j).FlightLevel * 100));
 			}
-			
-			// Draw line to
-			g->DrawLine(&pen, lastPoint.x, lastPoint.y, screen->ConvertCoordFromPositionToPixel(route.at(j).PositionRaw).x, (screen->ConvertCoordFromPositionToPixel(route.at(j).PositionRaw).y));
-			lastPoint = screen->ConvertCoordFromPositionToPixel(route.at(j).PositionRaw);
 		}
 	}
+}
 
-	// Cleanup
-	DeleteObject(&pen);
-	DeleteObject(&brush);
+void CCommonRenders::RenderRouteLeg(CDrawList* list, CRadarScreen* screen, int pen, const CRouteSegment* leg, POINT from, POINT to) {
+	// Straight line if no leg or the leg is short enough
+	if (leg == nullptr || leg->Points.size() <= 2) {
+		if (CProjection::IsVisible(from, to)) list->Line(pen, { from.x, from.y }, { to.x, to.y });
+		return;
+	}
 
-	// Restore context
-	dc->RestoreDC(iDC);
+	// Project the densified points in one pass, pinning the ends to the given points (the arc can bow into view between off screen ends)
+	vector<POINT> projected;
+	CProjection::ToPixels(screen, leg->Points, projected);
+	if (!CProjection::IsVisible(projected)) {
+		return;
+	}
+	vector<CDrawPoint> points;
+	points.reserve(projected.size());
+	points.push_back({ from.x, from.y });
+	for (int i = 1; i < projected.size() - 1; i++) {
+		points.push_back({ projected[i].x, projected[i].y });
+	}
+	points.push_back({ to.x, to.y });
+
+	// Draw
+	list->Polyline(pen, points.data(), (int)points.size());
 }
 
 void CCommonRenders::RenderQDM(CDC* dc, Graphics* g, CRadarScreen* screen, CPosition* position1, CPosition* position2, POINT cursorPosition, CPosition* cursorLatLon) {
@@ -475,16 +463,16 @@ void CCommonRenders::RenderQDM(CDC* dc, Graphics* g, CRadarScreen* screen, CPosi
 	int iDC = dc->SaveDC();
 
 	// Get raw screen coordinates
-	POINT rawPoint1(screen->ConvertCoordFromPositionToPixel(*position1));
-	POINT rawPoint2(screen->ConvertCoordFromPositionToPixel(*position2));
+	POINT rawPoint1(CProjection::ToPixel(screen, *position1));
+	POINT rawPoint2(CProjection::ToPixel(screen, *position2));
 
 	// Convert to Point objects
 	Point point1(rawPoint1.x, rawPoint1.y);
 	Point point2(rawPoint2.x, rawPoint2.y);
 
 	// Drawing tools
-	Pen pen(DarkGrey, 2);
-	SolidBrush brush(DarkGrey);
+	Pen* pen = StyleCache::GetPen(DarkGrey, 2);
+	SolidBrush* brush = StyleCache::GetBrush(DarkGrey);
 
 	// Font
 	FontSelector::SelectMonoFont(12, dc);
@@ -499,13 +487,13 @@ void CCommonRenders::RenderQDM(CDC* dc, Graphics* g, CRadarScreen* screen, CPosi
 	Rect positionRect2(point2.X - 2, point2.Y - 2, 4, 4);
 
 	// Fill number 1
-	g->FillEllipse(&brush, positionRect1);
+	g->FillEllipse(brush, positionRect1);
 
 	// If number 2 defined fill it and draw line between, otherwise draw line to cursor position
 	if (position2->m_Latitude != 0.0 && position2->m_Longitude != 0.0) {
 		// Draw dots and connect
-		g->FillEllipse(&brush, positionRect2);
-		g->DrawLine(&pen, point1, point2);
+		g->FillEllipse(brush, positionRect2);
+		g->DrawLine(pen, point1, point2);
 
 		// Draw the lat lon text
 		if (point1.Y < point2.Y) {
@@ -524,7 +512,7 @@ void CCommonRenders::RenderQDM(CDC* dc, Graphics* g, CRadarScreen* screen, CPosi
 		dc->TextOutA(midpoint.x, midpoint.y, (to_string((int)position1->DistanceTo(*position2)) + "nm").c_str());
 	}
 	else {
-		g->DrawLine(&pen, point1, Point(cursorPosition.x, cursorPosition.y));
+		g->DrawLine(pen, point1, Point(cursorPosition.x, cursorPosition.y));
 
 		// Draw the lat lon text
 		if (point1.Y < cursorPosition.y) {
@@ -543,10 +531,6 @@ void CCommonRenders::RenderQDM(CDC* dc, Graphics* g, CRadarScreen* screen, CPosi
 		dc->TextOutA(midpoint.x, midpoint.y, (to_string((int)position1->DistanceTo(*cursorLatLon)) + "nm").c_str());
 	}
 
-	// Cleanup
-	DeleteObject(&pen);
-	DeleteObject(&brush);
-
 	// Restore context
 	dc->RestoreDC(iDC);
 }
\ No newline at end of file
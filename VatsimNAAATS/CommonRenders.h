@@ -5,6 +5,7 @@
 #include "RoutesHelper.h"
 #include "DataHandler.h"
 #include "MenuBar.h"
+#include "DrawList.h"
 #include <string>
 #include <gdiplus.h>
 
@@ -22,8 +23,9 @@ class CCommonRenders // Commonly rendered items, here for ease of access
 		static void RenderScrollBar(CDC* dc, Graphics* g, CRadarScreen* screen, POINT topLeft, CWinScrollBar* scrollView);
 
 		// Screen actions
-		static void RenderTracks(CDC* dc, Graphics* g, CRadarScreen* screen, COverlayType type, CMenuBar* menubar);
-		static void RenderRoutes(CDC* dc, Graphics* g, CRadarScreen* screen);
+		static void RenderTracks(CDrawList* list, CRadarScreen* screen, COverlayType type, CMenuBar* menubar);
+		static void RenderRoutes(CDrawList* list, CRadarScreen* screen);
+		static void RenderRouteLeg(CDrawList* list, CRadarScreen* screen, int pen, const CRouteSegment* leg, POINT from, POINT to);
 		static void RenderQDM(CDC* dc, Graphics* g, CRadarScreen* screen, CPosition* position1, CPosition* position2, POINT cursorPosition, CPosition* cursorLatlon);
 };
 
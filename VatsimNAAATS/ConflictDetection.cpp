@@ -1,5 +1,10 @@
 #include "pch.h"
 #include "ConflictDetection.h"
+#include "CommonRenders.h"
+#include "RouteGeometry.h"
+#include "Projection.h"
+#include "TextCache.h"
+#include "CallsignTable.h"
 
 vector<CAircraftStatus> CConflictDetection::PIVLocations1;
 vector<CAircraftStatus> CConflictDetection::PIVLocations2;
@@ -7,16 +12,16 @@ vector<CRoutePosition> CConflictDetection::PIVRoute1;
 vector<CRoutePosition> CConflictDetection::PIVRoute2;
 vector<CSepStatus> CConflictDetection::PIVSeparationStatuses;
 vector<CSTCAStatus> CConflictDetection::CurrentSTCA;
-map<string, int>* CConflictDetection::aircraftOnScreen;
+CAircraftIdSet* CConflictDetection::aircraftOnScreen;
 
 void CConflictDetection::RBLTool(CDC* dc, Graphics* g, CRadarScreen* screen, string target1, string target2) {
 	// Save context
 	int iDC = dc->SaveDC();
 
 	// Make pens
-	Pen orangePen(TargetOrange, 2);
-	Pen yellowPen(WarningYellow, 2);
-	Pen redPen(CriticalRed, 2);
+	Pen* orangePen = StyleCache::GetPen(TargetOrange, 2);
+	Pen* yellowPen = StyleCache::GetPen(WarningYellow, 2);
+	Pen* redPen = StyleCache::GetPen(CriticalRed, 2);
 
 	// Positions
 	CRadarTarget ac1 = screen->GetPlugIn()->RadarTargetSelect(target1.c_str());
@@ -28,18 +33,18 @@ void CConflictDetection::RBLTool(CDC* dc, Graphics* g, CRadarScreen* screen, str
 	CSepStatus status = DetectStatus(screen, &status1, &status2);
 
 	// Now get points in screen pixels
-	POINT t1Point = screen->ConvertCoordFromPositionToPixel(status1.Position);
-	POINT t2Point = screen->ConvertCoordFromPositionToPixel(status2.Position);
+	POINT t1Point = CProjection::ToPixel(screen, status1.Position);
+	POINT t2Point = CProjection::ToPixel(screen, status2.Position);
 
 	// Select pen
 	if (status.ConflictStatus == CConflictStatus::OK) {
-		g->DrawLine(&orangePen, t1Point.x, t1Point.y, t2Point.x, t2Point.y);
+		g->DrawLine(orangePen, t1Point.x, t1Point.y, t2Point.x, t2Point.y);
 	}
 	else if (status.ConflictStatus == CConflictStatus::WARNING) {
-		g->DrawLine(&yellowPen, t1Point.x, t1Point.y, t2Point.x, t2Point.y);
+		g->DrawLine(yellowPen, t1Point.x, t1Point.y, t2Point.x, t2Point.y);
 	}
 	else {
-		g->DrawLine(&redPen, t1Point.x, t1Point.y, t2Point.x, t2Point.y);
+		g->DrawLine(redPen, t1Point.x, t1Point.y, t2Point.x, t2Point.y);
 	}
 
 	// Now draw the text
@@ -54,11 +59,6 @@ void CConflictDetection::RBLTool(CDC* dc, Graphics* g, CRadarScreen* screen, str
 
 	// Restore context
 	dc->RestoreDC(iDC);
-
-	// Clean up
-	DeleteObject(&orangePen);
-	DeleteObject(&yellowPen);
-	DeleteObject(&redPen);
 }
 
 void CConflictDetection::SepTool(CDC* dc, Graphics* g, CRadarScreen* screen, string targetA, string targetB) {
@@ -66,9 +66,9 @@ void CConflictDetection::SepTool(CDC* dc, Graphics* g, CRadarScreen* screen, str
 	int iDC = dc->SaveDC();
 
 	// Make pens
-	Pen orangePen(TargetOrange, 2);
-	Pen yellowPen(WarningYellow, 2);
-	Pen redPen(CriticalRed, 2);
+	Pen* orangePen = StyleCache::GetPen(TargetOrange, 2);
+	Pen* yellowPen = StyleCache::GetPen(WarningYellow, 2);
+	Pen* redPen = StyleCache::GetPen(CriticalRed, 2);
 
 	// Radar targets & aircraft objects
 	CRadarTarget ac1 = screen->GetPlugIn()->RadarTargetSelect(targetA.c_str());
@@ -119,19 +119,19 @@ void CConflictDetection::SepTool(CDC* dc, Graphics* g, CRadarScreen* screen, str
 
 	// Draw line for aircraft A
 	for (vector<CSepStatus>::iterator status = statuses.begin() + 1; status != statuses.end(); status++) {
+		// Project the segment once
+		POINT from = CProjection::ToPixel(screen, originalPos1);
+		POINT to = CProjection::ToPixel(screen, status->AircraftLocations.first);
+
 		// Select pen
+		Pen* pen = redPen;
 		if (status->ConflictStatus == CConflictStatus::OK) {
-			g->DrawLine(&orangePen, screen->ConvertCoordFromPositionToPixel(originalPos1).x, screen->ConvertCoordFromPositionToPixel(originalPos1).y,
-				screen->ConvertCoordFromPositionToPixel(status->AircraftLocations.first).x, screen->ConvertCoordFromPositionToPixel(status->AircraftLocations.first).y);
+			pen = orangePen;
 		}
 		else if (status->ConflictStatus == CConflictStatus::WARNING) {
-			g->DrawLine(&yellowPen, screen->ConvertCoordFromPositionToPixel(originalPos1).x, screen->ConvertCoordFromPositionToPixel(originalPos1).y,
-				screen->ConvertCoordFromPositionToPixel(status->AircraftLocations.first).x, screen->ConvertCoordFromPositionToPixel(status->AircraftLocations.first).y);
-		}
-		else {
-			g->DrawLine(&redPen, screen->ConvertCoordFromPositionToPixel(originalPos1).x, screen->ConvertCoordFromPositionToPixel(originalPos1).y,
-				screen->ConvertCoordFromPositionToPixel(status->AircraftLocations.first).x, screen->ConvertCoordFromPositionToPixel(status->AircraftLocations.first).y);
+			pen = yellowPen;
 		}
+		g->DrawLine(pen, from.x, from.y, to.x, to.y);
 
 		// Set pos
 		originalPos1 = status->AircraftLocations.first;
@@ -139,29 +139,29 @@ void CConflictDetection::SepTool(CDC* dc, Graphics* g, CRadarScreen* screen, str
 
 	// Draw line for aircraft B
 	for (vector<CSepStatus>::iterator status = statuses.begin() + 1; status != statuses.end(); status++) {
+		// Project the segment once
+		POINT from = CProjection::ToPixel(screen, originalPos2);
+		POINT to = CProjection::ToPixel(screen, status->AircraftLocations.second);
+
 		// Select pen
+		Pen* pen = redPen;
 		if (status->ConflictStatus == CConflictStatus::OK) {
-			g->DrawLine(&orangePen, screen->ConvertCoordFromPositionToPixel(originalPos2).x, screen->ConvertCoordFromPositionToPixel(originalPos2).y,
-				screen->ConvertCoordFromPositionToPixel(status->AircraftLocations.second).x, screen->ConvertCoordFromPositionToPixel(status->AircraftLocations.second).y);
+			pen = orangePen;
 		}
 		else if (status->ConflictStatus == CConflictStatus::WARNING) {
-			g->DrawLine(&yellowPen, screen->ConvertCoordFromPositionToPixel(originalPos2).x, screen->ConvertCoordFromPositionToPixel(originalPos2).y,
-				screen->ConvertCoordFromPositionToPixel(status->AircraftLocations.second).x, screen->ConvertCoordFromPositionToPixel(status->AircraftLocations.second).y);
-		}
-		else {
-			g->DrawLine(&redPen, screen->ConvertCoordFromPositionToPixel(originalPos2).x, screen->ConvertCoordFromPositionToPixel(originalPos2).y,
-				screen->ConvertCoordFromPositionToPixel(status->AircraftLocations.second).x, screen->ConvertCoordFromPositionToPixel(status->AircraftLocations.second).y);
+			pen = yellowPen;
 		}
+		g->DrawLine(pen, from.x, from.y, to.x, to.y);
+
 		// Set pos
 		originalPos2 = status->AircraftLocations.second;
 	}
 
 	// Draw line between points and finish
-	orangePen.SetDashStyle(DashStyleDash);
-	orangePen.SetDashCap(DashCapRound);
-	g->DrawLine(&orangePen, screen->ConvertCoordFromPositionToPixel(status1.Position).x, screen->ConvertCoordFromPositionToPixel(status1.Position).y,
-		screen->ConvertCoordFromPositionToPixel(status2.Position).x, screen->ConvertCoordFromPositionToPixel(status2.Position).y);
-	POINT midpoint = CUtils::GetMidPoint(screen->ConvertCoordFromPositionToPixel(status1.Position), screen->ConvertCoordFromPositionToPixel(status2.Position));
+	POINT t1Point = CProjection::ToPixel(screen, status1.Position);
+	POINT t2Point = CProjection::ToPixel(screen, status2.Position);
+	g->DrawLine(StyleCache::GetPen(TargetOrange, 2, DashStyleDash), t1Point.x, t1Point.y, t2Point.x, t2Point.y);
+	POINT midpoint = CUtils::GetMidPoint(t1Point, t2Point);
 	
 	// Text label plus colour switching
 	FontSelector::SelectMonoFont(12, dc);
@@ -172,11 +172,6 @@ void CConflictDetection::SepTool(CDC* dc, Graphics* g, CRadarScreen* screen, str
 
 	// Restore context
 	dc->RestoreDC(iDC);
-
-	// Clean up
-	DeleteObject(&orangePen);
-	DeleteObject(&yellowPen);
-	DeleteObject(&redPen);
 }
 
 void CConflictDetection::PIVTool(CRadarScreen* screen, string targetA, string targetB) {
@@ -215,9 +210,10 @@ bool CConflictDetection::ProbeTool(CRadarScreen* screen, string callsign, map<st
 	vector<string> callsigns;
 
 	// Check statuses against on screen aircraft
-	for (auto i = aircraftOnScreen->begin(); i != aircraftOnScreen->end(); i++) {
+	for (int id : aircraftOnScreen->Members()) {
 		// Of course, skip the instance of the same aircraft
-		if (i->first == callsign) {
+		const string& onScreenCallsign = CCallsignTable::GetCallsign(id);
+		if (onScreenCallsign == callsign) {
 			continue;
 		}
 
@@ -225,8 +221,8 @@ bool CConflictDetection::ProbeTool(CRadarScreen* screen, string callsign, map<st
 		vector<CSepStatus> sepStatuses;
 
 		// Tartget and statuses
-		target = screen->GetPlugIn()->RadarTargetSelect(i->first.c_str());
-		vector<CAircraftStatus> loopAcStatuses = GetStatusesAlongRoutePoints(screen, i->first, target.GetPosition().GetReportedGS(), target.GetPosition().GetPressureAltitude());
+		target = screen->GetPlugIn()->RadarTargetSelect(onScreenCallsign.c_str());
+		vector<CAircraftStatus> loopAcStatuses = GetStatusesAlongRoutePoints(screen, onScreenCallsign, target.GetPosition().GetReportedGS(), target.GetPosition().GetPressureAltitude());
 
 		// Get the shortest vector (this is what we set the loop end to so we don't get an overflow)
 		int end = loopAcStatuses.size() > acStatuses.size() ? acStatuses.size() : loopAcStatuses.size();
@@ -257,23 +253,17 @@ bool CConflictDetection::ProbeTool(CRadarScreen* screen, string callsign, map<st
 	return 1;
 }
 
-void CConflictDetection::RenderPIV(CDC* dc, Graphics* g, CRadarScreen* screen, string targetA, string targetB) {
-	// Save context
-	int iDC = dc->SaveDC();
-
+void CConflictDetection::RenderPIV(CDrawList* list, CRadarScreen* screen, string targetA, string targetB) {
 	// Pens & brush
-	Pen pen(TargetOrange, 2);
-	Pen yellowPen(WarningYellow, 2);
-	Pen redPen(CriticalRed, 2);
-	SolidBrush brush(TargetOrange);
+	int pen = list->Style(TargetOrange.GetValue(), 2);
+	int yellowPen = list->Style(WarningYellow.GetValue(), 2);
+	int redPen = list->Style(CriticalRed.GetValue(), 2);
+	int brush = list->Style(TargetOrange.GetValue());
 
-	// Font
-	FontSelector::SelectMonoFont(12, dc);
-	dc->SetTextColor(TargetOrange.ToCOLORREF());
-	dc->SetTextAlign(TA_LEFT);
-
-	// Anti-aliasing
-	g->SetSmoothingMode(SmoothingModeAntiAlias);
+	// Fonts (the times are yellow and centred)
+	int font = list->Font(CDrawFontFamily::MONO, 12);
+	int timeFont = list->Font(CDrawFontFamily::MONO, 12, CDrawAlign::CENTER);
+	int timeColour = list->Style(WarningYellow.GetValue());
 
 	// Hold these for drawing between aircraft and point
 	POINT lastPoint1;
@@ -283,44 +273,42 @@ void CConflictDetection::RenderPIV(CDC* dc, Graphics* g, CRadarScreen* screen, s
 	if (!PIVRoute1.empty()) { // Failsafe
 		// Radar target
 		CRadarTarget target = screen->GetPlugIn()->RadarTargetSelect(targetA.c_str());
-		POINT aircraftPos = screen->ConvertCoordFromPositionToPixel(target.GetPosition().GetPosition());
-		lastPoint1 = screen->ConvertCoordFromPositionToPixel(CConflictDetection::PIVRoute1.begin()->PositionRaw);
+		POINT aircraftPos = CProjection::ToPixel(screen, target.GetPosition().GetPosition());
+		lastPoint1 = CProjection::ToPixel(screen, CConflictDetection::PIVRoute1.begin()->PositionRaw);
 		for (auto i = CConflictDetection::PIVRoute1.begin(); i != CConflictDetection::PIVRoute1.end(); i++) {
-			POINT point = screen->ConvertCoordFromPositionToPixel(i->PositionRaw);
-			// Draw text and dot only if not AIRCRAFT fix
-			if (i->Fix != "AIRCRAFT") {
+			POINT point = CProjection::ToPixel(screen, i->PositionRaw);
+			// Draw text and dot only if not AIRCRAFT fix, and on screen
+			if (i->Fix != "AIRCRAFT" && CProjection::IsVisible(point)) {
 				// Get point, text rectangle & define y offset
-				string text = i->Fix; // To get TextExtent				
-				CRect box(point.x - (dc->GetTextExtent(text.c_str()).cx / 2), point.y + 10, point.x + (dc->GetTextExtent(text.c_str()).cx), point.y + 50);
+				const string& text = i->Fix; // To get TextExtent
+				CDrawSize extent = list->MeasureText(font, text);
+				CRect box(point.x - (extent.Width / 2), point.y + 10, point.x + extent.Width, point.y + 50);
 				int offsetY = 0;
 
 				// Draw dot
-				Rect pointRect(point.x - 3, point.y - 3, 6, 6);
-				g->FillEllipse(&brush, pointRect);
+				list->FillEllipse(brush, { point.x - 3, point.y - 3 }, { point.x + 3, point.y + 3 });
 
 				// Print text for fix
-				dc->TextOutA(box.left, box.top, text.c_str());
+				list->Text(font, brush, { box.left, box.top }, text);
 				offsetY += 14;
 
 				// Print text for estimate
-				text = i->Estimate;
-				dc->TextOutA(box.left, box.top + offsetY, text.c_str());
+				list->Text(font, brush, { box.left, box.top + offsetY }, i->Estimate);
 				offsetY += 14;
 
 				// Print text for flight level
-				text = to_string(i->FlightLevel);
-				dc->TextOutA(box.left, box.top + offsetY, text.c_str());
+				list->Text(font, brush, { box.left, box.top + offsetY }, CTextCache::FlightLevel(i->FlightLevel * 100));
 			}
 			// Draw the line between points if there is no estimate (point is behind the aircraft)
 			if (i->Estimate == "--") {
-				// Draw line
-				g->DrawLine(&pen, lastPoint1.x, lastPoint1.y, point.x, point.y);
+				// Draw line (great circle if we have the leg)
+				CCommonRenders::RenderRouteLeg(list, screen, pen, i != PIVRoute1.begin() ? i->Leg.get() : nullptr, lastPoint1, point);
 				lastPoint1 = point;
 
 				// If next point is either AIRCRAFT, or the estimate is positive draw line between last point and target
 				if (i != PIVRoute1.end() - 1) {
 					if (std::next(i, 1)->Fix == "AIRCRAFT" || std::next(i, 1)->Estimate != "--") {
-						g->DrawLine(&pen, lastPoint1.x, lastPoint1.y, aircraftPos.x, aircraftPos.y);
+						list->Line(pen, { lastPoint1.x, lastPoint1.y }, { aircraftPos.x, aircraftPos.y });
 						lastPoint1 = aircraftPos;
 					}
 				}
@@ -329,45 +317,43 @@ void CConflictDetection::RenderPIV(CDC* dc, Graphics* g, CRadarScreen* screen, s
 	}
 	if (!PIVRoute2.empty()) { // Failsafe
 		CRadarTarget target = screen->GetPlugIn()->RadarTargetSelect(targetB.c_str());
-		POINT aircraftPos = screen->ConvertCoordFromPositionToPixel(target.GetPosition().GetPosition());
-		lastPoint2 = screen->ConvertCoordFromPositionToPixel(CConflictDetection::PIVRoute2.begin()->PositionRaw);
+		POINT aircraftPos = CProjection::ToPixel(screen, target.GetPosition().GetPosition());
+		lastPoint2 = CProjection::ToPixel(screen, CConflictDetection::PIVRoute2.begin()->PositionRaw);
 		for (auto i = CConflictDetection::PIVRoute2.begin(); i != CConflictDetection::PIVRoute2.end(); i++) {
-			POINT point = screen->ConvertCoordFromPositionToPixel(i->PositionRaw);
-			// Draw text and dot only if not AIRCRAFT fix
-			if (i->Fix != "AIRCRAFT") {
+			POINT point = CProjection::ToPixel(screen, i->PositionRaw);
+			// Draw text and dot only if not AIRCRAFT fix, and on screen
+			if (i->Fix != "AIRCRAFT" && CProjection::IsVisible(point)) {
 				// Get point, text rectangle & define y offset
-				string text = i->Fix; // To get TextExtent
-				CRect box(point.x - (dc->GetTextExtent(text.c_str()).cx / 2), point.y + 10, point.x + (dc->GetTextExtent(text.c_str()).cx), point.y + 50);
+				const string& text = i->Fix; // To get TextExtent
+				CDrawSize extent = list->MeasureText(font, text);
+				CRect box(point.x - (extent.Width / 2), point.y + 10, point.x + extent.Width, point.y + 50);
 				int offsetY = 0;
 
 				// Draw dot
-				Rect pointRect(point.x - 3, point.y - 3, 6, 6);
-				g->FillEllipse(&brush, pointRect);
+				list->FillEllipse(brush, { point.x - 3, point.y - 3 }, { point.x + 3, point.y + 3 });
 
 				// Print text for fix
-				dc->TextOutA(box.left, box.top, text.c_str());
+				list->Text(font, brush, { box.left, box.top }, text);
 				offsetY += 14;
 
 				// Print text for estimate
-				text = i->Estimate;
-				dc->TextOutA(box.left, box.top + offsetY, text.c_str());
+				list->Text(font, brush, { box.left, box.top + offsetY }, i->Estimate);
 				offsetY += 14;
 
 				// Print text for flight level
-				text = to_string(i->FlightLevel);
-				dc->TextOutA(box.left, box.top + offsetY, text.c_str());
+				list->Text(font, brush, { box.left, box.top + offsetY }, CTextCache::FlightLevel(i->FlightLevel * 100));
 			}
 
 			// Draw the line between points if there is no estimate (point is behind the aircraft)
 			if (i->Estimate == "--") {
-				// Draw line
-				g->DrawLine(&pen, lastPoint2.x, lastPoint2.y, point.x, point.y);
+				// Draw line (great circle if we have the leg)
+				CCommonRenders::RenderRouteLeg(list, screen, pen, i != PIVRoute2.begin() ? i->Leg.get() : nullptr, lastPoint2, point);
 				lastPoint2 = point;
 
 				// If next point is either AIRCRAFT, or the estimate is positive draw line between last point and target
 				if (i != PIVRoute2.end() - 1) {
 					if (std::next(i, 1)->Fix == "AIRCRAFT" || std::next(i, 1)->Estimate != "--") {
-						g->DrawLine(&pen, lastPoint2.x, lastPoint2.y, aircraftPos.x, aircraftPos.y);
+						list->Line(pen, { lastPoint2.x, lastPoint2.y }, { aircraftPos.x, aircraftPos.y });
 						lastPoint2 = aircraftPos;
 					}
 				}				
@@ -382,42 +368,37 @@ void CConflictDetection::RenderPIV(CDC* dc, Graphics* g, CRadarScreen* screen, s
 	CRadarTarget tB = screen->GetPlugIn()->RadarTargetSelect(targetB.c_str());
 	for (i;  i < CConflictDetection::PIVSeparationStatuses.size(); i++) {
 		// Points
-		POINT piv1 = screen->ConvertCoordFromPositionToPixel(CConflictDetection::PIVLocations1.at(i).Position);
-		POINT piv2 = screen->ConvertCoordFromPositionToPixel(CConflictDetection::PIVLocations2.at(i).Position);
+		POINT piv1 = CProjection::ToPixel(screen, CConflictDetection::PIVLocations1.at(i).Position);
+		POINT piv2 = CProjection::ToPixel(screen, CConflictDetection::PIVLocations2.at(i).Position);
 		// Select pen
+		int statusPen = redPen;
 		if (CConflictDetection::PIVSeparationStatuses.at(i).ConflictStatus == CConflictStatus::OK) {
-			g->DrawLine(&pen, lastPoint1.x, lastPoint1.y, piv1.x, piv1.y);
-			g->DrawLine(&pen, lastPoint2.x, lastPoint2.y, piv2.x, piv2.y);
+			statusPen = pen;
 		}
 		else if (CConflictDetection::PIVSeparationStatuses.at(i).ConflictStatus == CConflictStatus::WARNING) {
-			g->DrawLine(&yellowPen, lastPoint1.x, lastPoint1.y, piv1.x, piv1.y);
-			g->DrawLine(&yellowPen, lastPoint2.x, lastPoint2.y, piv2.x, piv2.y);
-		}
-		else {
-			g->DrawLine(&redPen, lastPoint1.x, lastPoint1.y, piv1.x, piv1.y);
-			g->DrawLine(&redPen, lastPoint2.x, lastPoint2.y, piv2.x, piv2.y);
+			statusPen = yellowPen;
 		}
 
-		// Text
-		dc->SetTextColor(WarningYellow.ToCOLORREF());
-		dc->SetTextAlign(TA_CENTER);
+		// Draw the segments that are on screen
+		if (CProjection::IsVisible(lastPoint1, piv1)) list->Line(statusPen, { lastPoint1.x, lastPoint1.y }, { piv1.x, piv1.y });
+		if (CProjection::IsVisible(lastPoint2, piv2)) list->Line(statusPen, { lastPoint2.x, lastPoint2.y }, { piv2.x, piv2.y });
 
 		// Draw times
 		if (previousStatus != CConflictDetection::PIVSeparationStatuses.at(i).ConflictStatus) {
 			// Get times (subtract 1 because previous estimate is needed)
-			string time1 = CUtils::ParseZuluTime(false, CConflictDetection::PIVLocations1.at(i).Estimate - 1);
-			string time2 = CUtils::ParseZuluTime(false, CConflictDetection::PIVLocations2.at(i).Estimate - 1);
+			const string& time1 = CTextCache::ZuluTime(max(CConflictDetection::PIVLocations1.at(i).Estimate - 1, 0));
+			const string& time2 = CTextCache::ZuluTime(max(CConflictDetection::PIVLocations2.at(i).Estimate - 1, 0));
 
 			// Print text for both
-			dc->TextOutA(lastPoint1.x, lastPoint1.y - 20, time1.c_str());
-			dc->TextOutA(lastPoint2.x, lastPoint2.y - 20, time2.c_str());
+			list->Text(timeFont, timeColour, { lastPoint1.x, lastPoint1.y - 20 }, time1);
+			list->Text(timeFont, timeColour, { lastPoint2.x, lastPoint2.y - 20 }, time2);
 
 			// Draw crosses
-			yellowPen.SetLineCap(LineCapRound, LineCapRound, DashCapRound);
-			g->DrawLine(&yellowPen, lastPoint1.x - 5, lastPoint1.y - 5, lastPoint1.x + 5, lastPoint1.y + 5); // AC1
-			g->DrawLine(&yellowPen, lastPoint1.x - 5, lastPoint1.y + 5, lastPoint1.x + 5, lastPoint1.y - 5); // AC1
-			g->DrawLine(&yellowPen, lastPoint2.x - 5, lastPoint2.y - 5, lastPoint2.x + 5, lastPoint2.y + 5); // AC2
-			g->DrawLine(&yellowPen, lastPoint2.x - 5, lastPoint2.y + 5, lastPoint2.x + 5, lastPoint2.y - 5); // AC2
+			int crossPen = list->Style(WarningYellow.GetValue(), 2, DashStyleSolid, LineCapRound);
+			list->Line(crossPen, { lastPoint1.x - 5, lastPoint1.y - 5 }, { lastPoint1.x + 5, lastPoint1.y + 5 }); // AC1
+			list->Line(crossPen, { lastPoint1.x - 5, lastPoint1.y + 5 }, { lastPoint1.x + 5, lastPoint1.y - 5 }); // AC1
+			list->Line(crossPen, { lastPoint2.x - 5, lastPoint2.y - 5 }, { lastPoint2.x + 5, lastPoint2.y + 5 }); // AC2
+			list->Line(crossPen, { lastPoint2.x - 5, lastPoint2.y + 5 }, { lastPoint2.x + 5, lastPoint2.y - 5 }); // AC2
 
 		}
 
@@ -425,8 +406,8 @@ void CConflictDetection::RenderPIV(CDC* dc, Graphics* g, CRadarScreen* screen, s
 		previousStatus = CConflictDetection::PIVSeparationStatuses.at(i).ConflictStatus;
 
 		// Reset points
-		lastPoint1 = screen->ConvertCoordFromPositionToPixel(CConflictDetection::PIVLocations1.at(i).Position);
-		lastPoint2 = screen->ConvertCoordFromPositionToPixel(CConflictDetection::PIVLocations2.at(i).Position);
+		lastPoint1 = CProjection::ToPixel(screen, CConflictDetection::PIVLocations1.at(i).Position);
+		lastPoint2 = CProjection::ToPixel(screen, CConflictDetection::PIVLocations2.at(i).Position);
 	}
 
 	// Now draw the remainder of the line for the longer aircraft
@@ -437,23 +418,19 @@ void CConflictDetection::RenderPIV(CDC* dc, Graphics* g, CRadarScreen* screen, s
 		? true : false;
 	POINT pointToDraw;
 	if (isLonger) {
-		pointToDraw = screen->ConvertCoordFromPositionToPixel(CConflictDetection::PIVLocations1.at(i - 1).Position);
+		pointToDraw = CProjection::ToPixel(screen, CConflictDetection::PIVLocations1.at(i - 1).Position);
 	}
 	else {
-		pointToDraw = screen->ConvertCoordFromPositionToPixel(CConflictDetection::PIVLocations2.at(i - 1).Position);
+		pointToDraw = CProjection::ToPixel(screen, CConflictDetection::PIVLocations2.at(i - 1).Position);
 	}
 
-	// Cap type
-	yellowPen.SetLineCap(LineCapSquare, LineCapSquare, DashCapRound);
-
 	// Iterate and draw
 	for (i; i < length; i++) {
 		// Select orange pen
 		if (isLonger) {
 			try {
-				POINT pt = screen->ConvertCoordFromPositionToPixel(CConflictDetection::PIVLocations1.at(i).Position);
-				g->DrawLine(&pen, pointToDraw.x, pointToDraw.y, pt.x, pt.y);
-				dc->MoveTo(pointToDraw);
+				POINT pt = CProjection::ToPixel(screen, CConflictDetection::PIVLocations1.at(i).Position);
+				if (CProjection::IsVisible(pointToDraw, pt)) list->Line(pen, { pointToDraw.x, pointToDraw.y }, { pt.x, pt.y });
 				pointToDraw = pt;
 			}
 			catch (exception & ex) {
@@ -462,9 +439,8 @@ void CConflictDetection::RenderPIV(CDC* dc, Graphics* g, CRadarScreen* screen, s
 		}
 		else {
 			try {
-				POINT pt = screen->ConvertCoordFromPositionToPixel(CConflictDetection::PIVLocations2.at(i).Position);
-				g->DrawLine(&pen, pointToDraw.x, pointToDraw.y, pt.x, pt.y);
-				dc->MoveTo(pointToDraw);
+				POINT pt = CProjection::ToPixel(screen, CConflictDetection::PIVLocations2.at(i).Position);
+				if (CProjection::IsVisible(pointToDraw, pt)) list->Line(pen, { pointToDraw.x, pointToDraw.y }, { pt.x, pt.y });
 				pointToDraw = pt;
 			}
 			catch (exception & ex) {
@@ -473,18 +449,9 @@ void CConflictDetection::RenderPIV(CDC* dc, Graphics* g, CRadarScreen* screen, s
 		}
 
 	}
-
-	// Cleanup
-	DeleteObject(&pen);
-	DeleteObject(&yellowPen);
-	DeleteObject(&redPen);
-	DeleteObject(&brush);
-	
-	// Restore context
-	dc->RestoreDC(iDC);
 }
 
-void CConflictDetection::CheckSTCA(CRadarScreen* screen, CRadarTarget* target, map<string, int>* onScreenAircraft) {
+void CConflictDetection::CheckSTCA(CRadarScreen* screen, CRadarTarget* target, CAircraftIdSet* onScreenAircraft) {
 	// Set on screen aircraft
 	aircraftOnScreen = onScreenAircraft;
 
@@ -494,11 +461,13 @@ void CConflictDetection::CheckSTCA(CRadarScreen* screen, CRadarTarget* target, m
 			target->GetPosition().GetReportedGS(), target->GetPosition().GetReportedHeadingTrueNorth(), target->GetPosition().GetPosition());
 
 
+		int targetId = CCallsignTable::Intern(targetAc.Callsign);
+
 		// Detect the status
-		for (auto i = onScreenAircraft->begin(); i != onScreenAircraft->end(); i++) {
-			if (i->first == targetAc.Callsign)
+		for (int id : onScreenAircraft->Members()) {
+			if (id == targetId)
 				continue;
-			CRadarTarget ac = screen->GetPlugIn()->RadarTargetSelect(i->first.c_str());
+			CRadarTarget ac = screen->GetPlugIn()->RadarTargetSelect(CCallsignTable::GetCallsign(id).c_str());
 
 			// Status for this aircraft
 			CAircraftStatus acTest(ac.GetCallsign(), ac.GetPosition().GetPressureAltitude(),
@@ -514,7 +483,7 @@ void CConflictDetection::CheckSTCA(CRadarScreen* screen, CRadarTarget* target, m
 			bool alreadyExist = false;
 			auto idx = CurrentSTCA.begin();
 			for (idx = CurrentSTCA.begin(); idx != CurrentSTCA.end(); idx++) {
-				if ((targetAc.Callsign == idx->CallsignB && acTest.Callsign == idx->CallsignA) || (targetAc.Callsign == idx->CallsignA && acTest.Callsign == idx->CallsignB)) {
+				if ((targetId == idx->IdB && id == idx->IdA) || (targetId == idx->IdA && id == idx->IdB)) {
 					alreadyExist = true;
 					break;
 				}
@@ -576,8 +545,8 @@ CSepStatus CConflictDetection::DetectStatus(CRadarScreen* screen, CAircraftStatu
 	// Default status obj
 	CSepStatus status;
 	CTrackStatus trackStatus = CTrackStatus::NA;
-	CAircraftFlightPlan fp1;
-	CAircraftFlightPlan fp2;
+	CFlightHotData fp1;
+	CFlightHotData fp2;
 
 	// Targets
 	CRadarTarget targetA = screen->GetPlugIn()->RadarTargetSelect(aircraftA->Callsign.c_str());
@@ -592,8 +561,8 @@ CSepStatus CConflictDetection::DetectStatus(CRadarScreen* screen, CAircraftStatu
 		int gsB = aircraftB->GroundSpeed;
 
 		// vNAAATS flight plans
-		CDataHandler::GetFlightData(targetA.GetCallsign(), fp1);
-		CDataHandler::GetFlightData(targetB.GetCallsign(), fp2);
+		CDataHandler::GetFlightHotData(aircraftA->Callsign, fp1);
+		CDataHandler::GetFlightHotData(aircraftB->Callsign, fp2);
 
 		status.AltDifference = altA > altB ? altA - altB : altB - altA;
 		status.DistanceAsNM = aircraftA->Position.DistanceTo(aircraftB->Position);
@@ -847,17 +816,19 @@ vector<CAircraftStatus> CConflictDetection::GetStatusesAlongRoute(CRadarScreen*
 			// Get the time
 			int time = CUtils::GetTimeDistanceSpeed(route.at(i).DistanceFromLastPoint, groundSpeed);
 
-			// Get the heading
-			int heading;
-			if (counter == 0) { // If the position is the aircraft's location then get that direction
-				heading = acPos.DirectionTo(route.at(i).PositionRaw);
-				prevPos = acPos;
-				counter++;
+			// Get the leg, from the aircraft on the first pass otherwise the precomputed one
+			shared_ptr<const CRouteSegment> leg;
+			if (counter == 0 || route.at(i).Leg == nullptr) {
+				leg = CRouteGeometry::BuildSegment(counter == 0 ? acPos : prevPos, route.at(i).PositionRaw, 0.0);
+				if (counter == 0) {
+					prevPos = acPos;
+					counter++;
+				}
 			}
 			else {
-				// Get the direction from point to point
-				heading = prevPos.DirectionTo(route.at(i).PositionRaw);
+				leg = route.at(i).Leg;
 			}
+			int heading = (int)round(leg->InitialBearing);
 
 			// Iterate through the times and get the points
 			for (int j = 0; j < time; j++) {
@@ -872,7 +843,7 @@ vector<CAircraftStatus> CConflictDetection::GetStatusesAlongRoute(CRadarScreen*
 					status.Position = acPos;
 				}
 				else {
-					status.Position = CUtils::GetPointDistanceBearing(prevPos, ((route.at(i).DistanceFromLastPoint * 1852) / time) * j, heading);
+					status.Position = CRouteGeometry::Interpolate(*leg, ((double)route.at(i).DistanceFromLastPoint / time) * j);
 				}
 				// Add status
 				statuses.push_back(status);
@@ -923,6 +894,10 @@ vector<CAircraftStatus> CConflictDetection::GetStatusesAlongRoutePoints(CRadarSc
 			prevPos = acPos;
 			counter++;
 		}
+		else if (route.at(i).Leg != nullptr) {
+			// Precomputed leg
+			heading = (int)round(route.at(i).Leg->InitialBearing);
+		}
 		else {
 			// Get the direction from point to point
 			heading = prevPos.DirectionTo(route.at(i).PositionRaw);
@@ -7,6 +7,7 @@
 #include "RoutesHelper.h"
 #include "DataHandler.h"
 #include "Styles.h"
+#include "DrawList.h"
 #include <gdiplus.h>
 #include <map>
 
@@ -24,7 +25,7 @@ class CConflictDetection
 		static vector<CRoutePosition> PIVRoute1;
 		static vector<CRoutePosition> PIVRoute2;
 		static vector<CSepStatus> PIVSeparationStatuses;
-		static map<string, int>* aircraftOnScreen;
+		static CAircraftIdSet* aircraftOnScreen;
 
 		// STCA
 		static vector<CSTCAStatus> CurrentSTCA;
@@ -39,10 +40,10 @@ class CConflictDetection
 		static void PIVTool(CRadarScreen* screen, string targetA, string targetB);
 
 		// Path Intercept Vector tool
-		static void RenderPIV(CDC* dc, Graphics* g, CRadarScreen* screen, string targetA, string targetB);
+		static void RenderPIV(CDrawList* list, CRadarScreen* screen, string targetA, string targetB);
 
 		// STCA (run every 10s)
-		static void CheckSTCA(CRadarScreen* screen, CRadarTarget* target, map<string, int>* onScreenAircraft);
+		static void CheckSTCA(CRadarScreen* screen, CRadarTarget* target, CAircraftIdSet* onScreenAircraft);
 
 		// Probe tool
 		static bool ProbeTool(CRadarScreen* screen, string callsign, map<string, vector<CSepStatus>>* statuses, CAircraftFlightPlan* copy = nullptr);
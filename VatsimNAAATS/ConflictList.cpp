@@ -39,10 +39,10 @@ void CConflictList::RenderList(Graphics* g, CDC* dc, CRadarScreen* screen) {
 	int offsetX = 0;
 	for (auto item = CConflictDetection::CurrentSTCA.begin(); item != CConflictDetection::CurrentSTCA.end(); item++) {
 		// Get flight plans
-		CAircraftFlightPlan fp1;
-		CAircraftFlightPlan fp2;
-		CDataHandler::GetFlightData(item->CallsignA, fp1);
-		CDataHandler::GetFlightData(item->CallsignB, fp2);
+		CFlightHotData fp1;
+		CFlightHotData fp2;
+		CDataHandler::GetFlightHotData(item->CallsignA, fp1);
+		CDataHandler::GetFlightHotData(item->CallsignB, fp2);
 
 		// Pick text colour
 		COLORREF textColour;
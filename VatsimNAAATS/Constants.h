@@ -118,9 +118,29 @@ const bool DEBUG_MODE = true;
 // Sector file & geo constants
 const int SECTELEMENT_COORD_IDX = 7;
 const int RADIUS_EARTH_NM = 3440;
+const double ROUTE_DENSIFY_STEP = 1.0; // Degrees of arc between great circle points on a route leg
+
+// Network
+const int NETWORK_RESYNC_TIME = 60; // Seconds after which the delta sync watermark is too old and a full sync is done
+const int NETWORK_CACHE_AGE = 3600; // Seconds after which cached network flight data is too old to use at startup
+const int HTTP_WORKERS = 4; // I/O threads in the HTTP client
+const int HTTP_TIMEOUT = 10000; // Default request timeout (milliseconds)
+const int OUTBOUND_INTERVAL = 1000; // Milliseconds between outbound update flushes
+const int OUTBOUND_BACKOFF = 2000; // First retry delay for a failed update (milliseconds), doubled each attempt
+const int OUTBOUND_BACKOFF_MAX = 60000; // Longest retry delay (milliseconds)
+const int OUTBOUND_MAX_ATTEMPTS = 6; // Attempts before an update is dropped
 
 // Screen details
 #define DISPLAY_NAME "vNAAATS Display"
+const int CURSOR_INTERVAL = 40; // Milliseconds between cursor samples
+const int PROFILER_FRAMES = 128; // Frames kept by the frame profiler
+const int CULL_MARGIN = 150; // Pixels outside the radar area still drawn (tags, leader lines and halos reach in from here)
+const int TAG_WIDTH = 88;
+const int TAG_HEIGHT = 33;
+const int TAG_HEIGHT_DETAILED = 58; // With the type and destination line
+const int DECLUTTER_CELL = 64; // Tag spatial hash cell size (pixels)
+const int DECLUTTER_BUDGET = 24; // Most tags re-placed per frame
+const int TEXT_EXTENT_MAX = 2048; // Strings measured per font before the text cache starts again
 
 // Text, margins and padding
 const int MEN_FONT_SIZE = 16;
@@ -236,6 +256,14 @@ enum class CPathType {
     TCKS
 };
 
+// Route token type
+enum class CRouteTokenType {
+    INVALID,
+    FIX,
+    COORDINATE,
+    OTHER
+};
+
 // Track direction enum
 enum class CTrackDirection {
     UNKNOWN,
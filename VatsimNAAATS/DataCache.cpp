@@ -0,0 +1,307 @@
+#include "pch.h"
+#include "DataCache.h"
+#include "Utils.h"
+#include <fstream>
+#include <cstring>
+#include <ctime>
+
+// File header
+static const uint32_t CACHE_MAGIC = 0x4341414E; // "NAAC"
+static const uint32_t CACHE_VERSION = 1;
+static const uint32_t CACHE_TRACKS = 1;
+static const uint32_t CACHE_FLIGHTS = 2;
+
+// Writers (native byte order, the cache never leaves the machine)
+static void PutU32(string& out, uint32_t value) { out.append((const char*)&value, sizeof(value)); }
+static void PutI64(string& out, int64_t value) { out.append((const char*)&value, sizeof(value)); }
+static void PutDouble(string& out, double value) { out.append((const char*)&value, sizeof(value)); }
+static void PutString(string& out, const string& value) {
+	PutU32(out, (uint32_t)value.size());
+	out.append(value);
+}
+
+static void PutHeader(string& out, uint32_t kind) {
+	PutU32(out, CACHE_MAGIC);
+	PutU32(out, CACHE_VERSION);
+	PutU32(out, kind);
+	PutI64(out, (int64_t)time(nullptr));
+}
+
+// Bounds checked reader, IsOk goes false on the first short read and stays false
+struct CCacheReader {
+	CCacheReader(const string& buffer) : Buffer(buffer) {}
+
+	const string& Buffer;
+	size_t Cursor = 0;
+	bool IsOk = true;
+
+	bool Read(void* value, size_t size) {
+		if (!IsOk || Buffer.size() - Cursor < size) {
+			IsOk = false;
+			return false;
+		}
+		memcpy(value, Buffer.data() + Cursor, size);
+		Cursor += size;
+		return true;
+	}
+
+	uint32_t GetU32() { uint32_t value = 0; Read(&value, sizeof(value)); return value; }
+	int64_t GetI64() { int64_t value = 0; Read(&value, sizeof(value)); return value; }
+	double GetDouble() { double value = 0.0; Read(&value, sizeof(value)); return value; }
+
+	string GetString() {
+		uint32_t length = GetU32();
+		if (!IsOk || Buffer.size() - Cursor < length) {
+			IsOk = false;
+			return "";
+		}
+		string value(Buffer.data() + Cursor, length);
+		Cursor += length;
+		return value;
+	}
+
+	// A count can never be more than the bytes left, stops a corrupt file asking for a huge reserve
+	uint32_t GetCount() {
+		uint32_t count = GetU32();
+		if (count > Buffer.size() - Cursor) IsOk = false;
+		return IsOk ? count : 0;
+	}
+
+	// Check the header, returns the time the file was saved
+	bool GetHeader(uint32_t kind, int64_t& saved) {
+		if (GetU32() != CACHE_MAGIC || GetU32() != CACHE_VERSION || GetU32() != kind) IsOk = false;
+		saved = GetI64();
+		return IsOk;
+	}
+};
+
+int CDataCache::SaveTracks(const CTrackSet& tracks, const CCacheValidators& validators) {
+	string buffer;
+	PutHeader(buffer, CACHE_TRACKS);
+
+	// Where it came from
+	PutString(buffer, validators.Url);
+	PutString(buffer, validators.ETag);
+	PutString(buffer, validators.LastModified);
+
+	// Tracks
+	PutString(buffer, tracks.TMI);
+	PutU32(buffer, (uint32_t)tracks.Tracks.size());
+	for (const auto& kv : tracks.Tracks) {
+		const CTrack& track = kv.second;
+		PutString(buffer, track.Identifier);
+		PutString(buffer, track.TMI);
+		PutU32(buffer, (uint32_t)track.Direction);
+		PutString(buffer, track.validFrom);
+		PutString(buffer, track.validTo);
+
+		// Route points
+		size_t points = min(track.Route.size(), track.RouteRaw.size());
+		PutU32(buffer, (uint32_t)points);
+		for (size_t i = 0; i < points; i++) {
+			PutString(buffer, track.Route[i]);
+			PutDouble(buffer, track.RouteRaw[i].m_Latitude);
+			PutDouble(buffer, track.RouteRaw[i].m_Longitude);
+		}
+
+		// Flight levels
+		PutU32(buffer, (uint32_t)track.FlightLevels.size());
+		for (int level : track.FlightLevels) {
+			PutU32(buffer, (uint32_t)level);
+		}
+	}
+
+	return WriteCacheFile("vNAAATS.tracks.cache", buffer);
+}
+
+int CDataCache::LoadTracks(CTrackSet& tracks, CCacheValidators& validators) {
+	string buffer;
+	if (ReadCacheFile("vNAAATS.tracks.cache", buffer) != 0) {
+		return 1;
+	}
+
+	CCacheReader reader(buffer);
+	int64_t saved = 0;
+	if (!reader.GetHeader(CACHE_TRACKS, saved)) {
+		return 1;
+	}
+
+	// Where it came from
+	validators.Url = reader.GetString();
+	validators.ETag = reader.GetString();
+	validators.LastModified = reader.GetString();
+
+	// Tracks
+	tracks.TMI = reader.GetString();
+	uint32_t count = reader.GetCount();
+	for (uint32_t i = 0; i < count && reader.IsOk; i++) {
+		CTrack track;
+		track.Identifier = reader.GetString();
+		track.TMI = reader.GetString();
+		track.Direction = (CTrackDirection)reader.GetU32();
+		track.validFrom = reader.GetString();
+		track.validTo = reader.GetString();
+
+		// Route points
+		uint32_t points = reader.GetCount();
+		track.Route.reserve(points);
+		track.RouteRaw.reserve(points);
+		for (uint32_t j = 0; j < points && reader.IsOk; j++) {
+			track.Route.push_back(reader.GetString());
+			CPosition position;
+			position.m_Latitude = reader.GetDouble();
+			position.m_Longitude = reader.GetDouble();
+			track.RouteRaw.push_back(position);
+		}
+
+		// Flight levels
+		uint32_t levels = reader.GetCount();
+		for (uint32_t j = 0; j < levels && reader.IsOk; j++) {
+			track.FlightLevels.push_back((int)reader.GetU32());
+		}
+
+		tracks.Tracks[track.Identifier] = track;
+	}
+
+	// Truncated or empty
+	if (!reader.IsOk || tracks.Tracks.empty()) {
+		tracks = CTrackSet();
+		return 1;
+	}
+
+	return 0;
+}
+
+int CDataCache::SaveFlights(const map<string, CNetworkFlightPlan>& flights) {
+	string buffer;
+	PutHeader(buffer, CACHE_FLIGHTS);
+
+	PutU32(buffer, (uint32_t)flights.size());
+	for (const auto& kv : flights) {
+		const CNetworkFlightPlan& fp = kv.second;
+		PutString(buffer, fp.Callsign);
+		PutString(buffer, fp.Type);
+		PutU32(buffer, (uint32_t)fp.AssignedLevel);
+		PutU32(buffer, (uint32_t)fp.AssignedMach);
+		PutString(buffer, fp.Track);
+		PutString(buffer, fp.Route);
+		PutString(buffer, fp.RouteEtas);
+		PutString(buffer, fp.Departure);
+		PutString(buffer, fp.Arrival);
+		PutString(buffer, fp.Etd);
+		PutString(buffer, fp.Selcal);
+		PutString(buffer, fp.State);
+		PutString(buffer, fp.TrackedBy);
+		PutString(buffer, fp.TrackedById);
+		PutString(buffer, fp.LastUpdated);
+		PutU32(buffer, (uint32_t)fp.TargetMode);
+
+		// Flags
+		uint32_t flags = (fp.Direction ? 1 : 0) | (fp.DatalinkConnected ? 2 : 0) | (fp.IsEquipped ? 4 : 0) | (fp.Relevant ? 8 : 0);
+		PutU32(buffer, flags);
+	}
+
+	return WriteCacheFile("vNAAATS.flights.cache", buffer);
+}
+
+int CDataCache::LoadFlights(map<string, CNetworkFlightPlan>& flights, int maxAge) {
+	string buffer;
+	if (ReadCacheFile("vNAAATS.flights.cache", buffer) != 0) {
+		return 1;
+	}
+
+	CCacheReader reader(buffer);
+	int64_t saved = 0;
+	if (!reader.GetHeader(CACHE_FLIGHTS, saved)) {
+		return 1;
+	}
+
+	// Too old to be the same flights
+	if ((int64_t)time(nullptr) - saved > maxAge) {
+		return 1;
+	}
+
+	uint32_t count = reader.GetCount();
+	for (uint32_t i = 0; i < count && reader.IsOk; i++) {
+		CNetworkFlightPlan fp;
+		fp.Callsign = reader.GetString();
+		fp.Type = reader.GetString();
+		fp.AssignedLevel = (int)reader.GetU32();
+		fp.AssignedMach = (int)reader.GetU32();
+		fp.Track = reader.GetString();
+		fp.Route = reader.GetString();
+		fp.RouteEtas = reader.GetString();
+		fp.Departure = reader.GetString();
+		fp.Arrival = reader.GetString();
+		fp.Etd = reader.GetString();
+		fp.Selcal = reader.GetString();
+		fp.State = reader.GetString();
+		fp.TrackedBy = reader.GetString();
+		fp.TrackedById = reader.GetString();
+		fp.LastUpdated = reader.GetString();
+		fp.TargetMode = (CRadarTargetMode)reader.GetU32();
+
+		// Flags
+		uint32_t flags = reader.GetU32();
+		fp.Direction = (flags & 1) != 0;
+		fp.DatalinkConnected = (flags & 2) != 0;
+		fp.IsEquipped = (flags & 4) != 0;
+		fp.Relevant = (flags & 8) != 0;
+
+		if (reader.IsOk) flights[fp.Callsign] = fp;
+	}
+
+	// Truncated
+	if (!reader.IsOk) {
+		flights.clear();
+		return 1;
+	}
+
+	return 0;
+}
+
+string CDataCache::GetPath(const string& name) {
+	return CUtils::DllPath + "\\" + name;
+}
+
+int CDataCache::WriteCacheFile(const string& name, const string& buffer) {
+	// Write alongside
+	string path = GetPath(name);
+	string temporary = path + ".tmp";
+	{
+		ofstream file(temporary, ios::binary | ios::trunc);
+		if (!file.is_open()) {
+			return 1;
+		}
+		file.write(buffer.data(), buffer.size());
+		if (!file.good()) {
+			return 1;
+		}
+	}
+
+	// Swap in
+	if (!MoveFileExA(temporary.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+		DeleteFileA(temporary.c_str());
+		return 1;
+	}
+
+	return 0;
+}
+
+int CDataCache::ReadCacheFile(const string& name, string& buffer) {
+	ifstream file(GetPath(name), ios::binary | ios::ate);
+	if (!file.is_open()) {
+		return 1;
+	}
+
+	// Whole file in one read
+	streamoff size = file.tellg();
+	if (size <= 0) {
+		return 1;
+	}
+	buffer.resize((size_t)size);
+	file.seekg(0);
+	file.read(&buffer[0], size);
+
+	return file.good() ? 0 : 1;
+}
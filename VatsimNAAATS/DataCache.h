@@ -0,0 +1,42 @@
+#pragma once
+#include <string>
+#include <map>
+#include "EuroScopePlugIn.h"
+#include "Structures.h"
+
+using namespace std;
+using namespace EuroScopePlugIn;
+
+// What a cached download was fetched from, sent back so the server can answer 304 if nothing changed
+struct CCacheValidators {
+	string Url;
+	string ETag;
+	string LastModified;
+};
+
+// Last known network data, kept next to the plugin in a compact binary format so the display is usable before the first download completes
+class CDataCache
+{
+	public:
+		// Save the track set with the validators it was downloaded with
+		static int SaveTracks(const CTrackSet& tracks, const CCacheValidators& validators);
+
+		// Load the cached track set (1 if there is none or it can't be read)
+		static int LoadTracks(CTrackSet& tracks, CCacheValidators& validators);
+
+		// Save the network flight records
+		static int SaveFlights(const map<string, CNetworkFlightPlan>& flights);
+
+		// Load the network flight records if they were saved within the given age (seconds)
+		static int LoadFlights(map<string, CNetworkFlightPlan>& flights, int maxAge);
+
+	private:
+		// Full path of a cache file
+		static string GetPath(const string& name);
+
+		// Write a buffer to disk, replacing the old file only once the new one is complete
+		static int WriteCacheFile(const string& name, const string& buffer);
+
+		// Read a whole file
+		static int ReadCacheFile(const string& name, string& buffer);
+};
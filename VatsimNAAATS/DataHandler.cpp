@@ -1,12 +1,18 @@
 #include "pch.h"
 #include "DataHandler.h"
 #include "RoutesHelper.h"
+#include "RouteGeometry.h"
+#include "TrackIngest.h"
+#include "NetworkParser.h"
+#include "NetworkSync.h"
+#include "DataCache.h"
+#include "OutboundQueue.h"
+#include "Diagnostics.h"
+#include "Lifecycle.h"
 #include "Keys.h"
 #include <iostream>
 #include <fstream>
 #include <json.hpp>
-#include <WinInet.h>
-#pragma comment(lib,"WinInet.Lib")
 
 // Include dependency
 using json = nlohmann::json;
@@ -14,229 +20,360 @@ using namespace ApiKeys;
 
 const string CDataHandler::TrackURL = "https://api.vnaaats.net/GetAllNatTracks";
 map<string, CAircraftFlightPlan> CDataHandler::flights;
+set<string> CDataHandler::changedFlights;
+shared_ptr<const CFlightIndex> CDataHandler::publishedFlights = make_shared<CFlightIndex>();
+vector<pair<string, function<void(CRadarScreen*, CAircraftFlightPlan&)>>> CDataHandler::pendingUpdates;
+mutex CDataHandler::pendingUpdatesLock;
+atomic<bool> CDataHandler::networkSyncActive(false);
+thread CDataHandler::refreshThread;
+thread CDataHandler::syncThread;
+bool CDataHandler::isNetworkRefreshed = false;
+bool CDataHandler::isCacheLoaded = false;
+bool CDataHandler::isNetworkWatched = false;
+CSyncWatermark CDataHandler::syncWatermark;
+CCacheValidators CDataHandler::trackValidators;
+mutex CDataHandler::trackValidatorsLock;
+shared_ptr<CTrackSet> CDataHandler::pendingTracks;
+vector<pair<string, bool>> CDataHandler::userMessages;
+string CDataHandler::newVersion;
+mutex CDataHandler::userMessagesLock;
+map<string, CNetworkFlightPlan> CDataHandler::networkCache;
+mutex CDataHandler::networkCacheLock;
 
 const string CDataHandler::PluginVersion = "https://raw.githubusercontent.com/vNAAATS/vatsim-NAAATS/master/pluginversion.txt";
 const string CDataHandler::TrackSource = "https://api.vnaaats.net/GetTrackSource";
-const string CDataHandler::GetSingleAircraft = "https://api.vnaaats.net/GetSingleFlightData?callsign=";
+const string CDataHandler::GetAllAircraft = "https://api.vnaaats.net/GetAllFlightData";
 const string CDataHandler::PostSingleAircraft = "https://api.vnaaats.net/PostFlightData?code=" + ApiKeys::FUNC_KEY;
 const string CDataHandler::FlightDataUpdate = "https://api.vnaaats.net/UpdateFlightData?code=" + ApiKeys::FUNC_KEY;
 
-int CDataHandler::CheckPluginVersion(CPlugIn* plugin)
+int CDataHandler::CheckPluginVersion()
 {
 	// Try and get data and pass into string
 	string responseString = "";
 	try {
-		// Convert URL to LPCSTR type
-		LPCSTR lpcURL = CDataHandler::PluginVersion.c_str();
-
-		// Delete cache data
-		DeleteUrlCacheEntry(lpcURL);
-
 		// Download data
-		CComPtr<IStream> pStream;
-		HRESULT hr = URLOpenBlockingStream(NULL, lpcURL, &pStream, 0, NULL);
+		CHttpResponse response = CHttpClient::Get(PluginVersion);
 		// If failed
-		if (FAILED(hr)) {
-			int code = (int)hr;
+		if (!response.IsOk()) {
+			string code = ResponseCode(response);
 			// Show user message
-			plugin->DisplayUserMessage("vNAAATS", "Error", "Failed to fetch version info. Code: " + code, true, true, true, true, true);
+			QueueUserMessage(string("Failed to fetch version info. Code: " + code), true);
 			// Clogger
 			CLogger::Log(CLogType::ERR, "Could not fetch version info. Code: " + code, "CDataHandler::CheckPluginVersion");
 			return -1;
 		}
-		// Put data into buffer
-		char tempBuffer[16384];
-		DWORD bytesRead = 0;
-		hr = pStream->Read(tempBuffer, sizeof(tempBuffer), &bytesRead);
-		// Put data into string
-		for (int i = 0; i < bytesRead; i++) {
-			responseString += tempBuffer[i];
-		}
+		responseString = response.Body;
 	}
 	catch (exception & e) {
 		// Log to ES
-		plugin->DisplayUserMessage("vNAAATS", "Error", string("Failed to fetch version info: " + string(e.what())).c_str(), true, true, true, true, true);
+		QueueUserMessage(string("Failed to fetch version info: " + string(e.what())), true);
 		// Clogger
 		CLogger::Log(CLogType::EXC, "Could not fetch version info: " + string(string(e.what())), "CDataHandler::CheckPluginVersion");
 		return -1;
 	}
 
-	// Check version
+	// Check version, the UI thread tells the user
 	if (responseString != PLUGIN_VERSION) {
-		// Display dialog if update available
-		int msgBox = MessageBox(NULL, (LPCSTR)("A new version of vNAAATS (" + responseString + ") is now available. Your version: " + PLUGIN_VERSION +
-			"\nPlease update as soon as possible to avoid possible compatibility issues.\nFind the new version at vNAAATS.net.").c_str(),
-			(LPCSTR)"vNAAATS Version Notification", MB_ICONWARNING | MB_OK);
-
-		if (msgBox == IDOK) {
-			// Open the website
-			ShellExecute(NULL, "open", "https://vnaaats.net/", NULL, NULL, SW_SHOWNORMAL);
-		}
-		return msgBox;
+		lock_guard<mutex> lock(userMessagesLock);
+		newVersion = responseString;
+		return 0;
 	}
 
 	return -1;
 }
 
-int CDataHandler::PopulateLatestTrackData(CPlugIn* plugin) {
+void CDataHandler::ShowVersionNotification(const string& version) {
+	// Display dialog if update available
+	int msgBox = MessageBox(NULL, (LPCSTR)("A new version of vNAAATS (" + version + ") is now available. Your version: " + PLUGIN_VERSION +
+		"\nPlease update as soon as possible to avoid possible compatibility issues.\nFind the new version at vNAAATS.net.").c_str(),
+		(LPCSTR)"vNAAATS Version Notification", MB_ICONWARNING | MB_OK);
+
+	if (msgBox == IDOK) {
+		// Open the website
+		ShellExecute(NULL, "open", "https://vnaaats.net/", NULL, NULL, SW_SHOWNORMAL);
+	}
+}
+
+int CDataHandler::PopulateLatestTrackData(CRadarScreen* screen) {
+	// Download
+	shared_ptr<CTrackSet> staging;
+	int status = DownloadTracks(staging);
+	ShowUserMessages(screen->GetPlugIn());
+	if (status == 1) {
+		return 1;
+	}
+
+	// Nothing new since the last download
+	if (status == 2) {
+		string tmi = CRoutesHelper::GetTracks()->TMI;
+		screen->GetPlugIn()->DisplayUserMessage("Message", "vNAAATS Plugin", string("Track data is up to date. TMI is " + tmi + ".").c_str(), false, false, false, false, false);
+		CLogger::Log(CLogType::NORM, "Track data unchanged. TMI is " + tmi + ".", "CDataHandler::PopulateLatestTrackData");
+		return 0;
+	}
+
+	return ApplyTracks(screen, staging);
+}
+
+int CDataHandler::LoadCachedData(CRadarScreen* screen) {
+	// Once per plugin, a display opened later keeps what the refresh brought in
+	if (isCacheLoaded) {
+		return 0;
+	}
+	isCacheLoaded = true;
+
+	// Tracks
+	shared_ptr<CTrackSet> tracks = make_shared<CTrackSet>();
+	CCacheValidators validators;
+	int status = 1;
+	if (CDataCache::LoadTracks(*tracks, validators) == 0) {
+		{
+			lock_guard<mutex> lock(trackValidatorsLock);
+			trackValidators = validators;
+		}
+		CRoutesHelper::SetTracks(tracks);
+		CLogger::Log(CLogType::NORM, "Cached track data loaded. TMI is " + tracks->TMI + ".", "CDataHandler::LoadCachedData");
+		status = 0;
+	}
+
+	// Network flight data (only if recent, it is matched to flights as they are created)
+	map<string, CNetworkFlightPlan> cached;
+	if (CDataCache::LoadFlights(cached, NETWORK_CACHE_AGE) == 0) {
+		CLogger::Log(CLogType::NORM, "Cached network data loaded for " + to_string(cached.size()) + " aircraft.", "CDataHandler::LoadCachedData");
+		lock_guard<mutex> lock(networkCacheLock);
+		networkCache = move(cached);
+	}
+
+	return status;
+}
+
+void CDataHandler::StartNetworkRefresh() {
+	// Nothing new once the plugin is unloading
+	if (CLifecycle::IsShuttingDown()) {
+		return;
+	}
+
+	// Once per plugin, not per display
+	if (isNetworkRefreshed) {
+		return;
+	}
+	isNetworkRefreshed = true;
+
+	refreshThread = thread(RefreshNetworkData);
+	WatchNetworkThreads();
+}
+
+void CDataHandler::RefreshNetworkData() {
+	// Tracks, handed to the UI thread to swap in
+	shared_ptr<CTrackSet> staging;
+	if (DownloadTracks(staging) == 0) {
+		atomic_store(&pendingTracks, staging);
+	}
+
+	// Check plugin version (not while the plugin is unloading)
+	if (!CLifecycle::IsShuttingDown()) {
+		CheckPluginVersion();
+	}
+}
+
+void CDataHandler::WatchNetworkThreads() {
+	if (isNetworkWatched) return;
+	isNetworkWatched = true;
+	CLifecycle::OnShutdown(JoinNetworkThreads);
+}
+
+void CDataHandler::JoinNetworkThreads() {
+	// Requests in flight fail once the HTTP client is released, so neither is held up for long
+	if (refreshThread.joinable()) refreshThread.join();
+	if (syncThread.joinable()) syncThread.join();
+}
+
+bool CDataHandler::ApplyPendingTracks(CRadarScreen* screen) {
+	// Anything the refresh had to say
+	ShowUserMessages(screen->GetPlugIn());
+
+	shared_ptr<CTrackSet> staging = atomic_exchange(&pendingTracks, shared_ptr<CTrackSet>());
+	if (staging == nullptr) {
+		return false;
+	}
+
+	return ApplyTracks(screen, staging) == 0;
+}
+
+void CDataHandler::QueueUserMessage(string message, bool isError) {
+	lock_guard<mutex> lock(userMessagesLock);
+	userMessages.push_back(make_pair(message, isError));
+}
+
+void CDataHandler::ShowUserMessages(CPlugIn* plugin) {
+	// Take the queue
+	vector<pair<string, bool>> messages;
+	string version;
+	{
+		lock_guard<mutex> lock(userMessagesLock);
+		messages.swap(userMessages);
+		version.swap(newVersion);
+	}
+
+	// Nobody to show them to
+	if (CLifecycle::IsShuttingDown()) {
+		return;
+	}
+
+	for (auto& message : messages) {
+		if (message.second) {
+			plugin->DisplayUserMessage("vNAAATS", "Error", message.first.c_str(), true, true, true, true, true);
+		}
+		else {
+			plugin->DisplayUserMessage("Message", "vNAAATS Plugin", message.first.c_str(), false, false, false, false, false);
+		}
+	}
+
+	// New version found by the refresh
+	if (version != "") {
+		ShowVersionNotification(version);
+	}
+}
+
+int CDataHandler::DownloadTracks(shared_ptr<CTrackSet>& staging) {
 	// Try and get data and pass into string
 	string responseString;
+	CCacheValidators validators;
 	try {
-		// Convert URL to LPCSTR type
-		string eventTracks = TrackURL + "?event=true";
-		LPCSTR lpcURL = GetTrackSource(plugin) == 0 ? TrackURL.c_str() : eventTracks.c_str();
-
-		// Delete cache data
-		DeleteUrlCacheEntry(lpcURL);
+		// Track URL
+		validators.Url = GetTrackSource() == 0 ? TrackURL : TrackURL + "?event=true";
+
+		// Only ask for changes if we hold tracks from the same URL
+		CHttpRequest request;
+		request.Url = validators.Url;
+		{
+			lock_guard<mutex> lock(trackValidatorsLock);
+			if (trackValidators.Url == validators.Url && CRoutesHelper::GetTracks()->TMI != "") {
+				request.IfNoneMatch = trackValidators.ETag;
+				request.IfModifiedSince = trackValidators.LastModified;
+			}
+		}
 
 		// Download data
-		CComPtr<IStream> pStream;
-		HRESULT hr = URLOpenBlockingStream(NULL, lpcURL, &pStream, 0, NULL);
+		CHttpResponse response = CHttpClient::Instance()->Send(request).get();
+		// Unchanged
+		if (response.IsNotModified()) {
+			return 2;
+		}
 		// If failed
-		if (FAILED(hr)) {
-			int code = (int)hr;
+		if (!response.IsOk()) {
+			string code = ResponseCode(response);
 			// Show user message
-			plugin->DisplayUserMessage("vNAAATS", "Error", "Track data download failed. Code: " + code, true, true, true, true, true);
+			QueueUserMessage(string("Track data download failed. Code: " + code), true);
 			// Clogger
-			CLogger::Log(CLogType::ERR, "Could not connect to tracks API. Code: " + code, "CDataHandler::PopulateLatestTrackData");
+			CLogger::Log(CLogType::ERR, "Could not connect to tracks API. Code: " + code, "CDataHandler::DownloadTracks");
 			return 1;
 		}
-		// Put data into buffer
-		char tempBuffer[16384];
-		DWORD bytesRead = 0;
-		hr = pStream->Read(tempBuffer, sizeof(tempBuffer), &bytesRead);
-		// Put data into string
-		for (int i = 0; i < bytesRead; i++) {
-			responseString += tempBuffer[i];
-		}
+		responseString = move(response.Body);
+		validators.ETag = response.ETag;
+		validators.LastModified = response.LastModified;
 	}
 	catch (exception & e) {
 		// Log to ES
-		plugin->DisplayUserMessage("vNAAATS", "Error", string("Failed to load NAT Track data: " + string(e.what())).c_str(), true, true, true, true, true);
+		QueueUserMessage(string("Failed to load NAT Track data: " + string(e.what())), true);
 		// Clogger
-		CLogger::Log(CLogType::EXC, "Failed to load NAT Track data: " + string(string(e.what())), "CDataHandler::PopulateLatestTrackData");
+		CLogger::Log(CLogType::EXC, "Failed to load NAT Track data: " + string(string(e.what())), "CDataHandler::DownloadTracks");
 		return 1;
 	}
-	
-	// Parse the json
-	try {
-		// Clear old tracks
-		if (!CRoutesHelper::CurrentTracks.empty()) {
-			CRoutesHelper::CurrentTracks.clear();
-		}
-		
-		// Now we parse the json
-		auto jsonArray = json::parse(responseString);
-		for (int i = 0; i < jsonArray.size(); i++) {
-			// Make track
-			CTrack track;
-
-			// Identifier
-			track.Identifier = jsonArray[i].at("id");
-
-			// TMI
-			track.TMI = jsonArray[i].at("tmi");
-			CRoutesHelper::CurrentTMI = jsonArray[i].at("tmi");
-
-			// Direction
-			if (jsonArray[i].at("direction") == 0) {
-				track.Direction = CTrackDirection::UNKNOWN;
-			}
-			else if (jsonArray[i].at("direction") == 1) {
-				track.Direction = CTrackDirection::WEST;
-			}
-			else {
-				track.Direction = CTrackDirection::EAST;
-			}
 
-			// Route
-			for (int j = 0; j < jsonArray[i].at("route").size(); j++) {
-				track.Route.push_back(jsonArray[i].at("route")[j].at("name"));
-
-				// Get lat and lon vars
-				double lat = jsonArray[i].at("route")[j].at("latitude");
-				double lon = jsonArray[i].at("route")[j].at("longitude");
-
-				// Split the name string to determine whether half waypoints (i.e. xxxx/xx not xx/xx)
-				vector<string> splitString;
-				int successCode = CUtils::StringSplit(jsonArray[i].at("route")[j].at("name"), '/', &splitString);
-				
-				// If they are weird half waypoints then divide by 100 to get the decimal
-				if (successCode == 0 && splitString.size() == 2) {
-					if (splitString[0].size() > 2)
-						lat /= 100.0;
-					
-					if (splitString[1].size() > 2)
-						lon /= 100.0;
-				}
-
-				// Finally, append
-				track.RouteRaw.push_back(CUtils::PositionFromLatLon(lat, lon));				
-			}
+	// Build the new track set off to the side, the live tracks are untouched until it is complete
+	staging = make_shared<CTrackSet>();
+	string error;
+	if (CTrackIngest::ParseTracks(responseString, *staging, error) != 0) {
+		// User message
+		QueueUserMessage(string("Failed to parse NAT track JSON return: " + error), true);
+		// Clogger
+		CLogger::Log(CLogType::EXC, "Failed to parse NAT track JSON return: " + error, "CDataHandler::DownloadTracks");
+		return 1;
+	}
 
-			// Flight levels
-			for (int j = 0; j < jsonArray[i].at("flightLevels").size(); j++) {
-				track.FlightLevels.push_back((int)jsonArray[i].at("flightLevels")[j]);
-			}
+	// Keep it for next time
+	{
+		lock_guard<mutex> lock(trackValidatorsLock);
+		trackValidators = validators;
+	}
+	if (CDataCache::SaveTracks(*staging, validators) != 0) {
+		CLogger::Log(CLogType::WARN, "Could not write the track cache.", "CDataHandler::DownloadTracks");
+	}
 
-			// Validity
-			track.validFrom = string(jsonArray[i].at("validFrom"));
-			track.validTo = string(jsonArray[i].at("validTo"));
+	return 0;
+}
 
-			// Push track to tracks array
-			CRoutesHelper::CurrentTracks.insert(make_pair(track.Identifier, track));
-		}
-		// Everything succeeded, show to user
-		plugin->DisplayUserMessage("Message", "vNAAATS Plugin", string("Track data loaded successfully. TMI is " + CRoutesHelper::CurrentTMI + ".").c_str(), false, false, false, false, false);
-		// Clogger
-		CLogger::Log(CLogType::NORM, string("Track data loaded successfully. TMI is " + CRoutesHelper::CurrentTMI + "."), "CDataHandler::PopulateLatestTrackData");
+int CDataHandler::ApplyTracks(CRadarScreen* screen, shared_ptr<CTrackSet> staging) {
+	CPlugIn* plugin = screen->GetPlugIn();
+	clock_t ingestTimer = clock();
+
+	// Swap it in, keeping the old set to see what changed
+	shared_ptr<const CTrackSet> previous = CRoutesHelper::GetTracks();
+	CRoutesHelper::SetTracks(staging);
+
+	// Re-expand only the flights on tracks that changed
+	CTrackChanges changes;
+	CTrackIngest::DiffTracks(*previous, *staging, changes);
+	int rerouted = RerouteTrackFlights(screen, changes);
+
+	// Log the summary
+	double ingestTime = (double)(clock() - ingestTimer) / ((double)CLOCKS_PER_SEC / 1000.0);
+	CLogger::Log(CLogType::NORM, "TMI " + (previous->TMI == "" ? string("none") : previous->TMI) + " -> " + staging->TMI + ": "
+		+ to_string(changes.Added.size()) + " added, " + to_string(changes.Removed.size()) + " removed, " + to_string(changes.Changed.size()) + " changed, "
+		+ to_string(rerouted) + " flights re-routed in " + CUtils::RoundDecimalPlaces(ingestTime, 1) + "ms.", "CDataHandler::ApplyTracks");
+
+	// Everything succeeded, show to user
+	plugin->DisplayUserMessage("Message", "vNAAATS Plugin", string("Track data loaded successfully. TMI is " + staging->TMI + ".").c_str(), false, false, false, false, false);
+	// Clogger
+	CLogger::Log(CLogType::NORM, string("Track data loaded successfully. TMI is " + staging->TMI + "."), "CDataHandler::ApplyTracks");
+	return 0;
+}
+
+int CDataHandler::RerouteTrackFlights(CRadarScreen* screen, const CTrackChanges& changes) {
+	// Nothing to do
+	if (changes.Changed.empty() && changes.Removed.empty()) {
 		return 0;
 	}
-	catch (exception & e) {
-		// User message
-		plugin->DisplayUserMessage("vNAAATS", "Error", string("Failed to parse NAT track JSON return: " + string(e.what())).c_str(), true, true, true, true, true);
-		// Clogger
-		CLogger::Log(CLogType::EXC, "Failed to parse NAT track JSON return: " + string(e.what()), "CDataHandler::PopulateLatestTrackData");
-		return 1;
+
+	// Queue the flights bound to a changed or removed track
+	int count = 0;
+	for (auto& kv : flights) {
+		const string& track = kv.second.Track;
+		if (find(changes.Changed.begin(), changes.Changed.end(), track) != changes.Changed.end()
+			|| find(changes.Removed.begin(), changes.Removed.end(), track) != changes.Removed.end()) {
+			CUtils::CAsyncData* data = new CUtils::CAsyncData();
+			data->Screen = screen;
+			data->Callsign = kv.first;
+			CRoutesHelper::QueueRoute(data); // Async
+			count++;
+		}
 	}
+
+	return count;
 }
 
-int CDataHandler::GetTrackSource(CPlugIn* plugin) {
+int CDataHandler::GetTrackSource() {
 	// Try and get data and pass into string
 	string responseString;
 	try {
-		// Convert URL to LPCSTR type
-		LPCSTR lpcURL = TrackSource.c_str();
-
-		// Delete cache data
-		DeleteUrlCacheEntry(lpcURL);
-
 		// Download data
-		CComPtr<IStream> pStream;
-		HRESULT hr = URLOpenBlockingStream(NULL, lpcURL, &pStream, 0, NULL);
+		CHttpResponse response = CHttpClient::Get(TrackSource);
 		// If failed
-		if (FAILED(hr)) {
-			int code = (int)hr;
+		if (!response.IsOk()) {
+			string code = ResponseCode(response);
 			// Show user message
-			plugin->DisplayUserMessage("vNAAATS", "Error", "Track source retrieval failed. Code: " + code, true, true, true, true, true);
+			QueueUserMessage(string("Track source retrieval failed. Code: " + code), true);
 			// Clogger
 			CLogger::Log(CLogType::ERR, "Could not connect to the vNAAATS network. Code: " + code, "CDataHandler::GetTrackSource");
 			return 1;
 		}
-		// Put data into buffer
-		char tempBuffer[16384];
-		DWORD bytesRead = 0;
-		hr = pStream->Read(tempBuffer, sizeof(tempBuffer), &bytesRead);
-		// Put data into string
-		for (int i = 0; i < bytesRead; i++) {
-			responseString += tempBuffer[i];
-		}
+		responseString = response.Body;
 
 		return stoi(responseString);
 	}
 	catch (exception & e) {
 		// Log to ES
-		plugin->DisplayUserMessage("vNAAATS", "Error", string("Failed to load track source data: " + string(e.what())).c_str(), true, true, true, true, true);
+		QueueUserMessage(string("Failed to load track source data: " + string(e.what())), true);
 		// Clogger
 		CLogger::Log(CLogType::EXC, "Failed to load track source: " + string(string(e.what())), "CDataHandler::GetTrackSource");
 		return 1;
@@ -244,23 +381,141 @@ int CDataHandler::GetTrackSource(CPlugIn* plugin) {
 }
 
 CAircraftFlightPlan* CDataHandler::GetFlightData(string callsign) {
-	if (flights.find(callsign) != flights.end()) {
-		
-		return &flights.find(callsign)->second;
+	auto fp = flights.find(callsign);
+	if (fp != flights.end()) {
+		return &fp->second;
 	}
-	// Return invalid
-	CAircraftFlightPlan fp;
-	fp.IsValid = false;
-	return &fp;
+	// Return invalid (reset each time in case the last caller wrote to it)
+	static CAircraftFlightPlan invalid;
+	invalid = CAircraftFlightPlan();
+	invalid.IsValid = false;
+	return &invalid;
+}
+
+bool CDataHandler::FlightExists(string callsign) {
+	return flights.find(callsign) != flights.end();
 }
 
-void CDataHandler::GetFlightData(string callsign, CAircraftFlightPlan& fp) {
+shared_ptr<const CAircraftFlightPlan> CDataHandler::GetFlightSnapshot(string callsign) {
+	shared_ptr<const CFlightIndex> index = atomic_load(&publishedFlights);
+	auto fp = index->Flights.find(callsign);
+	return fp != index->Flights.end() ? fp->second : nullptr;
+}
+
+shared_ptr<const CFlightIndex> CDataHandler::GetFlightSnapshots() {
+	return atomic_load(&publishedFlights);
+}
+
+bool CDataHandler::GetFlightHotData(const string& callsign, CFlightHotData& hot) {
+	shared_ptr<const CFlightIndex> index = atomic_load(&publishedFlights);
+	auto data = index->HotData.find(callsign);
+	if (data == index->HotData.end()) {
+		hot = CFlightHotData();
+		return false;
+	}
+	hot = data->second;
+	return true;
+}
+
+void CDataHandler::PostFlightUpdate(string callsign, function<void(CRadarScreen*, CAircraftFlightPlan&)> update) {
+	lock_guard<mutex> lock(pendingUpdatesLock);
+	pendingUpdates.push_back(make_pair(callsign, update));
+}
+
+void CDataHandler::PostFlightUpdates(vector<pair<string, function<void(CRadarScreen*, CAircraftFlightPlan&)>>>& updates) {
+	lock_guard<mutex> lock(pendingUpdatesLock);
+	for (auto& update : updates) {
+		pendingUpdates.push_back(move(update));
+	}
+	updates.clear();
+}
+
+void CDataHandler::MarkFlightChanged(string callsign) {
 	if (flights.find(callsign) != flights.end()) {
-		fp = flights.find(callsign)->second;
-		fp.IsValid = true;
-		return;
+		changedFlights.insert(callsign);
 	}
-	fp.IsValid = false;
+}
+
+int CDataHandler::ApplyFlightUpdates(CRadarScreen* screen) {
+	// Take the queue
+	vector<pair<string, function<void(CRadarScreen*, CAircraftFlightPlan&)>>> updates;
+	{
+		lock_guard<mutex> lock(pendingUpdatesLock);
+		updates.swap(pendingUpdates);
+	}
+
+	// Apply in order, dropping changes to flights that have since been deleted
+	for (auto& update : updates) {
+		auto fp = flights.find(update.first);
+		if (fp != flights.end()) {
+			update.second(screen, fp->second);
+			changedFlights.insert(update.first);
+		}
+	}
+
+	// Publish
+	return PublishFlightData();
+}
+
+bool CDataHandler::HasPendingChanges() {
+	if (atomic_load(&pendingTracks) != nullptr) {
+		return true;
+	}
+
+	{
+		lock_guard<mutex> lock(userMessagesLock);
+		if (!userMessages.empty() || newVersion != "") {
+			return true;
+		}
+	}
+
+	lock_guard<mutex> lock(pendingUpdatesLock);
+	return !pendingUpdates.empty();
+}
+
+int CDataHandler::PublishFlightData() {
+	// Nothing changed
+	if (changedFlights.empty()) {
+		return 0;
+	}
+
+	// Copy the index (records are shared, only the changed ones are replaced)
+	shared_ptr<const CFlightIndex> current = atomic_load(&publishedFlights);
+	shared_ptr<CFlightIndex> index = make_shared<CFlightIndex>(*current);
+	index->Version++;
+
+	int published = 0;
+	for (const string& callsign : changedFlights) {
+		auto fp = flights.find(callsign);
+		if (fp == flights.end()) {
+			// Deleted
+			index->Flights.erase(callsign);
+			index->HotData.erase(callsign);
+		}
+		else {
+			// Bump the record version and replace the copy
+			fp->second.Version++;
+			index->Flights[callsign] = make_shared<const CAircraftFlightPlan>(fp->second);
+			index->HotData[callsign] = MakeHotData(fp->second);
+		}
+		published++;
+	}
+	changedFlights.clear();
+
+	// Swap it in, readers holding the old index keep it until they let go
+	atomic_store(&publishedFlights, shared_ptr<const CFlightIndex>(index));
+	return published;
+}
+
+CFlightHotData CDataHandler::MakeHotData(const CAircraftFlightPlan& fp) {
+	CFlightHotData hot;
+	hot.FlightLevel = atoi(fp.FlightLevel.c_str());
+	hot.Mach = atoi(fp.Mach.c_str());
+	strncpy_s(hot.Track, sizeof(hot.Track), fp.Track.c_str(), _TRUNCATE);
+	hot.IsEquipped = fp.IsEquipped;
+	hot.IsCleared = fp.IsCleared;
+	hot.IsValid = fp.IsValid;
+	return hot;
 }
 
 int CDataHandler::UpdateFlightData(CRadarScreen* screen, string callsign, bool updateRoute) {
@@ -277,7 +532,7 @@ int CDataHandler::UpdateFlightData(CRadarScreen* screen, string callsign, bool u
 		CUtils::CAsyncData* data = new CUtils::CAsyncData();
 		data->Screen = screen;
 		data->Callsign = callsign;
-		_beginthread(CRoutesHelper::InitialiseRoute, 0, (void*) data); // Async
+		CRoutesHelper::QueueRoute(data); // Async
 	}
 
 	// Success
@@ -335,14 +590,26 @@ int CDataHandler::CreateFlightData(CRadarScreen* screen, string callsign) {
 		// Flight plan is valid
 		fp.IsValid = true;
 
+		// Fill in from the last network record we have, the next sync corrects anything stale
+		{
+			lock_guard<mutex> lock(networkCacheLock);
+			auto cached = networkCache.find(callsign);
+			if (cached != networkCache.end()) {
+				vector<string> route;
+				CNetworkSync::SplitRoute(cached->second.Route, route);
+				CNetworkSync::ApplyRecord(fp, cached->second, route);
+			}
+		}
+
 		// Add FP to map
 		flights[callsign] = fp;
+		changedFlights.insert(callsign);
 
 		// Generate route
 		CUtils::CAsyncData* data = new CUtils::CAsyncData();
 		data->Screen = screen;
 		data->Callsign = callsign;
-		_beginthread(CRoutesHelper::InitialiseRoute, 0, (void*)data); // Async
+		CRoutesHelper::QueueRoute(data); // Async
 
 		// Log string
 		string fDLog = "Flight data object " + data->Callsign + " generated successfully.";
@@ -367,8 +634,9 @@ int CDataHandler::CreateFlightData(CRadarScreen* screen, string callsign) {
 
 int CDataHandler::DeleteFlightData(string callsign) {
 	if (flights.find(callsign) != flights.end()) {
-		// Remove the flight if it exists
+		// Remove the flight if it exists (published copies live on until released)
 		flights.erase(callsign);
+		changedFlights.insert(callsign);
 		// Clogger
 		CLogger::Log(CLogType::NORM, "Flight data object for " + callsign + " destroyed successfully.", "CDataHandler::DeleteFlightData");
 		return 0;
@@ -379,6 +647,9 @@ int CDataHandler::DeleteFlightData(string callsign) {
 }
 
 int CDataHandler::SetRoute(string callsign, vector<CWaypoint>* route, string track, CAircraftFlightPlan* copiedPlan) {
+	// Precompute the leg geometry once for all route consumers
+	CRouteGeometry::BuildRoute(*route);
+
 	if (copiedPlan != nullptr) {
 		// Set route if flight exists
 		copiedPlan->Route.clear();
@@ -393,335 +664,194 @@ int CDataHandler::SetRoute(string callsign, vector<CWaypoint>* route, string tra
 
 		return 0;
 	}
-	if (flights.find(callsign) != flights.end()) {
-		// Set route if flight exists
-		flights.find(callsign)->second.Route.clear();
-		flights.find(callsign)->second.Route = *route;
-		flights.find(callsign)->second.Route.shrink_to_fit();
-		// Set track if not nothing
-		if (track != "")
-			flights.find(callsign)->second.Track = track;
-		else 
-			flights.find(callsign)->second.Track = "RR";
-
-		// Success code
-		return 0;
-	}
-	else {
-		return 1; // Non-success code occurs when flight doesn't exist
-	}
-}
-
-void CDataHandler::DownloadNetworkAircraft(void* args) {
-	// Convert args
-	CUtils::CNetworkAsyncData* data = (CUtils::CNetworkAsyncData*) args;
-
-	// Get callsign & radar screen
-	string callsign = data->Callsign;
-	CRadarScreen* screen = data->Screen;
 
-	// Create URL
-	string reqUrl = GetSingleAircraft + callsign;
+	// Hand the route over to the UI thread (called from the route worker)
+	vector<CWaypoint> newRoute = *route;
+	newRoute.shrink_to_fit();
+	string newTrack = track != "" ? track : "RR";
+	PostFlightUpdate(callsign, [newRoute, newTrack](CRadarScreen* screen, CAircraftFlightPlan& fp) {
+		fp.Route = newRoute;
+		fp.Track = newTrack;
+	});
 
-	// Try and get data and pass into string
-	string responseString;
+	// Success code
+	return 0;
+}
 
-	try {
-		// Convert URL to LPCSTR type
-		LPCSTR lpcURL = reqUrl.c_str();
+void CDataHandler::SyncNetworkAircraft() {
+	// Nothing new once the plugin is unloading
+	if (CLifecycle::IsShuttingDown()) {
+		return;
+	}
 
-		// Delete cache data
-		DeleteUrlCacheEntry(lpcURL);
+	// Only one sync at a time
+	bool expected = false;
+	if (!networkSyncActive.compare_exchange_strong(expected, true)) {
+		return;
+	}
 
-		// Download data
-		CComPtr<IStream> pStream;
-		HRESULT hr = URLOpenBlockingStream(NULL, lpcURL, &pStream, 0, NULL);
-		// If failed (probably a 404 not found)
-		if (FAILED(hr)) {
-			// Cleanup
-			delete args;
-			return;
-		}
+	// The last one has finished, collect it
+	if (syncThread.joinable()) syncThread.join();
+	syncThread = thread(GetAllNetworkAircraft);
+	WatchNetworkThreads();
+}
 
-		// Put data into buffer
-		char tempBuffer[16384];
-		DWORD bytesRead = 0;
-		hr = pStream->Read(tempBuffer, sizeof(tempBuffer), &bytesRead);
-		// Put data into string
-		for (int i = 0; i < bytesRead; i++) {
-			responseString += tempBuffer[i];
-		}
+void CDataHandler::GetAllNetworkAircraft() {
+	// Performance timer
+	clock_t syncClock = clock();
+
+	// Download and diff against the flights we hold
+	shared_ptr<const CFlightIndex> local = GetFlightSnapshots();
+	CNetworkSyncResult result;
+	int status = CNetworkSync::Sync(GetAllAircraft, *local, syncWatermark, result);
+	if (CLifecycle::IsShuttingDown()) {
+		networkSyncActive = false;
+		return;
 	}
-	catch (exception & e) {
-		data->plugin->DisplayUserMessage("vNAAATS", "Error", string("Failed to download aircraft data for " + data->Callsign + ". Error: " + string(e.what())).c_str(), true, true, true, true, true);
-		CLogger::Log(CLogType::EXC, "Could not download network data for aircraft " + callsign + ": " + string(e.what()) + "\nRequest URL: \n" + reqUrl, "CDataHandler::DownloadNetworkAircraft");
-		// Cleanup
-		delete args;
+	if (status == 1) {
+		CLogger::Log(CLogType::ERR, "Could not sync network aircraft. A connection to the server could not be established.", "CDataHandler::GetAllNetworkAircraft");
+		networkSyncActive = false;
+		return;
+	}
+	if (status == 2) {
+		CLogger::Log(CLogType::EXC, "Could not parse network aircraft: " + result.Error + "\nRequest URL: \n" + result.Url, "CDataHandler::GetAllNetworkAircraft");
+		networkSyncActive = false;
 		return;
 	}
 
-	// Parse the json
-	try {
-		// Now we parse the json
-		auto jsonArray = json::parse(responseString);
-		for (int i = 0; i < jsonArray.size(); i++) {
-			// Make a network object
-			CNetworkFlightPlan netFP;
-
-			// Fill properties
-			netFP.Callsign = jsonArray[i].at("callsign");
-			netFP.Type = jsonArray[i].at("type");
-			netFP.AssignedLevel = jsonArray[i].at("assignedLevel");
-			netFP.AssignedMach = jsonArray[i].at("assignedMach");
-			netFP.Track = jsonArray[i].at("track");
-			netFP.Route = jsonArray[i].at("route");
-			netFP.RouteEtas = jsonArray[i].at("routeEtas");
-			netFP.Departure = jsonArray[i].at("departure");
-			netFP.Arrival = jsonArray[i].at("arrival");
-			netFP.Direction = jsonArray[i].at("direction");
-			netFP.Etd = jsonArray[i].at("etd");
-			netFP.Selcal = jsonArray[i].at("selcal");
-			netFP.DatalinkConnected = jsonArray[i].at("datalinkConnected");
-			netFP.IsEquipped = jsonArray[i].at("isEquipped");
-			netFP.State = jsonArray[i].at("state");
-			netFP.Relevant = jsonArray[i].at("relevant");
-			netFP.TrackedBy = jsonArray[i].at("trackedBy");
-			netFP.TrackedById = jsonArray[i].at("trackedById");
-			netFP.TargetMode = jsonArray[i].at("targetMode");
-			netFP.LastUpdated = jsonArray[i].at("lastUpdated");
-
-			// Get flight plan
-			CAircraftFlightPlan* fp = CDataHandler::GetFlightData(callsign);
-
-			// If it is valid
-			if (fp->IsValid) {
-				// Check if it is cleared
-				if (!fp->IsCleared) fp->IsCleared = true;
-				// Simply update all the values
-				fp->FlightLevel = to_string(netFP.AssignedLevel);
-				fp->Mach = to_string(netFP.AssignedMach);
-				fp->Track = netFP.Track;
-				fp->Depart = netFP.Departure;
-				fp->Dest = netFP.Arrival;
-				fp->Etd = netFP.Etd;
-				fp->State = netFP.State;
-				fp->IsEquipped = netFP.IsEquipped;
-				fp->IsRelevant = netFP.Relevant;
-				fp->DLStatus = to_string(netFP.DatalinkConnected);
-				fp->TargetMode = CUtils::GetTargetMode(screen->GetPlugIn()->RadarTargetSelect(callsign.c_str()).GetPosition().GetRadarFlags());
-
-				// Routes
-				vector<string> splitString;
-				CUtils::StringSplit(netFP.Route, ' ', &splitString);
-				bool isUpdated = false;
-
-				// Check first if they are the same length
-				if (splitString.size() != fp->RouteRaw.size()) {
-					// They are not so update the route
-					fp->RouteRaw = splitString;
-					isUpdated = true;
-				}
-				else {
-					// Now iterate and find out if there are discrepancies
-					for (int i = 0; i < splitString.size(); i++) {
-						if (splitString[i] != fp->RouteRaw[i]) {
-							// There is a discrepancy
-							fp->RouteRaw = splitString;
-							isUpdated = true;
-							break;
-						}
-					}
-				}
-
-				// If isUpdated is true, then we re-instantiate the route, hopefully without a crash
-				if (isUpdated) UpdateFlightData(screen, callsign, true);
-			}
-		}
+	// Changed flights, and the ones the network doesn't know about
+	vector<pair<string, function<void(CRadarScreen*, CAircraftFlightPlan&)>>> updates;
+	for (const auto& changed : result.Changed) {
+		updates.push_back(make_pair(changed.first.Callsign, MakeNetworkUpdate(changed.first, changed.second)));
 	}
-	catch (exception & e) {
-		data->plugin->DisplayUserMessage("vNAAATS", "Error", string("Failed to parse aircraft data for " + callsign +". Error: " + string(e.what())).c_str(), true, true, true, true, true);
-		CLogger::Log(CLogType::EXC, "Could not parse downloaded JSON for network aircraft " + callsign + ": " + string(e.what()) + "\nRequest URL: \n" + reqUrl, "CDataHandler::DownloadNetworkAircraft");
-		// Cleanup
-		delete args;
-		return;
+	for (const string& callsign : result.Unsynced) {
+		updates.push_back(make_pair(callsign, [](CRadarScreen* screen, CAircraftFlightPlan& fp) { fp.IsFirstUpdate = true; }));
 	}
 
-	// Cleanup
-	delete args;
-}
+	// Apply as one batch on the UI thread
+	size_t changed = updates.size();
+	PostFlightUpdates(updates);
 
-void CDataHandler::GetAllNetworkAircraft() {
+	// Remember for the next start
+	CacheNetworkFlights(result.Received, !result.IsDelta);
 
-}
+	// Diagnostics
+	CDiagnostics::RecordNetworkSync(result.IsDelta, result.Bytes, result.Records, (int)changed);
+	double syncTime = (double)(clock() - syncClock) / ((double)CLOCKS_PER_SEC) * 1000.0;
+	CLogger::Log(CLogType::NORM, string(result.IsDelta ? "Delta" : "Full") + " network sync complete. " + to_string(result.Records) + " records received, " + to_string(changed)
+		+ " flights updated in " + CUtils::RoundDecimalPlaces(syncTime, 1) + "ms.", "CDataHandler::GetAllNetworkAircraft");
 
-void CDataHandler::PostNetworkAircraft(void* args) {
-	// Convert args
-	CUtils::CNetworkAsyncData* data = (CUtils::CNetworkAsyncData*) args;
+	networkSyncActive = false;
+}
 
-	// Prefix
-	string reqUrl = PostSingleAircraft;
+string CDataHandler::ResponseCode(const CHttpResponse& response) {
+	return response.Status != 0 ? to_string(response.Status) : response.Error;
+}
 
-	try {
-		// Switch target mode
-		int mode = 0;
-		switch (data->FP->TargetMode) {
-			case CRadarTargetMode::PRIMARY:
-				mode = 0;
-				break;
-			case CRadarTargetMode::SECONDARY_S:
-				mode = 1;
-				break;
-			case CRadarTargetMode::SECONDARY_C:
-				mode = 2;
-				break;
-			case CRadarTargetMode::ADS_B:
-				mode = 3;
-				break;
-			default:
-				mode = 3;
-				break;
-		}
+function<void(CRadarScreen*, CAircraftFlightPlan&)> CDataHandler::MakeNetworkUpdate(const CNetworkFlightPlan& netFP, const vector<string>& route) {
+	// The display is the one applying it, displays can close while the update waits
+	return [netFP, route](CRadarScreen* screen, CAircraftFlightPlan& fp) {
+		// Simply update all the values
+		bool isUpdated = CNetworkSync::ApplyRecord(fp, netFP, route);
+		fp.TargetMode = CUtils::GetTargetMode(screen->GetPlugIn()->RadarTargetSelect(fp.Callsign.c_str()).GetPosition().GetRadarFlags());
 
-		// Construct URL
-		reqUrl += "&callsign=" + data->FP->Callsign;
-		reqUrl += "&type=" + data->FP->Type;
-		reqUrl += "&level=" + to_string(data->FP->AssignedLevel);
-		reqUrl += "&mach=" + to_string(data->FP->AssignedMach);
-		reqUrl += "&track=" + data->FP->Track;
-		reqUrl += "&route=" + data->FP->Route;
-		reqUrl += "&routeEtas=" + data->FP->RouteEtas;
-		reqUrl += "&departure=" + data->FP->Departure;
-		reqUrl += "&arrival=" + data->FP->Arrival;
-		reqUrl += "&direction=" + to_string(data->FP->Direction);
-		reqUrl += "&etd=" + data->FP->Etd;
-		reqUrl += "&selcal=" + data->FP->Selcal;
-		reqUrl += "&datalinkConnected=" + data->FP->DatalinkConnected;
-		reqUrl += "&isEquipped=" + to_string(data->FP->IsEquipped);
-		reqUrl += "&state=" + data->FP->State;
-		reqUrl += "&relevant=" + to_string(data->FP->Relevant);
-		reqUrl += "&targetMode=" + to_string(mode);
-		reqUrl += "&trackedBy=" + data->FP->TrackedBy;
-		reqUrl += "&trackedById=" + data->FP->TrackedById;
-	
-		// Convert URL to LPCSTR type
-		LPCSTR lpcURL = reqUrl.c_str();
-
-		// Delete cache data
-		DeleteUrlCacheEntry(lpcURL);
+		// If isUpdated is true, then we re-instantiate the route, hopefully without a crash
+		if (isUpdated) UpdateFlightData(screen, fp.Callsign, true);
+	};
+}
 
-		// Download data
-		CComPtr<IStream> pStream;
-		HRESULT hr = URLOpenBlockingStream(NULL, lpcURL, &pStream, 0, NULL);
+void CDataHandler::CacheNetworkFlights(const vector<CNetworkFlightPlan>& records, bool isFull) {
+	map<string, CNetworkFlightPlan> snapshot;
+	{
+		lock_guard<mutex> lock(networkCacheLock);
 
-		// If failed
-		if (FAILED(hr)) {
-			// We want to know about it
-			data->plugin->DisplayUserMessage("vNAAATS", "Error", string("Failed to post aircraft data for " + data->Callsign + ". The server returned an error.").c_str(), true, true, true, true, true);
-			CLogger::Log(CLogType::ERR, "Could not post aircraft " + data->FP->Callsign + " to the network. A connection to the server could not be established.", "CDataHandler::PostNetworkAircraft");
-			// Cleanup
-			delete data->FP;
-			delete args;
-			return;
-		}
-		else {
-			// Success, clean up and move on
-			delete data->FP;
-			delete args;
-			return;
+		// A full sync is the whole picture, a delta only adds to it
+		if (isFull) networkCache.clear();
+		for (const CNetworkFlightPlan& netFP : records) {
+			networkCache[netFP.Callsign] = netFP;
 		}
+		if (!isFull) return;
+		snapshot = networkCache;
 	}
-	catch (exception & e) {
-		data->plugin->DisplayUserMessage("vNAAATS", "Error", string("Failed to post aircraft data for " + data->Callsign + ". Error: " + string(e.what())).c_str(), true, true, true, true, true);
-		CLogger::Log(CLogType::EXC, "Could not post aircraft " + data->FP->Callsign + " to the network: " + string(e.what()) + "\nRequest URL: \n" + reqUrl, "CDataHandler::PostNetworkAircraft");
-		// Cleanup
-		delete data->FP;
-		delete args;
-		return;
+
+	// Save outside the lock
+	if (CDataCache::SaveFlights(snapshot) != 0) {
+		CLogger::Log(CLogType::WARN, "Could not write the network flight cache.", "CDataHandler::CacheNetworkFlights");
 	}
 }
 
-void CDataHandler::UpdateNetworkAircraft(void* args) {
+void CDataHandler::PostNetworkAircraft(void* args) {
 	// Convert args
 	CUtils::CNetworkAsyncData* data = (CUtils::CNetworkAsyncData*) args;
 
-	// Prefix
-	string reqUrl = FlightDataUpdate;
-
-	try {
-		// Switch target mode
-		int mode = 0;
-		switch (data->FP->TargetMode) {
-		case CRadarTargetMode::PRIMARY:
-			mode = 0;
-			break;
-		case CRadarTargetMode::SECONDARY_S:
-			mode = 1;
-			break;
-		case CRadarTargetMode::SECONDARY_C:
-			mode = 2;
-			break;
-		case CRadarTargetMode::ADS_B:
-			mode = 3;
-			break;
-		default:
-			mode = 3;
-			break;
-		}
+	// Queue, anything already waiting for this aircraft is replaced
+	if (data->FP != nullptr) {
+		COutboundQueue::Enqueue(*data->FP, true);
+	}
 
-		// Construct URL		
-		reqUrl += "&callsign=" + data->FP->Callsign;
-		reqUrl += "&type=" + data->FP->Type;
-		reqUrl += "&level=" + to_string(data->FP->AssignedLevel);
-		reqUrl += "&mach=" + to_string(data->FP->AssignedMach);
-		reqUrl += "&track=" + data->FP->Track;
-		reqUrl += "&route=" + data->FP->Route;
-		reqUrl += "&routeEtas=" + data->FP->RouteEtas;
-		reqUrl += "&departure=" + data->FP->Departure;
-		reqUrl += "&arrival=" + data->FP->Arrival;
-		reqUrl += "&direction=" + to_string(data->FP->Direction);
-		reqUrl += "&etd=" + data->FP->Etd;
-		reqUrl += "&selcal=" + data->FP->Selcal;
-		reqUrl += "&datalinkConnected=" + data->FP->DatalinkConnected;
-		reqUrl += "&isEquipped=" + to_string(data->FP->IsEquipped);
-		reqUrl += "&state=" + data->FP->State;
-		reqUrl += "&relevant=" + to_string(data->FP->Relevant);
-		reqUrl += "&targetMode=" + to_string(mode);
-		reqUrl += "&trackedBy=" + data->FP->TrackedBy;
-		reqUrl += "&trackedById=" + data->FP->TrackedById;
-	
-		// Convert URL to LPCSTR type
-		LPCSTR lpcURL = reqUrl.c_str();
-
-		// Delete cache data
-		DeleteUrlCacheEntry(lpcURL);
+	// Cleanup
+	delete data->FP;
+	delete args;
+}
 
-		// Download data
-		CComPtr<IStream> pStream;
-		HRESULT hr = URLOpenBlockingStream(NULL, lpcURL, &pStream, 0, NULL);
+void CDataHandler::UpdateNetworkAircraft(void* args) {
+	// Convert args
+	CUtils::CNetworkAsyncData* data = (CUtils::CNetworkAsyncData*) args;
 
-		// If failed
-		if (FAILED(hr)) {
-			// We want to know about it
-			data->plugin->DisplayUserMessage("vNAAATS", "Error", string("Failed to update aircraft data for " + data->Callsign + ". The server returned an error.").c_str(), true, true, true, true, true);
-			CLogger::Log(CLogType::ERR, "Could not post update for aircraft " + data->FP->Callsign + ".  A connection to the server could not be established.", "CDataHandler::UpdateNetworkAircraft");
-			// Cleanup
-			delete data->FP;
-			delete args;
-			return;
-		}
-		else {
-			// Success, clean up and move on
-			delete data->FP;
-			delete args;
-			return;
-		}
+	// Queue, anything already waiting for this aircraft is replaced
+	if (data->FP != nullptr) {
+		COutboundQueue::Enqueue(*data->FP, false);
 	}
-	catch (exception & e) {
-		data->plugin->DisplayUserMessage("vNAAATS", "Error", string("Failed to update aircraft data for " + data->Callsign + ". Error: " + string(e.what())).c_str(), true, true, true, true, true);
-		CLogger::Log(CLogType::EXC, "Could not post aircraft " + data->FP->Callsign + " to the network: " + string(e.what()) + "\nRequest URL: \n" + reqUrl, "CDataHandler::UpdateNetworkAircraft");
-		// Cleanup
-		delete data->FP;
-		delete args;
-		return;
+
+	// Cleanup
+	delete data->FP;
+	delete args;
+}
+
+string CDataHandler::MakeFlightDataUrl(const CNetworkFlightPlan& fp, bool isPost) {
+	// Prefix
+	string reqUrl = isPost ? PostSingleAircraft : FlightDataUpdate;
+
+	// Switch target mode
+	int mode = 0;
+	switch (fp.TargetMode) {
+	case CRadarTargetMode::PRIMARY:
+		mode = 0;
+		break;
+	case CRadarTargetMode::SECONDARY_S:
+		mode = 1;
+		break;
+	case CRadarTargetMode::SECONDARY_C:
+		mode = 2;
+		break;
+	case CRadarTargetMode::ADS_B:
+		mode = 3;
+		break;
+	default:
+		mode = 3;
+		break;
 	}
-}
\ No newline at end of file
+
+	// Construct URL
+	reqUrl += "&callsign=" + fp.Callsign;
+	reqUrl += "&type=" + fp.Type;
+	reqUrl += "&level=" + to_string(fp.AssignedLevel);
+	reqUrl += "&mach=" + to_string(fp.AssignedMach);
+	reqUrl += "&track=" + fp.Track;
+	reqUrl += "&route=" + fp.Route;
+	reqUrl += "&routeEtas=" + fp.RouteEtas;
+	reqUrl += "&departure=" + fp.Departure;
+	reqUrl += "&arrival=" + fp.Arrival;
+	reqUrl += "&direction=" + to_string(fp.Direction);
+	reqUrl += "&etd=" + fp.Etd;
+	reqUrl += "&selcal=" + fp.Selcal;
+	reqUrl += "&datalinkConnected=" + to_string(fp.DatalinkConnected);
+	reqUrl += "&isEquipped=" + to_string(fp.IsEquipped);
+	reqUrl += "&state=" + fp.State;
+	reqUrl += "&relevant=" + to_string(fp.Relevant);
+	reqUrl += "&targetMode=" + to_string(mode);
+	reqUrl += "&trackedBy=" + fp.TrackedBy;
+	reqUrl += "&trackedById=" + fp.TrackedById;
+
+	return reqUrl;
+}
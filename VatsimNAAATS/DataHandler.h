@@ -5,7 +5,16 @@
 #include "Overlays.h"
 #include "Utils.h"
 #include "Logger.h"
+#include "HttpClient.h"
+#include "DataCache.h"
+#include "NetworkSync.h"
 #include <json.hpp>
+#include <set>
+#include <mutex>
+#include <memory>
+#include <functional>
+#include <atomic>
+#include <thread>
 
 using namespace std;
 using namespace EuroScopePlugIn;
@@ -13,15 +22,59 @@ using namespace EuroScopePlugIn;
 class CDataHandler
 {
 	public:
-	// Check plugin version number
-	static int CheckPluginVersion(CPlugIn* plugin);
+	// Check plugin version number, a newer one is shown by the UI thread (0 if newer, -1 otherwise)
+	static int CheckPluginVersion();
 
 	// Download nat track data
-	static int PopulateLatestTrackData(CPlugIn* plugin);
+	static int PopulateLatestTrackData(CRadarScreen* screen);
 
-	// Get flight data
+	// Load the last known tracks and network flight data from disk (UI thread, once per plugin)
+	static int LoadCachedData(CRadarScreen* screen);
+
+	// Download tracks and check the version on the refresh thread (UI thread, once per plugin)
+	static void StartNetworkRefresh();
+
+	// Swap in tracks downloaded in the background (UI thread only), true if they were applied
+	static bool ApplyPendingTracks(CRadarScreen* screen);
+
+	// Queue a message for the user, EuroScope can only be called from the UI thread (any thread)
+	static void QueueUserMessage(string message, bool isError);
+
+	// Show the queued messages and any new version, dropped once the plugin is unloading (UI thread)
+	static void ShowUserMessages(CPlugIn* plugin);
+
+	// Get flight data (UI thread only, call MarkFlightChanged after writing through it)
 	static CAircraftFlightPlan* GetFlightData(string callsign);
-	static void GetFlightData(string callsign, CAircraftFlightPlan& fp);
+
+	// Check if a flight data object exists (UI thread only)
+	static bool FlightExists(string callsign);
+
+	// Get the last published copy of a flight (any thread, nullptr if none)
+	static shared_ptr<const CAircraftFlightPlan> GetFlightSnapshot(string callsign);
+
+	// Get the last published copy of every flight (any thread)
+	static shared_ptr<const CFlightIndex> GetFlightSnapshots();
+
+	// Get the hot fields of a flight without touching the full plan (any thread, false if none)
+	static bool GetFlightHotData(const string& callsign, CFlightHotData& hot);
+
+	// Queue a change to a flight, applied on the UI thread with the display that applies it (any thread)
+	static void PostFlightUpdate(string callsign, function<void(CRadarScreen*, CAircraftFlightPlan&)> update);
+
+	// Queue a batch of changes, applied together on the UI thread (any thread)
+	static void PostFlightUpdates(vector<pair<string, function<void(CRadarScreen*, CAircraftFlightPlan&)>>>& updates);
+
+	// Mark a flight as changed after editing it through a held pointer (UI thread only)
+	static void MarkFlightChanged(string callsign);
+
+	// Apply queued changes and publish changed flights (UI thread only)
+	static int ApplyFlightUpdates(CRadarScreen* screen);
+
+	// Whether worker threads have left changes, tracks or messages for the UI thread to pick up (any thread)
+	static bool HasPendingChanges();
+
+	// Publish changed flights (UI thread only)
+	static int PublishFlightData();
 
 	// Update a flight data object
 	static int UpdateFlightData(CRadarScreen* screen, string callsign, bool updateRoute);
@@ -36,32 +89,83 @@ class CDataHandler
 	static int SetRoute(string callsign, vector<CWaypoint>* route, string track, CAircraftFlightPlan* copiedPlan = nullptr);
 
 	/// vNAAATS network methods
-	// Download aircraft data (single)
-	static void DownloadNetworkAircraft(void* args);
-
-	// Download all aircraft data
-	static void GetAllNetworkAircraft();
+	// Start a bulk sync unless one is already running (UI thread)
+	static void SyncNetworkAircraft();
 
-	// Post new aircraft data
+	// Post new aircraft data (queued on the outbound queue, takes ownership of args)
 	static void PostNetworkAircraft(void* args);
 
-	// Update aircraft data
+	// Update aircraft data (queued on the outbound queue, takes ownership of args)
 	static void UpdateNetworkAircraft(void* args);
+
+	// Request URL for posting or updating a flight
+	static string MakeFlightDataUrl(const CNetworkFlightPlan& fp, bool isPost);
+
+	// HTTP status, or the transport error if the server never answered
+	static string ResponseCode(const CHttpResponse& response);
 	
 	private:
 		// Methods
-		static int GetTrackSource(CPlugIn* plugin); // Event tracks or not
+		static void RefreshNetworkData(); // Refresh thread, tracks and version
+		static void GetAllNetworkAircraft(); // Sync thread, download all aircraft data (bulk sync)
+		static void WatchNetworkThreads(); // Have the network threads joined at shutdown (once)
+		static void JoinNetworkThreads(); // Plugin shutdown
+		static void ShowVersionNotification(const string& version); // New version dialog (UI thread only)
+		static int GetTrackSource(); // Event tracks or not
+		static int RerouteTrackFlights(CRadarScreen* screen, const CTrackChanges& changes); // Re-expand flights on changed tracks
+		static int DownloadTracks(shared_ptr<CTrackSet>& staging); // 0 new set staged, 1 failed, 2 unchanged since the last download
+		static int ApplyTracks(CRadarScreen* screen, shared_ptr<CTrackSet> staging); // Swap in a track set (UI thread only)
+		static void CacheNetworkFlights(const vector<CNetworkFlightPlan>& records, bool isFull); // Remember network records, saved on full syncs
+		static CFlightHotData MakeHotData(const CAircraftFlightPlan& fp); // Hot fields of a flight
+		static function<void(CRadarScreen*, CAircraftFlightPlan&)> MakeNetworkUpdate(const CNetworkFlightPlan& netFP, const vector<string>& route); // Apply a network record
 
 		// Version URL
 		static const string PluginVersion;
 
 		// NAT Track URL
 		static const string TrackURL;
+
+		// Flight store, written by the UI thread only
 		static map<string, CAircraftFlightPlan> flights;
+		static set<string> changedFlights;
+
+		// Published flights (swapped atomically)
+		static shared_ptr<const CFlightIndex> publishedFlights;
+
+		// Changes queued by worker threads
+		static vector<pair<string, function<void(CRadarScreen*, CAircraftFlightPlan&)>>> pendingUpdates;
+		static mutex pendingUpdatesLock;
+
+		// Bulk sync running
+		static atomic<bool> networkSyncActive;
+
+		// Network threads, started and joined on the UI thread
+		static thread refreshThread;
+		static thread syncThread;
+		static bool isNetworkRefreshed;
+		static bool isCacheLoaded;
+		static bool isNetworkWatched;
+
+		// Delta sync watermark, sync thread only
+		static CSyncWatermark syncWatermark;
+
+		// Validators of the live tracks and tracks waiting for the UI thread
+		static CCacheValidators trackValidators;
+		static mutex trackValidatorsLock;
+		static shared_ptr<CTrackSet> pendingTracks;
+
+		// Messages waiting for the UI thread (text, is error) and a newer plugin version
+		static vector<pair<string, bool>> userMessages;
+		static string newVersion;
+		static mutex userMessagesLock;
+
+		// Last network record of every flight, used to fill in flights as they are created
+		static map<string, CNetworkFlightPlan> networkCache;
+		static mutex networkCacheLock;
 
 		// vNAAATS API Links
 		static const string TrackSource;
-		static const string GetSingleAircraft;
+		static const string GetAllAircraft;
 		static const string FlightDataUpdate;
 		static const string PostSingleAircraft;
 };
@@ -0,0 +1,129 @@
+#include "pch.h"
+#include "Diagnostics.h"
+#include "Utils.h"
+#include "OutboundQueue.h"
+
+bool CDiagnostics::IsVisible = false;
+CDiagnostics::CNetworkSyncStats CDiagnostics::lastSync;
+unsigned long long CDiagnostics::totalSyncBytes = 0;
+int CDiagnostics::syncCount = 0;
+mutex CDiagnostics::statsLock;
+CDiagnostics::CCpuStats CDiagnostics::cpu;
+double CDiagnostics::refreshTime = 0.0;
+clock_t CDiagnostics::cpuWindowStart = 0;
+double CDiagnostics::processCpuTime = -1.0;
+
+// FILETIME (100ns ticks) to milliseconds
+static double FileTimeMs(const FILETIME& time) {
+	ULARGE_INTEGER ticks;
+	ticks.LowPart = time.dwLowDateTime;
+	ticks.HighPart = time.dwHighDateTime;
+	return (double)ticks.QuadPart / 10000.0;
+}
+
+void CDiagnostics::RecordNetworkSync(bool isDelta, size_t bytes, int records, int applied) {
+	lock_guard<mutex> lock(statsLock);
+	lastSync.IsDelta = isDelta;
+	lastSync.Bytes = bytes;
+	lastSync.Records = records;
+	lastSync.Applied = applied;
+	totalSyncBytes += bytes;
+	syncCount++;
+}
+
+void CDiagnostics::RecordCursorLoad(double cpuPercent, double refreshesPerSecond) {
+	lock_guard<mutex> lock(statsLock);
+	cpu.Cursor = cpuPercent;
+	cpu.Refreshes = refreshesPerSecond;
+}
+
+void CDiagnostics::RecordRefreshTime(double ms) {
+	lock_guard<mutex> lock(statsLock);
+	refreshTime += ms;
+}
+
+double CDiagnostics::GetThreadCpuTime() {
+	FILETIME creation, exit, kernel, user;
+	if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user)) {
+		return 0.0;
+	}
+	return FileTimeMs(kernel) + FileTimeMs(user);
+}
+
+void CDiagnostics::UpdateCpuStats() {
+	// Process time so far
+	FILETIME creation, exit, kernel, user;
+	double processTime = 0.0;
+	if (GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) {
+		processTime = FileTimeMs(kernel) + FileTimeMs(user);
+	}
+
+	// First call starts the window
+	lock_guard<mutex> lock(statsLock);
+	if (processCpuTime < 0.0) {
+		processCpuTime = processTime;
+		cpuWindowStart = clock();
+		refreshTime = 0.0;
+		return;
+	}
+
+	// Roll over once a second
+	double window = (double)(clock() - cpuWindowStart) / ((double)CLOCKS_PER_SEC / 1000.0);
+	if (window < 1000.0) {
+		return;
+	}
+	cpu.UI = refreshTime / window * 100.0;
+	cpu.Process = (processTime - processCpuTime) / window * 100.0;
+	processCpuTime = processTime;
+	cpuWindowStart = clock();
+	refreshTime = 0.0;
+}
+
+void CDiagnostics::RenderDiagnostics(CDC* dc, CRadarScreen* screen) {
+	// Save context for later
+	int iDC = dc->SaveDC();
+
+	// Copy the stats out
+	UpdateCpuStats();
+	CCpuStats load;
+	CNetworkSyncStats sync;
+	unsigned long long totalBytes;
+	int count;
+	{
+		lock_guard<mutex> lock(statsLock);
+		load = cpu;
+		sync = lastSync;
+		totalBytes = totalSyncBytes;
+		count = syncCount;
+	}
+
+	// Font
+	FontSelector::SelectMonoFont(14, dc);
+	dc->SetTextColor(TextWhite.ToCOLORREF());
+	dc->SetTextAlign(TA_LEFT);
+
+	// Lines
+	int x = screen->GetRadarArea().left + 10;
+	int y = MENBAR_HEIGHT + 30;
+	string line = "NET SYNC " + to_string(count) + (sync.IsDelta ? " DELTA " : " FULL ")
+		+ CUtils::RoundDecimalPlaces(sync.Bytes / 1024.0, 1) + "KB " + to_string(sync.Applied) + "/" + to_string(sync.Records) + " APPLIED";
+	dc->TextOutA(x, y, line.c_str());
+	y += 14;
+	line = "NET TOTAL " + CUtils::RoundDecimalPlaces(totalBytes / 1024.0, 1) + "KB";
+	dc->TextOutA(x, y, line.c_str());
+	y += 14;
+	COutboundStats outbound = COutboundQueue::GetStats();
+	line = "NET OUT " + to_string(outbound.Depth) + " QUEUED " + to_string(outbound.InFlight) + " IN FLIGHT " + to_string(outbound.Sent) + " SENT "
+		+ to_string(outbound.Coalesced) + " COALESCED " + to_string(outbound.Retries) + " RETRIED " + to_string(outbound.Dropped) + " DROPPED";
+	dc->TextOutA(x, y, line.c_str());
+	y += 14;
+	line = "NET OUT LATENCY " + CUtils::RoundDecimalPlaces(outbound.LastLatency, 0) + "MS MAX " + CUtils::RoundDecimalPlaces(outbound.MaxLatency, 0) + "MS";
+	dc->TextOutA(x, y, line.c_str());
+	y += 14;
+	line = "CPU CURSOR " + CUtils::RoundDecimalPlaces(load.Cursor, 1) + "% UI " + CUtils::RoundDecimalPlaces(load.UI, 1) + "% PROCESS " + CUtils::RoundDecimalPlaces(load.Process, 1)
+		+ "% REFRESH REQ " + CUtils::RoundDecimalPlaces(load.Refreshes, 1) + "/S";
+	dc->TextOutA(x, y, line.c_str());
+
+	// Restore context
+	dc->RestoreDC(iDC);
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include <string>
+#include <mutex>
+#include <chrono>
+#include <ctime>
+#include "EuroScopePlugIn.h"
+#include "Constants.h"
+#include "Styles.h"
+
+using namespace std;
+using namespace Colours;
+using namespace EuroScopePlugIn;
+
+// Runtime counters for the diagnostics view (toggled with ".vnaaats diag")
+class CDiagnostics
+{
+	public:
+		// Show the view
+		static bool IsVisible;
+
+		// Record a network sync cycle (sync thread)
+		static void RecordNetworkSync(bool isDelta, size_t bytes, int records, int applied);
+
+		// Record the cursor thread's load over the last sample window (cursor thread)
+		static void RecordCursorLoad(double cpuPercent, double refreshesPerSecond);
+
+		// Record time spent in OnRefresh (UI thread)
+		static void RecordRefreshTime(double ms);
+
+		// CPU time used by the calling thread so far (milliseconds)
+		static double GetThreadCpuTime();
+
+		// Times the scope it lives in as refresh time (UI thread)
+		struct CRefreshTimer {
+			CRefreshTimer() : Start(chrono::steady_clock::now()) {}
+			~CRefreshTimer() { RecordRefreshTime(chrono::duration<double, milli>(chrono::steady_clock::now() - Start).count()); }
+			chrono::steady_clock::time_point Start;
+		};
+
+		// Draw the view
+		static void RenderDiagnostics(CDC* dc, CRadarScreen* screen);
+
+	private:
+		// One network sync cycle
+		struct CNetworkSyncStats {
+			bool IsDelta = false;
+			size_t Bytes = 0;
+			int Records = 0;
+			int Applied = 0;
+		};
+
+		// Plugin load, percentages of one core
+		struct CCpuStats {
+			double Cursor = 0.0;
+			double Refreshes = 0.0; // Refreshes the cursor thread asked for, per second
+			double UI = 0.0;
+			double Process = 0.0; // Whole of EuroScope, for scale
+		};
+
+		// Roll the UI and process windows over once a second (UI thread)
+		static void UpdateCpuStats();
+
+		static CNetworkSyncStats lastSync;
+		static CCpuStats cpu;
+		static double refreshTime; // OnRefresh milliseconds in the current window
+		static clock_t cpuWindowStart;
+		static double processCpuTime; // Process milliseconds at the start of the window
+		static unsigned long long totalSyncBytes;
+		static int syncCount;
+		static mutex statsLock;
+};
@@ -0,0 +1,139 @@
+#include "pch.h"
+#include "DrawList.h"
+
+void CDrawList::Begin(CDrawBackend* backend) {
+	Clear();
+	this->backend = backend;
+}
+
+void CDrawList::Submit() {
+	if (backend != nullptr && !commands.empty()) {
+		backend->Replay(*this);
+	}
+	Clear();
+}
+
+int CDrawList::Style(uint32_t colour, float width, int dash, int cap) {
+	// Existing, there are only ever a handful a frame
+	for (int i = 0; i < (int)styles.size(); i++) {
+		const CDrawStyle& style = styles[i];
+		if (style.Colour == colour && style.Width == width && style.Dash == dash && style.Cap == cap) {
+			return i;
+		}
+	}
+
+	// New
+	CDrawStyle style;
+	style.Colour = colour;
+	style.Width = width;
+	style.Dash = dash;
+	style.Cap = cap;
+	styles.push_back(style);
+	return (int)styles.size() - 1;
+}
+
+int CDrawList::Font(CDrawFontFamily family, int size, CDrawAlign align) {
+	// Existing
+	for (int i = 0; i < (int)fonts.size(); i++) {
+		const CDrawFont& font = fonts[i];
+		if (font.Family == family && font.Size == size && font.Align == align) {
+			return i;
+		}
+	}
+
+	// New
+	CDrawFont font;
+	font.Family = family;
+	font.Size = size;
+	font.Align = align;
+	fonts.push_back(font);
+	return (int)fonts.size() - 1;
+}
+
+CDrawSize CDrawList::MeasureText(int font, const string& text) const {
+	if (backend == nullptr || font < 0 || font >= (int)fonts.size()) {
+		return CDrawSize();
+	}
+	return backend->MeasureText(fonts[font], text);
+}
+
+void CDrawList::Line(int style, CDrawPoint from, CDrawPoint to) {
+	// Carries on the last segment, add to it
+	if (CanMerge(style, from)) {
+		points.push_back(to);
+		commands.back().Op = CDrawOp::POLYLINE;
+		commands.back().Count++;
+		merged++;
+		return;
+	}
+
+	CDrawPoint segment[2] = { from, to };
+	Add(CDrawOp::LINE, style, segment, 2);
+}
+
+void CDrawList::Polyline(int style, const CDrawPoint* points, int count) {
+	if (count < 2) return;
+
+	// Carries on the last segment, add to it
+	if (CanMerge(style, points[0])) {
+		this->points.insert(this->points.end(), points + 1, points + count);
+		commands.back().Op = CDrawOp::POLYLINE;
+		commands.back().Count += count - 1;
+		merged++;
+		return;
+	}
+
+	Add(count == 2 ? CDrawOp::LINE : CDrawOp::POLYLINE, style, points, count);
+}
+
+void CDrawList::Text(int font, int style, CDrawPoint at, const string& text) {
+	if (text.empty()) return;
+
+	Add(CDrawOp::TEXT, style, &at, 1);
+	CDrawCommand& command = commands.back();
+	command.Font = font;
+	command.Text = (int)this->text.size();
+	command.Length = (int)text.size();
+	this->text.append(text);
+}
+
+void CDrawList::FillRect(int style, CDrawPoint topLeft, CDrawPoint bottomRight) {
+	CDrawPoint corners[2] = { topLeft, bottomRight };
+	Add(CDrawOp::FILL_RECT, style, corners, 2);
+}
+
+void CDrawList::FillEllipse(int style, CDrawPoint topLeft, CDrawPoint bottomRight) {
+	CDrawPoint corners[2] = { topLeft, bottomRight };
+	Add(CDrawOp::FILL_ELLIPSE, style, corners, 2);
+}
+
+void CDrawList::FillPolygon(int style, const CDrawPoint* points, int count) {
+	if (count < 3) return;
+	Add(CDrawOp::FILL_POLYGON, style, points, count);
+}
+
+void CDrawList::Clear() {
+	commands.clear();
+	points.clear();
+	styles.clear();
+	fonts.clear();
+	text.clear();
+	merged = 0;
+}
+
+bool CDrawList::CanMerge(int style, CDrawPoint from) const {
+	// Only the last command, so the drawing order doesn't change (its points are the last in the buffer)
+	if (commands.empty()) return false;
+	const CDrawCommand& last = commands.back();
+	return (last.Op == CDrawOp::LINE || last.Op == CDrawOp::POLYLINE) && last.Style == style && points.back() == from;
+}
+
+void CDrawList::Add(CDrawOp op, int style, const CDrawPoint* from, int count) {
+	CDrawCommand command;
+	command.Op = op;
+	command.Style = style;
+	command.First = (int)points.size();
+	command.Count = count;
+	commands.push_back(command);
+	points.insert(points.end(), from, from + count);
+}
@@ -0,0 +1,140 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+
+using namespace std;
+
+// A point in screen pixels
+struct CDrawPoint {
+	int X = 0;
+	int Y = 0;
+	bool operator==(const CDrawPoint& other) const { return X == other.X && Y == other.Y; }
+};
+
+// Size of a text run
+struct CDrawSize {
+	int Width = 0;
+	int Height = 0;
+};
+
+// Draw commands
+enum class CDrawOp {
+	LINE, // Two points, becomes a polyline when the next segment carries on from it
+	POLYLINE,
+	TEXT, // One point, where the run starts
+	FILL_RECT, // Top left and bottom right
+	FILL_ELLIPSE, // Bounding box, top left and bottom right
+	FILL_POLYGON
+};
+
+// Font families, the backend maps them onto its own fonts
+enum class CDrawFontFamily {
+	NORMAL,
+	MONO,
+	ATC
+};
+
+// Where a text run sits on its point
+enum class CDrawAlign {
+	LEFT,
+	CENTER
+};
+
+// Pen or brush, only pens use the width, dash and cap
+struct CDrawStyle {
+	uint32_t Colour = 0; // ARGB
+	float Width = 1;
+	int Dash = 0; // GDI+ DashStyle, 0 is solid
+	int Cap = 0; // GDI+ LineCap, 0 is flat
+};
+
+// Font for text runs
+struct CDrawFont {
+	CDrawFontFamily Family = CDrawFontFamily::MONO;
+	int Size = 12;
+	CDrawAlign Align = CDrawAlign::LEFT;
+};
+
+// One command, its points and text live in the list's buffers
+struct CDrawCommand {
+	CDrawOp Op = CDrawOp::LINE;
+	int Style = 0; // Pen, brush or text colour
+	int First = 0; // First point
+	int Count = 0; // Number of points
+	int Font = -1; // Text only
+	int Text = 0; // Offset into the text buffer, text only
+	int Length = 0;
+};
+
+class CDrawBackend;
+
+// Draw commands for part of a frame, built by the renderers and replayed by a backend (UI thread only)
+// Nothing here is platform specific, so the renderers that emit into it can be counted and checked headless
+// A segment that carries on from the last one in the same pen is merged into it as it is added
+// Clearing keeps the buffers, so a warm list doesn't allocate
+class CDrawList
+{
+	public:
+		// Start recording for a backend (it measures the text), drops anything left over
+		void Begin(CDrawBackend* backend);
+
+		// Replay everything to the backend and clear
+		void Submit();
+
+		// Index of a pen, brush or text colour, the same style gets the same index
+		int Style(uint32_t colour, float width = 1, int dash = 0, int cap = 0);
+
+		// Index of a font
+		int Font(CDrawFontFamily family, int size, CDrawAlign align = CDrawAlign::LEFT);
+
+		// Size of a text run, zero without a backend
+		CDrawSize MeasureText(int font, const string& text) const;
+
+		// Commands
+		void Line(int style, CDrawPoint from, CDrawPoint to);
+		void Polyline(int style, const CDrawPoint* points, int count);
+		void Text(int font, int style, CDrawPoint at, const string& text);
+		void FillRect(int style, CDrawPoint topLeft, CDrawPoint bottomRight);
+		void FillEllipse(int style, CDrawPoint topLeft, CDrawPoint bottomRight);
+		void FillPolygon(int style, const CDrawPoint* points, int count);
+
+		// Drop the commands, keep the buffers
+		void Clear();
+
+		// For the backends
+		const vector<CDrawCommand>& Commands() const { return commands; }
+		const vector<CDrawPoint>& Points() const { return points; }
+		const vector<CDrawStyle>& Styles() const { return styles; }
+		const vector<CDrawFont>& Fonts() const { return fonts; }
+		const string& TextBuffer() const { return text; }
+		int Merged() const { return merged; } // Segments merged into the one before since the last clear
+
+	private:
+		// Whether a segment starting at a point carries on the last command
+		bool CanMerge(int style, CDrawPoint from) const;
+
+		// Add a command with its points
+		void Add(CDrawOp op, int style, const CDrawPoint* from, int count);
+
+		vector<CDrawCommand> commands;
+		vector<CDrawPoint> points;
+		vector<CDrawStyle> styles;
+		vector<CDrawFont> fonts;
+		string text; // Every text run, back to back
+		CDrawBackend* backend = nullptr;
+		int merged = 0;
+};
+
+// Replays draw lists
+class CDrawBackend
+{
+	public:
+		virtual ~CDrawBackend() {}
+
+		// Size of a text run in a font
+		virtual CDrawSize MeasureText(const CDrawFont& font, const string& text) = 0;
+
+		// Draw the list, in order
+		virtual void Replay(const CDrawList& list) = 0;
+};
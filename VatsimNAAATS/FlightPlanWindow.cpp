@@ -4,6 +4,9 @@
 #include "Styles.h"
 #include "Utils.h"
 #include "MessageWindow.h"
+#include "Lifecycle.h"
+#include "TextCache.h"
+#include "CallsignTable.h"
 #include <iostream>
 #include <fstream>
 #include <json.hpp>
@@ -195,8 +198,8 @@ void CFlightPlanWindow::RenderWindow(CDC* dc, Graphics* g, CRadarScreen* screen)
 	int iDC = dc->SaveDC();
 
 	// Create brushes
-	CBrush darkerBrush(ScreenBlue.ToCOLORREF());
-	CBrush lighterBrush(WindowBorder.ToCOLORREF());
+	CBrush* darkerBrush = StyleCache::GetGdiBrush(ScreenBlue.ToCOLORREF());
+	CBrush* lighterBrush = StyleCache::GetGdiBrush(WindowBorder.ToCOLORREF());
 
 	// Select title font
 	FontSelector::SelectNormalFont(16, dc);
@@ -223,11 +226,11 @@ void CFlightPlanWindow::RenderWindow(CDC* dc, Graphics* g, CRadarScreen* screen)
 	}
 	// Create base window rectangle
 	CRect windowRect(topLeft.x, topLeft.y, topLeft.x + WINSZ_FLTPLN_WIDTH, topLeft.y + size);
-	dc->FillRect(windowRect, &darkerBrush);
+	dc->FillRect(windowRect, darkerBrush);
 
 	// Create titlebar
 	CRect titleRect(windowRect.left, windowRect.top, windowRect.left + WINSZ_FLTPLN_WIDTH, windowRect.top + WINSZ_TITLEBAR_HEIGHT);
-	dc->FillRect(titleRect, &lighterBrush);
+	dc->FillRect(titleRect, lighterBrush);
 	dc->DrawEdge(titleRect, EDGE_RAISED, BF_BOTTOM);
 	dc->TextOutA(titleRect.left + (WINSZ_FLTPLN_WIDTH / 2), titleRect.top + (WINSZ_TITLEBAR_HEIGHT / 7), string(string("Flight Plan") + string(" - ") + primedPlan->Callsign).c_str());
 
@@ -237,7 +240,7 @@ void CFlightPlanWindow::RenderWindow(CDC* dc, Graphics* g, CRadarScreen* screen)
 
 	// Create button bar
 	CRect buttonBarRect(windowRect.left, windowRect.top + WINSZ_TITLEBAR_HEIGHT - 1, windowRect.left + WINSZ_FLTPLN_WIDTH, windowRect.top + 100);
-	dc->FillRect(buttonBarRect, &darkerBrush);
+	dc->FillRect(buttonBarRect, darkerBrush);
 	dc->Draw3dRect(buttonBarRect, ScreenBlue.ToCOLORREF(), BevelDark.ToCOLORREF());
 	InflateRect(buttonBarRect, -1, -1);
 	dc->Draw3dRect(buttonBarRect, ScreenBlue.ToCOLORREF(), BevelDark.ToCOLORREF());
@@ -263,7 +266,7 @@ void CFlightPlanWindow::RenderWindow(CDC* dc, Graphics* g, CRadarScreen* screen)
 
 	// Create info bar
 	CRect infoBarRect(windowRect.left, buttonBarRect.bottom + 1, windowRect.left + WINSZ_FLTPLN_WIDTH, buttonBarRect.bottom + (IsData ? 50 : 75));
-	dc->FillRect(infoBarRect, &darkerBrush);
+	dc->FillRect(infoBarRect, darkerBrush);
 	dc->Draw3dRect(infoBarRect, BevelLight.ToCOLORREF(), BevelDark.ToCOLORREF());
 	InflateRect(infoBarRect, -1, -1);
 	dc->Draw3dRect(infoBarRect, BevelLight.ToCOLORREF(), BevelDark.ToCOLORREF());
@@ -422,21 +425,17 @@ void CFlightPlanWindow::RenderWindow(CDC* dc, Graphics* g, CRadarScreen* screen)
 		RenderATCRestrictSubModal(dc, g, screen, { windowRect.left + 80, windowRect.top + 30 });
 	}
 
-	// Cleanup
-	DeleteObject(darkerBrush);
-	DeleteObject(lighterBrush);
-
 	// Restore device context
 	dc->RestoreDC(iDC);
 }
 
 CRect CFlightPlanWindow::RenderDataPanel(CDC* dc, Graphics* g, CRadarScreen* screen, POINT topLeft, bool isCopy) {
 	// Brushes
-	CBrush routeBox(RouteBox.ToCOLORREF());
-	CBrush darkerBrush(ScreenBlue.ToCOLORREF());
-	CBrush lighterBrush(WindowBorder.ToCOLORREF());
-	CBrush lightBackground(LightBackground.ToCOLORREF());
-	CBrush evenLighterBackground(NoReadBk.ToCOLORREF());
+	CBrush* routeBox = StyleCache::GetGdiBrush(RouteBox.ToCOLORREF());
+	CBrush* darkerBrush = StyleCache::GetGdiBrush(ScreenBlue.ToCOLORREF());
+	CBrush* lighterBrush = StyleCache::GetGdiBrush(WindowBorder.ToCOLORREF());
+	CBrush* lightBackground = StyleCache::GetGdiBrush(LightBackground.ToCOLORREF());
+	CBrush* evenLighterBackground = StyleCache::GetGdiBrush(NoReadBk.ToCOLORREF());
 
 	// Create data bar
 	CRect dataBarRect(topLeft.x, topLeft.y + 1, topLeft.x + WINSZ_FLTPLN_WIDTH, topLeft.y + WINSZ_FLTPLN_HEIGHT_DATA + 2);
@@ -446,7 +445,7 @@ CRect CFlightPlanWindow::RenderDataPanel(CDC* dc, Graphics* g, CRadarScreen* scr
 
 	// Show callsign in coloured box
 	CRect idBox(topLeft.x + 6, dataBarRect.top + 8, topLeft.x + 150, dataBarRect.top + 36);
-	dc->FillRect(idBox, !primedPlan->IsCleared || isCopy ? &evenLighterBackground : &lightBackground);
+	dc->FillRect(idBox, !primedPlan->IsCleared || isCopy ? evenLighterBackground : lightBackground);
 	FontSelector::SelectATCFont(18, dc);
 	dc->SetTextColor(Black.ToCOLORREF());
 	dc->SetTextAlign(TA_CENTER);
@@ -454,7 +453,7 @@ CRect CFlightPlanWindow::RenderDataPanel(CDC* dc, Graphics* g, CRadarScreen* scr
 
 	// Create the route box
 	CRect rteBox(topLeft.x + 5, idBox.bottom + 8, dataBarRect.right - 100, idBox.bottom + 84);
-	dc->FillRect(rteBox, &routeBox);
+	dc->FillRect(rteBox, routeBox);
 	dc->Draw3dRect(rteBox, BevelDark.ToCOLORREF(), BevelLight.ToCOLORREF());
 	InflateRect(rteBox, -1, -1);
 	dc->Draw3dRect(rteBox, BevelDark.ToCOLORREF(), BevelLight.ToCOLORREF());
@@ -623,21 +622,14 @@ CRect CFlightPlanWindow::RenderDataPanel(CDC* dc, Graphics* g, CRadarScreen* scr
 		textInputs.at(boxType).Content = "NON COMPLIANT";
 	CCommonRenders::RenderTextInput(dc, screen, { dataBarRect.left + 5, rteBox.bottom + 43 }, WINSZ_FLTPLN_WIDTH - 13, 20, &textInputs.at(boxType));
 
-	// Cleanup
-	DeleteObject(darkerBrush);
-	DeleteObject(lighterBrush);
-	DeleteObject(lightBackground);
-	DeleteObject(evenLighterBackground);
-	DeleteObject(routeBox);
-
 	return dataBarRect;
 }
 
 void CFlightPlanWindow::RenderConflictWindow(CDC* dc, Graphics* g, CRadarScreen* screen, POINT topLeft)
 {
 	// Create brushes
-	CBrush darkerBrush(ScreenBlue.ToCOLORREF());
-	CBrush lighterBrush(WindowBorder.ToCOLORREF());
+	CBrush* darkerBrush = StyleCache::GetGdiBrush(ScreenBlue.ToCOLORREF());
+	CBrush* lighterBrush = StyleCache::GetGdiBrush(WindowBorder.ToCOLORREF());
 
 	// Select title font
 	FontSelector::SelectNormalFont(16, dc);
@@ -652,7 +644,7 @@ void CFlightPlanWindow::RenderConflictWindow(CDC* dc, Graphics* g, CRadarScreen*
 
 	// Create titlebar
 	CRect titleRect(conflictPanel.left, conflictPanel.top, conflictPanel.left + WINSZ_FLTPLN_WIDTH, conflictPanel.top + WINSZ_TITLEBAR_HEIGHT);
-	dc->FillRect(titleRect, &lighterBrush);
+	dc->FillRect(titleRect, lighterBrush);
 	dc->DrawEdge(titleRect, EDGE_RAISED, BF_BOTTOM);
 	dc->TextOutA(titleRect.left + (WINSZ_FLTPLN_WIDTH / 2), titleRect.top + (WINSZ_TITLEBAR_HEIGHT / 7), string("Conflict Window - " + primedPlan->Callsign).c_str()); // TODO: show callsign properly
 
@@ -687,7 +679,7 @@ void CFlightPlanWindow::RenderConflictWindow(CDC* dc, Graphics* g, CRadarScreen*
 		offsetX += 65;
 		dc->TextOutA(offsetX, offsetY, primedPlan->FlightLevel.c_str());
 		offsetX += 30;
-		dc->TextOutA(offsetX, offsetY, ("M" + CUtils::PadWithZeros(3, stoi(primedPlan->Mach))).c_str());
+		dc->TextOutA(offsetX, offsetY, CTextCache::Mach(CCallsignTable::Intern(primedPlan->Callsign), stoi(primedPlan->Mach)).c_str());
 		offsetX += 45;
 		// Draw main route
 		for (int i = 0; i < primedPlan->RouteRaw.size(); i++) {			
@@ -703,12 +695,13 @@ void CFlightPlanWindow::RenderConflictWindow(CDC* dc, Graphics* g, CRadarScreen*
 		for (auto kv : currentProbeStatuses) {
 			CRadarTarget target = screen->GetPlugIn()->RadarTargetSelect(kv.first.c_str());
 			int mach = target.GetCorrelatedFlightPlan().GetFlightPlanData().PerformanceGetMach(target.GetPosition().GetPressureAltitude(), target.GetVerticalSpeed());
+			int acId = CCallsignTable::Intern(kv.first);
 			// Draw aircraft data
 			dc->TextOutA(offsetX, offsetY, kv.first.c_str());
 			offsetX += 65;
-			dc->TextOutA(offsetX, offsetY, to_string((int)(round(target.GetPosition().GetFlightLevel()) / 100.0)).c_str());
+			dc->TextOutA(offsetX, offsetY, CTextCache::FlightLevel(target.GetPosition().GetFlightLevel()).c_str());
 			offsetX += 30;
-			dc->TextOutA(offsetX, offsetY, ("M" + CUtils::PadWithZeros(3, mach)).c_str());
+			dc->TextOutA(offsetX, offsetY, CTextCache::Mach(acId, mach).c_str());
 			offsetX += 45;
 			// Draw statuses
 			for (int i = 0; i < kv.second.size(); i++) {
@@ -732,17 +725,13 @@ void CFlightPlanWindow::RenderConflictWindow(CDC* dc, Graphics* g, CRadarScreen*
 
 		offsetY += 35;
 	}
-
-	// Clean up
-	DeleteObject(darkerBrush);
-	DeleteObject(lighterBrush);
 }
 
 void CFlightPlanWindow::RenderMessageWindow(CDC* dc, Graphics* g, CRadarScreen* screen, POINT bottomLeft)
 {
 	// Create brushes
-	CBrush darkerBrush(ScreenBlue.ToCOLORREF());
-	CBrush lighterBrush(WindowBorder.ToCOLORREF());
+	CBrush* darkerBrush = StyleCache::GetGdiBrush(ScreenBlue.ToCOLORREF());
+	CBrush* lighterBrush = StyleCache::GetGdiBrush(WindowBorder.ToCOLORREF());
 
 	// Select title font
 	FontSelector::SelectNormalFont(16, dc);
@@ -751,20 +740,20 @@ void CFlightPlanWindow::RenderMessageWindow(CDC* dc, Graphics* g, CRadarScreen*
 
 	// Create message panel
 	CRect messagePanel(bottomLeft.x, bottomLeft.y - WINSZ_FLTPLN_HEIGHT_MSG - 2, bottomLeft.x + WINSZ_FLTPLN_WIDTH, bottomLeft.y);
-	dc->FillRect(messagePanel, &darkerBrush);
+	dc->FillRect(messagePanel, darkerBrush);
 	dc->Draw3dRect(messagePanel, BevelLight.ToCOLORREF(), BevelDark.ToCOLORREF());
 	InflateRect(messagePanel, -1, -1);
 	dc->Draw3dRect(messagePanel, BevelLight.ToCOLORREF(), BevelDark.ToCOLORREF());
 
 	// Create titlebar
 	CRect titleRect(messagePanel.left, messagePanel.top, messagePanel.left + WINSZ_FLTPLN_WIDTH, messagePanel.top + WINSZ_TITLEBAR_HEIGHT);
-	dc->FillRect(titleRect, &lighterBrush);
+	dc->FillRect(titleRect, lighterBrush);
 	dc->DrawEdge(titleRect, EDGE_RAISED, BF_BOTTOM);
 	dc->TextOutA(titleRect.left + (WINSZ_FLTPLN_WIDTH / 2), titleRect.top + (WINSZ_TITLEBAR_HEIGHT / 7), string("FROM: " + (primedPlan->CurrentMessage != nullptr ? primedPlan->CurrentMessage->From : "")).c_str()); // TODO: show who from properly
 
 	// Create button bar
 	CRect buttonBarRect(messagePanel.left - 1, messagePanel.bottom - 40, messagePanel.left + WINSZ_FLTPLN_WIDTH, messagePanel.bottom);
-	dc->FillRect(buttonBarRect, &darkerBrush);
+	dc->FillRect(buttonBarRect, darkerBrush);
 	dc->Draw3dRect(buttonBarRect, BevelLight.ToCOLORREF(), ScreenBlue.ToCOLORREF());
 	InflateRect(buttonBarRect, -1, -1);
 	dc->Draw3dRect(buttonBarRect, BevelLight.ToCOLORREF(), ScreenBlue.ToCOLORREF());
@@ -845,17 +834,13 @@ void CFlightPlanWindow::RenderMessageWindow(CDC* dc, Graphics* g, CRadarScreen*
 			offsetX += 82;
 		}
 	}
-
-	// Clean up
-	DeleteObject(darkerBrush);
-	DeleteObject(lighterBrush);
 }
 
 void CFlightPlanWindow::RenderClearanceWindow(CDC* dc, Graphics* g, CRadarScreen* screen, POINT topLeft)
 {
 	// Create brushes
-	CBrush darkerBrush(ScreenBlue.ToCOLORREF());
-	CBrush lighterBrush(WindowBorder.ToCOLORREF());
+	CBrush* darkerBrush = StyleCache::GetGdiBrush(ScreenBlue.ToCOLORREF());
+	CBrush* lighterBrush = StyleCache::GetGdiBrush(WindowBorder.ToCOLORREF());
 
 	// Select title font
 	FontSelector::SelectNormalFont(16, dc);
@@ -870,7 +855,7 @@ void CFlightPlanWindow::RenderClearanceWindow(CDC* dc, Graphics* g, CRadarScreen
 
 	// Create titlebar
 	CRect titleRect(clearancePanel.left, clearancePanel.top, clearancePanel.left + WINSZ_FLTPLN_WIDTH, clearancePanel.top + WINSZ_TITLEBAR_HEIGHT);
-	dc->FillRect(titleRect, &lighterBrush);
+	dc->FillRect(titleRect, lighterBrush);
 	dc->DrawEdge(titleRect, EDGE_RAISED, BF_BOTTOM);
 	dc->TextOutA(titleRect.left + (WINSZ_FLTPLN_WIDTH / 2), titleRect.top + (WINSZ_TITLEBAR_HEIGHT / 7), (string(string("Clearance") + string(" - ") + primedPlan->Callsign).c_str())); // TODO: show callsign properly
 
@@ -979,20 +964,16 @@ void CFlightPlanWindow::RenderClearanceWindow(CDC* dc, Graphics* g, CRadarScreen
 		}
 	}
 
-
-	// Clean up
-	DeleteObject(darkerBrush);
-	DeleteObject(lighterBrush);
 }
 
 // Todo: modify this to make more suitable for voice clearances, and for position report entry and fix bugs
 void CFlightPlanWindow::RenderManEntryWindow(CDC* dc, Graphics* g, CRadarScreen* screen, POINT topLeft)
 {
 	// Create brushes
-	CBrush routeBox(RouteBox.ToCOLORREF());
-	CBrush darkerBrush(ScreenBlue.ToCOLORREF());
-	CBrush lighterBrush(WindowBorder.ToCOLORREF());
-	CBrush lightBackground(LightBackground.ToCOLORREF());
+	CBrush* routeBox = StyleCache::GetGdiBrush(RouteBox.ToCOLORREF());
+	CBrush* darkerBrush = StyleCache::GetGdiBrush(ScreenBlue.ToCOLORREF());
+	CBrush* lighterBrush = StyleCache::GetGdiBrush(WindowBorder.ToCOLORREF());
+	CBrush* lightBackground = StyleCache::GetGdiBrush(LightBackground.ToCOLORREF());
 
 	// Select title font
 	FontSelector::SelectNormalFont(16, dc);
@@ -1007,13 +988,13 @@ void CFlightPlanWindow::RenderManEntryWindow(CDC* dc, Graphics* g, CRadarScreen*
 
 	// Create titlebar
 	CRect titleRect(manEntryPanel.left, manEntryPanel.top, manEntryPanel.left + WINSZ_FLTPLN_WIDTH, manEntryPanel.top + WINSZ_TITLEBAR_HEIGHT);
-	dc->FillRect(titleRect, &lighterBrush);
+	dc->FillRect(titleRect, lighterBrush);
 	dc->DrawEdge(titleRect, EDGE_RAISED, BF_BOTTOM);
 	dc->TextOutA(titleRect.left + (WINSZ_FLTPLN_WIDTH / 2), titleRect.top + (WINSZ_TITLEBAR_HEIGHT / 7), (string(string("Manual Entry") + string(" - ") + primedPlan->Callsign).c_str())); // TODO: show callsign properly
 
 	// Show callsign in coloured box
 	CRect idBox(topLeft.x + 6, titleRect.bottom + 8, topLeft.x + 150, titleRect.bottom + 36);
-	dc->FillRect(idBox, &lightBackground);
+	dc->FillRect(idBox, lightBackground);
 	FontSelector::SelectATCFont(18, dc);
 	dc->SetTextColor(Black.ToCOLORREF());
 	dc->SetTextAlign(TA_CENTER);
@@ -1021,7 +1002,7 @@ void CFlightPlanWindow::RenderManEntryWindow(CDC* dc, Graphics* g, CRadarScreen*
 
 	// Create the route box
 	CRect rteBox(topLeft.x + 5, idBox.bottom + 8, manEntryPanel.right - 150, idBox.bottom + 94);
-	dc->FillRect(rteBox, &routeBox);
+	dc->FillRect(rteBox, routeBox);
 	dc->Draw3dRect(rteBox, BevelDark.ToCOLORREF(), BevelLight.ToCOLORREF());
 	InflateRect(rteBox, -1, -1);
 	dc->Draw3dRect(rteBox, BevelDark.ToCOLORREF(), BevelLight.ToCOLORREF());
@@ -1148,17 +1129,13 @@ void CFlightPlanWindow::RenderManEntryWindow(CDC* dc, Graphics* g, CRadarScreen*
 		windowButtons[BTN_MAN_SUBMIT].State = CInputState::DISABLED;
 	else 
 		windowButtons[BTN_MAN_SUBMIT].State = CInputState::INACTIVE;
-
-	// Clean up
-	DeleteObject(darkerBrush);
-	DeleteObject(lighterBrush);
 }
 
 void CFlightPlanWindow::RenderCoordModal(CDC* dc, Graphics* g, CRadarScreen* screen, POINT topLeft)
 {
 	// Create brushes
-	CBrush darkerBrush(ScreenBlue.ToCOLORREF());
-	CBrush lighterBrush(WindowBorder.ToCOLORREF());
+	CBrush* darkerBrush = StyleCache::GetGdiBrush(ScreenBlue.ToCOLORREF());
+	CBrush* lighterBrush = StyleCache::GetGdiBrush(WindowBorder.ToCOLORREF());
 
 	// Select title font
 	FontSelector::SelectNormalFont(16, dc);
@@ -1172,14 +1149,14 @@ void CFlightPlanWindow::RenderCoordModal(CDC* dc, Graphics* g, CRadarScreen* scr
 
 	// Create coordination window
 	CRect coordWindow(subWindowPositions[SUBWIN_COORD].x, subWindowPositions[SUBWIN_COORD].y + 1, subWindowPositions[SUBWIN_COORD].x + WINSZ_FLTPLN_WIDTH_COORD, subWindowPositions[SUBWIN_COORD].y + WINSZ_FLTPLN_HEIGHT_COORD);
-	dc->FillRect(coordWindow, &darkerBrush);
+	dc->FillRect(coordWindow, darkerBrush);
 	dc->Draw3dRect(coordWindow, BevelLight.ToCOLORREF(), BevelDark.ToCOLORREF());
 	InflateRect(coordWindow, -1, -1);
 	dc->Draw3dRect(coordWindow, BevelLight.ToCOLORREF(), BevelDark.ToCOLORREF());
 
 	// Create titlebar
 	CRect titleRect(coordWindow.left, coordWindow.top, coordWindow.left + WINSZ_FLTPLN_WIDTH_COORD, coordWindow.top + WINSZ_TITLEBAR_HEIGHT);
-	dc->FillRect(titleRect, &lighterBrush);
+	dc->FillRect(titleRect, lighterBrush);
 	dc->DrawEdge(titleRect, EDGE_RAISED, BF_BOTTOM);
 	dc->TextOutA(titleRect.left + (WINSZ_FLTPLN_WIDTH_COORD / 2), titleRect.top + (WINSZ_TITLEBAR_HEIGHT / 7), (string("Co-ordination Window - " + primedPlan->Callsign).c_str())); // TODO: show callsign properly
 	screen->AddScreenObject(WIN_FLTPLN, to_string(SUBWIN_COORD).c_str(), titleRect, true, "");
@@ -1208,7 +1185,7 @@ void CFlightPlanWindow::RenderCoordModal(CDC* dc, Graphics* g, CRadarScreen* scr
 
 	// Draw button bar
 	CRect buttonBarRect(coordWindow.left, coordWindow.bottom - 50, coordWindow.left + WINSZ_FLTPLN_WIDTH_COORD, coordWindow.bottom);
-	dc->FillRect(buttonBarRect, &darkerBrush);
+	dc->FillRect(buttonBarRect, darkerBrush);
 	dc->Draw3dRect(buttonBarRect, BevelLight.ToCOLORREF(), ScreenBlue.ToCOLORREF());
 	InflateRect(buttonBarRect, -1, -1);
 	dc->Draw3dRect(buttonBarRect, BevelLight.ToCOLORREF(), ScreenBlue.ToCOLORREF());
@@ -1297,17 +1274,13 @@ void CFlightPlanWindow::RenderCoordModal(CDC* dc, Graphics* g, CRadarScreen* scr
 	dc->Draw3dRect(coordWindow, WindowBorder.ToCOLORREF(), WindowBorder.ToCOLORREF());
 	InflateRect(coordWindow, 1, 1);
 	dc->DrawEdge(coordWindow, EDGE_RAISED, BF_RECT);
-
-	// Clean up
-	DeleteObject(darkerBrush);
-	DeleteObject(lighterBrush);
 }
 
 void CFlightPlanWindow::RenderHistoryModal(CDC* dc, Graphics* g, CRadarScreen* screen, POINT topLeft)
 {
 	// Create brushes
-	CBrush darkerBrush(ScreenBlue.ToCOLORREF());
-	CBrush lighterBrush(WindowBorder.ToCOLORREF());
+	CBrush* darkerBrush = StyleCache::GetGdiBrush(ScreenBlue.ToCOLORREF());
+	CBrush* lighterBrush = StyleCache::GetGdiBrush(WindowBorder.ToCOLORREF());
 
 	// If the position is null then set it
 	if (subWindowPositions[SUBWIN_HIST].x == 0 && subWindowPositions[SUBWIN_HIST].y == 0) {
@@ -1321,14 +1294,14 @@ void CFlightPlanWindow::RenderHistoryModal(CDC* dc, Graphics* g, CRadarScreen* s
 
 	// Create history window
 	CRect histWindow(subWindowPositions[SUBWIN_HIST].x, subWindowPositions[SUBWIN_HIST].y + 1, subWindowPositions[SUBWIN_HIST].x + WINSZ_FLTPLN_WIDTH_HIST, subWindowPositions[SUBWIN_HIST].y + WINSZ_FLTPLN_HEIGHT_HIST);
-	dc->FillRect(histWindow, &darkerBrush);
+	dc->FillRect(histWindow, darkerBrush);
 	dc->Draw3dRect(histWindow, BevelLight.ToCOLORREF(), BevelDark.ToCOLORREF());
 	InflateRect(histWindow, -1, -1);
 	dc->Draw3dRect(histWindow, BevelLight.ToCOLORREF(), BevelDark.ToCOLORREF());
 
 	// Create titlebar
 	CRect titleRect(histWindow.left, histWindow.top, histWindow.left + WINSZ_FLTPLN_WIDTH_HIST, histWindow.top + WINSZ_TITLEBAR_HEIGHT);
-	dc->FillRect(titleRect, &lighterBrush);
+	dc->FillRect(titleRect, lighterBrush);
 	dc->DrawEdge(titleRect, EDGE_RAISED, BF_BOTTOM);
 	dc->TextOutA(titleRect.left + (WINSZ_FLTPLN_WIDTH_HIST / 2), titleRect.top + (WINSZ_TITLEBAR_HEIGHT / 7), (string("Flight History - " + primedPlan->Callsign).c_str())); // TODO: show callsign properly
 	screen->AddScreenObject(WIN_FLTPLN, to_string(SUBWIN_HIST).c_str(), titleRect, true, "");
@@ -1368,17 +1341,13 @@ void CFlightPlanWindow::RenderHistoryModal(CDC* dc, Graphics* g, CRadarScreen* s
 	dc->Draw3dRect(histWindow, WindowBorder.ToCOLORREF(), WindowBorder.ToCOLORREF());
 	InflateRect(histWindow, 1, 1);
 	dc->DrawEdge(histWindow, EDGE_RAISED, BF_RECT);
-
-	// Clean up
-	DeleteObject(darkerBrush);
-	DeleteObject(lighterBrush);
 }
 
 void CFlightPlanWindow::RenderATCRestrictModal(CDC* dc, Graphics* g, CRadarScreen* screen, POINT topLeft)
 {
 	// Create brushes
-	CBrush darkerBrush(ScreenBlue.ToCOLORREF());
-	CBrush lighterBrush(WindowBorder.ToCOLORREF());
+	CBrush* darkerBrush = StyleCache::GetGdiBrush(ScreenBlue.ToCOLORREF());
+	CBrush* lighterBrush = StyleCache::GetGdiBrush(WindowBorder.ToCOLORREF());
 
 	// Plan
 	CAircraftFlightPlan* plan = IsCopyMade ? &copiedPlan : primedPlan;
@@ -1395,14 +1364,14 @@ void CFlightPlanWindow::RenderATCRestrictModal(CDC* dc, Graphics* g, CRadarScree
 
 	// Create restrictions window
 	CRect atcrWindow(subWindowPositions[SUBWIN_ATCR].x, subWindowPositions[SUBWIN_ATCR].y, subWindowPositions[SUBWIN_ATCR].x + WINSZ_FLTPLN_WIDTH_MDL, subWindowPositions[SUBWIN_ATCR].y + WINSZ_FLTPLN_HEIGHT_ATCR);
-	dc->FillRect(atcrWindow, &darkerBrush);
+	dc->FillRect(atcrWindow, darkerBrush);
 	dc->Draw3dRect(atcrWindow, BevelLight.ToCOLORREF(), BevelDark.ToCOLORREF());
 	InflateRect(atcrWindow, -1, -1);
 	dc->Draw3dRect(atcrWindow, BevelLight.ToCOLORREF(), BevelDark.ToCOLORREF());
 
 	// Create titlebar
 	CRect titleRect(atcrWindow.left, atcrWindow.top, atcrWindow.left + WINSZ_FLTPLN_WIDTH_MDL, atcrWindow.top + WINSZ_TITLEBAR_HEIGHT);
-	dc->FillRect(titleRect, &lighterBrush);
+	dc->FillRect(titleRect, lighterBrush);
 	dc->DrawEdge(titleRect, EDGE_RAISED, BF_BOTTOM);
 	dc->TextOutA(titleRect.left + (WINSZ_FLTPLN_WIDTH_MDL / 2), titleRect.top + (WINSZ_TITLEBAR_HEIGHT / 7), (string("ATC Restrictions Editor - " + primedPlan->Callsign).c_str())); // TODO: show callsign properly
 	screen->AddScreenObject(WIN_FLTPLN, "RESTRICTIONS", atcrWindow, false, ""); // So it can't be moved
@@ -1505,10 +1474,6 @@ void CFlightPlanWindow::RenderATCRestrictModal(CDC* dc, Graphics* g, CRadarScree
 	dc->Draw3dRect(atcrWindow, WindowBorder.ToCOLORREF(), WindowBorder.ToCOLORREF());
 	InflateRect(atcrWindow, 1, 1);
 	dc->DrawEdge(atcrWindow, EDGE_RAISED, BF_RECT);
-
-	// Clean up
-	DeleteObject(darkerBrush);
-	DeleteObject(lighterBrush);
 }
 
 void CFlightPlanWindow::RenderExchangeModal(CDC* dc, Graphics* g, CRadarScreen* screen, POINT topLeft)
@@ -1518,8 +1483,8 @@ void CFlightPlanWindow::RenderExchangeModal(CDC* dc, Graphics* g, CRadarScreen*
 		return;
 
 	// Create brushes
-	CBrush darkerBrush(ScreenBlue.ToCOLORREF());
-	CBrush lighterBrush(WindowBorder.ToCOLORREF());
+	CBrush* darkerBrush = StyleCache::GetGdiBrush(ScreenBlue.ToCOLORREF());
+	CBrush* lighterBrush = StyleCache::GetGdiBrush(WindowBorder.ToCOLORREF());
 
 	// Select title font
 	FontSelector::SelectNormalFont(16, dc);
@@ -1537,14 +1502,14 @@ void CFlightPlanWindow::RenderExchangeModal(CDC* dc, Graphics* g, CRadarScreen*
 
 	// Create coordination window
 	CRect coordWindow(subWindowPositions[SUBWIN_XCHANGE].x, subWindowPositions[SUBWIN_XCHANGE].y + 1, subWindowPositions[SUBWIN_XCHANGE].x + WINSZ_FLTPLN_WIDTH_MDL, subWindowPositions[SUBWIN_XCHANGE].y + WINSZ_FLTPLN_HEIGHT_COORD);
-	dc->FillRect(coordWindow, &darkerBrush);
+	dc->FillRect(coordWindow, darkerBrush);
 	dc->Draw3dRect(coordWindow, BevelLight.ToCOLORREF(), BevelDark.ToCOLORREF());
 	InflateRect(coordWindow, -1, -1);
 	dc->Draw3dRect(coordWindow, BevelLight.ToCOLORREF(), BevelDark.ToCOLORREF());
 
 	// Create titlebar
 	CRect titleRect(coordWindow.left, coordWindow.top, coordWindow.left + WINSZ_FLTPLN_WIDTH_MDL, coordWindow.top + WINSZ_TITLEBAR_HEIGHT);
-	dc->FillRect(titleRect, &lighterBrush);
+	dc->FillRect(titleRect, lighterBrush);
 	dc->DrawEdge(titleRect, EDGE_RAISED, BF_BOTTOM);
 	dc->TextOutA(titleRect.left + (WINSZ_FLTPLN_WIDTH_MDL / 2), titleRect.top + (WINSZ_TITLEBAR_HEIGHT / 7), string("Active Co-ordination - " + primedPlan->Callsign).c_str()); // TODO: show callsign properly
 	screen->AddScreenObject(WIN_FLTPLN, to_string(SUBWIN_XCHANGE).c_str(), titleRect, true, "");
@@ -1685,17 +1650,13 @@ void CFlightPlanWindow::RenderExchangeModal(CDC* dc, Graphics* g, CRadarScreen*
 	dc->Draw3dRect(coordWindow, WindowBorder.ToCOLORREF(), WindowBorder.ToCOLORREF());
 	InflateRect(coordWindow, 1, 1);
 	dc->DrawEdge(coordWindow, EDGE_RAISED, BF_RECT);
-
-	// Clean up
-	DeleteObject(darkerBrush);
-	DeleteObject(lighterBrush);
 }
 
 void CFlightPlanWindow::RenderATCRestrictSubModal(CDC* dc, Graphics* g, CRadarScreen* screen, POINT topLeft)
 {
 	// Create brushes
-	CBrush darkerBrush(ScreenBlue.ToCOLORREF());
-	CBrush lighterBrush(WindowBorder.ToCOLORREF());
+	CBrush* darkerBrush = StyleCache::GetGdiBrush(ScreenBlue.ToCOLORREF());
+	CBrush* lighterBrush = StyleCache::GetGdiBrush(WindowBorder.ToCOLORREF());
 
 	// Select title font
 	FontSelector::SelectNormalFont(16, dc);
@@ -1704,14 +1665,14 @@ void CFlightPlanWindow::RenderATCRestrictSubModal(CDC* dc, Graphics* g, CRadarSc
 
 	// Create restrictions sub window
 	CRect atcrWindow(topLeft.x, topLeft.y, topLeft.x + WINSZ_FLTPLN_WIDTH_MDL, topLeft.y + WINSZ_FLTPLN_HEIGHT_ATCR/2);
-	dc->FillRect(atcrWindow, &darkerBrush);
+	dc->FillRect(atcrWindow, darkerBrush);
 	dc->Draw3dRect(atcrWindow, BevelLight.ToCOLORREF(), BevelDark.ToCOLORREF());
 	InflateRect(atcrWindow, -1, -1);
 	dc->Draw3dRect(atcrWindow, BevelLight.ToCOLORREF(), BevelDark.ToCOLORREF());
 
 	// Create titlebar
 	CRect titleRect(atcrWindow.left, atcrWindow.top, atcrWindow.left + WINSZ_FLTPLN_WIDTH_MDL, atcrWindow.top + WINSZ_TITLEBAR_HEIGHT);
-	dc->FillRect(titleRect, &lighterBrush);
+	dc->FillRect(titleRect, lighterBrush);
 	dc->DrawEdge(titleRect, EDGE_RAISED, BF_BOTTOM);
 	dc->TextOutA(titleRect.left + (WINSZ_FLTPLN_WIDTH_MDL / 2), titleRect.top + (WINSZ_TITLEBAR_HEIGHT / 7), (string("ATC/ " + restrictionSelections[RestrictionSubModalType] + " - " + primedPlan->Callsign).c_str()));
 	screen->AddScreenObject(WIN_FLTPLN, to_string(SUBWIN_ATCR).c_str(), titleRect, true, "");
@@ -1823,10 +1784,6 @@ void CFlightPlanWindow::RenderATCRestrictSubModal(CDC* dc, Graphics* g, CRadarSc
 	dc->Draw3dRect(atcrWindow, WindowBorder.ToCOLORREF(), WindowBorder.ToCOLORREF());
 	InflateRect(atcrWindow, 1, 1);
 	dc->DrawEdge(atcrWindow, EDGE_RAISED, BF_RECT);
-
-	// Clean up
-	DeleteObject(darkerBrush);
-	DeleteObject(lighterBrush);
 }
 
 bool CFlightPlanWindow::IsButtonPressed(int id) {
@@ -1870,6 +1827,7 @@ void CFlightPlanWindow::Instantiate(CRadarScreen* screen,string callsign, CMessa
 	// Add message
 	if (msg != nullptr) {
 		primedPlan->CurrentMessage = msg;
+		CDataHandler::MarkFlightChanged(primedPlan->Callsign);
 		IsMessageOpen = true;
 		windowButtons[BTN_MSG].State = CInputState::INACTIVE;
 	}
@@ -2267,7 +2225,7 @@ void CFlightPlanWindow::SetTextValue(CRadarScreen* screen, int id, string conten
 				data->Screen = screen;
 				data->Callsign = primedPlan->Callsign;
 				data->FP = id == TXT_TCK_CPY ? &copiedPlan : nullptr;
-				_beginthread(CRoutesHelper::InitialiseRoute, 0, (void*)data); // Async
+				CRoutesHelper::QueueRoute(data); // Async
 
 				// Set the error to false
 				textInputs.find(id)->second.Error = false;
@@ -2316,7 +2274,7 @@ void CFlightPlanWindow::SetTextValue(CRadarScreen* screen, int id, string conten
 				data->Screen = screen;
 				data->Callsign = primedPlan->Callsign;
 				data->FP = id == TXT_CPY_RTE ? &copiedPlan : nullptr;
-				_beginthread(CRoutesHelper::InitialiseRoute, 0, (void*) data); // Async
+				CRoutesHelper::QueueRoute(data); // Async
 
 				// Set the error to false
 				textInputs.find(id)->second.Error = false;
@@ -2651,7 +2609,7 @@ void CFlightPlanWindow::ButtonUp(int id, CRadarScreen* screen) {
 						data->Screen = screen;
 						data->Callsign = primedPlan->Callsign;
 						data->FP = netFP;
-						_beginthread(CDataHandler::PostNetworkAircraft, 0, (void*)data); // Async
+						CDataHandler::PostNetworkAircraft((void*)data); // Queued on the outbound queue
 					}
 					catch (std::exception & ex) {
 						CLogger::DebugLog(screen, "An exception occurred. " + *ex.what());
@@ -2697,17 +2655,13 @@ void CFlightPlanWindow::ButtonUp(int id, CRadarScreen* screen) {
 							}
 						}
 
-						// Post data to the database
-						DWORD activeCode;
-						HANDLE hnd = CUtils::GetESProcess();
-						GetExitCodeProcess(hnd, &activeCode);
-						// Check if the app is still active
-						if (activeCode == STILL_ACTIVE) {
+						// Post data to the database (nothing goes out once the plugin is unloading)
+						if (!CLifecycle::IsShuttingDown()) {
 							CUtils::CNetworkAsyncData* data = new CUtils::CNetworkAsyncData();
 							data->Screen = screen;
 							data->Callsign = primedPlan->Callsign;
 							data->FP = netFP;
-							_beginthread(CDataHandler::UpdateNetworkAircraft, 0, (void*)data); // Async
+							CDataHandler::UpdateNetworkAircraft((void*)data); // Queued on the outbound queue
 						}
 					}
 					catch (std::exception & ex) {
@@ -2767,17 +2721,13 @@ void CFlightPlanWindow::ButtonUp(int id, CRadarScreen* screen) {
 								}
 							}
 
-							// Post data to the database
-							DWORD activeCode;
-							HANDLE hnd = CUtils::GetESProcess();
-							GetExitCodeProcess(hnd, &activeCode);
-							// Check if the app is still active
-							if (activeCode == STILL_ACTIVE) {
+							// Post data to the database (nothing goes out once the plugin is unloading)
+							if (!CLifecycle::IsShuttingDown()) {
 								CUtils::CNetworkAsyncData* data = new CUtils::CNetworkAsyncData();
 								data->Screen = screen;
 								data->Callsign = primedPlan->Callsign;
 								data->FP = netFP;
-								_beginthread(CDataHandler::UpdateNetworkAircraft, 0, (void*)data); // Async
+								CDataHandler::UpdateNetworkAircraft((void*)data); // Queued on the outbound queue
 							}
 						}
 						catch (std::exception & ex) {
@@ -2837,7 +2787,7 @@ void CFlightPlanWindow::ButtonUp(int id, CRadarScreen* screen) {
 						data->Screen = screen;
 						data->Callsign = primedPlan->Callsign;
 						data->FP = netFP;
-						_beginthread(CDataHandler::UpdateNetworkAircraft, 0, (void*)data); // Async
+						CDataHandler::UpdateNetworkAircraft((void*)data); // Queued on the outbound queue
 					}
 				}
 				catch (std::exception & ex) {
@@ -2893,7 +2843,7 @@ void CFlightPlanWindow::ButtonUp(int id, CRadarScreen* screen) {
 					data->Screen = screen;
 					data->Callsign = primedPlan->Callsign;
 					data->FP = netFP;
-					_beginthread(CDataHandler::UpdateNetworkAircraft, 0, (void*)data); // Async
+					CDataHandler::UpdateNetworkAircraft((void*)data); // Queued on the outbound queue
 				}
 			}
 			catch (std::exception & ex) {
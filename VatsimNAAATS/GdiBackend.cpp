@@ -0,0 +1,94 @@
+#include "pch.h"
+#include "GdiBackend.h"
+#include "Styles.h"
+#include "TextCache.h"
+
+CGdiBackend::CGdiBackend(CDC* dc, Graphics* g) {
+	this->dc = dc;
+	this->g = g;
+}
+
+CDrawSize CGdiBackend::MeasureText(const CDrawFont& font, const string& text) {
+	// Measure in the font and put the old one back, recording shouldn't change the context
+	HGDIOBJ previous = ::GetCurrentObject(dc->GetSafeHdc(), OBJ_FONT);
+	SelectFont(font);
+	CSize extent = CTextCache::GetTextExtent(dc, text);
+	::SelectObject(dc->GetSafeHdc(), previous);
+
+	CDrawSize size;
+	size.Width = extent.cx;
+	size.Height = extent.cy;
+	return size;
+}
+
+void CGdiBackend::Replay(const CDrawList& list) {
+	// Save context
+	int iDC = dc->SaveDC();
+
+	// Anti-aliasing
+	g->SetSmoothingMode(SmoothingModeAntiAlias);
+
+	// Only change the text state when it changes
+	int currentFont = -1;
+	int currentColour = -1;
+
+	const vector<CDrawPoint>& points = list.Points();
+	for (const CDrawCommand& command : list.Commands()) {
+		const CDrawStyle& style = list.Styles()[command.Style];
+		const CDrawPoint* first = points.data() + command.First;
+		switch (command.Op) {
+			case CDrawOp::LINE:
+				g->DrawLine(StyleCache::GetPen(Color(style.Colour), style.Width, (DashStyle)style.Dash, (LineCap)style.Cap), first[0].X, first[0].Y, first[1].X, first[1].Y);
+				break;
+			case CDrawOp::POLYLINE:
+			case CDrawOp::FILL_POLYGON:
+				linePoints.clear();
+				for (int i = 0; i < command.Count; i++) {
+					linePoints.push_back(Point(first[i].X, first[i].Y));
+				}
+				if (command.Op == CDrawOp::POLYLINE) {
+					g->DrawLines(StyleCache::GetPen(Color(style.Colour), style.Width, (DashStyle)style.Dash, (LineCap)style.Cap), linePoints.data(), (INT)linePoints.size());
+				}
+				else {
+					g->FillPolygon(StyleCache::GetBrush(Color(style.Colour)), linePoints.data(), (INT)linePoints.size());
+				}
+				break;
+			case CDrawOp::TEXT:
+				if (command.Font != currentFont) {
+					const CDrawFont& font = list.Fonts()[command.Font];
+					SelectFont(font);
+					dc->SetTextAlign(font.Align == CDrawAlign::CENTER ? TA_CENTER : TA_LEFT);
+					currentFont = command.Font;
+				}
+				if (command.Style != currentColour) {
+					dc->SetTextColor(Color(style.Colour).ToCOLORREF());
+					currentColour = command.Style;
+				}
+				dc->TextOutA(first[0].X, first[0].Y, list.TextBuffer().data() + command.Text, command.Length);
+				break;
+			case CDrawOp::FILL_RECT:
+				g->FillRectangle(StyleCache::GetBrush(Color(style.Colour)), first[0].X, first[0].Y, first[1].X - first[0].X, first[1].Y - first[0].Y);
+				break;
+			case CDrawOp::FILL_ELLIPSE:
+				g->FillEllipse(StyleCache::GetBrush(Color(style.Colour)), first[0].X, first[0].Y, first[1].X - first[0].X, first[1].Y - first[0].Y);
+				break;
+		}
+	}
+
+	// Restore context
+	dc->RestoreDC(iDC);
+}
+
+void CGdiBackend::SelectFont(const CDrawFont& font) {
+	switch (font.Family) {
+		case CDrawFontFamily::NORMAL:
+			FontSelector::SelectNormalFont(font.Size, dc);
+			break;
+		case CDrawFontFamily::MONO:
+			FontSelector::SelectMonoFont(font.Size, dc);
+			break;
+		case CDrawFontFamily::ATC:
+			FontSelector::SelectATCFont(font.Size, dc);
+			break;
+	}
+}
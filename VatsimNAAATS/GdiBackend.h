@@ -0,0 +1,26 @@
+#pragma once
+#include "pch.h"
+#include <gdiplus.h>
+#include "DrawList.h"
+
+using namespace std;
+using namespace Gdiplus;
+
+// Backend that replays draw lists onto the radar screen, pens and brushes come from the style cache and fonts from the font selector
+// Lives for one refresh, like the device context it draws on
+class CGdiBackend : public CDrawBackend
+{
+	public:
+		CGdiBackend(CDC* dc, Graphics* g);
+
+		CDrawSize MeasureText(const CDrawFont& font, const string& text) override;
+		void Replay(const CDrawList& list) override;
+
+	private:
+		// Select a font into the context
+		void SelectFont(const CDrawFont& font);
+
+		CDC* dc;
+		Graphics* g;
+		vector<Point> linePoints; // Reused for polylines and polygons
+};
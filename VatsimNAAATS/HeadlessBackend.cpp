@@ -0,0 +1,64 @@
+#include "pch.h"
+#include "HeadlessBackend.h"
+
+CDrawSize CHeadlessBackend::MeasureText(const CDrawFont& font, const string& text) {
+	// Characters are roughly 0.6 of the font height wide
+	CDrawSize size;
+	size.Width = (int)text.size() * font.Size * 3 / 5;
+	size.Height = font.Size;
+	return size;
+}
+
+void CHeadlessBackend::Replay(const CDrawList& list) {
+	stats.Lists++;
+	stats.Merged += list.Merged();
+	for (const CDrawCommand& command : list.Commands()) {
+		stats.Commands++;
+		if (!IsValid(list, command)) {
+			stats.Invalid++;
+			continue;
+		}
+		stats.Points += command.Count;
+
+		// Count it
+		switch (command.Op) {
+			case CDrawOp::LINE:
+			case CDrawOp::POLYLINE:
+				stats.Lines++;
+				stats.Segments += command.Count - 1;
+				break;
+			case CDrawOp::TEXT:
+				stats.Texts++;
+				break;
+			case CDrawOp::FILL_RECT:
+			case CDrawOp::FILL_ELLIPSE:
+			case CDrawOp::FILL_POLYGON:
+				stats.Fills++;
+				break;
+		}
+	}
+}
+
+bool CHeadlessBackend::IsValid(const CDrawList& list, const CDrawCommand& command) {
+	// Points and style are in the list
+	if (command.First < 0 || command.Count < 1 || command.First + command.Count > (int)list.Points().size()) return false;
+	if (command.Style < 0 || command.Style >= (int)list.Styles().size()) return false;
+	if (list.Styles()[command.Style].Width <= 0) return false;
+
+	// Enough points for what it is
+	switch (command.Op) {
+		case CDrawOp::LINE:
+			return command.Count == 2;
+		case CDrawOp::POLYLINE:
+			return command.Count >= 2;
+		case CDrawOp::TEXT:
+			return command.Count == 1 && command.Length > 0 && command.Font >= 0 && command.Font < (int)list.Fonts().size()
+				&& command.Text >= 0 && command.Text + command.Length <= (int)list.TextBuffer().size();
+		case CDrawOp::FILL_RECT:
+		case CDrawOp::FILL_ELLIPSE:
+			return command.Count == 2;
+		case CDrawOp::FILL_POLYGON:
+			return command.Count >= 3;
+	}
+	return false;
+}
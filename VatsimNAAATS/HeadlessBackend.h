@@ -0,0 +1,34 @@
+#pragma once
+#include "DrawList.h"
+
+// What a headless backend has seen
+struct CDrawStats {
+	int Lists = 0;
+	int Commands = 0;
+	int Lines = 0; // Lines and polylines
+	int Segments = 0; // Segments across the lines and polylines
+	int Texts = 0;
+	int Fills = 0;
+	int Points = 0;
+	int Merged = 0; // Segments the lists merged before they were submitted
+	int Invalid = 0; // Commands that point outside the list's buffers or don't have enough points
+};
+
+// Backend that draws nothing, it counts and checks the commands so frame building can be measured without EuroScope
+// Text is measured as a fixed pitch font
+class CHeadlessBackend : public CDrawBackend
+{
+	public:
+		CDrawSize MeasureText(const CDrawFont& font, const string& text) override;
+		void Replay(const CDrawList& list) override;
+
+		// Counts since the last reset
+		const CDrawStats& GetStats() const { return stats; }
+		void Reset() { stats = CDrawStats(); }
+
+	private:
+		// Whether a command is well formed
+		static bool IsValid(const CDrawList& list, const CDrawCommand& command);
+
+		CDrawStats stats;
+};
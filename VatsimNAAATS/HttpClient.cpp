@@ -0,0 +1,222 @@
+#include "pch.h"
+#include "HttpClient.h"
+#include "Logger.h"
+#include "Lifecycle.h"
+
+// Client that is already shut down, every request fails as it is sent
+class CStoppedHttpClient : public CHttpClient
+{
+	public:
+		future<CHttpResponse> Send(const CHttpRequest& request) {
+			promise<CHttpResponse> result;
+			result.set_value(Cancelled());
+			return result.get_future();
+		}
+
+		void Send(const CHttpRequest& request, function<void(const CHttpResponse&)> callback) {
+			if (callback) callback(Cancelled());
+		}
+
+		void Shutdown() {}
+
+		static CHttpResponse Cancelled() {
+			CHttpResponse response;
+			response.Error = "Client shut down";
+			return response;
+		}
+};
+
+CHttpClient* CHttpClient::instance = nullptr;
+mutex CHttpClient::instanceLock;
+bool CHttpClient::isReleased = false;
+
+CHttpClient* CHttpClient::Instance() {
+	lock_guard<mutex> lock(instanceLock);
+	if (instance == nullptr) {
+		// A late caller while the plugin unloads gets the stopped client, its requests fail straight away
+		if (isReleased || CLifecycle::IsShuttingDown()) {
+			return Stopped();
+		}
+		instance = MakeClient();
+	}
+	return instance;
+}
+
+CHttpClient* CHttpClient::Stopped() {
+	// Never replaced or deleted, so nothing is leaked however many late callers there are
+	static CStoppedHttpClient stopped;
+	return &stopped;
+}
+
+void CHttpClient::SetInstance(CHttpClient* client) {
+	CHttpClient* previous = nullptr;
+	{
+		lock_guard<mutex> lock(instanceLock);
+		previous = instance;
+		instance = client;
+	}
+
+	// Stop the old client outside the lock, its callbacks may use the instance
+	if (previous != nullptr && previous != client) {
+		previous->Shutdown();
+		delete previous;
+	}
+}
+
+void CHttpClient::Release() {
+	{
+		lock_guard<mutex> lock(instanceLock);
+		isReleased = true;
+	}
+	SetInstance(nullptr);
+}
+
+CHttpResponse CHttpClient::Get(const string& url, int timeoutMs) {
+	CHttpRequest request;
+	request.Url = url;
+	request.TimeoutMs = timeoutMs;
+	return Instance()->Send(request).get();
+}
+
+string CHttpClient::UrlEncode(const string& value) {
+	static const char* hex = "0123456789ABCDEF";
+	string encoded;
+	encoded.reserve(value.size());
+	for (unsigned char c : value) {
+		if (isalnum(c) || c == '-' || c == '_' || c == '.' || c == '~') {
+			encoded += c;
+		}
+		else {
+			encoded += '%';
+			encoded += hex[c >> 4];
+			encoded += hex[c & 15];
+		}
+	}
+	return encoded;
+}
+
+future<CHttpResponse> CPooledHttpClient::Send(const CHttpRequest& request) {
+	shared_ptr<promise<CHttpResponse>> result = make_shared<promise<CHttpResponse>>();
+	future<CHttpResponse> response = result->get_future();
+	Send(request, [result](const CHttpResponse& r) { result->set_value(r); });
+	return response;
+}
+
+void CPooledHttpClient::Send(const CHttpRequest& request, function<void(const CHttpResponse&)> callback) {
+	// Queue the job
+	bool isQueued = false;
+	{
+		lock_guard<mutex> lock(jobsLock);
+		if (!isStopping) {
+			jobs.push_back({ request, callback, chrono::steady_clock::now() });
+			isQueued = true;
+		}
+	}
+
+	// Client is shutting down, fail straight away
+	if (!isQueued) {
+		CHttpResponse response;
+		response.Error = "Client shut down";
+		if (callback) callback(response);
+		return;
+	}
+
+	jobsSignal.notify_one();
+}
+
+void CPooledHttpClient::Shutdown() {
+	// Stop taking work
+	deque<CHttpJob> abandoned;
+	{
+		lock_guard<mutex> lock(jobsLock);
+		if (isStopping) return;
+		isStopping = true;
+		abandoned.swap(jobs);
+	}
+	jobsSignal.notify_all();
+
+	// Closing the connections cancels requests in flight, and nothing opens a new one
+	{
+		lock_guard<mutex> lock(connectionsLock);
+		isCancelled = true;
+		for (auto& connection : connections) {
+			CloseConnection(connection.second);
+		}
+		connections.clear();
+	}
+
+	// Wait for the workers
+	for (int i = 0; i < workers.size(); i++) {
+		if (workers[i].joinable()) workers[i].join();
+	}
+	workers.clear();
+
+	// Nothing can be using the transport now
+	OnStopped();
+
+	// Fail anything that never ran
+	CHttpResponse cancelled;
+	cancelled.Error = "Client shut down";
+	for (auto& job : abandoned) {
+		if (job.Callback) job.Callback(cancelled);
+	}
+}
+
+void CPooledHttpClient::Start(int workers) {
+	for (int i = 0; i < workers; i++) {
+		this->workers.push_back(thread(&CPooledHttpClient::Worker, this));
+	}
+}
+
+void CPooledHttpClient::Worker() {
+	while (true) {
+		// Wait for a job
+		CHttpJob job;
+		{
+			unique_lock<mutex> lock(jobsLock);
+			jobsSignal.wait(lock, [this] { return isStopping || !jobs.empty(); });
+			if (isStopping) return;
+			job = move(jobs.front());
+			jobs.pop_front();
+		}
+
+		// The time spent queued counts against the timeout, a request that has run out is never sent
+		CHttpResponse response;
+		int waitedMs = (int)chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - job.Queued).count();
+		if (waitedMs >= job.Request.TimeoutMs) {
+			response.Error = "Timed out waiting for a worker";
+		}
+		else {
+			job.Request.TimeoutMs -= waitedMs;
+			response = Perform(job.Request);
+		}
+
+		// Hand it back
+		if (!job.Callback) continue;
+		try {
+			job.Callback(response);
+		}
+		catch (exception& e) {
+			CLogger::Log(CLogType::EXC, "Request callback failed: " + string(e.what()) + "\nRequest URL: \n" + job.Request.Url, "CPooledHttpClient::Worker");
+		}
+	}
+}
+
+void* CPooledHttpClient::GetConnection(const string& host, int port) {
+	lock_guard<mutex> lock(connectionsLock);
+
+	// Existing connection
+	string key = host + ":" + to_string(port);
+	auto it = connections.find(key);
+	if (it != connections.end()) {
+		return it->second;
+	}
+
+	// New connection
+	if (isCancelled) return nullptr;
+	void* connection = OpenConnection(host, port);
+	if (connection != nullptr) {
+		connections.insert(make_pair(key, connection));
+	}
+	return connection;
+}
@@ -0,0 +1,130 @@
+#pragma once
+#include <string>
+#include <map>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <future>
+#include <functional>
+#include <condition_variable>
+#include <chrono>
+#include "Constants.h"
+
+using namespace std;
+
+// An HTTP request
+struct CHttpRequest {
+	string Method = "GET";
+	string Url;
+	string Body;
+	string ContentType;
+	string IfNoneMatch; // ETag of the copy we hold
+	string IfModifiedSince; // Last-Modified of the copy we hold
+	int TimeoutMs = HTTP_TIMEOUT;
+};
+
+// An HTTP response, Status is 0 if the request never reached the server
+struct CHttpResponse {
+	int Status = 0;
+	string Body;
+	string Error;
+	string ETag;
+	string LastModified;
+	bool IsOk() const { return Status >= 200 && Status < 300; }
+	bool IsNotModified() const { return Status == 304; }
+};
+
+// HTTP transport, swapped out for a stub when testing
+class CHttpClient
+{
+	public:
+		virtual ~CHttpClient() {}
+
+		// Queue a request, the future is ready once the response is complete
+		virtual future<CHttpResponse> Send(const CHttpRequest& request) = 0;
+
+		// Queue a request, the callback runs on an I/O worker once the response is complete
+		virtual void Send(const CHttpRequest& request, function<void(const CHttpResponse&)> callback) = 0;
+
+		// Stop the workers, queued requests complete with an error
+		virtual void Shutdown() = 0;
+
+		// The client every network path uses (created on first use, a stopped client once released or unloading)
+		static CHttpClient* Instance();
+
+		// Replace the client, takes ownership (tests)
+		static void SetInstance(CHttpClient* client);
+
+		// Shut down and release the client, later callers get the stopped client (plugin exit)
+		static void Release();
+
+		// Blocking GET helper for code already on a worker thread
+		static CHttpResponse Get(const string& url, int timeoutMs = HTTP_TIMEOUT);
+
+		// Percent-encode a query string value (everything but unreserved characters)
+		static string UrlEncode(const string& value);
+
+	private:
+		// The platform transport (defined with it)
+		static CHttpClient* MakeClient();
+
+		// Client whose requests fail straight away, for late callers
+		static CHttpClient* Stopped();
+
+		static CHttpClient* instance;
+		static mutex instanceLock;
+		static bool isReleased;
+};
+
+// Fixed pool of I/O workers over a transport, connections are kept per host so requests reuse them (keep-alive)
+// Transports open their handles in their constructor and then call Start, and call Shutdown in their destructor
+class CPooledHttpClient : public CHttpClient
+{
+	public:
+		virtual ~CPooledHttpClient() {}
+
+		future<CHttpResponse> Send(const CHttpRequest& request);
+		void Send(const CHttpRequest& request, function<void(const CHttpResponse&)> callback);
+		void Shutdown();
+
+	protected:
+		// Start the workers
+		void Start(int workers);
+
+		// Perform a request on the calling worker (the timeout is what is left after waiting in the queue)
+		virtual CHttpResponse Perform(const CHttpRequest& request) = 0;
+
+		// Open a connection to a host, nullptr if it can't be made
+		virtual void* OpenConnection(const string& host, int port) = 0;
+
+		// Close a connection, cancelling any request in flight on it
+		virtual void CloseConnection(void* connection) = 0;
+
+		// Release anything else the transport holds, once the workers have stopped
+		virtual void OnStopped() {}
+
+		// Get the (shared) connection for a host, nullptr once shutting down
+		void* GetConnection(const string& host, int port);
+
+	private:
+		// A queued request
+		struct CHttpJob {
+			CHttpRequest Request;
+			function<void(const CHttpResponse&)> Callback;
+			chrono::steady_clock::time_point Queued;
+		};
+
+		// Worker loop
+		void Worker();
+
+		map<string, void*> connections; // Keyed by host:port
+		bool isCancelled = false; // No new connections, guarded by connectionsLock
+		mutex connectionsLock;
+
+		deque<CHttpJob> jobs;
+		mutex jobsLock;
+		condition_variable jobsSignal;
+		vector<thread> workers;
+		bool isStopping = false;
+};
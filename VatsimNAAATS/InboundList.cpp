@@ -21,7 +21,7 @@ void CInboundList::RenderList(Graphics* g, CDC* dc, CRadarScreen* screen)
 	int sDC = dc->SaveDC();
 
 	// Brush
-	SolidBrush brush(TextWhite);
+	SolidBrush* brush = StyleCache::GetBrush(TextWhite);
 
 	// Make rectangle
 	Rect rectangle(topleft.x, topleft.y, LIST_INBOUND_WIDTH, 500);
@@ -41,44 +41,38 @@ void CInboundList::RenderList(Graphics* g, CDC* dc, CRadarScreen* screen)
 		for (vector<CInboundAircraft>::iterator ac = AircraftList.begin(); ac != AircraftList.end(); ac++) {
 			// Direction arrow (Shanwick)
 			if (ac->Direction == false) {
-				SolidBrush brush(TextWhite);
 				Point points[3] = { Point(rectangle.X + 10, rectangle.Y + (offsetY + 4)),
 					Point(rectangle.X + 10, rectangle.Y + (offsetY + 4) + 10),
 					Point(rectangle.X, rectangle.Y + (offsetY + 4) + 5) };
-				g->FillPolygon(&brush, points, 3);
+				g->FillPolygon(brush, points, 3);
 			}
 			// Draw callsign
-			string line = string(ac->Callsign);
-			dc->TextOutA(rectangle.X + offsetX, rectangle.Y + offsetY, line.c_str());
+			dc->TextOutA(rectangle.X + offsetX, rectangle.Y + offsetY, ac->Callsign.c_str());
 			offsetX += 140;
 
-			// Draw entry point
-			line = CUtils::ConvertCoordinateFormat(ac->Point, 0);
-			dc->TextOutA(rectangle.X + offsetX, rectangle.Y + offsetY, line.c_str());
+			// Draw entry point (the list is rebuilt every five seconds, so only format it once per build)
+			if (ac->PointText.empty()) ac->PointText = CUtils::ConvertCoordinateFormat(ac->Point, 0);
+			dc->TextOutA(rectangle.X + offsetX, rectangle.Y + offsetY, ac->PointText.c_str());
 			offsetX += 70;
 
 			// Draw estimated time
-			line = ac->Estimate;
-			dc->TextOutA(rectangle.X + offsetX, rectangle.Y + offsetY, line.c_str());
+			dc->TextOutA(rectangle.X + offsetX, rectangle.Y + offsetY, ac->Estimate.c_str());
 			offsetX += 45;
 
 			// Draw altitude
-			line = to_string(ac->FinalAltitude / 100);
-			dc->TextOutA(rectangle.X + offsetX, rectangle.Y + offsetY, line.c_str());
+			dc->TextOutA(rectangle.X + offsetX, rectangle.Y + offsetY, ac->Level.c_str());
 			offsetX += 50;
 
 			// Draw destination
-			line = string(ac->Destination);
-			dc->TextOutA(rectangle.X + offsetX, rectangle.Y + offsetY, line.c_str());
+			dc->TextOutA(rectangle.X + offsetX, rectangle.Y + offsetY, ac->Destination.c_str());
 			offsetX += 45;
 
 			// Direction arrow (Gander)
 			if (ac->Direction == true) {
-				SolidBrush brush(TextWhite);
 				Point points[3] = { Point(rectangle.X + offsetX, rectangle.Y + (offsetY + 4)),
 					Point(rectangle.X + offsetX, rectangle.Y + (offsetY + 4) + 10),
 					Point(rectangle.X + offsetX + 10, rectangle.Y + (offsetY + 4) + 5) };
-				g->FillPolygon(&brush, points, 3);
+				g->FillPolygon(brush, points, 3);
 			}
 
 			// Offset the y index and reset the X offset
@@ -111,13 +105,13 @@ void CInboundList::RenderList(Graphics* g, CDC* dc, CRadarScreen* screen)
 			Point btn[3] = { Point(rectangle.X + 140, rectangle.Y),
 					Point(rectangle.X + 128, rectangle.Y + textExtentY - 2),
 					Point(rectangle.X + 152, rectangle.Y + textExtentY - 2) };
-			g->FillPolygon(&brush, btn, 3);
+			g->FillPolygon(brush, btn, 3);
 		}
 		else { // If hide
 			Point btn[3] = { Point(rectangle.X + 140, rectangle.Y + textExtentY - 2),
 					Point(rectangle.X + 128, rectangle.Y),
 					Point(rectangle.X + 152, rectangle.Y) };
-			g->FillPolygon(&brush, btn, 3);
+			g->FillPolygon(brush, btn, 3);
 		}
 
 		// Add the button
@@ -125,9 +119,6 @@ void CInboundList::RenderList(Graphics* g, CDC* dc, CRadarScreen* screen)
 		screen->AddScreenObject(LIST_INBOUND, "HIDESHOW", rect, false, "");
 	}	
 
-	// Cleanup
-	DeleteObject(&brush);
-
 	// Restore device context
 	dc->RestoreDC(sDC);
 }
@@ -0,0 +1,86 @@
+#include "pch.h"
+#include "Lifecycle.h"
+#include "Logger.h"
+
+CShutdownToken CLifecycle::token;
+vector<function<void()>> CLifecycle::callbacks;
+mutex CLifecycle::callbacksLock;
+
+CShutdownToken::CShutdownToken() : isSignalled(false) {
+	// Manual reset, stays set for every waiter
+	event = CreateEventA(NULL, TRUE, FALSE, NULL);
+}
+
+CShutdownToken::~CShutdownToken() {
+	if (event != NULL) CloseHandle(event);
+}
+
+void CShutdownToken::Signal() {
+	isSignalled = true;
+	if (event != NULL) SetEvent(event);
+}
+
+bool CShutdownToken::IsSignalled() const {
+	return isSignalled;
+}
+
+bool CShutdownToken::Wait(int timeoutMs, const CShutdownToken* linked) const {
+	// Events to wait on
+	HANDLE events[2];
+	DWORD count = 0;
+	if (event != NULL) events[count++] = event;
+	if (linked != nullptr && linked->event != NULL) events[count++] = linked->event;
+
+	// Couldn't create the events, fall back to a plain sleep
+	if (count == 0) {
+		Sleep((DWORD)timeoutMs);
+	}
+	else {
+		WaitForMultipleObjects(count, events, FALSE, (DWORD)timeoutMs);
+	}
+
+	return IsSignalled() || (linked != nullptr && linked->IsSignalled());
+}
+
+CShutdownToken& CLifecycle::Token() {
+	return token;
+}
+
+bool CLifecycle::IsShuttingDown() {
+	return token.IsSignalled();
+}
+
+void CLifecycle::OnShutdown(function<void()> callback) {
+	{
+		lock_guard<mutex> lock(callbacksLock);
+		if (!token.IsSignalled()) {
+			callbacks.push_back(callback);
+			return;
+		}
+	}
+
+	// Too late to register, stop it now
+	callback();
+}
+
+void CLifecycle::RequestShutdown() {
+	// Only once
+	vector<function<void()>> stopping;
+	{
+		lock_guard<mutex> lock(callbacksLock);
+		if (token.IsSignalled()) return;
+		token.Signal();
+		stopping.swap(callbacks);
+	}
+	CLogger::Log(CLogType::NORM, "Shutting down " + to_string(stopping.size()) + " background worker(s).", "CLifecycle::RequestShutdown");
+
+	// Stop outside the lock, a worker may be registering as it goes
+	for (auto it = stopping.rbegin(); it != stopping.rend(); it++) {
+		try {
+			(*it)();
+		}
+		catch (exception& e) {
+			CLogger::Log(CLogType::EXC, "Failed to stop a worker: " + string(e.what()), "CLifecycle::RequestShutdown");
+		}
+	}
+}
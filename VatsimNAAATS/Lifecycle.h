@@ -0,0 +1,52 @@
+#pragma once
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <functional>
+
+using namespace std;
+
+// One-way stop signal backed by a manual-reset event, so a worker can sleep on it instead of polling
+class CShutdownToken
+{
+	public:
+		CShutdownToken();
+		~CShutdownToken();
+		CShutdownToken(const CShutdownToken&) = delete;
+		CShutdownToken& operator=(const CShutdownToken&) = delete;
+
+		// Set the token, wakes everything waiting on it
+		void Signal();
+
+		// Whether the token has been set
+		bool IsSignalled() const;
+
+		// Sleep for up to the timeout, returns true as soon as this or the linked token is set
+		bool Wait(int timeoutMs, const CShutdownToken* linked = nullptr) const;
+
+	private:
+		HANDLE event;
+		atomic<bool> isSignalled;
+};
+
+// Plugin lifecycle, the plugin-wide shutdown token and the workers that need stopping when it is set
+class CLifecycle
+{
+	public:
+		// Plugin-wide token, set once when the plugin is unloaded
+		static CShutdownToken& Token();
+
+		// Whether the plugin is being unloaded
+		static bool IsShuttingDown();
+
+		// Register a stop routine for a background worker (runs straight away if already shutting down)
+		static void OnShutdown(function<void()> callback);
+
+		// Set the token and stop the registered workers, newest first (plugin destructor)
+		static void RequestShutdown();
+
+	private:
+		static CShutdownToken token;
+		static vector<function<void()>> callbacks;
+		static mutex callbacksLock;
+};
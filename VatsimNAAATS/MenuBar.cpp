@@ -72,7 +72,7 @@ void CMenuBar::RenderBar(CDC* dc, Graphics* g, CRadarScreen* screen, string asel
 	int sDC = dc->SaveDC();
 
 	// Brush to draw the bar
-	CBrush brush(ScreenBlue.ToCOLORREF());
+	CBrush* brush = StyleCache::GetGdiBrush(ScreenBlue.ToCOLORREF());
 
 	// Get screen width
 	RECT radarArea = screen->GetRadarArea();
@@ -80,7 +80,7 @@ void CMenuBar::RenderBar(CDC* dc, Graphics* g, CRadarScreen* screen, string asel
 
 	// Create the base rectangle and the 3d bevel
 	CRect baseMenuRectColour(radarArea.left, radarArea.top, radarArea.left + screenWidth, MENBAR_HEIGHT);
-	dc->FillRect(baseMenuRectColour, &brush);
+	dc->FillRect(baseMenuRectColour, brush);
 	CRect baseMenuRect(radarArea.left, radarArea.top, radarArea.left + screenWidth, MENBAR_HEIGHT);
 	dc->Draw3dRect(baseMenuRect, ScreenBlue.ToCOLORREF(), BevelLight.ToCOLORREF());
 
@@ -276,9 +276,6 @@ void CMenuBar::RenderBar(CDC* dc, Graphics* g, CRadarScreen* screen, string asel
 	dc->TextOutA(offsetX, 30, textInputs[TXT_SEARCH].Label.c_str());
 	CCommonRenders::RenderTextInput(dc, screen, { offsetX, dc->GetTextExtent("ABCD").cy + 35 }, textInputs[TXT_SEARCH].Width, 20, & textInputs[TXT_SEARCH]);
 
-	// Clean up
-	DeleteObject(&brush);
-
 	// Restore
 	dc->RestoreDC(sDC);
 }
@@ -312,7 +309,8 @@ map<int, CWinButton> CMenuBar::GetToggleButtons() {
 void CMenuBar::MakeDropDownItems(int id) {
 	if (id == DRP_TCKCTRL) {
 		map<string, bool> map;
-		for (auto kv : CRoutesHelper::CurrentTracks) {
+		shared_ptr<const CTrackSet> tracks = CRoutesHelper::GetTracks();
+		for (const auto& kv : tracks->Tracks) {
 			map.insert(make_pair(kv.first, true));
 		}
 		dropDowns[DRP_TCKCTRL].Items.clear();
@@ -53,9 +53,9 @@ void CMessageWindow::RenderWindow(CDC* dc, Graphics* g, CRadarScreen* screen) {
 	int iDC = dc->SaveDC();
 
 	// Create brushes
-	CBrush darkerBrush(ScreenBlue.ToCOLORREF());
-	CBrush lighterBrush(WindowBorder.ToCOLORREF());
-	CBrush evenDarkerBrush(ButtonPressed.ToCOLORREF());
+	CBrush* darkerBrush = StyleCache::GetGdiBrush(ScreenBlue.ToCOLORREF());
+	CBrush* lighterBrush = StyleCache::GetGdiBrush(WindowBorder.ToCOLORREF());
+	CBrush* evenDarkerBrush = StyleCache::GetGdiBrush(ButtonPressed.ToCOLORREF());
 
 	// Select title font
 	FontSelector::SelectNormalFont(16, dc);
@@ -64,17 +64,17 @@ void CMessageWindow::RenderWindow(CDC* dc, Graphics* g, CRadarScreen* screen) {
 
 	// Create base window rectangle
 	CRect windowRect(topLeft.x, topLeft.y, topLeft.x + WINSZ_MSG_WIDTH, topLeft.y + WINSZ_MSG_HEIGHT);
-	dc->FillRect(windowRect, &darkerBrush);
+	dc->FillRect(windowRect, darkerBrush);
 
 	// Create titlebar
 	CRect titleRect(windowRect.left, windowRect.top, windowRect.left + WINSZ_MSG_WIDTH, windowRect.top + WINSZ_TITLEBAR_HEIGHT);
-	dc->FillRect(titleRect, &lighterBrush);
+	dc->FillRect(titleRect, lighterBrush);
 	dc->DrawEdge(titleRect, EDGE_RAISED, BF_BOTTOM);
 	dc->TextOutA(titleRect.left + (WINSZ_MSG_WIDTH / 2), titleRect.top + (WINSZ_TITLEBAR_HEIGHT / 7), ("Messages (" + to_string(MessageCount) + ")").c_str());
 
 	// Create button bar
 	CRect buttonBarRect(windowRect.left, windowRect.bottom - 50, windowRect.left + WINSZ_MSG_WIDTH, windowRect.bottom);
-	dc->FillRect(buttonBarRect, &darkerBrush);
+	dc->FillRect(buttonBarRect, darkerBrush);
 	dc->Draw3dRect(buttonBarRect, BevelLight.ToCOLORREF(), ScreenBlue.ToCOLORREF());
 	InflateRect(buttonBarRect, -1, -1);
 	dc->Draw3dRect(buttonBarRect, BevelLight.ToCOLORREF(), ScreenBlue.ToCOLORREF());
@@ -161,7 +161,7 @@ void CMessageWindow::RenderWindow(CDC* dc, Graphics* g, CRadarScreen* screen) {
 				message.bottom = windowRect.top + WINSZ_TITLEBAR_HEIGHT + (!wrappedText.empty() ? dc->GetTextExtent("ABCD").cy * wrappedText.size() + 15 + deltaoffsetY : offsetY) + 5;
 
 				if (ActiveMessages[i].Id == SelectedMessage) {
-					dc->FillRect(message, &evenDarkerBrush);
+					dc->FillRect(message, evenDarkerBrush);
 				}
 
 				// Text 'from'
@@ -223,10 +223,6 @@ void CMessageWindow::RenderWindow(CDC* dc, Graphics* g, CRadarScreen* screen) {
 	InflateRect(windowRect, 1, 1);
 	dc->DrawEdge(windowRect, EDGE_RAISED, BF_RECT);
 
-	// Cleanup
-	DeleteObject(darkerBrush);
-	DeleteObject(lighterBrush);
-
 	// Restore device context
 	dc->RestoreDC(iDC);
 }
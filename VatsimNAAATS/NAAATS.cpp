@@ -6,6 +6,7 @@
 #include "Constants.h"
 #include "RadarDisplay.h"
 #include "Utils.h"
+#include "Lifecycle.h"
 
 CNAAATSPlugin::CNAAATSPlugin() : CPlugIn(COMPATIBILITY_CODE, PLUGIN_NAME.c_str(), PLUGIN_VERSION.c_str(), PLUGIN_AUTHOR.c_str(), PLUGIN_COPYRIGHT.c_str())
 {
@@ -14,7 +15,8 @@ CNAAATSPlugin::CNAAATSPlugin() : CPlugIn(COMPATIBILITY_CODE, PLUGIN_NAME.c_str()
 }
 
 CNAAATSPlugin::~CNAAATSPlugin() {
-
+	// Stop the background workers before anything they use goes away
+	CLifecycle::RequestShutdown();
 }
 
 CRadarScreen* CNAAATSPlugin::OnRadarScreenCreated(const char* sDisplayName, bool NeedRadarContent, bool GeoReferenced, bool CanBeSaved, bool CanBeCreated) 
@@ -0,0 +1,337 @@
+#include "pch.h"
+#include "NetworkParser.h"
+#include "TrackIngest.h"
+#include <json.hpp>
+
+// Include dependency
+using json = nlohmann::json;
+
+// A scalar value from the stream
+struct CSaxValue {
+	enum { NUL, BOOLEAN, NUMBER, TEXT } Type = NUL;
+	bool Boolean = false;
+	double Number = 0.0;
+	std::string* Text = nullptr;
+};
+
+// Base handler, tracks nesting and turns the SAX events into typed hooks
+// (json_sax declares a member called string, so std::string is spelled out in the handlers)
+class CSaxHandler : public nlohmann::json_sax<json>
+{
+	public:
+		std::string Error;
+
+		bool null() override { CSaxValue value; return OnValue(value); }
+		bool boolean(bool val) override { CSaxValue value; value.Type = CSaxValue::BOOLEAN; value.Boolean = val; return OnValue(value); }
+		bool number_integer(number_integer_t val) override { return Number((double)val); }
+		bool number_unsigned(number_unsigned_t val) override { return Number((double)val); }
+		bool number_float(number_float_t val, const string_t& raw) override { return Number((double)val); }
+		bool string(string_t& val) override { CSaxValue value; value.Type = CSaxValue::TEXT; value.Text = &val; return OnValue(value); }
+		bool binary(binary_t& val) override { return Fail("Unexpected binary value."); }
+		bool key(string_t& val) override { return OnKey(val); }
+		bool start_object(std::size_t elements) override { depth++; return OnStartObject(); }
+		bool end_object() override { bool isOk = OnEndObject(); depth--; return isOk; }
+		bool start_array(std::size_t elements) override { depth++; return OnStartArray(); }
+		bool end_array() override { bool isOk = OnEndArray(); depth--; return isOk; }
+		bool parse_error(std::size_t position, const std::string& token, const nlohmann::detail::exception& ex) override { return Fail(ex.what()); }
+
+	protected:
+		// Hooks (depth includes the container being opened or closed)
+		virtual bool OnValue(CSaxValue& value) = 0;
+		virtual bool OnKey(const std::string& key) = 0;
+		virtual bool OnStartObject() = 0;
+		virtual bool OnEndObject() = 0;
+		virtual bool OnStartArray() = 0;
+		virtual bool OnEndArray() { return true; }
+
+		bool Fail(const std::string& message) {
+			if (Error.empty()) Error = message;
+			return false;
+		}
+
+		// Typed reads, fail the parse on a type mismatch (as the DOM conversions threw)
+		bool ReadString(CSaxValue& value, std::string& out, const char* name) {
+			if (value.Type != CSaxValue::TEXT) return Fail("Field " + std::string(name) + " is not a string.");
+			out = move(*value.Text);
+			return true;
+		}
+
+		bool ReadNumber(CSaxValue& value, double& out, const char* name) {
+			if (value.Type != CSaxValue::NUMBER) return Fail("Field " + std::string(name) + " is not a number.");
+			out = value.Number;
+			return true;
+		}
+
+		bool ReadBool(CSaxValue& value, bool& out, const char* name) {
+			if (value.Type == CSaxValue::BOOLEAN) out = value.Boolean;
+			else if (value.Type == CSaxValue::NUMBER) out = value.Number != 0.0;
+			else return Fail("Field " + std::string(name) + " is not a boolean.");
+			return true;
+		}
+
+		// Index of a key in a field list, -1 if it isn't one we want
+		static int FindField(const std::string& key, const char* const* fields, int count) {
+			for (int i = 0; i < count; i++) {
+				if (key == fields[i]) return i;
+			}
+			return -1;
+		}
+
+		int depth = 0;
+
+	private:
+		bool Number(double val) {
+			CSaxValue value;
+			value.Type = CSaxValue::NUMBER;
+			value.Number = val;
+			return OnValue(value);
+		}
+};
+
+// Flight data fields
+static const char* const FlightFields[] = {
+	"callsign", "type", "assignedLevel", "assignedMach", "track", "route", "routeEtas", "departure", "arrival", "direction",
+	"etd", "selcal", "datalinkConnected", "isEquipped", "state", "relevant", "trackedBy", "trackedById", "targetMode", "lastUpdated"
+};
+static const int FLIGHT_FIELD_COUNT = 20;
+
+// Flight data: [ { "callsign": ..., ... }, ... ]
+class CFlightPlanSax : public CSaxHandler
+{
+	public:
+		CFlightPlanSax(function<void(CNetworkFlightPlan&)>& onFlight) : onFlight(onFlight) {}
+
+	protected:
+		bool OnStartObject() override {
+			if (depth == 1) return Fail("Flight data is not an array.");
+			if (depth == 2) {
+				// New record
+				record = CNetworkFlightPlan();
+				seen = 0;
+				field = -1;
+			}
+			return true;
+		}
+
+		bool OnEndObject() override {
+			if (depth != 2) return true;
+
+			// Every field has to be there
+			for (int i = 0; i < FLIGHT_FIELD_COUNT; i++) {
+				if ((seen & (1u << i)) == 0) return Fail("Flight record is missing " + std::string(FlightFields[i]) + ".");
+			}
+
+			onFlight(record);
+			return true;
+		}
+
+		bool OnStartArray() override {
+			if (depth == 2) return Fail("Flight record is not an object.");
+			return true;
+		}
+
+		bool OnKey(const std::string& key) override {
+			if (depth == 2) field = FindField(key, FlightFields, FLIGHT_FIELD_COUNT);
+			return true;
+		}
+
+		bool OnValue(CSaxValue& value) override {
+			if (depth == 0) return Fail("Flight data is not an array.");
+			if (depth == 1) return Fail("Flight record is not an object.");
+			if (depth != 2 || field < 0) return true;
+
+			// Assign
+			seen |= 1u << field;
+			const char* name = FlightFields[field];
+			double number = 0.0;
+			switch (field) {
+				case 0: return ReadString(value, record.Callsign, name);
+				case 1: return ReadString(value, record.Type, name);
+				case 2: if (!ReadNumber(value, number, name)) return false; record.AssignedLevel = (int)number; return true;
+				case 3: if (!ReadNumber(value, number, name)) return false; record.AssignedMach = (int)number; return true;
+				case 4: return ReadString(value, record.Track, name);
+				case 5: return ReadString(value, record.Route, name);
+				case 6: return ReadString(value, record.RouteEtas, name);
+				case 7: return ReadString(value, record.Departure, name);
+				case 8: return ReadString(value, record.Arrival, name);
+				case 9: return ReadBool(value, record.Direction, name);
+				case 10: return ReadString(value, record.Etd, name);
+				case 11: return ReadString(value, record.Selcal, name);
+				case 12: return ReadBool(value, record.DatalinkConnected, name);
+				case 13: return ReadBool(value, record.IsEquipped, name);
+				case 14: return ReadString(value, record.State, name);
+				case 15: return ReadBool(value, record.Relevant, name);
+				case 16: return ReadString(value, record.TrackedBy, name);
+				case 17: return ReadString(value, record.TrackedById, name);
+				case 18: if (!ReadNumber(value, number, name)) return false; record.TargetMode = (CRadarTargetMode)(int)number; return true;
+				case 19: return ReadString(value, record.LastUpdated, name);
+				default: return true;
+			}
+		}
+
+	private:
+		function<void(CNetworkFlightPlan&)>& onFlight;
+		CNetworkFlightPlan record;
+		unsigned int seen = 0;
+		int field = -1;
+};
+
+// Track fields
+static const char* const TrackFields[] = { "id", "tmi", "direction", "route", "flightLevels", "validFrom", "validTo" };
+static const int TRACK_FIELD_COUNT = 7;
+static const int TRACK_ROUTE = 3;
+static const int TRACK_LEVELS = 4;
+static const char* const PointFields[] = { "name", "latitude", "longitude" };
+static const int POINT_FIELD_COUNT = 3;
+
+// Tracks: [ { "id": ..., "route": [ { "name": ..., "latitude": ..., "longitude": ... } ], "flightLevels": [ ... ], ... } ]
+class CTrackSax : public CSaxHandler
+{
+	public:
+		CTrackSax(function<void(CTrack&, bool)>& onTrack) : onTrack(onTrack) {}
+
+	protected:
+		bool OnStartObject() override {
+			if (depth == 1) return Fail("Track data is not an array.");
+			if (depth == 2) {
+				// New track
+				track = CTrack();
+				track.Direction = CTrackDirection::UNKNOWN;
+				seen = 0;
+				field = -1;
+				pointsValid = true;
+			}
+			else if (depth == 4 && field == TRACK_ROUTE) {
+				// New route point
+				pointSeen = 0;
+				pointField = -1;
+			}
+			return true;
+		}
+
+		bool OnEndObject() override {
+			if (depth == 4 && field == TRACK_ROUTE) {
+				for (int i = 0; i < POINT_FIELD_COUNT; i++) {
+					if ((pointSeen & (1u << i)) == 0) return Fail("Track route point is missing " + std::string(PointFields[i]) + ".");
+				}
+
+				// The track is rejected anyway once a point is bad
+				if (!pointsValid) return true;
+				CPosition position;
+				if (!CTrackIngest::MakeTrackPoint(pointName, pointLat, pointLon, position)) {
+					pointsValid = false;
+					return true;
+				}
+				track.Route.push_back(pointName);
+				track.RouteRaw.push_back(position);
+			}
+			else if (depth == 2) {
+				for (int i = 0; i < TRACK_FIELD_COUNT; i++) {
+					if ((seen & (1u << i)) == 0) return Fail("Track is missing " + std::string(TrackFields[i]) + ".");
+				}
+				onTrack(track, pointsValid);
+			}
+			return true;
+		}
+
+		bool OnStartArray() override {
+			if (depth == 2) return Fail("Track is not an object.");
+			if (depth == 3 && (field == TRACK_ROUTE || field == TRACK_LEVELS)) {
+				seen |= 1u << field;
+			}
+			return true;
+		}
+
+		bool OnKey(const std::string& key) override {
+			if (depth == 2) {
+				field = FindField(key, TrackFields, TRACK_FIELD_COUNT);
+			}
+			else if (depth == 4 && field == TRACK_ROUTE) {
+				pointField = FindField(key, PointFields, POINT_FIELD_COUNT);
+			}
+			return true;
+		}
+
+		bool OnValue(CSaxValue& value) override {
+			if (depth == 0) return Fail("Track data is not an array.");
+			if (depth == 1) return Fail("Track is not an object.");
+
+			// Track fields
+			if (depth == 2 && field >= 0) {
+				const char* name = TrackFields[field];
+				double number = 0.0;
+				switch (field) {
+					case 0: seen |= 1u << field; return ReadString(value, track.Identifier, name);
+					case 1: seen |= 1u << field; return ReadString(value, track.TMI, name);
+					case 2:
+						seen |= 1u << field;
+						if (!ReadNumber(value, number, name)) return false;
+						if (number == 0) track.Direction = CTrackDirection::UNKNOWN;
+						else if (number == 1) track.Direction = CTrackDirection::WEST;
+						else track.Direction = CTrackDirection::EAST;
+						return true;
+					case 5: seen |= 1u << field; return ReadString(value, track.validFrom, name);
+					case 6: seen |= 1u << field; return ReadString(value, track.validTo, name);
+					default: return Fail("Field " + std::string(name) + " is not an array.");
+				}
+			}
+
+			// Flight levels
+			if (depth == 3 && field == TRACK_LEVELS) {
+				double level = 0.0;
+				if (!ReadNumber(value, level, "flightLevels")) return false;
+				track.FlightLevels.push_back((int)level);
+				return true;
+			}
+
+			// Route point fields
+			if (depth == 4 && field == TRACK_ROUTE && pointField >= 0) {
+				pointSeen |= 1u << pointField;
+				const char* name = PointFields[pointField];
+				switch (pointField) {
+					case 0: return ReadString(value, pointName, name);
+					case 1: return ReadNumber(value, pointLat, name);
+					default: return ReadNumber(value, pointLon, name);
+				}
+			}
+
+			return true;
+		}
+
+	private:
+		function<void(CTrack&, bool)>& onTrack;
+		CTrack track;
+		unsigned int seen = 0;
+		int field = -1;
+		bool pointsValid = true;
+		std::string pointName;
+		double pointLat = 0.0;
+		double pointLon = 0.0;
+		unsigned int pointSeen = 0;
+		int pointField = -1;
+};
+
+// Run a handler over a response
+static int RunSax(const string& response, CSaxHandler& handler, string& error) {
+	try {
+		if (!json::sax_parse(response, &handler)) {
+			error = handler.Error != "" ? handler.Error : "Invalid JSON.";
+			return 1;
+		}
+	}
+	catch (exception& e) {
+		error = e.what();
+		return 1;
+	}
+	return 0;
+}
+
+int CNetworkParser::ParseFlightPlans(const string& response, function<void(CNetworkFlightPlan&)> onFlight, string& error) {
+	CFlightPlanSax handler(onFlight);
+	return RunSax(response, handler, error);
+}
+
+int CNetworkParser::ParseTracks(const string& response, function<void(CTrack&, bool)> onTrack, string& error) {
+	CTrackSax handler(onTrack);
+	return RunSax(response, handler, error);
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include <string>
+#include <functional>
+#include "EuroScopePlugIn.h"
+#include "Structures.h"
+
+using namespace std;
+using namespace EuroScopePlugIn;
+
+// Streaming (SAX) parsers for the vNAAATS API payloads, records are built straight from the response text without a json DOM
+class CNetworkParser
+{
+	public:
+		// Parse a flight data array, each complete record is handed to the callback as soon as it closes
+		static int ParseFlightPlans(const string& response, function<void(CNetworkFlightPlan&)> onFlight, string& error);
+
+		// Parse a NAT track array, the flag is false if a route point could not be made into a position
+		static int ParseTracks(const string& response, function<void(CTrack&, bool)> onTrack, string& error);
+};
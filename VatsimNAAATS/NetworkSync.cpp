@@ -0,0 +1,129 @@
+#include "pch.h"
+#include "NetworkSync.h"
+#include "NetworkParser.h"
+#include "RouteParser.h"
+#include "HttpClient.h"
+#include <set>
+
+int CNetworkSync::Sync(const string& baseUrl, const CFlightIndex& local, CSyncWatermark& watermark, CNetworkSyncResult& result) {
+	result = CNetworkSyncResult();
+	result.IsDelta = IsDeltaDue(watermark, local);
+	result.Url = MakeUrl(baseUrl, watermark, result.IsDelta);
+
+	// Download in one request
+	CHttpResponse response = CHttpClient::Get(result.Url);
+	if (!response.IsOk()) {
+		result.Error = response.Status != 0 ? to_string(response.Status) : response.Error;
+		return 1;
+	}
+	result.Bytes = response.Body.size();
+
+	// Parse once and collect the changed flights
+	set<string> received;
+	string newest = result.IsDelta ? watermark.Value : "";
+	int status = CNetworkParser::ParseFlightPlans(response.Body, [&](CNetworkFlightPlan& netFP) {
+		result.Records++;
+		received.insert(netFP.Callsign);
+		result.Received.push_back(netFP);
+
+		// Newest record (ISO 8601 timestamps compare as strings)
+		if (netFP.LastUpdated > newest) newest = netFP.LastUpdated;
+
+		// Skip flights we don't hold
+		auto fp = local.Flights.find(netFP.Callsign);
+		if (fp == local.Flights.end()) {
+			return;
+		}
+
+		// Skip if nothing differs
+		vector<string> route;
+		SplitRoute(netFP.Route, route);
+		if (fp->second->IsFirstUpdate && !IsPlanChanged(*fp->second, netFP, route)) {
+			return;
+		}
+
+		result.Changed.push_back(make_pair(netFP, move(route)));
+	}, result.Error);
+	if (status != 0) {
+		return 2;
+	}
+
+	// Flights the network doesn't know about have still been fetched once (full sync only)
+	if (!result.IsDelta) {
+		for (const auto& kv : local.Flights) {
+			if (!kv.second->IsFirstUpdate && received.find(kv.first) == received.end()) {
+				result.Unsynced.push_back(kv.first);
+			}
+		}
+	}
+
+	// Advance the watermark
+	if (!result.IsDelta || newest != watermark.Value) {
+		watermark.Value = newest;
+		watermark.Time = clock();
+	}
+
+	return 0;
+}
+
+bool CNetworkSync::IsDeltaDue(const CSyncWatermark& watermark, const CFlightIndex& local) {
+	if (watermark.Value == "" || (double)(clock() - watermark.Time) / ((double)CLOCKS_PER_SEC) >= NETWORK_RESYNC_TIME) {
+		return false;
+	}
+
+	for (const auto& kv : local.Flights) {
+		if (!kv.second->IsFirstUpdate) return false;
+	}
+	return true;
+}
+
+string CNetworkSync::MakeUrl(const string& baseUrl, const CSyncWatermark& watermark, bool isDelta) {
+	return isDelta ? baseUrl + "?since=" + CHttpClient::UrlEncode(watermark.Value) : baseUrl;
+}
+
+bool CNetworkSync::IsPlanChanged(const CAircraftFlightPlan& fp, const CNetworkFlightPlan& netFP, const vector<string>& route) {
+	return !fp.IsCleared
+		|| fp.FlightLevel != to_string(netFP.AssignedLevel)
+		|| fp.Mach != to_string(netFP.AssignedMach)
+		|| fp.Track != netFP.Track
+		|| fp.Depart != netFP.Departure
+		|| fp.Dest != netFP.Arrival
+		|| fp.Etd != netFP.Etd
+		|| fp.State != netFP.State
+		|| fp.IsEquipped != netFP.IsEquipped
+		|| fp.IsRelevant != netFP.Relevant
+		|| fp.DLStatus != to_string(netFP.DatalinkConnected)
+		|| fp.RouteRaw != route;
+}
+
+bool CNetworkSync::ApplyRecord(CAircraftFlightPlan& fp, const CNetworkFlightPlan& netFP, const vector<string>& route) {
+	// Check if it is cleared
+	if (!fp.IsCleared) fp.IsCleared = true;
+	fp.IsFirstUpdate = true;
+	fp.FlightLevel = to_string(netFP.AssignedLevel);
+	fp.Mach = to_string(netFP.AssignedMach);
+	fp.Track = netFP.Track;
+	fp.Depart = netFP.Departure;
+	fp.Dest = netFP.Arrival;
+	fp.Etd = netFP.Etd;
+	fp.State = netFP.State;
+	fp.IsEquipped = netFP.IsEquipped;
+	fp.IsRelevant = netFP.Relevant;
+	fp.DLStatus = to_string(netFP.DatalinkConnected);
+
+	// Route
+	if (route == fp.RouteRaw) {
+		return false;
+	}
+	fp.RouteRaw = route;
+	return true;
+}
+
+void CNetworkSync::SplitRoute(const string& route, vector<string>& points) {
+	points.clear();
+	size_t cursor = 0;
+	string_view point;
+	while (CRouteParser::NextToken(route, cursor, point)) {
+		points.emplace_back(point);
+	}
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <ctime>
+#include "Structures.h"
+
+using namespace std;
+
+// Delta sync watermark, the newest LastUpdated seen and when it last moved (or the last full sync)
+struct CSyncWatermark {
+	string Value;
+	clock_t Time = 0;
+};
+
+// What one bulk sync found
+struct CNetworkSyncResult {
+	bool IsDelta = false;
+	string Url;
+	size_t Bytes = 0;
+	int Records = 0;
+	vector<CNetworkFlightPlan> Received; // Every record, for the network cache
+	vector<pair<CNetworkFlightPlan, vector<string>>> Changed; // Records that differ from a flight we hold, with the split route
+	vector<string> Unsynced; // Flights we hold that the network doesn't know, still fetched once (full sync only)
+	string Error;
+};
+
+// vNAAATS network flight data bulk sync, downloads every record (or only those newer than the watermark) and diffs them against the flights we hold
+// Nothing here touches EuroScope, CDataHandler turns the result into flight updates for the UI thread
+class CNetworkSync
+{
+	public:
+		// Download and diff in one request, the watermark only moves once the response has parsed (0 ok, 1 download failed, 2 parse failed)
+		static int Sync(const string& baseUrl, const CFlightIndex& local, CSyncWatermark& watermark, CNetworkSyncResult& result);
+
+		// Whether the watermark is fresh and every flight we hold has been fully synced, so only changes need asking for
+		static bool IsDeltaDue(const CSyncWatermark& watermark, const CFlightIndex& local);
+
+		// Request URL, with the percent-encoded watermark for a delta sync
+		static string MakeUrl(const string& baseUrl, const CSyncWatermark& watermark, bool isDelta);
+
+		// Check if a network record differs from the local plan
+		static bool IsPlanChanged(const CAircraftFlightPlan& fp, const CNetworkFlightPlan& netFP, const vector<string>& route);
+
+		// Copy a network record into the local plan, true if the route changed
+		static bool ApplyRecord(CAircraftFlightPlan& fp, const CNetworkFlightPlan& netFP, const vector<string>& route);
+
+		// Split a network route into its points
+		static void SplitRoute(const string& route, vector<string>& points);
+};
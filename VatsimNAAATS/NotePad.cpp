@@ -28,9 +28,9 @@ void CNotePad::RenderWindow(CDC* dc, Graphics* g, CRadarScreen* screen) {
 	int iDC = dc->SaveDC();
 
 	// Create brushes
-	CBrush darkerBrush(ScreenBlue.ToCOLORREF());
-	CBrush lighterBrush(WindowBorder.ToCOLORREF());
-	CBrush evenDarkerBrush(ButtonPressed.ToCOLORREF());
+	CBrush* darkerBrush = StyleCache::GetGdiBrush(ScreenBlue.ToCOLORREF());
+	CBrush* lighterBrush = StyleCache::GetGdiBrush(WindowBorder.ToCOLORREF());
+	CBrush* evenDarkerBrush = StyleCache::GetGdiBrush(ButtonPressed.ToCOLORREF());
 
 	// Select title font
 	FontSelector::SelectNormalFont(16, dc);
@@ -39,11 +39,11 @@ void CNotePad::RenderWindow(CDC* dc, Graphics* g, CRadarScreen* screen) {
 
 	// Create base window rectangle
 	CRect windowRect(topLeft.x, topLeft.y, topLeft.x + WINSZ_NP_WIDTH, topLeft.y + WINSZ_NP_HEIGHT);
-	dc->FillRect(windowRect, &darkerBrush);
+	dc->FillRect(windowRect, darkerBrush);
 
 	// Create titlebar
 	CRect titleRect(windowRect.left, windowRect.top, windowRect.left + WINSZ_NP_WIDTH, windowRect.top + WINSZ_TITLEBAR_HEIGHT);
-	dc->FillRect(titleRect, &lighterBrush);
+	dc->FillRect(titleRect, lighterBrush);
 	dc->DrawEdge(titleRect, EDGE_RAISED, BF_BOTTOM);
 	dc->TextOutA(titleRect.left + (WINSZ_NP_WIDTH / 2), titleRect.top + (WINSZ_TITLEBAR_HEIGHT / 7), "Note Pad");
 
@@ -70,10 +70,6 @@ void CNotePad::RenderWindow(CDC* dc, Graphics* g, CRadarScreen* screen) {
 	InflateRect(windowRect, 1, 1);
 	dc->DrawEdge(windowRect, EDGE_RAISED, BF_RECT);
 
-	// Cleanup
-	DeleteObject(darkerBrush);
-	DeleteObject(lighterBrush);
-
 	// Restore device context
 	dc->RestoreDC(iDC);
 }
@@ -15,7 +15,7 @@ void COtherList::RenderList(Graphics* g, CDC* dc, CRadarScreen* screen) {
 	int sDC = dc->SaveDC();
 
 	// Brush
-	SolidBrush brush(TextWhite);
+	SolidBrush* brush = StyleCache::GetBrush(TextWhite);
 
 	// Make rectangle
 	Rect rectangle(topleft.x, topleft.y, LIST_OTHERS_WIDTH, 500);
@@ -42,13 +42,13 @@ void COtherList::RenderList(Graphics* g, CDC* dc, CRadarScreen* screen) {
 			Point btn[3] = { Point(rectangle.X + 140, rectangle.Y),
 					Point(rectangle.X + 128, rectangle.Y + textExtentY - 2),
 					Point(rectangle.X + 152, rectangle.Y + textExtentY - 2) };
-			g->FillPolygon(&brush, btn, 3);
+			g->FillPolygon(brush, btn, 3);
 		}
 		else { // If hide
 			Point btn[3] = { Point(rectangle.X + 140, rectangle.Y + textExtentY - 2),
 					Point(rectangle.X + 128, rectangle.Y),
 					Point(rectangle.X + 152, rectangle.Y) };
-			g->FillPolygon(&brush, btn, 3);
+			g->FillPolygon(brush, btn, 3);
 		}
 
 		// Add the button
@@ -86,7 +86,4 @@ void COtherList::RenderList(Graphics* g, CDC* dc, CRadarScreen* screen) {
 			idx++;
 		}
 	}
-
-	// Cleanup
-	DeleteObject(&brush);
 }
\ No newline at end of file
@@ -0,0 +1,137 @@
+#include "pch.h"
+#include "OutboundQueue.h"
+#include "DataHandler.h"
+#include "Logger.h"
+#include <vector>
+
+map<string, COutboundQueue::COutboundUpdate> COutboundQueue::pending;
+set<string> COutboundQueue::inFlight;
+COutboundStats COutboundQueue::stats;
+clock_t COutboundQueue::lastFlush = 0;
+mutex COutboundQueue::queueLock;
+
+// Milliseconds since a clock value
+static double ElapsedMs(clock_t since) {
+	return (double)(clock() - since) / ((double)CLOCKS_PER_SEC / 1000.0);
+}
+
+void COutboundQueue::Enqueue(const CNetworkFlightPlan& fp, bool isPost) {
+	lock_guard<mutex> lock(queueLock);
+
+	// Last write wins, a post stays a post until it has gone out
+	auto existing = pending.find(fp.Callsign);
+	if (existing != pending.end()) {
+		existing->second.FP = fp;
+		existing->second.IsPost = existing->second.IsPost || isPost;
+		stats.Coalesced++;
+		return;
+	}
+
+	COutboundUpdate update;
+	update.FP = fp;
+	update.IsPost = isPost;
+	update.Queued = clock();
+	update.NextAttempt = update.Queued;
+	pending.insert(make_pair(fp.Callsign, update));
+	stats.Depth = (int)pending.size();
+}
+
+void COutboundQueue::Flush() {
+	// Take everything that is due
+	vector<COutboundUpdate> batch;
+	{
+		lock_guard<mutex> lock(queueLock);
+		if (pending.empty() || ElapsedMs(lastFlush) < OUTBOUND_INTERVAL) {
+			return;
+		}
+		lastFlush = clock();
+
+		for (auto it = pending.begin(); it != pending.end();) {
+			// Wait for the last request for this aircraft, or for the backoff to run out
+			if (inFlight.find(it->first) != inFlight.end() || it->second.NextAttempt > lastFlush) {
+				it++;
+				continue;
+			}
+			inFlight.insert(it->first);
+			batch.push_back(it->second);
+			it = pending.erase(it);
+		}
+		stats.Depth = (int)pending.size();
+		stats.InFlight = (int)inFlight.size();
+	}
+
+	// Send
+	for (const COutboundUpdate& update : batch) {
+		CHttpRequest request;
+		request.Url = CDataHandler::MakeFlightDataUrl(update.FP, update.IsPost);
+		CHttpClient::Instance()->Send(request, [update](const CHttpResponse& response) {
+			OnResponse(update, response);
+		});
+	}
+}
+
+bool COutboundQueue::IsDue() {
+	lock_guard<mutex> lock(queueLock);
+	if (pending.empty() || ElapsedMs(lastFlush) < OUTBOUND_INTERVAL) {
+		return false;
+	}
+
+	// Anything not waiting on a request or a backoff
+	clock_t now = clock();
+	for (const auto& kv : pending) {
+		if (inFlight.find(kv.first) == inFlight.end() && kv.second.NextAttempt <= now) {
+			return true;
+		}
+	}
+	return false;
+}
+
+COutboundStats COutboundQueue::GetStats() {
+	lock_guard<mutex> lock(queueLock);
+	return stats;
+}
+
+void COutboundQueue::OnResponse(const COutboundUpdate& update, const CHttpResponse& response) {
+	const string& callsign = update.FP.Callsign;
+	bool isDropped = false;
+	{
+		lock_guard<mutex> lock(queueLock);
+		inFlight.erase(callsign);
+
+		if (response.IsOk()) {
+			// Acknowledged
+			stats.Sent++;
+			stats.LastLatency = ElapsedMs(update.Queued);
+			stats.MaxLatency = max(stats.MaxLatency, stats.LastLatency);
+		}
+		else {
+			auto newer = pending.find(callsign);
+			if (newer != pending.end()) {
+				// A newer update replaces this one, it still has to create the aircraft if this was a post
+				newer->second.IsPost = newer->second.IsPost || update.IsPost;
+			}
+			else if (update.Attempts + 1 >= OUTBOUND_MAX_ATTEMPTS) {
+				stats.Dropped++;
+				isDropped = true;
+			}
+			else {
+				// Back off and try again
+				COutboundUpdate retry = update;
+				retry.Attempts++;
+				int backoff = min(OUTBOUND_BACKOFF_MAX, OUTBOUND_BACKOFF << min(retry.Attempts - 1, 16));
+				retry.NextAttempt = clock() + (clock_t)((double)backoff * CLOCKS_PER_SEC / 1000.0);
+				pending.insert(make_pair(callsign, retry));
+				stats.Retries++;
+			}
+		}
+		stats.Depth = (int)pending.size();
+		stats.InFlight = (int)inFlight.size();
+	}
+
+	// Out of attempts, we want to know about it (shown by the UI thread)
+	if (isDropped) {
+		string verb = update.IsPost ? "post" : "update";
+		CDataHandler::QueueUserMessage("Failed to " + verb + " aircraft data for " + callsign + ". The server returned an error.", true);
+		CLogger::Log(CLogType::ERR, "Could not " + verb + " aircraft " + callsign + " to the network after " + to_string(OUTBOUND_MAX_ATTEMPTS) + " attempts. Code: " + CDataHandler::ResponseCode(response), "COutboundQueue::OnResponse");
+	}
+}
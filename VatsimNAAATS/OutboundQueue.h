@@ -0,0 +1,61 @@
+#pragma once
+#include <string>
+#include <map>
+#include <set>
+#include <mutex>
+#include <ctime>
+#include "EuroScopePlugIn.h"
+#include "Structures.h"
+#include "HttpClient.h"
+
+using namespace std;
+using namespace EuroScopePlugIn;
+
+// Outbound queue counters
+struct COutboundStats {
+	int Depth = 0; // Aircraft waiting to be sent
+	int InFlight = 0; // Requests the server hasn't answered yet
+	int Sent = 0;
+	int Coalesced = 0; // Updates replaced by a newer one before they went out
+	int Retries = 0;
+	int Dropped = 0;
+	double LastLatency = 0.0; // Queued to acknowledged (milliseconds)
+	double MaxLatency = 0.0;
+};
+
+// Flight data going to the vNAAATS network, coalesced per callsign (last write wins) and flushed at a fixed cadence
+// Only one request per callsign is ever in flight so the server sees the writes in order
+class COutboundQueue
+{
+	public:
+		// Queue a post or update, replacing anything still waiting for the aircraft (any thread)
+		static void Enqueue(const CNetworkFlightPlan& fp, bool isPost);
+
+		// Send everything that is due, at most once every OUTBOUND_INTERVAL (UI thread)
+		static void Flush();
+
+		// Whether the next Flush would send anything (any thread)
+		static bool IsDue();
+
+		// Copy of the counters
+		static COutboundStats GetStats();
+
+	private:
+		// An update waiting to go out
+		struct COutboundUpdate {
+			CNetworkFlightPlan FP;
+			bool IsPost = false; // Aircraft isn't on the network yet
+			clock_t Queued = 0; // First queued, latency is measured from here
+			clock_t NextAttempt = 0; // Backoff
+			int Attempts = 0;
+		};
+
+		// Server answered (I/O worker)
+		static void OnResponse(const COutboundUpdate& update, const CHttpResponse& response);
+
+		static map<string, COutboundUpdate> pending;
+		static set<string> inFlight;
+		static COutboundStats stats;
+		static clock_t lastFlush;
+		static mutex queueLock;
+};
@@ -3,9 +3,31 @@
 
 COverlayType COverlays::CurrentType = COverlayType::TCKS_ALL;
 
-void COverlays::ShowCurrentOverlay(CDC* dc, Graphics* g, CRadarScreen* screen, CMenuBar* menubar) {
+void COverlays::ShowCurrentOverlay(CDrawList* list, CRadarScreen* screen, CMenuBar* menubar) {
 	// Render the tracks path
-	CCommonRenders::RenderTracks(dc, g, screen, CurrentType, menubar);
+	CCommonRenders::RenderTracks(list, screen, CurrentType, menubar);
+}
+
+bool COverlays::IsOverlayChanged(CMenuBar* menubar, COverlayState* drawnState) {
+	// Current state
+	COverlayState state;
+	state.IsVisible = menubar->IsButtonPressed(CMenuBar::BTN_OVERLAYS);
+	state.Type = CurrentType;
+	if (state.IsVisible && CurrentType == COverlayType::TCKS_SEL) {
+		menubar->GetSelectedTracks(state.SelectedTracks);
+	}
+	state.Tracks = CRoutesHelper::GetTracks();
+
+	// Compare, hidden overlays only care about being shown again
+	bool isChanged = state.IsVisible != drawnState->IsVisible;
+	if (!isChanged && state.IsVisible) {
+		isChanged = state.Type != drawnState->Type || state.SelectedTracks != drawnState->SelectedTracks || state.Tracks != drawnState->Tracks;
+	}
+
+	if (isChanged) {
+		*drawnState = move(state);
+	}
+	return isChanged;
 }
 
 // Show and hide the grid reference and waypoints
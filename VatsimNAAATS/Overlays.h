@@ -14,11 +14,22 @@ using namespace EuroScopePlugIn;
 class COverlays
 {
 	public:
+		// What the background overlay is drawn from, each display keeps the state it last drew
+		struct COverlayState {
+			bool IsVisible = false;
+			COverlayType Type = COverlayType::TCKS_ALL;
+			vector<string> SelectedTracks;
+			shared_ptr<const CTrackSet> Tracks; // Swapped as a whole on a TMI change
+		};
+
 		// Current overlay type
 		static COverlayType CurrentType;
 
-		// Display the currently selected overlay
-		static void ShowCurrentOverlay(CDC* dc, Graphics* g, CRadarScreen* screen, CMenuBar* menubar);
+		// Display the currently selected overlay (back bitmap phase)
+		static void ShowCurrentOverlay(CDrawList* list, CRadarScreen* screen, CMenuBar* menubar);
+
+		// Whether the overlay has changed since a display's background was last asked to redraw, true once per change (UI thread)
+		static bool IsOverlayChanged(CMenuBar* menubar, COverlayState* drawnState);
 
 		// Grid reference
 		static void ShowHideGridReference(CRadarScreen* screen, bool show);
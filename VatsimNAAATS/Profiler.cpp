@@ -0,0 +1,106 @@
+#include "pch.h"
+#include "Profiler.h"
+#include "Utils.h"
+#include <vector>
+#include <algorithm>
+
+bool CFrameProfiler::IsEnabled = false;
+CFrameProfiler::CFrameSample CFrameProfiler::current;
+CFrameProfiler::CFrameSample CFrameProfiler::frames[PROFILER_FRAMES];
+int CFrameProfiler::frameHead = 0;
+int CFrameProfiler::frameCount = 0;
+
+// HUD labels, in stage order
+static const char* STAGE_NAMES[PRF_COUNT] = {
+	"FRAME", "MAINT", "LISTS", "OVERLAYS", "ROUTES", "TARGETS", "TAGS", "CONFLICT",
+	"MENU BAR", "LIST DRAW", "WIN TCKINFO", "WIN MSG", "WIN FLTPLN", "WIN NOTEPAD"
+};
+
+// Value at a fraction of the way through the sorted samples
+static double Percentile(vector<double>& values, double fraction) {
+	size_t index = min(values.size() - 1, (size_t)(fraction * (values.size() - 1) + 0.5));
+	nth_element(values.begin(), values.begin() + index, values.end());
+	return values[index];
+}
+
+void CFrameProfiler::AddTime(CProfileStage stage, double ms) {
+	current.Stages[stage] += ms;
+}
+
+void CFrameProfiler::EndFrame() {
+	if (!IsEnabled) return;
+
+	// Store and start again
+	frames[frameHead] = current;
+	frameHead = (frameHead + 1) % PROFILER_FRAMES;
+	frameCount = min(frameCount + 1, PROFILER_FRAMES);
+	current = CFrameSample();
+}
+
+void CFrameProfiler::Reset() {
+	current = CFrameSample();
+	frameHead = 0;
+	frameCount = 0;
+}
+
+void CFrameProfiler::RenderProfiler(CDC* dc, CRadarScreen* screen) {
+	// Save context for later
+	int iDC = dc->SaveDC();
+
+	// Font
+	FontSelector::SelectMonoFont(14, dc);
+	dc->SetTextColor(TextWhite.ToCOLORREF());
+	dc->SetTextAlign(TA_LEFT);
+
+	// Header
+	int x = screen->GetRadarArea().left + 10;
+	int y = MENBAR_HEIGHT + 120;
+	string line = "PROFILE " + to_string(frameCount) + " FRAMES (MS) P50/P95/MAX";
+	dc->TextOutA(x, y, line.c_str());
+	y += 14;
+
+	if (frameCount > 0) {
+		// Stages
+		vector<double> values;
+		values.reserve(frameCount);
+		for (int stage = 0; stage < PRF_COUNT; stage++) {
+			values.clear();
+			for (int i = 0; i < frameCount; i++) {
+				values.push_back(frames[i].Stages[stage]);
+			}
+			double maximum = *max_element(values.begin(), values.end());
+			double p95 = Percentile(values, 0.95);
+			double p50 = Percentile(values, 0.5);
+
+			line = string(STAGE_NAMES[stage]) + " " + CUtils::RoundDecimalPlaces(p50, 2) + "/" + CUtils::RoundDecimalPlaces(p95, 2) + "/" + CUtils::RoundDecimalPlaces(maximum, 2);
+			dc->TextOutA(x, y, line.c_str());
+			y += 14;
+		}
+
+		// Counts, from the last frame
+		const CFrameSample& last = frames[(frameHead + PROFILER_FRAMES - 1) % PROFILER_FRAMES];
+		line = "DRAWN " + to_string(last.Targets) + " TARGETS " + to_string(last.Tags) + " TAGS";
+		dc->TextOutA(x, y, line.c_str());
+		y += 14;
+
+		// Drawing resources made, should sit at 0 once the style cache is warm
+		int maxAllocations = 0;
+		for (int i = 0; i < frameCount; i++) {
+			maxAllocations = max(maxAllocations, frames[i].Allocations);
+		}
+		line = "ALLOCS " + to_string(last.Allocations) + " (MAX " + to_string(maxAllocations) + ")";
+		dc->TextOutA(x, y, line.c_str());
+		y += 14;
+
+		// Strings measured or formatted, only when something changes once the text cache is warm
+		int maxTextMisses = 0;
+		for (int i = 0; i < frameCount; i++) {
+			maxTextMisses = max(maxTextMisses, frames[i].TextMisses);
+		}
+		line = "TEXT " + to_string(last.TextMisses) + " (MAX " + to_string(maxTextMisses) + ")";
+		dc->TextOutA(x, y, line.c_str());
+	}
+
+	// Restore context
+	dc->RestoreDC(iDC);
+}
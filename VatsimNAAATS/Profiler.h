@@ -0,0 +1,98 @@
+#pragma once
+#include <string>
+#include <chrono>
+#include "EuroScopePlugIn.h"
+#include "Constants.h"
+#include "Styles.h"
+
+using namespace std;
+using namespace Colours;
+using namespace EuroScopePlugIn;
+
+// Stages of a frame
+enum CProfileStage {
+	PRF_FRAME, // Everything in OnRefresh
+	PRF_MAINTENANCE, // On screen set upkeep and list resets
+	PRF_LISTS, // Inbound and other list building
+	PRF_OVERLAYS,
+	PRF_ROUTES,
+	PRF_TARGETS,
+	PRF_TAGS,
+	PRF_CONFLICT, // STCA, SEP, RBL, PIV and QDM
+	PRF_MENUBAR,
+	PRF_LISTRENDER,
+	PRF_WIN_TCKINFO,
+	PRF_WIN_MSG,
+	PRF_WIN_FLTPLN,
+	PRF_WIN_NOTEPAD,
+	PRF_COUNT
+};
+
+// Per-stage frame timings kept in a ring buffer, with a HUD (toggled with ".vnaaats prof")
+// UI thread only, when disabled a scope costs a flag check
+class CFrameProfiler
+{
+	public:
+		// Collect timings
+		static bool IsEnabled;
+
+		// Times the scope it lives in against a stage, accumulated over the frame
+		class CScope {
+			public:
+				CScope(CProfileStage stage) : stage(stage), isActive(IsEnabled) {
+					if (isActive) start = chrono::steady_clock::now();
+				}
+				~CScope() { Stop(); }
+
+				// Stop early, returns the elapsed time (milliseconds, 0 when disabled)
+				double Stop() {
+					if (!isActive) return 0.0;
+					isActive = false;
+					double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+					AddTime(stage, ms);
+					return ms;
+				}
+
+			private:
+				CProfileStage stage;
+				bool isActive;
+				chrono::steady_clock::time_point start;
+		};
+
+		// Add time to a stage of the current frame
+		static void AddTime(CProfileStage stage, double ms);
+
+		// Count a drawn target or tag
+		static void CountTarget() { if (IsEnabled) current.Targets++; }
+		static void CountTag() { if (IsEnabled) current.Tags++; }
+
+		// Count a pen, brush or other drawing resource made during the frame
+		static void CountAllocation() { if (IsEnabled) current.Allocations++; }
+
+		// Count a string measured or formatted during the frame
+		static void CountTextMiss() { if (IsEnabled) current.TextMisses++; }
+
+		// Store the current frame and start the next
+		static void EndFrame();
+
+		// Drop everything collected
+		static void Reset();
+
+		// Draw the HUD
+		static void RenderProfiler(CDC* dc, CRadarScreen* screen);
+
+	private:
+		// One frame
+		struct CFrameSample {
+			double Stages[PRF_COUNT] = {};
+			int Targets = 0;
+			int Tags = 0;
+			int Allocations = 0;
+			int TextMisses = 0;
+		};
+
+		static CFrameSample current;
+		static CFrameSample frames[PROFILER_FRAMES];
+		static int frameHead; // Next slot
+		static int frameCount;
+};
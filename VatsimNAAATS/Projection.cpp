@@ -0,0 +1,132 @@
+#include "pch.h"
+#include "Projection.h"
+#include <cmath>
+#include <algorithm>
+
+unordered_map<CProjection::CPositionKey, POINT, CProjection::CPositionHash> CProjection::cache;
+POINT CProjection::probes[5] = {};
+bool CProjection::isAffine = false;
+RECT CProjection::viewport = {};
+double CProjection::affine[6] = {};
+
+// Probe positions spanning the NAT (lat, lon): origin, east, north and two checks
+static const double PROBES[5][2] = { { 30.0, -80.0 }, { 30.0, 10.0 }, { 70.0, -80.0 }, { 70.0, 10.0 }, { 50.0, -35.0 } };
+
+// Largest cache before it is cleared, a sweep across the whole NAT stays well under this
+static const size_t CACHE_LIMIT = 65536;
+
+// Largest error (pixels) for the affine fit to be trusted
+static const double AFFINE_TOLERANCE = 1.0;
+
+void CProjection::BeginFrame(CRadarScreen* screen) {
+	// What can be seen
+	viewport = screen->GetRadarArea();
+	viewport.left -= CULL_MARGIN;
+	viewport.top -= CULL_MARGIN;
+	viewport.right += CULL_MARGIN;
+	viewport.bottom += CULL_MARGIN;
+
+	// Where the probes land now
+	POINT current[5];
+	bool isMoved = false;
+	for (int i = 0; i < 5; i++) {
+		CPosition position;
+		position.m_Latitude = PROBES[i][0];
+		position.m_Longitude = PROBES[i][1];
+		current[i] = screen->ConvertCoordFromPositionToPixel(position);
+		if (current[i].x != probes[i].x || current[i].y != probes[i].y) {
+			isMoved = true;
+		}
+	}
+
+	// Same view, keep everything
+	if (!isMoved && cache.size() < CACHE_LIMIT) {
+		return;
+	}
+	cache.clear();
+	if (!isMoved) {
+		return;
+	}
+	for (int i = 0; i < 5; i++) {
+		probes[i] = current[i];
+	}
+
+	// Fit from the origin, east and north probes
+	double lonSpan = PROBES[1][1] - PROBES[0][1];
+	double latSpan = PROBES[2][0] - PROBES[0][0];
+	affine[1] = (current[1].x - current[0].x) / lonSpan;
+	affine[2] = (current[2].x - current[0].x) / latSpan;
+	affine[0] = current[0].x - affine[1] * PROBES[0][1] - affine[2] * PROBES[0][0];
+	affine[4] = (current[1].y - current[0].y) / lonSpan;
+	affine[5] = (current[2].y - current[0].y) / latSpan;
+	affine[3] = current[0].y - affine[4] * PROBES[0][1] - affine[5] * PROBES[0][0];
+
+	// Only trust it if it lands the check probes where EuroScope does
+	isAffine = true;
+	for (int i = 3; i < 5; i++) {
+		double x = affine[0] + affine[1] * PROBES[i][1] + affine[2] * PROBES[i][0];
+		double y = affine[3] + affine[4] * PROBES[i][1] + affine[5] * PROBES[i][0];
+		if (abs(x - current[i].x) > AFFINE_TOLERANCE || abs(y - current[i].y) > AFFINE_TOLERANCE) {
+			isAffine = false;
+		}
+	}
+}
+
+bool CProjection::IsVisible(POINT point) {
+	return point.x >= viewport.left && point.x <= viewport.right && point.y >= viewport.top && point.y <= viewport.bottom;
+}
+
+bool CProjection::IsVisible(POINT from, POINT to) {
+	// Entirely to one side
+	if (max(from.x, to.x) < viewport.left || min(from.x, to.x) > viewport.right) return false;
+	if (max(from.y, to.y) < viewport.top || min(from.y, to.y) > viewport.bottom) return false;
+	return true;
+}
+
+bool CProjection::IsVisible(const vector<POINT>& points) {
+	if (points.empty()) return false;
+
+	// Bounding box
+	RECT bounds = { points[0].x, points[0].y, points[0].x, points[0].y };
+	for (const POINT& point : points) {
+		bounds.left = min(bounds.left, point.x);
+		bounds.right = max(bounds.right, point.x);
+		bounds.top = min(bounds.top, point.y);
+		bounds.bottom = max(bounds.bottom, point.y);
+	}
+	return IsVisible({ bounds.left, bounds.top }, { bounds.right, bounds.bottom });
+}
+
+POINT CProjection::ToPixel(CRadarScreen* screen, const CPosition& position) {
+	// Cached
+	CPositionKey key = { position.m_Latitude, position.m_Longitude };
+	auto it = cache.find(key);
+	if (it != cache.end()) {
+		return it->second;
+	}
+
+	// Ask EuroScope
+	POINT point = screen->ConvertCoordFromPositionToPixel(position);
+	cache.insert(make_pair(key, point));
+	return point;
+}
+
+void CProjection::ToPixels(CRadarScreen* screen, const vector<CPosition>& positions, vector<POINT>& points) {
+	points.resize(positions.size());
+
+	// Point by point if the view can't be reconstructed
+	if (!isAffine) {
+		for (size_t i = 0; i < positions.size(); i++) {
+			points[i] = ToPixel(screen, positions[i]);
+		}
+		return;
+	}
+
+	// One multiply-add pass over the polyline
+	const double a0 = affine[0], a1 = affine[1], a2 = affine[2], a3 = affine[3], a4 = affine[4], a5 = affine[5];
+	for (size_t i = 0; i < positions.size(); i++) {
+		const CPosition& position = positions[i];
+		points[i].x = (LONG)lround(a0 + a1 * position.m_Longitude + a2 * position.m_Latitude);
+		points[i].y = (LONG)lround(a3 + a4 * position.m_Longitude + a5 * position.m_Latitude);
+	}
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <vector>
+#include <unordered_map>
+#include "EuroScopePlugIn.h"
+#include "Constants.h"
+
+using namespace std;
+using namespace EuroScopePlugIn;
+
+// Lat/lon to screen conversion and visibility tests shared by the renderers (UI thread only)
+// Conversions are cached until the view moves. Polylines go through an affine projection rebuilt from probe points whenever the view
+// changes, and fall back to EuroScope if the probes show the view isn't affine
+class CProjection
+{
+	public:
+		// Probe the view at the start of a refresh phase, drops the cache if it has moved
+		static void BeginFrame(CRadarScreen* screen);
+
+		// Whether a point is on screen (radar area plus CULL_MARGIN)
+		static bool IsVisible(POINT point);
+
+		// Whether any part of a segment or polyline could be on screen (bounding box test)
+		static bool IsVisible(POINT from, POINT to);
+		static bool IsVisible(const vector<POINT>& points);
+
+		// Convert one position
+		static POINT ToPixel(CRadarScreen* screen, const CPosition& position);
+
+		// Convert a whole polyline in one pass
+		static void ToPixels(CRadarScreen* screen, const vector<CPosition>& positions, vector<POINT>& points);
+
+	private:
+		// Cache key, the exact bits of the position
+		struct CPositionKey {
+			double Latitude;
+			double Longitude;
+			bool operator==(const CPositionKey& other) const { return Latitude == other.Latitude && Longitude == other.Longitude; }
+		};
+		struct CPositionHash {
+			size_t operator()(const CPositionKey& key) const { return hash<double>()(key.Latitude) * 31 + hash<double>()(key.Longitude); }
+		};
+
+		static unordered_map<CPositionKey, POINT, CPositionHash> cache;
+		static RECT viewport; // Radar area plus the margin
+		static POINT probes[5]; // Where the probe positions landed last time
+		static bool isAffine;
+		static double affine[6]; // x = [0] + [1] * lon + [2] * lat, y = [3] + [4] * lon + [5] * lat
+};
@@ -7,16 +7,25 @@
 #include "DataHandler.h"
 #include "Utils.h"
 #include "ConflictDetection.h"
+#include "Diagnostics.h"
+#include "OutboundQueue.h"
+#include "Profiler.h"
+#include "Projection.h"
+#include "TextCache.h"
+#include "GdiBackend.h"
 #include "DataHandler.h"
 #include <thread>
 #include <gdiplus.h>
 #include <ctype.h>
 #include <iostream>
+#include <algorithm>
 
 using namespace Gdiplus;
 using namespace std;
 using namespace EuroScopePlugIn;
 
+vector<CRadarDisplay*> CRadarDisplay::openDisplays;
+
 CRadarDisplay::CRadarDisplay()
 {
 	//COverlays::ShowHideGridReference(this, false);
@@ -30,6 +39,7 @@ CRadarDisplay::CRadarDisplay()
 	npWindow = new CNotePad({ 300, 300 }, { 800, 200 }); // TODO: save settings
 	menuBar = new CMenuBar();
 	asel = GetPlugIn()->FlightPlanSelectASEL().GetCallsign();
+	openDisplays.push_back(this);
 	fiveSecondTimer = clock();
 	tenSecondTimer = clock();
 	thirtySecondTimer = clock();
@@ -40,17 +50,24 @@ CRadarDisplay::CRadarDisplay()
 
 CRadarDisplay::~CRadarDisplay()
 {
+	// Stop the cursor thread before its data goes
+	appCursor->isClosed.Signal();
+	if (cursorThread.joinable()) cursorThread.join();
+
+	// Routes still queued for this display go to another one (or are dropped if it was the last)
+	openDisplays.erase(remove(openDisplays.begin(), openDisplays.end(), this), openDisplays.end());
+	CRoutesHelper::RetargetScreen(this, openDisplays.empty() ? nullptr : openDisplays.front());
+
 	// Clean up
-	appCursor->isESClosed;
 	delete appCursor;
-	delete trackWindow;
 	delete fltPlnWindow;
 	delete trackWindow;
 	delete msgWindow;
 	delete npWindow;
 	delete inboundList;
 	delete otherList;
-	delete this;
+	delete conflictList;
+	delete menuBar;
 }
 
 void CRadarDisplay::PopulateProgramData() {
@@ -91,27 +108,59 @@ void CRadarDisplay::PopulateProgramData() {
 		COverlays::CurrentType = COverlayType::TCKS_SEL;
 	}
 
-	// Download the tracks
-	CDataHandler::PopulateLatestTrackData(GetPlugIn());
+	// Last known tracks and network data, the refresh swaps in newer data when it arrives
+	CDataHandler::LoadCachedData(this);
+	CDataHandler::StartNetworkRefresh();
 
 	// Set tracks in menu bar
 	menuBar->MakeDropDownItems(menuBar->DRP_TCKCTRL);
 
-	// Initialise fonts
+	// Initialise fonts and the pens and brushes
 	FontSelector::InitialiseFonts();
+	StyleCache::InitialiseStyles();
 
 	// Start cursor update loop
 	appCursor->screen = this;
-	_beginthread(CursorStateUpdater, 0, (void*)appCursor);
+	cursorThread = thread(CursorStateUpdater, (void*)appCursor);
 	CLogger::Log(CLogType::NORM, "Firing cursor update sequence thread.", "CRadarDisplay::PopulateProgramData");
-
-	// Check plugin version
-	CDataHandler::CheckPluginVersion(GetPlugIn());
 }
 
-// On radar screen refresh (modified to occur 4 times a second)
+// On radar screen refresh (requested by the cursor thread when something visible changes)
 void CRadarDisplay::OnRefresh(HDC hDC, int Phase)
 {
+	// Static geometry lives on the background bitmap, EuroScope only redraws it on a pan or zoom, or when UpdateFrame sees the overlay change
+	if (Phase == REFRESH_PHASE_BACK_BITMAP) {
+		// Draw overlays if enabled
+		if (menuBar->IsButtonPressed(CMenuBar::BTN_OVERLAYS)) {
+			CProjection::BeginFrame(this);
+			CFrameProfiler::CScope overlayProfile(PRF_OVERLAYS);
+			CDC dc;
+			dc.Attach(hDC);
+			Graphics g(hDC);
+			CGdiBackend backend(&dc, &g);
+			drawList.Begin(&backend);
+			COverlays::ShowCurrentOverlay(&drawList, this, menuBar);
+			drawList.Submit();
+			dc.Detach();
+		}
+		return;
+	}
+
+	// Everything else is drawn before the tags, the remaining phases have nothing to do
+	if (Phase != REFRESH_PHASE_BEFORE_TAGS) {
+		return;
+	}
+
+	// Time spent here shows as UI load in the diagnostics
+	CDiagnostics::CRefreshTimer refreshTimer;
+	CFrameProfiler::CScope frameProfile(PRF_FRAME);
+
+	// Screen conversions are cached until the view moves
+	CProjection::BeginFrame(this);
+
+	// Bring the model up to date, once per frame
+	UpdateFrame();
+
 	// Create device context
 	CDC dc;
 	dc.Attach(hDC);
@@ -119,23 +168,475 @@ void CRadarDisplay::OnRefresh(HDC hDC, int Phase)
 	// Graphics object
 	Graphics g(hDC);
 
-	// 5 second timer
-	double fiveSecT = (double)(clock() - fiveSecondTimer) / ((double)CLOCKS_PER_SEC);
-	// 10 second timer
-	double tenSecT = (double)(clock() - tenSecondTimer) / ((double)CLOCKS_PER_SEC);
+	// Backend for the draw list
+	CGdiBackend backend(&dc, &g);
+
+	// Check if the altitude filter is on
+	bool altFiltEnabled = false;
+	if (menuBar->IsButtonPressed(CMenuBar::BTN_ALTFILT)) altFiltEnabled = true;
+
+	// Get the radar area
+	CRect RadarArea(GetRadarArea());
+	RadarArea.top = RadarArea.top - 1;
+	RadarArea.bottom = GetChatArea().bottom;
+
+	/// Write current lat lon on screen
+	int sDC = dc.SaveDC();
+	// Select font
+	FontSelector::SelectMonoFont(12, &dc);
+	dc.SetTextColor(TextWhite.ToCOLORREF());
+	dc.SetTextAlign(TA_LEFT);
+	// Get radar area and lat lon
+	CRect radarBounds = this->GetRadarArea();
+	dc.TextOutA(radarBounds.right - 185, radarBounds.bottom - dc.GetTextExtent("ABC").cy - 2, 
+		CUtils::GetLatLonString(&appCursor->latLonPosition).c_str());
+	dc.RestoreDC(sDC);
+
+	// Get first aircraft
+	CRadarTarget ac;
+	ac = GetPlugIn()->RadarTargetSelectFirst();
+
+	// Get entry time and direction
+	int entryMinutes;
+	bool direction;
+
+	// Draw routes
+	if (CRoutesHelper::ActiveRoutes.size() != CRoutesHelper::ActiveRoutes.empty() && CRoutesHelper::ActiveRoutes.size() != 0) {
+		CFrameProfiler::CScope routeProfile(PRF_ROUTES);
+		drawList.Begin(&backend);
+		CCommonRenders::RenderRoutes(&drawList, this);
+		drawList.Submit();
+	}
+
+	// Tags drawn this frame go into the declutter
+	declutter.BeginFrame();
+
+	// Loop all aircraft
+	while (ac.IsValid()) {
+		// Callsign id
+		int acId = CCallsignTable::Intern(ac.GetCallsign());
+
+		// The system plan
+		CFlightHotData aircraftFlightPlan;
+		CDataHandler::GetFlightHotData(ac.GetCallsign(), aircraftFlightPlan);
+
+		// Flight plan
+		CFlightPlan fp = GetPlugIn()->FlightPlanSelect(ac.GetCallsign());
+
+		// Route
+		CFlightPlanExtractedRoute rte = fp.GetExtractedRoute();
+
+		// Time and direction
+		entryMinutes = fp.GetSectorEntryMinutes();
+		direction = CUtils::GetAircraftDirection(ac.GetPosition().GetReportedHeading());
+		
+		//string debug = string(ac.GetCallsign()) + ":" + to_string(entryMinutes) + ":" + to_string(direction) + ":" + to_string(aircraftFlightPlan.ExitTime) + ":" + to_string(CUtils::GetTargetModeInt(ac.GetPosition().GetRadarFlags())) + "\n";
+
+		//CLogger::LogAircraftDebugInfo(debug);
+
+		// Check if they are a selected aircraft
+		if (ac.GetCallsign() == CAcTargets::SearchedAircraft) {
+			if (((double)(clock() - CAcTargets::fiveSecondTimer) / ((double)CLOCKS_PER_SEC)) >= 5) {
+				CAcTargets::SearchedAircraft = "";
+				CAcTargets::fiveSecondTimer = clock();
+			}
+			else {
+				CAcTargets::RenderSelectionHalo(&g, this, &ac);
+			}
+		}
+
+		// If PSSR button not pressed
+		/*if (!menuBar->IsButtonPressed(CMenuBar::BTN_PSSR)) {
+			// Check their PSSR state to hide all non ADS-B aircraft
+			if (CUtils::GetTargetMode(ac.GetPosition().GetRadarFlags()) != CRadarTargetMode::ADS_B) {
+				// Select the next target
+				ac = GetPlugIn()->RadarTargetSelectNext(ac);
+				if (aircraftOnScreen.find(ac.GetCallsign()) != aircraftOnScreen.end()) aircraftOnScreen.erase(ac.GetCallsign());
+				continue;
+			}
+		}*/
+
+		// Check their altitude, if they are outside the filter, skip them
+		if (altFiltEnabled && !menuBar->IsButtonPressed(CMenuBar::BTN_ALL)) {
+			if (ac.GetPosition().GetPressureAltitude() / 100 < CUtils::AltFiltLow || ac.GetPosition().GetPressureAltitude() / 100 > CUtils::AltFiltHigh) {
+				// Select the next target
+				aircraftOnScreen.Erase(acId);
+				ac = GetPlugIn()->RadarTargetSelectNext(ac);
+				continue;
+			}
+		}
+
+		// Check track filtering
+		if (menuBar->GetButtonState(menuBar->BTN_TCKCTRL) == CInputState::ACTIVE && !menuBar->IsButtonPressed(CMenuBar::BTN_ALL)) {
+			// Primed plan
+			string cs = (string)fp.GetCallsign();
+			vector<string> tracks;
+			auto idx = find_if(CConflictDetection::CurrentSTCA.begin(), CConflictDetection::CurrentSTCA.end(), [acId](const CSTCAStatus& obj) {return obj.IdA == acId || obj.IdB == acId; });
+			if (idx == CConflictDetection::CurrentSTCA.end())
+				menuBar->GetSelectedTracks(tracks);
+			bool skipAircraft = tracks.empty() ? false : true;
+			if (!tracks.empty()) {
+				// Our track if we have flight data, otherwise the cached one from the filed route
+				string acTrack = aircraftFlightPlan.IsValid ? string(aircraftFlightPlan.Track) : CRoutesHelper::GetNatTrack(this, cs);
+				for (int i = 0; i < tracks.size(); i++) {
+					if (acTrack == tracks[i]) {
+						skipAircraft = false;
+						break;
+					}
+				}
+			}
+
+			if (skipAircraft) {
+				// Select the next target
+				ac = GetPlugIn()->RadarTargetSelectNext(ac);
+				continue;
+			}
+		}
+		
+		// Parse inbound & other
+		bool filtersDisabled = menuBar->IsButtonPressed(CMenuBar::BTN_ALL);
+		if (CUtils::IsAircraftRelevant(this, &ac, filtersDisabled)) {
+			
+			// STCA
+			if (isTenSecondCycle) {
+				CFrameProfiler::CScope stcaProfile(PRF_CONFLICT);
+				CConflictDetection::CheckSTCA(this, &ac, &aircraftOnScreen);
+			}
+
+			if (isFiveSecondCycle) {
+				CFrameProfiler::CScope listProfile(PRF_LISTS);
+
+				// If going westbound
+				if (!direction && entryMinutes > 0) {
+					if (menuBar->GetDropDownValue(CMenuBar::DRP_AREASEL) == "CZQX") {
+						int i;
+						for (i = 0; i < rte.GetPointsNumber(); i++) {
+							// Find out if 30 west is in their flight plan
+							if (rte.GetPointPosition(i).m_Longitude == -30.0) {
+								// Test flight time
+								if (rte.GetPointDistanceInMinutes(i) > 0 && rte.GetPointDistanceInMinutes(i) < 60) {
+									// Add if within
+									inboundList->AircraftList.push_back(CInboundAircraft(ac.GetCallsign(), fp.GetFinalAltitude(), fp.GetClearedAltitude(),
+											rte.GetPointName(i), CTextCache::ZuluTime(rte.GetPointDistanceInMinutes(i)), fp.GetFlightPlanData().GetDestination(), false));
+									break;
+								}
+							}
+						}
+						if (i == rte.GetPointsNumber()) {
+							// Add to 'others' list
+							otherList->AircraftList.push_back(ac.GetCallsign());
+						}
+					}
+					else {
+						int i;
+						for (i = 0; i < rte.GetPointsNumber(); i++) {
+							// They are coming from land so check entry points
+							if (CUtils::IsEntryPoint(rte.GetPointName(i), direction) || CUtils::IsExitPoint(rte.GetPointName(i), direction)) {
+								// Add if within
+								inboundList->AircraftList.push_back(CInboundAircraft(ac.GetCallsign(), fp.GetFinalAltitude(), fp.GetClearedAltitude(),
+									rte.GetPointName(i), CTextCache::ZuluTime(rte.GetPointDistanceInMinutes(i)), fp.GetFlightPlanData().GetDestination(), false));
+								break;
+							}
+						}
+						if (i == rte.GetPointsNumber()) {
+							// Add to 'others' list
+							otherList->AircraftList.push_back(ac.GetCallsign());
+						}
+					}
+				}
+				else if (direction && entryMinutes > 0) {
+					if (menuBar->GetDropDownValue(CMenuBar::DRP_AREASEL) == "EGGX") {
+						int i;
+						for (i = 0; i < rte.GetPointsNumber(); i++) {
+							// Find out if 30 west is in their flight plan
+							if (rte.GetPointPosition(i).m_Longitude == -30.0) {
+								// Test flight time
+								if (rte.GetPointDistanceInMinutes(i) > 0 && rte.GetPointDistanceInMinutes(i) < 60) {
+									// Add if within
+									inboundList->AircraftList.push_back(CInboundAircraft(ac.GetCallsign(), fp.GetFinalAltitude(), fp.GetClearedAltitude(),
+										rte.GetPointName(i), CTextCache::ZuluTime(rte.GetPointDistanceInMinutes(i)), fp.GetFlightPlanData().GetDestination(), true));
+									break;
+								}
+							}
+						}
+						if (i == rte.GetPointsNumber()) {
+							// Add to 'others' list
+							otherList->AircraftList.push_back(ac.GetCallsign());
+						}
+					}
+					else {
+						// They are coming from land so check entry points
+						int i;
+						for (i = 0; i < rte.GetPointsNumber(); i++) {
+							if (CUtils::IsEntryPoint(rte.GetPointName(i), direction) || CUtils::IsExitPoint(rte.GetPointName(i), direction)) {
+								// Add if within
+								inboundList->AircraftList.push_back(CInboundAircraft(ac.GetCallsign(), fp.GetFinalAltitude(), fp.GetClearedAltitude(),
+									rte.GetPointName(i), CTextCache::ZuluTime(rte.GetPointDistanceInMinutes(i)), fp.GetFlightPlanData().GetDestination(), true));
+								break;
+							}
+						}
+						if (i == rte.GetPointsNumber()) {
+							// Add to 'others' list
+							otherList->AircraftList.push_back(ac.GetCallsign());
+						}
+					}
+				}
+			}
+
+			// Store whether detailed tags are enabled
+			bool detailedEnabled = false;
+
+			// Now we check if all the tags are selected as detailed
+			if (menuBar->IsButtonPressed(CMenuBar::BTN_EXT)) {
+				detailedEnabled = true; // Set detailed on
+
+				// Unpress detailed if not already
+				if (menuBar->IsButtonPressed(CMenuBar::BTN_DETAILED) && !aselDetailed) {
+					menuBar->SetButtonState(CMenuBar::BTN_DETAILED, CInputState::INACTIVE);
+				}
+			}
+
+			// Check if only one is set to detailed
+			if (menuBar->IsButtonPressed(CMenuBar::BTN_DETAILED)) {
+				if (fp.GetCallsign() == asel) {
+					detailedEnabled = true; // Set detailed on
+				}
+
+				// Unpress extended if not already
+				if (menuBar->IsButtonPressed(CMenuBar::BTN_EXT) && aselDetailed) {
+					menuBar->SetButtonState(CMenuBar::BTN_EXT, CInputState::INACTIVE);
+				}
+			}
+
+			bool ptl = false;
+			bool halo = false;
+			// Set PTL and HALO if they are on
+			if (menuBar->IsButtonPressed(CMenuBar::BTN_PTL)) {
+				ptl = true;
+			}
+			if (menuBar->IsButtonPressed(CMenuBar::BTN_HALO)) {
+				halo = true;
+			}
+
+			// Get STCA so it can be drawn
+			CSTCAStatus stcaStatus(ac.GetCallsign(), "", CConflictStatus::OK, -1, -1); // Create default
+			auto idx = CConflictDetection::CurrentSTCA.begin();
+			for (idx = CConflictDetection::CurrentSTCA.begin(); idx != CConflictDetection::CurrentSTCA.end(); idx++) {
+				if (acId == idx->IdA || acId == idx->IdB) {
+					stcaStatus = *idx;
+					break; // Break for optimisation
+				}
+			}
+
+			// Relevant, whether or not it can be seen
+			aircraftOnScreen.Insert(acId);
+
+			// Off screen, keep the model up to date but don't draw anything
+			POINT acPoint = CProjection::ToPixel(this, ac.GetPosition().GetPosition());
+			if (!CProjection::IsVisible(acPoint)) {
+				CAcTargets::UpdateTargetMode(&ac);
+			}
+			// Draw the tag and target with the information if tags are turned on and within altitude filter
+			else if (menuBar->IsButtonPressed(CMenuBar::BTN_TAGS)) {
+				pair<bool, POINT>* tagStatus = GetTagStatus(acId);
+				tagStatus->first = detailedEnabled; // Set detailed on
+
+				// Dragged tags stay put, the rest are placed clear of each other
+				pair<bool, POINT> tagPlacement = *tagStatus;
+				if (tagStatus->second.x == 0 && tagStatus->second.y == 0) {
+					tagPlacement.second = declutter.Place(acId, acPoint, detailedEnabled, direction);
+				}
+				else {
+					declutter.Pin(acId, acPoint, tagStatus->second, detailedEnabled);
+				}
+
+				CAcTargets::RenderTarget(&g, &dc, this, &ac, true, &menuBar->GetToggleButtons(), halo, ptl, &stcaStatus);
+				POINT tagPosition = CAcTargets::RenderTag(&g, &dc, this, &ac, &tagPlacement, direction, &stcaStatus, asel);
+
+				// If tracking dialog open
+				if (CAcTargets::OpenTrackingDialog != "" && CAcTargets::OpenTrackingDialog == ac.GetCallsign()) {
+					CAcTargets::RenderCoordTagItem(&dc, this, ac.GetCallsign(), tagPosition);
+				}
+
+			}
+			else {
+				CAcTargets::RenderTarget(&g, &dc, this, &ac, false, &menuBar->GetToggleButtons(), halo, ptl, &stcaStatus);
+			}
+		}
+		else { // If not there, and the aircraft was on the screen, then delete
+			aircraftOnScreen.Erase(acId);
+		}
+
+		// Select the next target
+		ac = GetPlugIn()->RadarTargetSelectNext(ac);
+	}
+
+	// Re-place the tags that moved (bounded)
+	{
+		CFrameProfiler::CScope declutterProfile(PRF_TAGS);
+		declutter.EndFrame();
+	}
+
+	// Clear ASELs if none of the range/separation tools are pressed
+	if (!menuBar->IsButtonPressed(CMenuBar::BTN_PIV)
+		&& !menuBar->IsButtonPressed(CMenuBar::BTN_RBL)
+		&& !menuBar->IsButtonPressed(CMenuBar::BTN_SEP)) {
+		// Reset ASELs if none enabled
+		aircraftSel1 = "";
+		aircraftSel2 = "";
+	}
+
+	/// RENDERING
+	// Draw menu bar
+	CFrameProfiler::CScope menuProfile(PRF_MENUBAR);
+	menuBar->RenderBar(&dc, &g, this, asel);
+	menuProfile.Stop();
+
+	// Draw lists
+	CFrameProfiler::CScope listRenderProfile(PRF_LISTRENDER);
+	inboundList->RenderList(&g, &dc, this);
+	otherList->RenderList(&g, &dc, this);
+	//rclList->RenderList(&g, &dc, this);
+	conflictList->RenderList(&g, &dc, this);
+	listRenderProfile.Stop();
+
+	// Separation tools
+	CFrameProfiler::CScope toolProfile(PRF_CONFLICT);
+
+	// SEP draw
+	if (menuBar->IsButtonPressed(CMenuBar::BTN_SEP)) {
+		// If both aircraft selected then draw
+		if (aircraftSel1 != "" && aircraftSel2 != "") {
+			CConflictDetection::SepTool(&dc, &g, this, aircraftSel1, aircraftSel2);
+		}
+	}
+
+	// RBL draw
+	if (menuBar->IsButtonPressed(CMenuBar::BTN_RBL)) {
+		if (aircraftSel1 != "" && aircraftSel2 != "") {
+			CConflictDetection::RBLTool(&dc, &g, this, aircraftSel1, aircraftSel2);
+		}
+	}
+
+	// PIV draw
+	if (menuBar->IsButtonPressed(CMenuBar::BTN_PIV)) {
+		// If both aircraft selected then draw
+		if (aircraftSel1 != "" && aircraftSel2 != "") {
+			// Render
+			drawList.Begin(&backend);
+			CConflictDetection::RenderPIV(&drawList, this, aircraftSel1, aircraftSel2);
+			drawList.Submit();
+		}
+	}
+
+	// QDM draw
+	if (menuBar->IsButtonPressed(CMenuBar::BTN_QDM)) {
+		// Check if first position is set
+		if (RulerPoint1.m_Latitude != 0.0 && RulerPoint1.m_Longitude != 0.0) {
+			// Render
+			CCommonRenders::RenderQDM(&dc, &g, this, &RulerPoint1, &RulerPoint2, appCursor->position, &appCursor->latLonPosition);
+		}
+	}
+	toolProfile.Stop();
+
+	// Draw track info window if button pressed
+	if (menuBar->IsButtonPressed(CMenuBar::BTN_TCKINFO)) {
+		CFrameProfiler::CScope windowProfile(PRF_WIN_TCKINFO);
+		trackWindow->RenderWindow(&dc, &g, this, menuBar);
+	}
+
+	// Draw message window if button pressed
+	if (menuBar->IsButtonPressed(CMenuBar::BTN_MESSAGE)) {
+		CFrameProfiler::CScope windowProfile(PRF_WIN_MSG);
+		msgWindow->RenderWindow(&dc, &g, this);
+	}
+
+	// Draw flight plan window if button pressed
+	if (menuBar->IsButtonPressed(CMenuBar::BTN_FLIGHTPLAN)) {
+		CFrameProfiler::CScope windowProfile(PRF_WIN_FLTPLN);
+		fltPlnWindow->RenderWindow(&dc, &g, this);
+	}
+
+	// Draw notepad window if button pressed
+	if (menuBar->IsButtonPressed(CMenuBar::BTN_NOTEPAD)) {
+		CFrameProfiler::CScope windowProfile(PRF_WIN_NOTEPAD);
+		npWindow->RenderWindow(&dc, &g, this);
+	}
+
+	// Diagnostics
+	if (CDiagnostics::IsVisible) {
+		CDiagnostics::RenderDiagnostics(&dc, this);
+	}
+
+	// Frame profile, the HUD shows the frames before this one
+	if (CFrameProfiler::IsEnabled) {
+		CFrameProfiler::RenderProfiler(&dc, this);
+	}
+
+	// Finally, reset the colour clock if time has been exceeded
+	if (double twoSecT = (double)(clock() - CAcTargets::twoSecondTimer) / ((double)CLOCKS_PER_SEC) >= 2.2) { // Ac target and tag colours
+		CAcTargets::twoSecondTimer = clock();
+	}
+
+	// Frame done
+	frameProfile.Stop();
+	CFrameProfiler::EndFrame();
+
+	// De-allocation
+	dc.Detach();
+	g.ReleaseHDC(hDC);
+	dc.DeleteDC();
+}
+
+// Per-frame model update, run once ahead of the drawing
+void CRadarDisplay::UpdateFrame()
+{
+	// Cursor samples and clicks from the cursor thread
+	UpdateCursor();
+
+	// Apply flight data changes from the worker threads, this publishes everything changed since the last frame
+	CDataHandler::ApplyFlightUpdates(this);
+
+	// Routes waiting on that publish
+	CRoutesHelper::SubmitRoutes();
+
+	// Tracks from the background refresh
+	if (CDataHandler::ApplyPendingTracks(this)) {
+		menuBar->MakeDropDownItems(CMenuBar::DRP_TCKCTRL);
+	}
+
+	// Send queued flight data
+	COutboundQueue::Flush();
+
+	// Overlay selection or tracks changed, redraw the background
+	if (COverlays::IsOverlayChanged(menuBar, &overlayState)) {
+		RefreshMapContent();
+	}
+
+	// Timed cycles that fall on this frame, the clocks restart straight away
+	isFiveSecondCycle = (double)(clock() - fiveSecondTimer) / ((double)CLOCKS_PER_SEC) >= 5;
+	if (isFiveSecondCycle) {
+		fiveSecondTimer = clock();
+	}
+	isTenSecondCycle = (double)(clock() - tenSecondTimer) / ((double)CLOCKS_PER_SEC) >= 10;
+	if (isTenSecondCycle) {
+		CLogger::Log(CLogType::NORM, "Recalculating STCA.", "CRadarDisplay::UpdateFrame");
+		tenSecondTimer = clock();
+	}
 
 	// Clear lists if not empty and time is greater than 1 second
-	if (fiveSecT >= 5 && !inboundList->AircraftList.empty()) {
+	CFrameProfiler::CScope maintenanceProfile(PRF_MAINTENANCE);
+	if (isFiveSecondCycle && !inboundList->AircraftList.empty()) {
 		inboundList->AircraftList.clear();
-		CLogger::Log(CLogType::NORM, "Refreshing Inbound list.", "CRadarDisplay::OnRefresh");
+		CLogger::Log(CLogType::NORM, "Refreshing Inbound list.", "CRadarDisplay::UpdateFrame");
 	}
-	if (fiveSecT >= 5 && !otherList->AircraftList.empty()) {
+	if (isFiveSecondCycle && !otherList->AircraftList.empty()) {
 		otherList->AircraftList.clear();
-		CLogger::Log(CLogType::NORM, "Refreshing Other list.", "CRadarDisplay::OnRefresh");
+		CLogger::Log(CLogType::NORM, "Refreshing Other list.", "CRadarDisplay::UpdateFrame");
 	}
 
 	// Online controllers
-	if (fiveSecT >= 5) {
+	if (isFiveSecondCycle) {
 		// Clear online controllers first
 		if (!fltPlnWindow->onlineControllers.empty())
 			fltPlnWindow->onlineControllers.clear();
@@ -145,21 +646,22 @@ void CRadarDisplay::OnRefresh(HDC hDC, int Phase)
 			if (string(controller.GetCallsign()).find("CTR") != string::npos || string(controller.GetCallsign()).find("FSS") != string::npos)
 			fltPlnWindow->onlineControllers[controller.GetCallsign()] = controller;
 		}
-		CLogger::Log(CLogType::NORM, "Refreshing controller list.", "CRadarDisplay::OnRefresh");
+		CLogger::Log(CLogType::NORM, "Refreshing controller list.", "CRadarDisplay::UpdateFrame");
 
 		// Log cursor position every 5 seconds
-		CLogger::Log(CLogType::NORM, "Current cursor position: (" + to_string(appCursor->position.x) + ", " + to_string(appCursor->position.y) + ")", "CRadarDisplay::OnRefresh");
+		CLogger::Log(CLogType::NORM, "Current cursor position: (" + to_string(appCursor->position.x) + ", " + to_string(appCursor->position.y) + ")", "CRadarDisplay::UpdateFrame");
 	}
 
 	// Set the ASEL if it is different to the current one in program
 	string cs = GetPlugIn()->FlightPlanSelectASEL().GetCallsign();
 	if (GetPlugIn()->FlightPlanSelectASEL().GetCallsign() != asel) {
 		asel = GetPlugIn()->FlightPlanSelectASEL().GetCallsign();
-		CLogger::Log(CLogType::NORM, "Selected aircraft changed to " + asel + ".", "CRadarDisplay::OnRefresh");
+		CLogger::Log(CLogType::NORM, "Selected aircraft changed to " + asel + ".", "CRadarDisplay::UpdateFrame");
 	}
 
 	// Set the flight plan button state
-	if (aircraftOnScreen.empty() || asel == "" || !CDataHandler::GetFlightData(asel)->IsValid || !CDataHandler::GetFlightData(asel)->IsFirstUpdate || !GetPlugIn()->ControllerMyself().IsController()) {
+	shared_ptr<const CAircraftFlightPlan> aselFp = CDataHandler::GetFlightSnapshot(asel);
+	if (aircraftOnScreen.Empty() || asel == "" || aselFp == nullptr || !aselFp->IsFirstUpdate || !GetPlugIn()->ControllerMyself().IsController()) {
 		if (menuBar->GetButtonState(CMenuBar::BTN_FLIGHTPLAN) != CInputState::DISABLED)
 			menuBar->SetButtonState(CMenuBar::BTN_FLIGHTPLAN, CInputState::DISABLED);
 	}
@@ -169,36 +671,38 @@ void CRadarDisplay::OnRefresh(HDC hDC, int Phase)
 	}
 
 	// Reset currently on screen list
-	if (tenSecT >= 10 && !aircraftOnScreen.empty()) {
-		CLogger::Log(CLogType::NORM, "Refreshing internal aircraft on screen list.", "CRadarDisplay::OnRefresh");
-		// Loop on screen aircraft
-		auto idx = aircraftOnScreen.begin();
-		while(idx != aircraftOnScreen.end()) {
+	if (isTenSecondCycle && !aircraftOnScreen.Empty()) {
+		CLogger::Log(CLogType::NORM, "Refreshing internal aircraft on screen list.", "CRadarDisplay::UpdateFrame");
+		// Loop on screen aircraft (over a copy so we can erase)
+		vector<int> onScreenIds = aircraftOnScreen.Members();
+		for (int id : onScreenIds) {
+			const string& callsign = CCallsignTable::GetCallsign(id);
+
 			// Check if valid
-			CRadarTarget target = GetPlugIn()->RadarTargetSelect(idx->first.c_str());
+			CRadarTarget target = GetPlugIn()->RadarTargetSelect(callsign.c_str());
 			bool isValid = CUtils::IsAircraftRelevant(this, &target, menuBar->IsButtonPressed(CMenuBar::BTN_ALL));
 			if (!target.IsValid() || !isValid) { // If not valid
 				// Erase aircraft selections if they are an asel
-				if (idx->first == aircraftSel1 || idx->first == aircraftSel2) { // We need to annul the selection and disable tool if activated
+				if (callsign == aircraftSel1 || callsign == aircraftSel2) { // We need to annul the selection and disable tool if activated
 					aircraftSel1 = "";
 					// Reset RBL (if active)
 					if (menuBar->IsButtonPressed(CMenuBar::BTN_RBL)) {
 						menuBar->SetButtonState(CMenuBar::BTN_RBL, CInputState::INACTIVE);
-						CLogger::Log(CLogType::NORM, "Resetting RBL tool.", "CRadarDisplay::OnRefresh");
+						CLogger::Log(CLogType::NORM, "Resetting RBL tool.", "CRadarDisplay::UpdateFrame");
 					}
 					// Reset SEP (if active)
 					if (menuBar->IsButtonPressed(CMenuBar::BTN_SEP)) {
-						CLogger::Log(CLogType::NORM, "Resetting SEP tool.", "CRadarDisplay::OnRefresh");
+						CLogger::Log(CLogType::NORM, "Resetting SEP tool.", "CRadarDisplay::UpdateFrame");
 						menuBar->SetButtonState(CMenuBar::BTN_SEP, CInputState::INACTIVE);
 					}
 					// Reset PIV (if active)
 					if (menuBar->IsButtonPressed(CMenuBar::BTN_PIV)) {
-						CLogger::Log(CLogType::NORM, "Resetting PIV tool.", "CRadarDisplay::OnRefresh");
+						CLogger::Log(CLogType::NORM, "Resetting PIV tool.", "CRadarDisplay::UpdateFrame");
 						menuBar->SetButtonState(CMenuBar::BTN_PIV, CInputState::INACTIVE);
 					}
 				}
 				// Erase ASEL
-				if (idx->first == asel) {
+				if (callsign == asel) {
 					asel = "";
 				}
 
@@ -206,8 +710,8 @@ void CRadarDisplay::OnRefresh(HDC hDC, int Phase)
 				auto jdx = CConflictDetection::CurrentSTCA.begin();
 				// Loop this way to avoid a vector overflow
 				while (jdx != CConflictDetection::CurrentSTCA.end()) {
-					if (idx->first == jdx->CallsignA || idx->first == jdx->CallsignB) {
-						CLogger::Log(CLogType::NORM, "Erasing STCA for " + idx->first + ".", "CRadarDisplay::OnRefresh");
+					if (id == jdx->IdA || id == jdx->IdB) {
+						CLogger::Log(CLogType::NORM, "Erasing STCA for " + callsign + ".", "CRadarDisplay::UpdateFrame");
 						jdx = CConflictDetection::CurrentSTCA.erase(jdx);						
 					}
 					else {
@@ -219,8 +723,8 @@ void CRadarDisplay::OnRefresh(HDC hDC, int Phase)
 				auto kdx = CRoutesHelper::ActiveRoutes.begin();
 				// Loop this way to avoid a vector overflow
 				while (kdx != CRoutesHelper::ActiveRoutes.end()) {
-					if (idx->first == *kdx || idx->first == *kdx) {
-						CLogger::Log(CLogType::NORM, "Erasing route for " + idx->first + ".", "CRadarDisplay::OnRefresh");
+					if (callsign == *kdx) {
+						CLogger::Log(CLogType::NORM, "Erasing route for " + callsign + ".", "CRadarDisplay::UpdateFrame");
 						kdx = CRoutesHelper::ActiveRoutes.erase(kdx);						
 					}
 					else {
@@ -228,27 +732,27 @@ void CRadarDisplay::OnRefresh(HDC hDC, int Phase)
 					}
 				}
 
-				if (CDataHandler::GetFlightData(idx->first)->IsValid) {
-					CLogger::Log(CLogType::NORM, "Deleting flight data for " + idx->first + ".", "CRadarDisplay::OnRefresh");
-					CDataHandler::DeleteFlightData(idx->first);					
+				if (CDataHandler::FlightExists(callsign)) {
+					CLogger::Log(CLogType::NORM, "Deleting flight data for " + callsign + ".", "CRadarDisplay::UpdateFrame");
+					CDataHandler::DeleteFlightData(callsign);					
 				}
 
 				// Erase flight plan window
 				menuBar->SetButtonState(menuBar->BTN_FLIGHTPLAN, CInputState::DISABLED);
 
 				// Finally erase the on screen reference
-				CLogger::Log(CLogType::NORM, "Erasing reference for " + idx->first + ".", "CRadarDisplay");
-				idx = aircraftOnScreen.erase(idx);
-			}
-			else {
-				++idx; // We increment here to avoid a vector overflow
+				CLogger::Log(CLogType::NORM, "Erasing reference for " + callsign + ".", "CRadarDisplay");
+				aircraftOnScreen.Erase(id);
 			}
 		}
 	}
 
+	maintenanceProfile.Stop();
+
 	// Redo the PIV calculations every 5 seconds
-	if (fiveSecT >= 5 && menuBar->IsButtonPressed(CMenuBar::BTN_PIV)) {
-		CLogger::Log(CLogType::NORM, "Recalculating PIV between " + aircraftSel1 + " and " + aircraftSel2 + ".", "CRadarDisplay::OnRefresh");
+	if (isFiveSecondCycle && menuBar->IsButtonPressed(CMenuBar::BTN_PIV)) {
+		CFrameProfiler::CScope pivProfile(PRF_CONFLICT);
+		CLogger::Log(CLogType::NORM, "Recalculating PIV between " + aircraftSel1 + " and " + aircraftSel2 + ".", "CRadarDisplay::UpdateFrame");
 		try {
 			CConflictDetection::PIVLocations1.clear();
 			CConflictDetection::PIVLocations2.clear();
@@ -256,391 +760,15 @@ void CRadarDisplay::OnRefresh(HDC hDC, int Phase)
 			CConflictDetection::PIVTool(this, aircraftSel1, aircraftSel2);
 		}
 		catch (exception & ex) {
-			CLogger::Log(CLogType::ERR, "An error occurred when trying to recalculate PIV. " + string(ex.what()), "CRadarDisplay::OnRefresh");
+			CLogger::Log(CLogType::ERR, "An error occurred when trying to recalculate PIV. " + string(ex.what()), "CRadarDisplay::UpdateFrame");
 		}
 		
 	}
 
-	// Check if the altitude filter is on
-	bool altFiltEnabled = false;
-	if (menuBar->IsButtonPressed(CMenuBar::BTN_ALTFILT)) altFiltEnabled = true;
-
-	// Get the radar area
-	CRect RadarArea(GetRadarArea());
-	RadarArea.top = RadarArea.top - 1;
-	RadarArea.bottom = GetChatArea().bottom;
-
-	if (Phase == REFRESH_PHASE_BEFORE_TAGS) {
-		/// Write current lat lon on screen
-		int sDC = dc.SaveDC();
-		// Select font
-		FontSelector::SelectMonoFont(12, &dc);
-		dc.SetTextColor(TextWhite.ToCOLORREF());
-		dc.SetTextAlign(TA_LEFT);
-		// Get radar area and lat lon
-		CRect radarBounds = this->GetRadarArea();
-		dc.TextOutA(radarBounds.right - 185, radarBounds.bottom - dc.GetTextExtent("ABC").cy - 2, 
-			CUtils::GetLatLonString(&appCursor->latLonPosition).c_str());
-		dc.RestoreDC(sDC);
-
-		// Draw overlays if enabled
-		if (menuBar->IsButtonPressed(CMenuBar::BTN_OVERLAYS)) {
-			COverlays::ShowCurrentOverlay(&dc, &g, this, menuBar);
-		}
-
-		// Get first aircraft
-		CRadarTarget ac;
-		ac = GetPlugIn()->RadarTargetSelectFirst();
-
-		// Get entry time and direction
-		int entryMinutes;
-		bool direction;
-
-		// Draw routes
-		if (CRoutesHelper::ActiveRoutes.size() != CRoutesHelper::ActiveRoutes.empty() && CRoutesHelper::ActiveRoutes.size() != 0) {
-			CCommonRenders::RenderRoutes(&dc, &g, this);
-		}
-
-		// Loop all aircraft
-		while (ac.IsValid()) {
-			// The system plan
-			CAircraftFlightPlan aircraftFlightPlan;
-			CDataHandler::GetFlightData(cs.c_str(), aircraftFlightPlan);
-
-			// Flight plan
-			CFlightPlan fp = GetPlugIn()->FlightPlanSelect(ac.GetCallsign());
-
-			// Route
-			CFlightPlanExtractedRoute rte = fp.GetExtractedRoute();
-
-			// Time and direction
-			entryMinutes = fp.GetSectorEntryMinutes();
-			direction = CUtils::GetAircraftDirection(ac.GetPosition().GetReportedHeading());
-			
-			//string debug = string(ac.GetCallsign()) + ":" + to_string(entryMinutes) + ":" + to_string(direction) + ":" + to_string(aircraftFlightPlan.ExitTime) + ":" + to_string(CUtils::GetTargetModeInt(ac.GetPosition().GetRadarFlags())) + "\n";
-
-			//CLogger::LogAircraftDebugInfo(debug);
-
-			// Check if they are a selected aircraft
-			if (ac.GetCallsign() == CAcTargets::SearchedAircraft) {
-				if (((double)(clock() - CAcTargets::fiveSecondTimer) / ((double)CLOCKS_PER_SEC)) >= 5) {
-					CAcTargets::SearchedAircraft = "";
-					CAcTargets::fiveSecondTimer = clock();
-				}
-				else {
-					CAcTargets::RenderSelectionHalo(&g, this, &ac);
-				}
-			}
-
-			// If PSSR button not pressed
-			/*if (!menuBar->IsButtonPressed(CMenuBar::BTN_PSSR)) {
-				// Check their PSSR state to hide all non ADS-B aircraft
-				if (CUtils::GetTargetMode(ac.GetPosition().GetRadarFlags()) != CRadarTargetMode::ADS_B) {
-					// Select the next target
-					ac = GetPlugIn()->RadarTargetSelectNext(ac);
-					if (aircraftOnScreen.find(ac.GetCallsign()) != aircraftOnScreen.end()) aircraftOnScreen.erase(ac.GetCallsign());
-					continue;
-				}
-			}*/
-
-			// Check their altitude, if they are outside the filter, skip them
-			if (altFiltEnabled && !menuBar->IsButtonPressed(CMenuBar::BTN_ALL)) {
-				if (ac.GetPosition().GetPressureAltitude() / 100 < CUtils::AltFiltLow || ac.GetPosition().GetPressureAltitude() / 100 > CUtils::AltFiltHigh) {
-					// Select the next target
-					ac = GetPlugIn()->RadarTargetSelectNext(ac);
-					if (aircraftOnScreen.find(ac.GetCallsign()) != aircraftOnScreen.end()) aircraftOnScreen.erase(ac.GetCallsign());
-					continue;
-				}
-			}
-
-			// Check track filtering
-			if (menuBar->GetButtonState(menuBar->BTN_TCKCTRL) == CInputState::ACTIVE && !menuBar->IsButtonPressed(CMenuBar::BTN_ALL)) {
-				// Primed plan
-				string cs = (string)fp.GetCallsign();
-				vector<string> tracks;
-				auto idx = find_if(CConflictDetection::CurrentSTCA.begin(), CConflictDetection::CurrentSTCA.end(), [&cs](const CSTCAStatus& obj) {return obj.CallsignA == cs || obj.CallsignB == cs; });
-				if (idx == CConflictDetection::CurrentSTCA.end())
-					menuBar->GetSelectedTracks(tracks);
-				bool skipAircraft = tracks.empty() ? false : true;
-				for (int i = 0; i < tracks.size(); i++) {
-					if (aircraftFlightPlan.IsValid) {
-						bool showAc = aircraftFlightPlan.Track == tracks[i];
-						if (showAc) {
-							skipAircraft = false;
-							break;
-						}						
-					}
-					else if (CRoutesHelper::OnNatTrack(this, string(fp.GetCallsign())) == tracks[i]) {
-						skipAircraft = false;
-						break;
-					}
-					else {
-						continue;
-					}
-				}
-
-				if (skipAircraft) {
-					// Select the next target
-					ac = GetPlugIn()->RadarTargetSelectNext(ac);
-					continue;
-				}
-			}
-			
-			// Parse inbound & other
-			bool filtersDisabled = menuBar->IsButtonPressed(CMenuBar::BTN_ALL);
-			if (CUtils::IsAircraftRelevant(this, &ac, filtersDisabled)) {
-				
-				// If not there then add the status
-				if (tagStatuses.find(fp.GetCallsign()) == tagStatuses.end()) {
-					pair<bool, POINT> pt = make_pair(false, POINT{ 0, 0 });
-					tagStatuses.insert(make_pair(string(fp.GetCallsign()), pt));
-				}
-
-				// STCA
-				if (tenSecT >= 10) {
-					CConflictDetection::CheckSTCA(this, &ac, &aircraftOnScreen);
-				}
-
-				if (fiveSecT >= 5) {
-					// If going westbound
-					if (!direction && entryMinutes > 0) {
-						if (menuBar->GetDropDownValue(CMenuBar::DRP_AREASEL) == "CZQX") {
-							int i;
-							for (i = 0; i < rte.GetPointsNumber(); i++) {
-								// Find out if 30 west is in their flight plan
-								if (rte.GetPointPosition(i).m_Longitude == -30.0) {
-									// Test flight time
-									if (rte.GetPointDistanceInMinutes(i) > 0 && rte.GetPointDistanceInMinutes(i) < 60) {
-										// Add if within
-										inboundList->AircraftList.push_back(CInboundAircraft(ac.GetCallsign(), fp.GetFinalAltitude(), fp.GetClearedAltitude(),
-												rte.GetPointName(i), CUtils::ParseZuluTime(false, -1, &fp, i), fp.GetFlightPlanData().GetDestination(), false));
-										break;
-									}
-								}
-							}
-							if (i == rte.GetPointsNumber()) {
-								// Add to 'others' list
-								otherList->AircraftList.push_back(ac.GetCallsign());
-							}
-						}
-						else {
-							int i;
-							for (i = 0; i < rte.GetPointsNumber(); i++) {
-								// They are coming from land so check entry points
-								if (CUtils::IsEntryPoint(rte.GetPointName(i), direction) || CUtils::IsExitPoint(rte.GetPointName(i), direction)) {
-									// Add if within
-									inboundList->AircraftList.push_back(CInboundAircraft(ac.GetCallsign(), fp.GetFinalAltitude(), fp.GetClearedAltitude(),
-										rte.GetPointName(i), CUtils::ParseZuluTime(false, -1, &fp, i), fp.GetFlightPlanData().GetDestination(), false));
-									break;
-								}
-							}
-							if (i == rte.GetPointsNumber()) {
-								// Add to 'others' list
-								otherList->AircraftList.push_back(ac.GetCallsign());
-							}
-						}
-					}
-					else if (direction && entryMinutes > 0) {
-						if (menuBar->GetDropDownValue(CMenuBar::DRP_AREASEL) == "EGGX") {
-							int i;
-							for (i = 0; i < rte.GetPointsNumber(); i++) {
-								// Find out if 30 west is in their flight plan
-								if (rte.GetPointPosition(i).m_Longitude == -30.0) {
-									// Test flight time
-									if (rte.GetPointDistanceInMinutes(i) > 0 && rte.GetPointDistanceInMinutes(i) < 60) {
-										// Add if within
-										inboundList->AircraftList.push_back(CInboundAircraft(ac.GetCallsign(), fp.GetFinalAltitude(), fp.GetClearedAltitude(),
-											rte.GetPointName(i), CUtils::ParseZuluTime(false, -1, &fp, i), fp.GetFlightPlanData().GetDestination(), true));
-										break;
-									}
-								}
-							}
-							if (i == rte.GetPointsNumber()) {
-								// Add to 'others' list
-								otherList->AircraftList.push_back(ac.GetCallsign());
-							}
-						}
-						else {
-							// They are coming from land so check entry points
-							int i;
-							for (i = 0; i < rte.GetPointsNumber(); i++) {
-								if (CUtils::IsEntryPoint(rte.GetPointName(i), direction) || CUtils::IsExitPoint(rte.GetPointName(i), direction)) {
-									// Add if within
-									inboundList->AircraftList.push_back(CInboundAircraft(ac.GetCallsign(), fp.GetFinalAltitude(), fp.GetClearedAltitude(),
-										rte.GetPointName(i), CUtils::ParseZuluTime(false, -1, &fp, i), fp.GetFlightPlanData().GetDestination(), true));
-									break;
-								}
-							}
-							if (i == rte.GetPointsNumber()) {
-								// Add to 'others' list
-								otherList->AircraftList.push_back(ac.GetCallsign());
-							}
-						}
-					}
-				}
-
-				// Store whether detailed tags are enabled
-				bool detailedEnabled = false;
-
-				// Now we check if all the tags are selected as detailed
-				if (menuBar->IsButtonPressed(CMenuBar::BTN_EXT)) {
-					detailedEnabled = true; // Set detailed on
-
-					// Unpress detailed if not already
-					if (menuBar->IsButtonPressed(CMenuBar::BTN_DETAILED) && !aselDetailed) {
-						menuBar->SetButtonState(CMenuBar::BTN_DETAILED, CInputState::INACTIVE);
-					}
-				}
-
-				// Check if only one is set to detailed
-				if (menuBar->IsButtonPressed(CMenuBar::BTN_DETAILED)) {
-					if (fp.GetCallsign() == asel) {
-						detailedEnabled = true; // Set detailed on
-					}
-
-					// Unpress extended if not already
-					if (menuBar->IsButtonPressed(CMenuBar::BTN_EXT) && aselDetailed) {
-						menuBar->SetButtonState(CMenuBar::BTN_EXT, CInputState::INACTIVE);
-					}
-				}
-
-				bool ptl = false;
-				bool halo = false;
-				// Set PTL and HALO if they are on
-				if (menuBar->IsButtonPressed(CMenuBar::BTN_PTL)) {
-					ptl = true;
-				}
-				if (menuBar->IsButtonPressed(CMenuBar::BTN_HALO)) {
-					halo = true;
-				}
-
-				// Get STCA so it can be drawn
-				CSTCAStatus stcaStatus(ac.GetCallsign(), "", CConflictStatus::OK, -1, -1); // Create default
-				auto idx = CConflictDetection::CurrentSTCA.begin();
-				for (idx = CConflictDetection::CurrentSTCA.begin(); idx != CConflictDetection::CurrentSTCA.end(); idx++) {
-					if (ac.GetCallsign() == idx->CallsignA || ac.GetCallsign() == idx->CallsignB) {
-						stcaStatus = *idx;
-						break; // Break for optimisation
-					}
-				}
-
-				// Draw the tag and target with the information if tags are turned on and within altitude filter
-				if (menuBar->IsButtonPressed(CMenuBar::BTN_TAGS)) {
-					if (aircraftOnScreen.find(ac.GetCallsign()) == aircraftOnScreen.end()) aircraftOnScreen.insert(make_pair(ac.GetCallsign(), 0));
-					auto kv = tagStatuses.find(fp.GetCallsign());
-					kv->second.first = detailedEnabled; // Set detailed on
-					CAcTargets::RenderTarget(&g, &dc, this, &ac, true, &menuBar->GetToggleButtons(), halo, ptl, &stcaStatus);
-					POINT tagPosition = CAcTargets::RenderTag(&g, &dc, this, &ac, &kv->second, direction, &stcaStatus, asel);
-
-					// If tracking dialog open
-					if (CAcTargets::OpenTrackingDialog != "" && CAcTargets::OpenTrackingDialog == ac.GetCallsign()) {
-						CAcTargets::RenderCoordTagItem(&dc, this, ac.GetCallsign(), tagPosition);
-					}
-
-				}
-				else {
-					if (aircraftOnScreen.find(ac.GetCallsign()) == aircraftOnScreen.end()) aircraftOnScreen.insert(make_pair(ac.GetCallsign(), 0));
-					CAcTargets::RenderTarget(&g, &dc, this, &ac, false, &menuBar->GetToggleButtons(), halo, ptl, &stcaStatus);
-				}
-			}
-			else { // If not there, and the aircraft was on the screen, then delete
-				if (aircraftOnScreen.find(ac.GetCallsign()) != aircraftOnScreen.end()) aircraftOnScreen.erase(ac.GetCallsign());
-			}
-
-			// Select the next target
-			ac = GetPlugIn()->RadarTargetSelectNext(ac);
-		}
-
-
-		// Clear ASELs if none of the range/separation tools are pressed
-		if (!menuBar->IsButtonPressed(CMenuBar::BTN_PIV)
-			&& !menuBar->IsButtonPressed(CMenuBar::BTN_RBL)
-			&& !menuBar->IsButtonPressed(CMenuBar::BTN_SEP)) {
-			// Reset ASELs if none enabled
-			aircraftSel1 = "";
-			aircraftSel2 = "";
-		}
-
-		/// RENDERING
-		// Draw menu bar
-		menuBar->RenderBar(&dc, &g, this, asel);
-
-		// Draw lists
-		inboundList->RenderList(&g, &dc, this);
-		otherList->RenderList(&g, &dc, this);
-		//rclList->RenderList(&g, &dc, this);
-		conflictList->RenderList(&g, &dc, this);
-
-		// SEP draw
-		if (menuBar->IsButtonPressed(CMenuBar::BTN_SEP)) {
-			// If both aircraft selected then draw
-			if (aircraftSel1 != "" && aircraftSel2 != "") {
-				CConflictDetection::SepTool(&dc, &g, this, aircraftSel1, aircraftSel2);
-			}
-		}
-
-		// RBL draw
-		if (menuBar->IsButtonPressed(CMenuBar::BTN_RBL)) {
-			if (aircraftSel1 != "" && aircraftSel2 != "") {
-				CConflictDetection::RBLTool(&dc, &g, this, aircraftSel1, aircraftSel2);
-			}
-		}
-
-		// PIV draw
-		if (menuBar->IsButtonPressed(CMenuBar::BTN_PIV)) {
-			// If both aircraft selected then draw
-			if (aircraftSel1 != "" && aircraftSel2 != "") {
-				// Render
-				CConflictDetection::RenderPIV(&dc, &g, this, aircraftSel1, aircraftSel2);
-			}
-		}
-
-		// QDM draw
-		if (menuBar->IsButtonPressed(CMenuBar::BTN_QDM)) {
-			// Check if first position is set
-			if (RulerPoint1.m_Latitude != 0.0 && RulerPoint1.m_Longitude != 0.0) {
-				// Render
-				CCommonRenders::RenderQDM(&dc, &g, this, &RulerPoint1, &RulerPoint2, appCursor->position, &appCursor->latLonPosition);
-			}
-		}
-
-		// Draw track info window if button pressed
-		if (menuBar->IsButtonPressed(CMenuBar::BTN_TCKINFO)) {
-			trackWindow->RenderWindow(&dc, &g, this, menuBar);
-		}
-
-		// Draw message window if button pressed
-		if (menuBar->IsButtonPressed(CMenuBar::BTN_MESSAGE)) {
-			msgWindow->RenderWindow(&dc, &g, this);
-		}
-
-		// Draw flight plan window if button pressed
-		if (menuBar->IsButtonPressed(CMenuBar::BTN_FLIGHTPLAN)) {
-			fltPlnWindow->RenderWindow(&dc, &g, this);
-		}
-
-		// Draw notepad window if button pressed
-		if (menuBar->IsButtonPressed(CMenuBar::BTN_NOTEPAD)) {
-			npWindow->RenderWindow(&dc, &g, this);
-		}
-
-		// Finally, reset the clocks if time has been exceeded
-		if (fiveSecT >= 5) {
-			fiveSecondTimer = clock();
-		}
-		if (tenSecT >= 10) {
-			CLogger::Log(CLogType::NORM, "Recalculating STCA.", "CRadarDisplay::OnRefresh");
-			tenSecondTimer = clock();
-		}
-		if (double twoSecT = (double)(clock() - CAcTargets::twoSecondTimer) / ((double)CLOCKS_PER_SEC) >= 2.2) { // Ac target and tag colours
-			CAcTargets::twoSecondTimer = clock();
-		}
+	// Sync with the vNAAATS network
+	if (isFiveSecondCycle) {
+		CDataHandler::SyncNetworkAircraft();
 	}
-
-	// De-allocation
-	dc.Detach();
-	g.ReleaseHDC(hDC);
-	dc.DeleteDC();
 }
 
 // Data updates
@@ -663,26 +791,19 @@ void CRadarDisplay::OnRadarTargetPositionUpdate(CRadarTarget RadarTarget)
 
 			// Update exit time
 			int exitMinutes = fpData.GetSectorExitMinutes();
-			if (exitMinutes != -1) {
+			if (exitMinutes != -1 && fp->ExitTime != exitMinutes) {
 				fp->ExitTime = exitMinutes;
+				CDataHandler::MarkFlightChanged(fp->Callsign);
 			}
 
 			// Update selcal code (maybe move into an Update method in DataHandler if I find there is more to update than just the selcal code)
-			string selcal = CUtils::GetSelcalCode(&fpData);
-			fp->SELCAL = selcal != "" ? selcal : "N/A";
-
-			// Download the vNAAATS network data on the plane
-			try {
-				CLogger::Log(CLogType::NORM, "Polling vNAAATS network to update " + string(RadarTarget.GetCallsign()), "CRadarDisplay::OnRadarTargetPositionUpdate");
-				CUtils::CNetworkAsyncData* data = new CUtils::CNetworkAsyncData();
-				data->Screen = this;
-				data->Callsign = fp->Callsign;
-				if (!fp->IsFirstUpdate) fp->IsFirstUpdate = true;
-				_beginthread(CDataHandler::DownloadNetworkAircraft, 0, (void*)data); // Async
+			const string& selcal = CTextCache::Selcal(CCallsignTable::Intern(RadarTarget.GetCallsign()), fpData.GetFlightPlanData().GetRemarks());
+			if (fp->SELCAL != selcal) {
+				fp->SELCAL = selcal;
+				CDataHandler::MarkFlightChanged(fp->Callsign);
 			}
-			catch (std::exception & ex) {
-				CLogger::DebugLog(this, "An exception occurred. " + *ex.what());
-			}			
+
+			// vNAAATS network data arrives with the bulk sync in OnRefresh
 
 			// Timer
 			double thirtySecT = (double)(clock() - thirtySecondTimer) / ((double)CLOCKS_PER_SEC);
@@ -704,10 +825,12 @@ void CRadarDisplay::OnRadarTargetPositionUpdate(CRadarTarget RadarTarget)
 						if (fpData.GetControllerAssignedData().GetAssignedMach() / 10 != stoi(fp->Mach)) {
 							// Assign
 							fp->Mach = to_string(fpData.GetControllerAssignedData().GetAssignedMach() / 10);
+							CDataHandler::MarkFlightChanged(fp->Callsign);
 						}
 						if (fpData.GetControllerAssignedData().GetFinalAltitude() / 100 != stoi(fp->FlightLevel)) {
 							// Assign
 							fp->FlightLevel = to_string(fpData.GetControllerAssignedData().GetFinalAltitude() / 100);
+							CDataHandler::MarkFlightChanged(fp->Callsign);
 						}
 					}
 				}				
@@ -741,19 +864,16 @@ void CRadarDisplay::OnRadarTargetPositionUpdate(CRadarTarget RadarTarget)
 					netFP->Route = ""; // Initialise
 					netFP->RouteEtas = ""; // Initialise
 
-					// Post data to the database
-					DWORD activeCode;
-					HANDLE hnd = CUtils::GetESProcess();
-					GetExitCodeProcess(hnd, &activeCode);
-					// Check if the app is still active
-					if (activeCode == STILL_ACTIVE && GetPlugIn()->ControllerMyself().IsValid()) {
+					// Post data to the database (nothing goes out once the plugin is unloading)
+					if (!CLifecycle::IsShuttingDown() && GetPlugIn()->ControllerMyself().IsValid()) {
 						if (netFP->Relevant != fp->IsRelevant) {
 							fp->IsRelevant = netFP->Relevant;
+							CDataHandler::MarkFlightChanged(fp->Callsign);
 							CUtils::CNetworkAsyncData* newData = new CUtils::CNetworkAsyncData();
 							newData->Screen = this;
 							newData->Callsign = fp->Callsign;
 							newData->FP = netFP;
-							_beginthread(CDataHandler::UpdateNetworkAircraft, 0, (void*)newData); // Async
+							CDataHandler::UpdateNetworkAircraft((void*)newData); // Queued on the outbound queue
 						}
 					}
 				}
@@ -777,7 +897,15 @@ void CRadarDisplay::OnRadarTargetPositionUpdate(CRadarTarget RadarTarget)
 	}
 }
 
+void CRadarDisplay::OnFlightPlanFlightPlanDataUpdate(CFlightPlan FlightPlan) {
+	// Filed route may have been amended so work out the track again
+	CRoutesHelper::UpdateNatTrack(this, FlightPlan.GetCallsign());
+}
+
 void CRadarDisplay::OnFlightPlanDisconnect(CFlightPlan FlightPlan) {
+	// Remove the cached track
+	CRoutesHelper::ClearNatTrack(FlightPlan.GetCallsign());
+
 	// Close the flight plan window immediately and cancel the ASEL so that we don't get a crash
 	if (FlightPlan.GetCallsign() == asel) {
 		menuBar->SetButtonState(CMenuBar::BTN_FLIGHTPLAN, CInputState::INACTIVE);
@@ -840,19 +968,16 @@ void CRadarDisplay::OnFlightPlanDisconnect(CFlightPlan FlightPlan) {
 					}
 				}
 
-				// Post data to the database
-				DWORD activeCode;
-				HANDLE hnd = CUtils::GetESProcess();
-				GetExitCodeProcess(hnd, &activeCode);
-				// Check if the app is still active
-				if (activeCode == STILL_ACTIVE && GetPlugIn()->ControllerMyself().IsValid()) {
+				// Post data to the database (nothing goes out once the plugin is unloading)
+				if (!CLifecycle::IsShuttingDown() && GetPlugIn()->ControllerMyself().IsValid()) {
 					if (netFP->Relevant != primedPlan->IsRelevant) {
 						primedPlan->IsRelevant = netFP->Relevant;
+						CDataHandler::MarkFlightChanged(primedPlan->Callsign);
 						CUtils::CNetworkAsyncData* newData = new CUtils::CNetworkAsyncData();
 						newData->Screen = this;
 						newData->Callsign = primedPlan->Callsign;
 						newData->FP = netFP;
-						_beginthread(CDataHandler::UpdateNetworkAircraft, 0, (void*)newData); // Async
+						CDataHandler::UpdateNetworkAircraft((void*)newData); // Queued on the outbound queue
 					}
 				}
 			}
@@ -901,9 +1026,9 @@ void CRadarDisplay::OnMoveScreenObject(int ObjectType, const char* sObjectId, PO
 
 	// Move tag
 	if (ObjectType == SCREEN_TAG || ObjectType == SCREEN_TAG_CS) {
-		auto kv = tagStatuses.find(sObjectId);
+		pair<bool, POINT>* tagStatus = GetTagStatus(CCallsignTable::Intern(sObjectId));
 		POINT acPosPix = ConvertCoordFromPositionToPixel(GetPlugIn()->RadarTargetSelect(sObjectId).GetPosition().GetPosition());
-		kv->second.second = { Area.left - acPosPix.x, Area.top - acPosPix.y };
+		tagStatus->second = { Area.left - acPosPix.x, Area.top - acPosPix.y };
 	}
 
 	// Move window
@@ -1035,10 +1160,10 @@ void CRadarDisplay::OnClickScreenObject(int ObjectType, const char* sObjectId, P
 				|| menuBar->IsButtonPressed(CMenuBar::BTN_RBL)
 				|| menuBar->IsButtonPressed(CMenuBar::BTN_SEP)) {
 				// Make sure flight plans are valid
-				if (aircraftSel1 == "" && CDataHandler::GetFlightData(asel)->IsValid) {
+				if (aircraftSel1 == "" && CDataHandler::FlightExists(asel)) {
 					aircraftSel1 = asel;
 				}
-				else if (aircraftSel2 == "" && aircraftSel1 != asel && CDataHandler::GetFlightData(asel)->IsValid) {
+				else if (aircraftSel2 == "" && aircraftSel1 != asel && CDataHandler::FlightExists(asel)) {
 					aircraftSel2 = asel;
 				}
 			}
@@ -1192,7 +1317,7 @@ void CRadarDisplay::OnClickScreenObject(int ObjectType, const char* sObjectId, P
 		if (ObjectType == SCREEN_TAG || ObjectType == SCREEN_TAG_CS) {
 			/// Set route drawing
 			// Make sure flight plan exists otherwise it will crash, and also that they aren't PIV aircraft
-			if (CDataHandler::GetFlightData(string(sObjectId))->IsValid && string(sObjectId) != aircraftSel1 && string(sObjectId) != aircraftSel2) {
+			if (CDataHandler::FlightExists(string(sObjectId)) && string(sObjectId) != aircraftSel1 && string(sObjectId) != aircraftSel2) {
 				int found = -1; // Found flag so we can remove if needed
 				for (int i = 0; i < CRoutesHelper::ActiveRoutes.size(); i++) {
 					// If the route is currently on the screen
@@ -1271,6 +1396,9 @@ void CRadarDisplay::OnButtonUpScreenObject(int ObjectType, const char* sObjectId
 		}
 		if (atoi(sObjectId) < 200) {
 			fltPlnWindow->ButtonUp(atoi(sObjectId), this);
+
+			// The window edits the flight data directly
+			if (fltPlnWindow->primedPlan != nullptr) CDataHandler::MarkFlightChanged(fltPlnWindow->primedPlan->Callsign);
 		}
 	}
 
@@ -1300,6 +1428,7 @@ void CRadarDisplay::OnButtonUpScreenObject(int ObjectType, const char* sObjectId
 		}
 		if (atoi(sObjectId) == CMenuBar::BTN_AUTOTAG) {
 			tagStatuses.clear();
+			declutter.Reset();
 		}
 		menuBar->ButtonDown(atoi(sObjectId));
 	}
@@ -1353,6 +1482,9 @@ void CRadarDisplay::OnFunctionCall(int FunctionId, const char* sItemString, POIN
 	// If it is a flight plan window text input
 	if (fltPlnWindow->IsTextInput(FunctionId)) {
 		fltPlnWindow->SetTextValue(this, FunctionId, string(sItemString));
+
+		// The window edits the flight data directly
+		if (fltPlnWindow->primedPlan != nullptr) CDataHandler::MarkFlightChanged(fltPlnWindow->primedPlan->Callsign);
 	}
 }
 
@@ -1398,42 +1530,120 @@ void CRadarDisplay::OnAsrContentLoaded(bool Loaded)
 }
 
 // TODO: Break into individual methods or create ScreenFunctions class/namespace
+bool CRadarDisplay::OnCompileCommand(const char* sCommandLine)
+{
+	// Toggle the diagnostics view
+	if (!_stricmp(sCommandLine, ".vnaaats diag")) {
+		CDiagnostics::IsVisible = !CDiagnostics::IsVisible;
+		RequestRefresh();
+		return true;
+	}
+
+	// Toggle the frame profiler
+	if (!_stricmp(sCommandLine, ".vnaaats prof")) {
+		CFrameProfiler::IsEnabled = !CFrameProfiler::IsEnabled;
+		CFrameProfiler::Reset();
+		RequestRefresh();
+		return true;
+	}
+
+	return false;
+}
+
+pair<bool, POINT>* CRadarDisplay::GetTagStatus(int id) {
+	// Grow to fit, new tags are not detailed and haven't been dragged
+	if (id >= (int)tagStatuses.size()) {
+		tagStatuses.resize(id + 1, make_pair(false, POINT{ 0, 0 }));
+	}
+	return &tagStatuses[id];
+}
+
+void CRadarDisplay::UpdateCursor() {
+	// Take the latest sample and clicks, hand over the radar area
+	POINT position;
+	vector<POINT> clicks;
+	{
+		lock_guard<mutex> lock(appCursor->lock);
+		appCursor->radarArea = GetRadarArea();
+		position = appCursor->sampled;
+		clicks.swap(appCursor->clicks);
+	}
+
+	// Lat/lon only worked out again when the cursor has moved
+	if (position.x != appCursor->position.x || position.y != appCursor->position.y) {
+		appCursor->position = position;
+		appCursor->latLonPosition = ConvertCoordFromPixelToPosition(position);
+	}
+
+	// Clicks only mean something to the QDM tool
+	for (const POINT& click : clicks) {
+		if (!menuBar->IsButtonPressed(CMenuBar::BTN_QDM)) {
+			break;
+		}
+		CPosition clickPosition = ConvertCoordFromPixelToPosition(click);
+
+		bool pointSet = false;
+		// Activate QDM, first check if first ruler point already filled
+		if (RulerPoint1.m_Latitude == 0.0 && RulerPoint1.m_Longitude == 0.0) {
+			// It isn't filled so set it
+			RulerPoint1 = clickPosition;
+
+			// So that we don't accidently set the 2nd point at the same time
+			pointSet = true;
+		}
+		// Check the 2nd point
+		if (!pointSet && (RulerPoint2.m_Latitude == 0.0 && RulerPoint2.m_Longitude == 0.0)) {
+			// It isn't filled so set it
+			RulerPoint2 = clickPosition;
+
+			// So we dont cancel the QDM automatically
+			pointSet = true;
+		}
+
+		// Both points are down so we need to reset
+		if (!pointSet && (RulerPoint2.m_Latitude != 0.0 && RulerPoint2.m_Longitude != 0.0)) {
+			RulerPoint1.m_Latitude = 0.0;
+			RulerPoint1.m_Longitude = 0.0;
+			RulerPoint2.m_Latitude = 0.0;
+			RulerPoint2.m_Longitude = 0.0;
+		}
+	}
+}
+
 void CRadarDisplay::CursorStateUpdater(void* args)
 {
 	// Pointer to cursor
 	CAppCursor* cursor = (CAppCursor*)args;
 
 	try {
-		// Timer
-		clock_t hundredmsTimer = clock();
+		// Timers
 		clock_t refreshTimer = clock();
+		clock_t statsTimer = clock();
+		double threadTime = CDiagnostics::GetThreadCpuTime();
+		int refreshRequests = 0;
 
 		// Monitor information for proper positioning
 		MONITORINFO monitorInfo;
 		monitorInfo.cbSize = sizeof(MONITORINFO);
 
-		// Get the process information - infinite loop in separate thread = bad unless you manually break the loop on application close
-		DWORD activeCode;
-		while (!cursor->isESClosed) {
-			HANDLE hnd = CUtils::GetESProcess();
-			GetExitCodeProcess(hnd, &activeCode);
-			// Check if the app is still active
-			if (cursor->isESClosed || activeCode != STILL_ACTIVE) {
-				CLogger::Log(CLogType::NORM, "ES quitting. Thread destroyed.");
-				break; // Break if not
-			}
-
-			// Ok so the app is still active let's get the cursor data
-			if (((double)(clock() - hundredmsTimer) / ((double)CLOCKS_PER_SEC)) >= 0.04) { // Greater than or equal to 40ms
-				// Get cursor position (only if previous cursor position is inside the radar area)
-				bool isCursorInsideRadarArea = false;
-				CRect radarArea = cursor->screen->GetRadarArea();
-
-				// Get the position and monitor in which the point lies
-				GetCursorPos(&cursor->position);
+		// Cursor state between samples
+		POINT rawPosition = { -1, -1 };
+		POINT position = { 0, 0 };
+		int button = 0;
+		bool isRefreshPending = false;
+
+		// Sample on a timer, sleeping on the tokens in between so an idle display costs nothing
+		while (!cursor->isClosed.Wait(CURSOR_INTERVAL, &CLifecycle::Token())) {
+			// Get the position, the relative position is only worked out again when the mouse has moved
+			POINT raw;
+			GetCursorPos(&raw);
+			bool isMoved = raw.x != rawPosition.x || raw.y != rawPosition.y;
+			if (isMoved) {
+				rawPosition = raw;
+				position = raw;
 
 				// Get the monitor
-				HMONITOR monitor = MonitorFromPoint(cursor->position, MONITOR_DEFAULTTONEAREST);
+				HMONITOR monitor = MonitorFromPoint(position, MONITOR_DEFAULTTONEAREST);
 				GetMonitorInfo(monitor, &monitorInfo);
 
 				// Get the monitor resolution
@@ -1441,113 +1651,96 @@ void CRadarDisplay::CursorStateUpdater(void* args)
 				int monResY = abs(monitorInfo.rcMonitor.top - monitorInfo.rcMonitor.bottom);
 
 				// Get the relative cursor position
-				if (cursor->position.x > monResX) { // greater than (x)
-					cursor->position.x = cursor->position.x % monResX;
+				if (position.x > monResX) { // greater than (x)
+					position.x = position.x % monResX;
 				}
-				if (cursor->position.y > monResY) { // greater than (y)
-					cursor->position.y = cursor->position.y % monResY;
+				if (position.y > monResY) { // greater than (y)
+					position.y = position.y % monResY;
 				}
-				if (cursor->position.x < 0) { // less than (x)
-					cursor->position.x = monResX - (abs(cursor->position.x) % monResX);
+				if (position.x < 0) { // less than (x)
+					position.x = monResX - (abs(position.x) % monResX);
 				}
-				if (cursor->position.y < 0) { // less than (y)
-					cursor->position.y = monResY - (abs(cursor->position.y) % monResY);
+				if (position.y < 0) { // less than (y)
+					position.y = monResY - (abs(position.y) % monResY);
 				}
+			}
+
+			// Get button presses
+			bool leftBtnPressed = (GetAsyncKeyState(VK_LBUTTON) & (1 << 15)) != 0;
+			bool rightBtnPressed = (GetAsyncKeyState(VK_RBUTTON) & (1 << 15)) != 0;
 
-				// Get button presses
-				bool leftBtnPressed = (GetAsyncKeyState(VK_LBUTTON) & (1 << 15)) != 0;
-				bool rightBtnPressed = (GetAsyncKeyState(VK_RBUTTON) & (1 << 15)) != 0;
+			{
+				lock_guard<mutex> lock(cursor->lock);
 
 				// Check if cursor inside radar area
-				if (cursor->position.x > radarArea.left&&
-					cursor->position.x < radarArea.right &&
-					cursor->position.y > radarArea.top + MENBAR_HEIGHT && // We want *our* radar screen so we add the vNAAATS menu bar height
-					cursor->position.y < radarArea.bottom) {
-					isCursorInsideRadarArea = true;
+				bool isCursorInsideRadarArea = position.x > cursor->radarArea.left &&
+					position.x < cursor->radarArea.right &&
+					position.y > cursor->radarArea.top + MENBAR_HEIGHT && // We want *our* radar screen so we add the vNAAATS menu bar height
+					position.y < cursor->radarArea.bottom;
+
+				// Moving over the radar area changes the lat/lon readout and the QDM line
+				if (isMoved) {
+					cursor->sampled = position;
+					if (isCursorInsideRadarArea) isRefreshPending = true;
 				}
 
-				// Lat/lon position
-				cursor->latLonPosition = cursor->screen->ConvertCoordFromPixelToPosition(cursor->position);
-
 				// Check button presses
 				if ((!leftBtnPressed && !rightBtnPressed) || !isCursorInsideRadarArea) {
-					cursor->button = 0;
+					button = 0;
 				}
 
 				/// Events!
-				// On left click
-				if (leftBtnPressed && cursor->button == 0) {
-					// QDM button
-					if (cursor->screen->menuBar->IsButtonPressed(CMenuBar::BTN_QDM) && isCursorInsideRadarArea) {
-						bool pointSet = false;
-						// Activate QDM, first check if first ruler point already filled
-						if (cursor->screen->RulerPoint1.m_Latitude == 0.0 && cursor->screen->RulerPoint1.m_Longitude == 0.0) {
-							// It isn't filled so set it
-							cursor->screen->RulerPoint1.m_Latitude = cursor->latLonPosition.m_Latitude;
-							cursor->screen->RulerPoint1.m_Longitude = cursor->latLonPosition.m_Longitude;
-
-							// So that we don't accidently set the 2nd point at the same time
-							pointSet = true;
-						}
-						// Check the 2nd point
-						if (!pointSet && (cursor->screen->RulerPoint2.m_Latitude == 0.0 && cursor->screen->RulerPoint2.m_Longitude == 0.0)) {
-							// It isn't filled so set it
-							cursor->screen->RulerPoint2.m_Latitude = cursor->latLonPosition.m_Latitude;
-							cursor->screen->RulerPoint2.m_Longitude = cursor->latLonPosition.m_Longitude;
-
-							// So we dont cancel the QDM automatically
-							pointSet = true;
-						}
-
-						// Both points are down so we need to reset
-						if (!pointSet && (cursor->screen->RulerPoint2.m_Latitude != 0.0 && cursor->screen->RulerPoint2.m_Longitude != 0.0)) {
-							cursor->screen->RulerPoint1.m_Latitude = 0.0;
-							cursor->screen->RulerPoint1.m_Longitude = 0.0;
-							cursor->screen->RulerPoint2.m_Latitude = 0.0;
-							cursor->screen->RulerPoint2.m_Longitude = 0.0;
-						}
+				// On left click, the UI thread works out what it was for
+				if (leftBtnPressed && button == 0) {
+					if (isCursorInsideRadarArea) {
+						cursor->clicks.push_back(position);
+						isRefreshPending = true;
 					}
 
 					// Set the button so the event doesn't fire again
-					cursor->button = 2;
+					button = 2;
 				}
 				// On right click
-				if (rightBtnPressed && cursor->button == 0) {
-
+				if (rightBtnPressed && button == 0) {
 					// Set the button so the event doesn't fire again
-					cursor->button = 1;
+					button = 1;
 				}
+			}
 
-				// Reset clock
-				hundredmsTimer = clock();
+			// Data from the worker threads waiting for a refresh to pick it up
+			if (!isRefreshPending && (CDataHandler::HasPendingChanges() || CRoutesHelper::HasDeferredRoutes() || COutboundQueue::IsDue())) {
+				isRefreshPending = true;
 			}
 
-			// Call refresh sequence more often
-			if (((double)(clock() - refreshTimer) / ((double)CLOCKS_PER_SEC)) >= cursor->screen->RefreshResolution) {
+			// Refresh only when something changed, at most once per refresh resolution
+			if (isRefreshPending && ((double)(clock() - refreshTimer) / ((double)CLOCKS_PER_SEC)) >= cursor->screen->RefreshResolution) {
 				// Refresh the radar screen
 				cursor->screen->RequestRefresh();
+				isRefreshPending = false;
+				refreshRequests++;
 
 				// Reset clock
 				refreshTimer = clock();
 			}
 
+			// Report the thread's own load once a second
+			double statsWindow = (double)(clock() - statsTimer) / ((double)CLOCKS_PER_SEC / 1000.0);
+			if (statsWindow >= 1000.0) {
+				double time = CDiagnostics::GetThreadCpuTime();
+				CDiagnostics::RecordCursorLoad((time - threadTime) / statsWindow * 100.0, refreshRequests / (statsWindow / 1000.0));
+				threadTime = time;
+				refreshRequests = 0;
+				statsTimer = clock();
+			}
 		}
 
-		// Check if the app is still active
-		if (cursor->isESClosed) {
-			CLogger::Log(CLogType::NORM, "ES quitting. Thread destroyed.");
-		}
-
-		
+		CLogger::Log(CLogType::NORM, "Display closing. Thread destroyed.", "CRadarDisplay::CursorStateUpdater");
 	}
 	catch (exception & ex) {
 		CLogger::DebugLog(cursor->screen, "An exception occurred in the CursorStateUpdater. " + *ex.what());
-		CLogger::Log(CLogType::ERR, "An error occurred. \nCursor position: " + to_string(cursor->latLonPosition.m_Latitude) + "," + to_string(cursor->latLonPosition.m_Longitude)
-			+ "\nRefresh Resolution: " + to_string(cursor->screen->RefreshResolution) + "\nVerbose details: " + *ex.what(), "CRadarDisplay::CursorStateUpdater");
+		CLogger::Log(CLogType::ERR, "An error occurred. \nRefresh Resolution: " + to_string(cursor->screen->RefreshResolution) + "\nVerbose details: " + *ex.what(), "CRadarDisplay::CursorStateUpdater");
 	}
 
-	// Clean up and return
-	delete args;
-
+	// The display deletes the cursor once the thread has been joined
 	return;
 }
\ No newline at end of file
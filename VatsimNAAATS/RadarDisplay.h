@@ -4,6 +4,7 @@
 #include <vector>
 #include <future>
 #include <thread>
+#include <mutex>
 #include "InboundList.h"
 #include "Structures.h"
 #include "OtherList.h"
@@ -15,6 +16,11 @@
 #include "TrackInfoWindow.h"
 #include "FlightPlanWindow.h"
 #include "MessageWindow.h"
+#include "CallsignTable.h"
+#include "Lifecycle.h"
+#include "TagDeclutter.h"
+#include "DrawList.h"
+#include "Overlays.h"
 
 using namespace std;
 using namespace EuroScopePlugIn;
@@ -38,6 +44,7 @@ class CRadarDisplay : public CRadarScreen
 		// Inherited methods
 		void OnRefresh(HDC hDC, int Phase);
 		void OnRadarTargetPositionUpdate(CRadarTarget RadarTarget);
+		void OnFlightPlanFlightPlanDataUpdate(CFlightPlan FlightPlan);
 		void OnFlightPlanDisconnect(CFlightPlan FlightPlan);
 		void OnMoveScreenObject(int ObjectType, const char* sObjectId, POINT Pt, RECT Area, bool Released);
 		void OnOverScreenObject(int ObjectType, const char* sObjectId, POINT Pt, RECT Area);
@@ -48,37 +55,66 @@ class CRadarDisplay : public CRadarScreen
 		void OnDoubleClickScreenObject(int ObjectType, const char* sObjectId, POINT Pt, RECT Area, int Button);
 		void OnAsrContentToBeSaved(void);
 		void OnAsrContentLoaded(bool Loaded);
+		bool OnCompileCommand(const char* sCommandLine);
 		static void CursorStateUpdater(void* args); // Asynchronous loop
 
 		inline void OnAsrContentToBeClosed(void)
 		{
 			// Manually call save
 			OnAsrContentToBeSaved();
-			appCursor->isESClosed = true;
+
+			// Stop the cursor thread for this display, the plugin may still have others open
+			appCursor->isClosed.Signal();
+
+			// EuroScope leaves freeing the display to us, the destructor joins the cursor thread
+			delete this;
 		}
 
 	private:
+		// Displays that are open, the work queued for one is moved to another when it closes (UI thread)
+		static vector<CRadarDisplay*> openDisplays;
+
+		// Tag status for a callsign id (detailed, offset the controller dragged it to)
+		pair<bool, POINT>* GetTagStatus(int id);
+
+		// Model update ahead of the drawing: worker data, lists, on screen set and timed cycles (once per frame)
+		void UpdateFrame();
+
+		// Pick up the cursor thread's samples and clicks (UI thread, start of each frame)
+		void UpdateCursor();
+
 		// Cursor position structure for async
 		struct CAppCursor {
 			CRadarDisplay* screen;
-			POINT position; // Screen coordinates
-			CPosition latLonPosition; // Lat lon
-			int button;
+			POINT position = { -1, -1 }; // Screen coordinates (UI thread)
+			CPosition latLonPosition; // Lat lon (UI thread)
 			clock_t singleClickTimer = 0; // activate on every single click to detect double click
 			bool isDoubleClick = false;
-			bool isESClosed = false;			
+			CShutdownToken isClosed; // Display closing
+
+			// Shared with the cursor thread
+			mutex lock;
+			POINT sampled = { 0, 0 }; // Last position sampled
+			CRect radarArea; // Published by the UI thread, ES can't be asked from the cursor thread
+			vector<POINT> clicks; // Left clicks in the radar area waiting for the UI thread
 		};
 		pair<int, int> screenResolution;
 		CAppCursor* appCursor = new CAppCursor(); // Constantly being updated
+		thread cursorThread; // Cursor loop, joined before the cursor is deleted
 		POINT mousePointer; // Updated on screen object actions only
 		clock_t fiveSecondTimer;
 		clock_t tenSecondTimer;
+		bool isFiveSecondCycle = false; // Five second work falls on this frame
+		bool isTenSecondCycle = false; // "
 		clock_t thirtySecondTimer;
 		bool aselDetailed;	
-		map<string, int> aircraftOnScreen;
+		CAircraftIdSet aircraftOnScreen;
 		map<int, string> menuFields;
 		string asel = "";
-		map<string, pair<bool, POINT>> tagStatuses;
+		vector<pair<bool, POINT>> tagStatuses; // Indexed by callsign id
+		CTagDeclutter declutter; // Places the tags that haven't been dragged
+		CDrawList drawList; // Overlays, routes and PIV, replayed by a GDI backend (kept so its buffers stay warm)
+		COverlays::COverlayState overlayState; // What this display's background overlay was last drawn from
 		string aircraftSel1 = ""; // For use in conflict tools
 		string aircraftSel2 = ""; // "
 		CMenuBar* menuBar;
@@ -0,0 +1,99 @@
+#include "pch.h"
+#include "RouteGeometry.h"
+#include "Utils.h"
+#include <cmath>
+
+shared_ptr<const CRouteSegment> CRouteGeometry::BuildSegment(CPosition from, CPosition to, double stepDegrees) {
+	shared_ptr<CRouteSegment> segment = make_shared<CRouteSegment>();
+
+	// Unit vectors
+	ToUnit(from, segment->StartUnit);
+	ToUnit(to, segment->EndUnit);
+
+	// Central angle (atan2 form is stable for short and long legs)
+	double cross[3] = {
+		segment->StartUnit[1] * segment->EndUnit[2] - segment->StartUnit[2] * segment->EndUnit[1],
+		segment->StartUnit[2] * segment->EndUnit[0] - segment->StartUnit[0] * segment->EndUnit[2],
+		segment->StartUnit[0] * segment->EndUnit[1] - segment->StartUnit[1] * segment->EndUnit[0]
+	};
+	double crossLength = sqrt(cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2]);
+	double dot = segment->StartUnit[0] * segment->EndUnit[0] + segment->StartUnit[1] * segment->EndUnit[1] + segment->StartUnit[2] * segment->EndUnit[2];
+	segment->Angle = atan2(crossLength, dot);
+	segment->Length = segment->Angle * RADIUS_EARTH_NM;
+
+	// Initial bearing
+	double lat1 = CUtils::ToRadians(from.m_Latitude);
+	double lat2 = CUtils::ToRadians(to.m_Latitude);
+	double deltaLon = CUtils::ToRadians(to.m_Longitude - from.m_Longitude);
+	double bearing = CUtils::ToDegrees(atan2(sin(deltaLon) * cos(lat2), cos(lat1) * sin(lat2) - sin(lat1) * cos(lat2) * cos(deltaLon)));
+	segment->InitialBearing = fmod(bearing + 360.0, 360.0);
+
+	// Densify
+	int steps = 1;
+	if (stepDegrees > 0.0) {
+		steps = max(1, (int)ceil(CUtils::ToDegrees(segment->Angle) / stepDegrees));
+	}
+	segment->Points.reserve(steps + 1);
+	segment->Points.push_back(from);
+	for (int i = 1; i < steps; i++) {
+		segment->Points.push_back(Slerp(*segment, (double)i / steps));
+	}
+	segment->Points.push_back(to);
+
+	return segment;
+}
+
+void CRouteGeometry::BuildRoute(vector<CWaypoint>& route) {
+	for (int i = 0; i < route.size(); i++) {
+		if (i == 0) {
+			route[i].Leg = nullptr;
+		}
+		else {
+			route[i].Leg = BuildSegment(route[i - 1].Position, route[i].Position);
+		}
+	}
+}
+
+CPosition CRouteGeometry::Interpolate(const CRouteSegment& segment, double distanceNM) {
+	// Zero length leg
+	if (segment.Length <= 0.0) {
+		return segment.Points.empty() ? CPosition() : segment.Points.front();
+	}
+
+	return Slerp(segment, distanceNM / segment.Length);
+}
+
+void CRouteGeometry::ToUnit(CPosition position, double* unit) {
+	double lat = CUtils::ToRadians(position.m_Latitude);
+	double lon = CUtils::ToRadians(position.m_Longitude);
+	unit[0] = cos(lat) * cos(lon);
+	unit[1] = cos(lat) * sin(lon);
+	unit[2] = sin(lat);
+}
+
+CPosition CRouteGeometry::FromUnit(const double* unit) {
+	CPosition position;
+	position.m_Latitude = CUtils::ToDegrees(atan2(unit[2], sqrt(unit[0] * unit[0] + unit[1] * unit[1])));
+	position.m_Longitude = CUtils::ToDegrees(atan2(unit[1], unit[0]));
+	return position;
+}
+
+CPosition CRouteGeometry::Slerp(const CRouteSegment& segment, double fraction) {
+	// Coincident points
+	double sinAngle = sin(segment.Angle);
+	if (abs(sinAngle) < 1e-12) {
+		return FromUnit(segment.StartUnit);
+	}
+
+	// Weights
+	double a = sin((1.0 - fraction) * segment.Angle) / sinAngle;
+	double b = sin(fraction * segment.Angle) / sinAngle;
+
+	double unit[3] = {
+		a * segment.StartUnit[0] + b * segment.EndUnit[0],
+		a * segment.StartUnit[1] + b * segment.EndUnit[1],
+		a * segment.StartUnit[2] + b * segment.EndUnit[2]
+	};
+
+	return FromUnit(unit);
+}
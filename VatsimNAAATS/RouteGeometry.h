@@ -0,0 +1,33 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include "EuroScopePlugIn.h"
+#include "Constants.h"
+#include "Structures.h"
+
+using namespace std;
+using namespace EuroScopePlugIn;
+
+// Great circle route geometry, computed once when a route is set
+class CRouteGeometry
+{
+	public:
+		// Build a leg between two positions, densified at the given angular step (degrees)
+		static shared_ptr<const CRouteSegment> BuildSegment(CPosition from, CPosition to, double stepDegrees = ROUTE_DENSIFY_STEP);
+
+		// Assign legs to every waypoint of a route (first waypoint has no leg)
+		static void BuildRoute(vector<CWaypoint>& route);
+
+		// Position a given distance (nautical miles) along a leg
+		static CPosition Interpolate(const CRouteSegment& segment, double distanceNM);
+
+	private:
+		// Lat/lon to unit vector
+		static void ToUnit(CPosition position, double* unit);
+
+		// Unit vector to lat/lon
+		static CPosition FromUnit(const double* unit);
+
+		// Spherical interpolation between the leg end points (0 to 1)
+		static CPosition Slerp(const CRouteSegment& segment, double fraction);
+};
@@ -0,0 +1,257 @@
+#include "pch.h"
+#include "RouteParser.h"
+#include <cstdio>
+#include <cmath>
+
+// Character helpers (avoid locale dependent isdigit/isalpha)
+static inline bool IsDigitChar(char c) { return c >= '0' && c <= '9'; }
+static inline bool IsAlphaChar(char c) { return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z'); }
+static inline char UpperChar(char c) { return (c >= 'a' && c <= 'z') ? (char)(c - 'a' + 'A') : c; }
+
+static inline bool AllDigits(string_view text) {
+	if (text.empty()) return false;
+	for (char c : text) {
+		if (!IsDigitChar(c)) return false;
+	}
+	return true;
+}
+
+bool CRouteParser::NextToken(string_view route, size_t& cursor, string_view& token) {
+	// Skip leading whitespace
+	while (cursor < route.size() && (route[cursor] == ' ' || route[cursor] == '\t' || route[cursor] == '\r' || route[cursor] == '\n')) {
+		cursor++;
+	}
+
+	// End of route
+	if (cursor >= route.size()) {
+		return false;
+	}
+
+	// Find the end of the token
+	size_t start = cursor;
+	while (cursor < route.size() && route[cursor] != ' ' && route[cursor] != '\t' && route[cursor] != '\r' && route[cursor] != '\n') {
+		cursor++;
+	}
+
+	token = route.substr(start, cursor - start);
+	return true;
+}
+
+bool CRouteParser::ParseToken(string_view text, CRouteToken& token) {
+	token.Text = text;
+	token.Latitude = 0.0;
+	token.Longitude = 0.0;
+
+	// Empty token
+	if (text.empty()) {
+		token.Type = CRouteTokenType::INVALID;
+		return false;
+	}
+
+	// Fix names are alpha only (airways, speed/level groups etc. fall through to OTHER)
+	if (IsFix(text, 1, text.size())) {
+		token.Type = CRouteTokenType::FIX;
+		return true;
+	}
+
+	// Coordinates
+	if (ParseCoordinate(text, token.Latitude, token.Longitude)) {
+		token.Type = CRouteTokenType::COORDINATE;
+		return true;
+	}
+
+	// Something alphanumeric we don't need to understand
+	for (char c : text) {
+		if (!IsDigitChar(c) && !IsAlphaChar(c) && c != '/') {
+			token.Type = CRouteTokenType::INVALID;
+			return false;
+		}
+	}
+	token.Type = CRouteTokenType::OTHER;
+	return true;
+}
+
+bool CRouteParser::ParseCoordinate(string_view text, double& latitude, double& longitude) {
+	double lat = 0.0;
+	double lon = 0.0;
+
+	// Slash format (DD/DD, DDMM/DDMM etc.), always N/W in the NAT
+	size_t slash = text.find('/');
+	if (slash != string_view::npos) {
+		string_view latText = text.substr(0, slash);
+		string_view lonText = text.substr(slash + 1);
+		if (latText.size() != 2 && latText.size() != 4) return false;
+		if (lonText.size() < 2 || lonText.size() > 5) return false;
+		if (!ParseAngle(latText, 2, lat) || !ParseAngle(lonText, 3, lon)) return false;
+		lon = -lon;
+	}
+	// ARINC 424 five character codes
+	else if (text.size() == 5) {
+		char first = UpperChar(text[0]);
+		char middle = UpperChar(text[2]);
+		char last = UpperChar(text[4]);
+		if (AllDigits(text.substr(0, 4)) && IsAlphaChar(last)) { // DDDDN
+			lat = (text[0] - '0') * 10 + (text[1] - '0');
+			lon = (text[2] - '0') * 10 + (text[3] - '0');
+			if (!ApplyQuadrant(last, lat, lon)) return false;
+		}
+		else if (AllDigits(text.substr(0, 2)) && IsAlphaChar(middle) && AllDigits(text.substr(3, 2))) { // DDNDD (longitude 100 or greater)
+			lat = (text[0] - '0') * 10 + (text[1] - '0');
+			lon = 100 + (text[3] - '0') * 10 + (text[4] - '0');
+			if (!ApplyQuadrant(middle, lat, lon)) return false;
+		}
+		else if (IsAlphaChar(first) && AllDigits(text.substr(1, 4))) { // NDDDD/HDDDD (half degree latitude)
+			lat = (text[1] - '0') * 10 + (text[2] - '0') + 0.5;
+			lon = (text[3] - '0') * 10 + (text[4] - '0');
+			if (!ApplyQuadrant(first == 'H' ? 'N' : first, lat, lon)) return false;
+		}
+		else {
+			return false;
+		}
+	}
+	// Full hemisphere format (DDNDDDW, DDMMNDDDMMW)
+	else if (text.size() >= 6 && text.size() <= 11) {
+		size_t hemi = text.find_first_not_of("0123456789");
+		if (hemi != 2 && hemi != 4) return false;
+		char latHemi = UpperChar(text[hemi]);
+		char lonHemi = UpperChar(text.back());
+		if ((latHemi != 'N' && latHemi != 'S') || (lonHemi != 'E' && lonHemi != 'W')) return false;
+		string_view lonText = text.substr(hemi + 1, text.size() - hemi - 2);
+		if (lonText.size() < 2 || lonText.size() > 5) return false;
+		if (!ParseAngle(text.substr(0, hemi), 2, lat) || !ParseAngle(lonText, 3, lon)) return false;
+		if (latHemi == 'S') lat = -lat;
+		if (lonHemi == 'W') lon = -lon;
+	}
+	else {
+		return false;
+	}
+
+	// Range check
+	if (abs(lat) > 90.0 || abs(lon) > 180.0) return false;
+
+	latitude = lat;
+	longitude = lon;
+	return true;
+}
+
+bool CRouteParser::IsFix(string_view text, size_t minLength, size_t maxLength) {
+	if (text.size() < minLength || text.size() > maxLength) return false;
+	for (char c : text) {
+		if (!IsAlphaChar(c)) return false;
+	}
+	return true;
+}
+
+size_t CRouteParser::FormatCoordinate(double latitude, double longitude, int format, char* buffer, size_t size) {
+	if (buffer == nullptr || size == 0) return 0;
+
+	// Split into whole degrees and minutes
+	int latTotal = (int)round(abs(latitude) * 60.0);
+	int lonTotal = (int)round(abs(longitude) * 60.0);
+	int latDeg = latTotal / 60;
+	int latMin = latTotal % 60;
+	int lonDeg = lonTotal / 60;
+	int lonMin = lonTotal % 60;
+
+	// ARINC codes can only hold whole or half degree latitude and whole longitude
+	if (format == 1 && (lonMin != 0 || (latMin != 0 && latMin != 30) || (latMin == 30 && lonDeg >= 100))) {
+		format = 2;
+	}
+
+	int written = 0;
+	if (format == 0) {
+		if (latMin != 0 && lonMin != 0)
+			written = snprintf(buffer, size, "%02d%02d/%03d%02d", latDeg, latMin, lonDeg, lonMin);
+		else if (latMin != 0)
+			written = snprintf(buffer, size, "%02d%02d/%02d", latDeg, latMin, lonDeg);
+		else if (lonMin != 0)
+			written = snprintf(buffer, size, "%02d/%03d%02d", latDeg, lonDeg, lonMin);
+		else
+			written = snprintf(buffer, size, "%02d/%02d", latDeg, lonDeg);
+	}
+	else if (format == 1) {
+		char quadrant = GetQuadrant(latitude, longitude);
+		if (latMin == 30)
+			written = snprintf(buffer, size, "%c%02d%02d", quadrant, latDeg, lonDeg);
+		else if (lonDeg >= 100)
+			written = snprintf(buffer, size, "%02d%c%02d", latDeg, quadrant, lonDeg - 100);
+		else
+			written = snprintf(buffer, size, "%02d%02d%c", latDeg, lonDeg, quadrant);
+	}
+	else {
+		char latHemi = latitude < 0 ? 'S' : 'N';
+		char lonHemi = longitude > 0 ? 'E' : 'W';
+		if (latMin != 0 || lonMin != 0)
+			written = snprintf(buffer, size, "%02d%02d%c%03d%02d%c", latDeg, latMin, latHemi, lonDeg, lonMin, lonHemi);
+		else
+			written = snprintf(buffer, size, "%02d%c%03d%c", latDeg, latHemi, lonDeg, lonHemi);
+	}
+
+	// Truncated or failed
+	if (written <= 0 || (size_t)written >= size) return 0;
+
+	return (size_t)written;
+}
+
+string CRouteParser::FormatCoordinate(double latitude, double longitude, int format) {
+	char buffer[16];
+	size_t length = FormatCoordinate(latitude, longitude, format, buffer, sizeof(buffer));
+	return string(buffer, length);
+}
+
+CPosition CRouteParser::ToPosition(double latitude, double longitude) {
+	CPosition position;
+	position.m_Latitude = latitude;
+	position.m_Longitude = longitude;
+	return position;
+}
+
+bool CRouteParser::ParseAngle(string_view digits, size_t maxDegreeDigits, double& angle) {
+	if (!AllDigits(digits)) return false;
+
+	// Degrees only, or degrees followed by two digit minutes
+	size_t degreeDigits = digits.size() <= maxDegreeDigits ? digits.size() : digits.size() - 2;
+	if (degreeDigits < 2 || degreeDigits > maxDegreeDigits) return false;
+
+	int degrees = 0;
+	for (size_t i = 0; i < degreeDigits; i++) {
+		degrees = degrees * 10 + (digits[i] - '0');
+	}
+
+	int minutes = 0;
+	if (degreeDigits < digits.size()) {
+		minutes = (digits[degreeDigits] - '0') * 10 + (digits[degreeDigits + 1] - '0');
+		if (minutes >= 60) return false;
+	}
+
+	angle = degrees + (minutes / 60.0);
+	return true;
+}
+
+bool CRouteParser::ApplyQuadrant(char quadrant, double& latitude, double& longitude) {
+	switch (UpperChar(quadrant)) {
+		case 'N': // North, west
+			longitude = -longitude;
+			return true;
+		case 'E': // North, east
+			return true;
+		case 'S': // South, east
+			latitude = -latitude;
+			return true;
+		case 'W': // South, west
+			latitude = -latitude;
+			longitude = -longitude;
+			return true;
+		default:
+			return false;
+	}
+}
+
+char CRouteParser::GetQuadrant(double latitude, double longitude) {
+	if (latitude >= 0) {
+		return longitude > 0 ? 'E' : 'N';
+	}
+	else {
+		return longitude > 0 ? 'S' : 'W';
+	}
+}
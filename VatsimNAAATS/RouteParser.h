@@ -0,0 +1,57 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include "EuroScopePlugIn.h"
+#include "Constants.h"
+
+using namespace std;
+using namespace EuroScopePlugIn;
+
+// A single lexed route token, the text is a view into the source route string
+struct CRouteToken {
+	string_view Text;
+	CRouteTokenType Type = CRouteTokenType::INVALID;
+	double Latitude = 0.0; // Decimal degrees, north positive
+	double Longitude = 0.0; // Decimal degrees, east positive
+};
+
+// Route lexer and NAT coordinate grammar (no heap allocation)
+// Recognised coordinate forms:
+//   DD/DD, DD/DDD, DDMM/DD, DDMM/DDMM, DDMM/DDDMM    (slash, N/W assumed)
+//   DDDDN, DDNDD                                    (ARINC 424, quadrant letter N/E/S/W)
+//   NDDDD, HDDDD                                    (ARINC 424 half degree latitude)
+//   DDNDDDW, DDMMNDDDMMW                            (full hemisphere)
+class CRouteParser
+{
+	public:
+		// Get the next whitespace delimited token, returns false at the end of the route
+		static bool NextToken(string_view route, size_t& cursor, string_view& token);
+
+		// Classify a token and parse its position if it is a coordinate
+		static bool ParseToken(string_view text, CRouteToken& token);
+
+		// Parse a coordinate in any of the recognised forms
+		static bool ParseCoordinate(string_view text, double& latitude, double& longitude);
+
+		// Check if the token is a fix name (alpha only)
+		static bool IsFix(string_view text, size_t minLength = 2, size_t maxLength = 5);
+
+		// Write a coordinate to a buffer (format = 0 (slash format), 1 (xxxxN), 2 (xxNxxxW)), returns length written or 0 on failure
+		static size_t FormatCoordinate(double latitude, double longitude, int format, char* buffer, size_t size);
+
+		// Format a coordinate to a string
+		static string FormatCoordinate(double latitude, double longitude, int format);
+
+		// Make a CPosition without going through strings
+		static CPosition ToPosition(double latitude, double longitude);
+
+	private:
+		// Parse a run of digits as degrees with optional trailing minutes
+		static bool ParseAngle(string_view digits, size_t maxDegreeDigits, double& angle);
+
+		// Apply an ARINC 424 quadrant letter to the absolute latitude and longitude
+		static bool ApplyQuadrant(char quadrant, double& latitude, double& longitude);
+
+		// Get the ARINC 424 quadrant letter for a position
+		static char GetQuadrant(double latitude, double longitude);
+};
@@ -1,21 +1,35 @@
 #include "pch.h"
 #include "RoutesHelper.h"
 #include "DataHandler.h"
+#include "RouteParser.h"
+#include "Lifecycle.h"
+#include "TextCache.h"
+#include <algorithm>
 
-map<string, CTrack> CRoutesHelper::CurrentTracks;
-
-string CRoutesHelper::CurrentTMI = "";
+shared_ptr<const CTrackSet> CRoutesHelper::currentTracks = make_shared<const CTrackSet>();
 
 vector<string> CRoutesHelper::ActiveRoutes;
 
+map<string, CTrackAssignment> CRoutesHelper::trackAssignments;
+
+deque<CUtils::CAsyncData*> CRoutesHelper::routeQueue;
+vector<CUtils::CAsyncData*> CRoutesHelper::deferredRoutes;
+mutex CRoutesHelper::routeQueueLock;
+condition_variable CRoutesHelper::routeQueueSignal;
+CRadarScreen* CRoutesHelper::routeInHand = nullptr;
+condition_variable CRoutesHelper::routeDoneSignal;
+bool CRoutesHelper::routeWorkerStarted = false;
+bool CRoutesHelper::routeWorkerStopping = false;
+thread CRoutesHelper::routeWorker;
+
 bool CRoutesHelper::GetRoute(CRadarScreen* screen, vector<CRoutePosition>* routeVector, string callsign, CAircraftFlightPlan* copy) {\
 	try {
 		// Get the flight plan
-		CAircraftFlightPlan* fp = copy != nullptr ? copy : CDataHandler::GetFlightData(callsign);
+		shared_ptr<const CAircraftFlightPlan> snapshot = copy == nullptr ? CDataHandler::GetFlightSnapshot(callsign) : nullptr;
+		const CAircraftFlightPlan* fp = copy != nullptr ? copy : snapshot.get();
 
-	
 		// Check validity
-		if (!fp->IsValid || fp->Route.size() == 0) {
+		if (fp == nullptr || !fp->IsValid || fp->Route.size() == 0) {
 			return false;
 		}
 
@@ -34,6 +48,7 @@ bool CRoutesHelper::GetRoute(CRadarScreen* screen, vector<CRoutePosition>* route
 				// Fix
 				position.Fix = fp->Route[idx].Name;
 				position.PositionRaw = fp->Route[idx].Position;
+				position.Leg = fp->Route[idx].Leg;
 
 				// Get estimate
 				if (!direction) { // Westbound
@@ -44,11 +59,12 @@ bool CRoutesHelper::GetRoute(CRadarScreen* screen, vector<CRoutePosition>* route
 							position.DistanceFromLastPoint = target.GetPosition().GetPosition().DistanceTo(fp->Route[idx].Position);
 						}
 						else {
-							// Calculate distance point to point
-							totalDistance += fp->Route.at(idx - 1).Position.DistanceTo(fp->Route.at(idx).Position);
-							position.DistanceFromLastPoint = fp->Route.at(idx - 1).Position.DistanceTo(fp->Route.at(idx).Position);
+							// Distance point to point (precomputed leg if we have it)
+							int legDistance = fp->Route.at(idx).Leg != nullptr ? (int)round(fp->Route.at(idx).Leg->Length) : (int)fp->Route.at(idx - 1).Position.DistanceTo(fp->Route.at(idx).Position);
+							totalDistance += legDistance;
+							position.DistanceFromLastPoint = legDistance;
 						}
-						position.Estimate = CUtils::ParseZuluTime(false, CUtils::GetTimeDistanceSpeed((int)round(totalDistance), target.GetPosition().GetReportedGS()));
+						position.Estimate = CTextCache::ZuluTime(CUtils::GetTimeDistanceSpeed((int)round(totalDistance), target.GetPosition().GetReportedGS()));
 					}
 					else {
 						position.Estimate = "--";
@@ -63,11 +79,12 @@ bool CRoutesHelper::GetRoute(CRadarScreen* screen, vector<CRoutePosition>* route
 							position.DistanceFromLastPoint = target.GetPosition().GetPosition().DistanceTo(fp->Route[idx].Position);
 						}
 						else {
-							// Calculate distance point to point
-							totalDistance += fp->Route.at(idx - 1).Position.DistanceTo(fp->Route.at(idx).Position);
-							position.DistanceFromLastPoint = fp->Route.at(idx - 1).Position.DistanceTo(fp->Route.at(idx).Position);
+							// Distance point to point (precomputed leg if we have it)
+							int legDistance = fp->Route.at(idx).Leg != nullptr ? (int)round(fp->Route.at(idx).Leg->Length) : (int)fp->Route.at(idx - 1).Position.DistanceTo(fp->Route.at(idx).Position);
+							totalDistance += legDistance;
+							position.DistanceFromLastPoint = legDistance;
 						}
-						position.Estimate = CUtils::ParseZuluTime(false, CUtils::GetTimeDistanceSpeed((int)round(totalDistance), target.GetPosition().GetReportedGS()));
+						position.Estimate = CTextCache::ZuluTime(CUtils::GetTimeDistanceSpeed((int)round(totalDistance), target.GetPosition().GetReportedGS()));
 					}
 					else {
 						position.Estimate = "--";
@@ -95,24 +112,37 @@ void CRoutesHelper::InitialiseRoute(void* args) {
 	// Convert args
 	CUtils::CAsyncData* data = (CUtils::CAsyncData*) args;
 	try {
-		// Flight plan
-		CAircraftFlightPlan* fp = data->FP != nullptr ? data->FP : CDataHandler::GetFlightData(data->Callsign);
+		// Flight plan (published copy, the live record belongs to the UI thread)
+		shared_ptr<const CAircraftFlightPlan> snapshot = data->FP == nullptr ? CDataHandler::GetFlightSnapshot(data->Callsign) : nullptr;
+		const CAircraftFlightPlan* fp = data->FP != nullptr ? data->FP : snapshot.get();
+		if (fp == nullptr) {
+			// Flight has gone
+			delete data;
+			return;
+		}
+
+		// Track id to set
+		string trackId = fp->Track;
 
 		// Final route vector
 		vector<CWaypoint> parsedRoute;
 
+		// Tracks
+		shared_ptr<const CTrackSet> tracks = GetTracks();
+
 		// Track
 		string trackReturned = "";
 
 		// First we check if they have a route string
 		if (fp != nullptr && !fp->RouteRaw.empty() && fp->RouteRaw.size() > 0) { // Get their route as per the route string
 			// We check now if they have a track
-			if (fp->Track != "RR" && CurrentTracks.find(fp->Track) != CurrentTracks.end()) {
+			auto assignedTrack = tracks->Tracks.find(fp->Track);
+			if (fp->Track != "RR" && assignedTrack != tracks->Tracks.end()) {
 				if (fp->Track.size() < 2 ) {
-					for (int i = 0; i < CurrentTracks.find(fp->Track)->second.RouteRaw.size(); i++) {
+					for (int i = 0; i < assignedTrack->second.RouteRaw.size(); i++) {
 						CWaypoint point;
-						point.Name = CurrentTracks.find(fp->Track)->second.Route[i];
-						point.Position = CurrentTracks.find(fp->Track)->second.RouteRaw[i];
+						point.Name = assignedTrack->second.Route[i];
+						point.Position = assignedTrack->second.RouteRaw[i];
 						parsedRoute.push_back(point);
 					}
 				}
@@ -142,16 +172,12 @@ void CRoutesHelper::InitialiseRoute(void* args) {
 					// Waypoint obj
 					CWaypoint point;
 
-					// We check whether there are any numbers in the item
-					bool isAllAlpha = true;
-					for (int j = 0; j < fp->RouteRaw[i].size(); j++) {
-						if (isdigit(fp->RouteRaw[i].at(j))) {
-							isAllAlpha = false;
-						}
-					}
+					// Classify the item
+					CRouteToken token;
+					CRouteParser::ParseToken(fp->RouteRaw[i], token);
 
 					// If it's a waypoint we need to search the sector file for the reference
-					if (isAllAlpha) {
+					if (token.Type != CRouteTokenType::COORDINATE) {
 						// Get sector file
 						data->Screen->GetPlugIn()->SelectActiveSectorfile();
 						CSectorElement fix; // Fixes element
@@ -186,12 +212,9 @@ void CRoutesHelper::InitialiseRoute(void* args) {
 						}
 					}
 					else {
-						// Make position from the string lat and lon
-						CPosition pos;
-						pos.m_Latitude = stod(fp->RouteRaw[i].substr(0, 2));
-						pos.m_Longitude = -(stod(fp->RouteRaw[i].substr(3, 2)));
+						// Make position from the parsed lat and lon
 						point.Name = fp->RouteRaw[i];
-						point.Position = pos;
+						point.Position = CRouteParser::ToPosition(token.Latitude, token.Longitude);
 					}
 
 					// Append the waypoint object
@@ -212,7 +235,7 @@ void CRoutesHelper::InitialiseRoute(void* args) {
 				// Check if it is concorde first
 				if (trackReturned.size() == 1) {
 					bool loopBreak = false;
-					for (auto kv : CRoutesHelper::CurrentTracks) {
+					for (const auto& kv : tracks->Tracks) {
 						if (kv.first == trackReturned) { // Assign track to the returned box
 							track = kv.second;
 							loopBreak = true;
@@ -223,7 +246,7 @@ void CRoutesHelper::InitialiseRoute(void* args) {
 						trackReturned = "";
 					}
 					// Track id
-					fp->Track = trackReturned;
+					trackId = trackReturned;
 				}
 			}
 
@@ -268,7 +291,7 @@ void CRoutesHelper::InitialiseRoute(void* args) {
 			}
 			else {
 				// Track id
-				fp->Track = "RR";
+				trackId = "RR";
 
 				// Find our entry and exit points
 				int entryPoint = -1;
@@ -322,14 +345,158 @@ void CRoutesHelper::InitialiseRoute(void* args) {
 		}
 
 		// Return the vector
-		CDataHandler::SetRoute(data->Callsign, &parsedRoute, fp->Track, data->FP != nullptr ? data->FP : nullptr);
+		CDataHandler::SetRoute(data->Callsign, &parsedRoute, trackId, data->FP != nullptr ? data->FP : nullptr);
 
 		// Cleanup
-		delete args;
+		delete data;
 	}
 	catch (std::exception & ex) {
 		CLogger::DebugLog(data->Screen, "An exception occurred. " + *ex.what());
 		CLogger::Log(CLogType::ERR, "An error occurred. Callsign: " + data->Callsign + "\nVerbose details: " + *ex.what(), "CRoutesHelper::InitialiseRoute");
+		delete data;
+	}
+}
+
+void CRoutesHelper::QueueRoute(CUtils::CAsyncData* data) {
+	// Copied plans go straight to the worker
+	if (data->FP != nullptr) {
+		SendToWorker(data);
+		return;
+	}
+
+	// The worker reads the published copy, so hold the request until the flight has been published with the frame
+	CDataHandler::MarkFlightChanged(data->Callsign);
+	lock_guard<mutex> lock(routeQueueLock);
+	if (routeWorkerStopping) {
+		delete data;
+		return;
+	}
+	for (auto deferred : deferredRoutes) {
+		if (deferred->Callsign == data->Callsign) {
+			delete data;
+			return;
+		}
+	}
+	deferredRoutes.push_back(data);
+}
+
+void CRoutesHelper::SubmitRoutes() {
+	// Take the held requests
+	vector<CUtils::CAsyncData*> routes;
+	{
+		lock_guard<mutex> lock(routeQueueLock);
+		routes.swap(deferredRoutes);
+	}
+
+	for (auto data : routes) {
+		SendToWorker(data);
+	}
+}
+
+bool CRoutesHelper::HasDeferredRoutes() {
+	lock_guard<mutex> lock(routeQueueLock);
+	return !deferredRoutes.empty();
+}
+
+void CRoutesHelper::RetargetScreen(CRadarScreen* closing, CRadarScreen* replacement) {
+	unique_lock<mutex> lock(routeQueueLock);
+
+	// Queued and held routes
+	auto retarget = [closing, replacement](CUtils::CAsyncData*& data) {
+		if (data->Screen != closing) return false;
+		if (replacement != nullptr) {
+			data->Screen = replacement;
+			return false;
+		}
+		delete data;
+		return true;
+	};
+	routeQueue.erase(remove_if(routeQueue.begin(), routeQueue.end(), retarget), routeQueue.end());
+	deferredRoutes.erase(remove_if(deferredRoutes.begin(), deferredRoutes.end(), retarget), deferredRoutes.end());
+
+	// The worker may be part way through one for this display
+	routeDoneSignal.wait(lock, [closing] { return routeInHand != closing; });
+}
+
+void CRoutesHelper::SendToWorker(CUtils::CAsyncData* data) {
+	bool isFirst = false;
+	{
+		lock_guard<mutex> lock(routeQueueLock);
+
+		// Plugin is unloading
+		if (routeWorkerStopping) {
+			delete data;
+			return;
+		}
+
+		// Coalesce with a pending request for the same flight (copied plans are always queued)
+		if (data->FP == nullptr) {
+			for (auto pending : routeQueue) {
+				if (pending->FP == nullptr && pending->Callsign == data->Callsign) {
+					delete data;
+					return;
+				}
+			}
+		}
+		routeQueue.push_back(data);
+
+		// Start the worker the first time round
+		if (!routeWorkerStarted) {
+			routeWorkerStarted = true;
+			routeWorker = thread(RouteWorker);
+			isFirst = true;
+		}
+	}
+	routeQueueSignal.notify_one();
+
+	// Stopped with the plugin (registered outside the lock, it runs straight away if we're already shutting down)
+	if (isFirst) {
+		CLifecycle::OnShutdown(StopRouteWorker);
+	}
+}
+
+void CRoutesHelper::RouteWorker() {
+	while (true) {
+		// Wait for work
+		CUtils::CAsyncData* data;
+		{
+			unique_lock<mutex> lock(routeQueueLock);
+			routeQueueSignal.wait(lock, [] { return routeWorkerStopping || !routeQueue.empty(); });
+			if (routeWorkerStopping) return;
+			data = routeQueue.front();
+			routeQueue.pop_front();
+			routeInHand = data->Screen;
+		}
+
+		// Initialise (deletes the data)
+		InitialiseRoute((void*)data);
+
+		// Done with the display
+		{
+			lock_guard<mutex> lock(routeQueueLock);
+			routeInHand = nullptr;
+		}
+		routeDoneSignal.notify_all();
+	}
+}
+
+void CRoutesHelper::StopRouteWorker() {
+	// Wake the worker and take what it never got to
+	deque<CUtils::CAsyncData*> abandoned;
+	{
+		lock_guard<mutex> lock(routeQueueLock);
+		routeWorkerStopping = true;
+		abandoned.swap(routeQueue);
+		abandoned.insert(abandoned.end(), deferredRoutes.begin(), deferredRoutes.end());
+		deferredRoutes.clear();
+	}
+	routeQueueSignal.notify_all();
+
+	// Finishes the route it is on first
+	if (routeWorker.joinable()) routeWorker.join();
+
+	for (auto data : abandoned) {
+		delete data;
 	}
 }
 
@@ -344,9 +511,10 @@ int CRoutesHelper::ParseRoute(CRadarScreen* screen, string callsign, string rawI
 		// Deal with track
 		if (isTrack) {
 			if (rawInput.size() < 3) {
-				if (CRoutesHelper::CurrentTracks.find(rawInput) != CRoutesHelper::CurrentTracks.end()) {
-					route = CRoutesHelper::CurrentTracks.at(rawInput).Route;
-					track = CRoutesHelper::CurrentTracks.at(rawInput).Identifier;
+				shared_ptr<const CTrackSet> tracks = GetTracks();
+				if (tracks->Tracks.find(rawInput) != tracks->Tracks.end()) {
+					route = tracks->Tracks.at(rawInput).Route;
+					track = tracks->Tracks.at(rawInput).Identifier;
 				}
 				else {
 					return 1;
@@ -387,68 +555,43 @@ int CRoutesHelper::ParseRoute(CRadarScreen* screen, string callsign, string rawI
 		}
 		else {
 			/// Validation
-			// Tokens for split string
-			vector<string> tokens;
-
-			// String stream
-			stringstream stream(rawInput);
-
-			// Intermediate value
-			string intermediate;
-
 			track = "RR";
 
-			// Tokenise the string
-			while (getline(stream, intermediate, ' '))
-			{
-				tokens.push_back(intermediate);
-			}
+			// Lex the route in place
+			size_t cursor = 0;
+			string_view item;
+			CRouteToken token;
+			while (CRouteParser::NextToken(rawInput, cursor, item)) {
+				// Classify the token
+				if (!CRouteParser::ParseToken(item, token)) {
+					return 1;
+				}
 
-			// Loop the tokens
-			for (int i = 0; i < tokens.size(); i++) {
-				// Check if digits
-				bool isAllAlpha = true;
-				for (int j = 0; j < tokens.at(i).size(); j++) {
-					if (isdigit(tokens.at(i).at(j))) {
-						isAllAlpha = false;
-					}
+				// The aircraft position is not part of the route
+				if (item == "AIRCRAFT") {
+					continue;
 				}
 
 				// If waypoint check the size
-				if (isAllAlpha) {
+				if (token.Type == CRouteTokenType::FIX) {
 					// Reject if greater or less than 5
-					if (tokens.at(i).size() < 5 || tokens.at(i).size() > 5) {
+					if (item.size() != 5) {
 						return 1;
 					}
-					else {
-						// Otherwise make uppercase and push back
-						string waypoint;
-						for (int j = 0; j < tokens.at(i).size(); j++) {
-							waypoint += toupper(tokens.at(i)[j]);
-						}
-						route.push_back(waypoint);
+
+					// Otherwise make uppercase and push back
+					string waypoint(item);
+					for (int j = 0; j < waypoint.size(); j++) {
+						waypoint[j] = toupper(waypoint[j]);
 					}
+					route.push_back(waypoint);
 				}
-				else { // It's a coordinate
-					if (tokens.at(i).size() < 5 || tokens.at(i).size() > 5) {
-						return 1;
-					}
-					else {
-						// Check manually
-						if (!isdigit(tokens.at(i)[0]))
-							return 1;
-						if (!isdigit(tokens.at(i)[1]))
-							return 1;
-						if (tokens.at(i)[2] != '/')
-							return 1;
-						if (!isdigit(tokens.at(i)[3]))
-							return 1;
-						if (!isdigit(tokens.at(i)[4]))
-							return 1;
-
-						// We got here so push it
-						route.push_back(tokens.at(i));
-					}
+				else if (token.Type == CRouteTokenType::COORDINATE) {
+					// Any accepted coordinate form is stored in slash format
+					route.push_back(CRouteParser::FormatCoordinate(token.Latitude, token.Longitude, 0));
+				}
+				else {
+					return 1;
 				}
 			}
 		}
@@ -456,25 +599,13 @@ int CRoutesHelper::ParseRoute(CRadarScreen* screen, string callsign, string rawI
 		// We got here, so set the route and return success code
 		if (copy != nullptr) {
 			copy->Track = track;
-			copy->RouteRaw.clear();
-			for (int i = 0; i < route.size(); i++) {
-				if (route[i] == "AIRCRAFT")
-					route.at(i).erase();
-					continue;
-				copy->RouteRaw.push_back(route[i]);
-			}
+			copy->RouteRaw = route;
 		}
 		else {
-			CDataHandler::GetFlightData(callsign)->Track = track;
-			CDataHandler::GetFlightData(callsign)->RouteRaw.clear();
-			for (int i = 0; i < route.size(); i++) {
-				if (route[i] == "AIRCRAFT") {
-					route.at(i).erase();
-					continue;
-				}
-					
-				CDataHandler::GetFlightData(callsign)->RouteRaw.push_back(route[i]);
-			}
+			CAircraftFlightPlan* fp = CDataHandler::GetFlightData(callsign);
+			fp->Track = track;
+			fp->RouteRaw = route;
+			CDataHandler::MarkFlightChanged(callsign);
 		}
 
 	}
@@ -492,52 +623,126 @@ string CRoutesHelper::OnNatTrack(CRadarScreen* screen, string callsign) {
 		// Get flight plan
 		CFlightPlan fp = screen->GetPlugIn()->FlightPlanSelect(callsign.c_str());
 
-		// Get route and begin search
+		// Get route and match it
 		string route = fp.GetFlightPlanData().GetRoute();
-		size_t found = route.find(string(" NAT"));
-		// If found
-		if (found != string::npos) {
-			// Make sure that it's not a waypoint starting with NAT (check character count)
-			while (found != string::npos && route.at(found + 5) != 0x20) {
-				route = route.substr(found + 5, route.size() - found + 5 - 1);
-				found = route.find(string(" NAT"));
+		return MatchNatTrack(route);
+	}
+	catch (std::exception & ex) {
+		CLogger::DebugLog(screen, "An exception occurred. " + *ex.what());
+		CLogger::Log(CLogType::ERR, "An error occurred. Callsign: " + callsign + "\nVerbose details: " + *ex.what(), "CRoutesHelper::OnNatTrack");
+		return "";
+	}
+}
+
+string CRoutesHelper::MatchNatTrack(string_view route) {
+	// Route points in filed order
+	vector<CRouteToken> points;
+
+	// Tracks
+	shared_ptr<const CTrackSet> tracks = GetTracks();
+
+	// Lex the route
+	size_t cursor = 0;
+	string_view item;
+	CRouteToken token;
+	while (CRouteParser::NextToken(route, cursor, item)) {
+		// Strip any speed/level group (e.g. DOTTY/M083F350) unless the slash is part of a coordinate
+		if (!CRouteParser::ParseToken(item, token) || token.Type == CRouteTokenType::OTHER) {
+			size_t slash = item.find('/');
+			if (slash == string_view::npos || !CRouteParser::ParseToken(item.substr(0, slash), token)) {
+				continue;
 			}
-			if (route.at(found + 5) == 0x20) { // If it was found (found + 5 was a space character)
-				// Get the ID and return
-				string trackId;
-				trackId.push_back(route.at(found + 4));
-
-				// Check if it exists
-				if (CurrentTracks.find(trackId) != CurrentTracks.end())
-					return trackId;
-				else
-					return "";
+		}
+
+		// Filed as "NATx" (or "NATSx" for concorde)
+		if (token.Type == CRouteTokenType::FIX && token.Text.size() >= 4 && token.Text.size() <= 5
+			&& toupper(token.Text[0]) == 'N' && toupper(token.Text[1]) == 'A' && toupper(token.Text[2]) == 'T') {
+			string trackId;
+			for (size_t i = 3; i < token.Text.size(); i++) {
+				trackId.push_back(toupper(token.Text[i]));
 			}
-			else if (route.at(found + 5) == 0x4c ||
-				route.at(found + 5) == 0x4d || route.at(found + 5) == 0x4e ||
-				route.at(found + 5) == 0x4f || route.at(found + 5) == 0x50) { // A letter matching a Concorde track was found
-
-				// Get the ID and return
-				string trackId;
-				trackId.push_back(route.at(found + 4) + route.at(found + 5));
-
-				// Check if it exists
-				if (CurrentTracks.find(trackId) != CurrentTracks.end())
-					return trackId;
-				else
-					return "";
+			if (trackId.size() == 1 && tracks->Tracks.find(trackId) != tracks->Tracks.end()) {
+				return trackId;
 			}
-			else {
-				return "";
+			if (IsConcordeTrack(trackId)) {
+				return trackId;
 			}
 		}
-		else { // Not on a NAT
-			return "";
+
+		// Keep the point
+		if (token.Type == CRouteTokenType::FIX || token.Type == CRouteTokenType::COORDINATE) {
+			points.push_back(token);
 		}
 	}
-	catch (std::exception & ex) {
-		CLogger::DebugLog(screen, "An exception occurred. " + *ex.what());
-		CLogger::Log(CLogType::ERR, "An error occurred. Callsign: " + callsign + "\nVerbose details: " + *ex.what(), "CRoutesHelper::OnNatTrack");
-		return "";
+
+	// Filed as the track's waypoint sequence
+	for (const auto& kv : tracks->Tracks) {
+		const CTrack& track = kv.second;
+		size_t length = track.Route.size();
+		if (length == 0 || length > points.size() || track.RouteRaw.size() != length) {
+			continue;
+		}
+
+		// Look for the whole sequence in order
+		for (size_t start = 0; start + length <= points.size(); start++) {
+			bool match = true;
+			for (size_t i = 0; i < length && match; i++) {
+				const CRouteToken& point = points[start + i];
+				if (point.Type == CRouteTokenType::COORDINATE) {
+					// Compare positions so any coordinate format matches
+					match = abs(point.Latitude - track.RouteRaw[i].m_Latitude) < 0.01
+						&& abs(point.Longitude - track.RouteRaw[i].m_Longitude) < 0.01;
+				}
+				else {
+					// Compare names
+					match = point.Text.size() == track.Route[i].size();
+					for (size_t j = 0; j < point.Text.size() && match; j++) {
+						match = toupper(point.Text[j]) == toupper(track.Route[i][j]);
+					}
+				}
+			}
+
+			if (match) {
+				return kv.first;
+			}
+		}
+	}
+
+	// Not on a NAT
+	return "";
+}
+
+string CRoutesHelper::GetNatTrack(CRadarScreen* screen, string callsign) {
+	// Use the cached assignment if the TMI hasn't changed
+	auto assignment = trackAssignments.find(callsign);
+	if (assignment != trackAssignments.end() && assignment->second.TMI == GetTracks()->TMI) {
+		return assignment->second.Track;
 	}
-}
\ No newline at end of file
+
+	// Otherwise evaluate it again
+	UpdateNatTrack(screen, callsign);
+	return trackAssignments[callsign].Track;
+}
+
+void CRoutesHelper::UpdateNatTrack(CRadarScreen* screen, string callsign) {
+	CTrackAssignment assignment;
+	assignment.Track = OnNatTrack(screen, callsign);
+	assignment.TMI = GetTracks()->TMI;
+	trackAssignments[callsign] = assignment;
+}
+
+void CRoutesHelper::ClearNatTrack(string callsign) {
+	trackAssignments.erase(callsign);
+}
+
+bool CRoutesHelper::IsConcordeTrack(string_view trackId) {
+	return trackId == "SM" || trackId == "SN" || trackId == "SO" || trackId == "SL" || trackId == "SP";
+}
+
+shared_ptr<const CTrackSet> CRoutesHelper::GetTracks() {
+	return atomic_load(&currentTracks);
+}
+
+void CRoutesHelper::SetTracks(shared_ptr<const CTrackSet> trackSet) {
+	atomic_store(&currentTracks, trackSet);
+}
@@ -3,6 +3,11 @@
 #include "Constants.h"
 #include "Structures.h"
 #include "Utils.h"
+#include "RouteParser.h"
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
 
 using namespace std;
 using namespace EuroScopePlugIn;
@@ -10,11 +15,11 @@ using namespace EuroScopePlugIn;
 class CRoutesHelper
 {
 	public:
-		// Current NAT tracks
-		static map<string, CTrack> CurrentTracks;
+		// Current NAT tracks and TMI (snapshot, never modified in place)
+		static shared_ptr<const CTrackSet> GetTracks();
 
-		// Current TMI
-		static string CurrentTMI;
+		// Publish a new track set, replacing the current one atomically
+		static void SetTracks(shared_ptr<const CTrackSet> trackSet);
 
 		// Active aircraft routes to draw
 		static vector<string> ActiveRoutes;
@@ -25,10 +30,65 @@ class CRoutesHelper
 		// Initialise route
 		static void InitialiseRoute(void* args);
 
+		// Queue a route to be initialised on the route worker (takes ownership of the data)
+		// Live flights are held until SubmitRoutes, after the frame has published them
+		static void QueueRoute(CUtils::CAsyncData* data);
+
+		// Hand the held routes to the worker, once per frame after the flight data is published (UI thread)
+		static void SubmitRoutes();
+
+		// Whether routes are waiting for the next frame (any thread)
+		static bool HasDeferredRoutes();
+
+		// Move the routes queued for a closing display onto another, dropped if none is left (UI thread, waits for the route in hand)
+		static void RetargetScreen(CRadarScreen* closing, CRadarScreen* replacement);
+
 		// Parse a raw route
 		static int ParseRoute(CRadarScreen* screen, string callsign, string rawInput, bool isTrack = false, CAircraftFlightPlan* copy = nullptr);
 
-		// Is on a NAT track
+		// Is on a NAT track (evaluates the filed route)
 		static string OnNatTrack(CRadarScreen* screen, string callsign);
+
+		// Match a filed route against the current tracks, either "NATx" or the track's waypoint sequence
+		static string MatchNatTrack(string_view route);
+
+		// Get the cached NAT track, only re-evaluated on amendment or TMI change
+		static string GetNatTrack(CRadarScreen* screen, string callsign);
+
+		// Re-evaluate the cached NAT track (flight plan created or amended)
+		static void UpdateNatTrack(CRadarScreen* screen, string callsign);
+
+		// Remove the cached NAT track
+		static void ClearNatTrack(string callsign);
+
+	private:
+		// Current track set
+		static shared_ptr<const CTrackSet> currentTracks;
+
+		// Route worker queue
+		static deque<CUtils::CAsyncData*> routeQueue;
+		static vector<CUtils::CAsyncData*> deferredRoutes; // Waiting for their flight to be published
+		static mutex routeQueueLock;
+		static condition_variable routeQueueSignal;
+		static CRadarScreen* routeInHand; // Display of the route being initialised
+		static condition_variable routeDoneSignal;
+		static bool routeWorkerStarted;
+		static bool routeWorkerStopping;
+		static thread routeWorker;
+
+		// Put a request on the worker queue, starting the worker the first time
+		static void SendToWorker(CUtils::CAsyncData* data);
+
+		// Route worker loop
+		static void RouteWorker();
+
+		// Stop the worker and drop anything still queued (plugin shutdown)
+		static void StopRouteWorker();
+
+		// Cached track assignments by callsign
+		static map<string, CTrackAssignment> trackAssignments;
+
+		// Check if the track identifier is a concorde route
+		static bool IsConcordeTrack(string_view trackId);
 };
 
@@ -5,6 +5,8 @@
 #include "Constants.h"
 #include <map>
 #include <unordered_map>
+#include <memory>
+#include "CallsignTable.h"
 
 // Describes a NAT track
 struct CTrack {
@@ -18,6 +20,35 @@ struct CTrack {
 	string validFrom;
 };
 
+// A complete set of NAT tracks for one TMI (immutable once published)
+struct CTrackSet {
+	string TMI;
+	map<string, CTrack> Tracks;
+};
+
+// Differences between two track sets
+struct CTrackChanges {
+	vector<string> Added;
+	vector<string> Removed;
+	vector<string> Changed;
+};
+
+// Cached NAT track assignment worked out from a filed route
+struct CTrackAssignment {
+	string Track;
+	string TMI; // TMI the assignment was evaluated against
+};
+
+// Precomputed geometry for a route leg (great circle)
+struct CRouteSegment {
+	double InitialBearing = 0.0; // Degrees true
+	double Length = 0.0; // Nautical miles
+	double Angle = 0.0; // Central angle (radians)
+	double StartUnit[3] = { 0.0, 0.0, 0.0 }; // Unit vectors (earth centred)
+	double EndUnit[3] = { 0.0, 0.0, 0.0 };
+	vector<CPosition> Points; // Densified points, start and end inclusive
+};
+
 // Describes a point along an aircraft's route
 struct CRoutePosition {
 	string Fix;
@@ -25,6 +56,7 @@ struct CRoutePosition {
 	string Estimate;
 	int DistanceFromLastPoint;
 	int FlightLevel;
+	shared_ptr<const CRouteSegment> Leg; // Leg from the previous route position
 };
 
 // Describes a generic waypoint
@@ -37,6 +69,7 @@ struct CWaypoint {
 	}
 	string Name;
 	CPosition Position;
+	shared_ptr<const CRouteSegment> Leg; // Leg from the previous waypoint (set with the route)
 };
 
 // Describes an inbound aircraft
@@ -49,6 +82,7 @@ struct CInboundAircraft {
 		Estimate = est;
 		Destination = dest;
 		Direction = direction;
+		Level = to_string(fA / 100);
 	}
 	string Callsign;
 	int FinalAltitude;
@@ -57,6 +91,8 @@ struct CInboundAircraft {
 	string Estimate;
 	string Destination;
 	bool Direction;
+	string Level; // Final level as the list shows it
+	string PointText; // Point as the list shows it, made on the first draw
 };
 
 // Describes a aircraft status
@@ -83,12 +119,16 @@ struct CSTCAStatus {
 	CSTCAStatus(string csA, string csB, CConflictStatus status, int distanceTime, int distanceNM) {
 		CallsignA = csA;
 		CallsignB = csB;
+		IdA = csA != "" ? CCallsignTable::Intern(csA) : -1;
+		IdB = csB != "" ? CCallsignTable::Intern(csB) : -1;
 		ConflictStatus = status;
 		DistanceAsTime = distanceTime;
 		DistanceAsNM = distanceNM;
 	}
-	string CallsignA;
+	string CallsignA; // Display only, compare ids
 	string CallsignB;
+	int IdA = -1;
+	int IdB = -1;
 	CConflictStatus ConflictStatus;
 	int DistanceAsTime;
 	int DistanceAsNM;
@@ -371,6 +411,24 @@ struct CAircraftFlightPlan {
 	bool IsFirstUpdate = false; // So that we can disable flight plan window until the plan has been fetched from server at least once
 	CRadarTargetMode TargetMode = CRadarTargetMode::ADS_B;
 	bool IsCleared = false;
+	unsigned long long Version = 0; // Bumped every time the record is published
+};
+
+// Flight data fields read on every frame, small enough to copy
+struct CFlightHotData {
+	int FlightLevel = 0; // Hundreds of feet
+	int Mach = 0; // Hundredths
+	char Track[4] = ""; // Track id, "RR" for random routes
+	bool IsEquipped = false;
+	bool IsCleared = false;
+	bool IsValid = false;
+};
+
+// Published flight data (immutable, replaced as a whole on every publish)
+struct CFlightIndex {
+	unsigned long long Version = 0;
+	map<string, shared_ptr<const CAircraftFlightPlan>> Flights;
+	map<string, CFlightHotData> HotData;
 };
 
 
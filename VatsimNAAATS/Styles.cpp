@@ -1,6 +1,9 @@
 #pragma once
 #include "pch.h"
 #include "Styles.h"
+#include "Profiler.h"
+
+using namespace Colours;
 
 // Initialise font values here because otherwise we get lots of linker errors
 CFont FontSelector::normalFont14;
@@ -14,4 +17,115 @@ CFont FontSelector::atcFont14;
 CFont FontSelector::atcFont15;
 CFont FontSelector::atcFont16;
 CFont FontSelector::atcFont18;
-bool FontSelector::fontsInitialised;
\ No newline at end of file
+bool FontSelector::fontsInitialised;
+
+// Style cache
+map<tuple<ARGB, REAL, int, int>, unique_ptr<Pen>> StyleCache::pens;
+map<ARGB, unique_ptr<SolidBrush>> StyleCache::brushes;
+map<tuple<COLORREF, int, int>, unique_ptr<CPen>> StyleCache::gdiPens;
+map<COLORREF, unique_ptr<CBrush>> StyleCache::gdiBrushes;
+bool StyleCache::stylesInitialised;
+
+void StyleCache::InitialiseStyles() {
+	// So that the palette is only ever made once
+	if (stylesInitialised) return;
+
+	// Targets, tags and the conflict tools
+	const Color targetColours[] = { TextWhite, TargetOrange, TargetBlue, WarningYellow, CriticalRed };
+	for (const Color& colour : targetColours) {
+		GetBrush(colour);
+		GetPen(colour, 1);
+		GetPen(colour, 1.5);
+		GetPen(colour, 2);
+	}
+
+	// Menu bar, lists and windows
+	const Color windowColours[] = { Grey, DarkGrey, ScreenBlue, LightBackground, NoReadBk, RouteBox, WindowBorder, ButtonPressed };
+	for (const Color& colour : windowColours) {
+		GetBrush(colour);
+		GetGdiBrush(colour.ToCOLORREF());
+	}
+	GetPen(BevelLight, 1.5);
+	GetPen(BevelDark, 1.5);
+
+	// Initialised
+	stylesInitialised = true;
+	CLogger::Log(CLogType::NORM, "Styles initialised.", "StyleCache");
+}
+
+Pen* StyleCache::GetPen(const Color& colour, REAL width, DashStyle dash, LineCap cap) {
+	// Existing
+	auto key = make_tuple(colour.GetValue(), width, (int)dash, (int)cap);
+	auto it = pens.find(key);
+	if (it != pens.end()) {
+		return it->second.get();
+	}
+
+	// Make it
+	CFrameProfiler::CountAllocation();
+	unique_ptr<Pen> pen(new Pen(colour, width));
+	if (dash != DashStyleSolid) {
+		pen->SetDashStyle(dash);
+		pen->SetDashCap(DashCapRound);
+	}
+	if (cap != LineCapFlat) {
+		pen->SetLineCap(cap, cap, DashCapRound);
+	}
+	Pen* result = pen.get();
+	pens.insert(make_pair(key, move(pen)));
+	return result;
+}
+
+SolidBrush* StyleCache::GetBrush(const Color& colour) {
+	// Existing
+	auto it = brushes.find(colour.GetValue());
+	if (it != brushes.end()) {
+		return it->second.get();
+	}
+
+	// Make it
+	CFrameProfiler::CountAllocation();
+	unique_ptr<SolidBrush> brush(new SolidBrush(colour));
+	SolidBrush* result = brush.get();
+	brushes.insert(make_pair(colour.GetValue(), move(brush)));
+	return result;
+}
+
+CPen* StyleCache::GetGdiPen(COLORREF colour, int width, int style) {
+	// Existing
+	auto key = make_tuple(colour, width, style);
+	auto it = gdiPens.find(key);
+	if (it != gdiPens.end()) {
+		return it->second.get();
+	}
+
+	// Make it
+	CFrameProfiler::CountAllocation();
+	unique_ptr<CPen> pen(new CPen(style, width, colour));
+	CPen* result = pen.get();
+	gdiPens.insert(make_pair(key, move(pen)));
+	return result;
+}
+
+CBrush* StyleCache::GetGdiBrush(COLORREF colour) {
+	// Existing
+	auto it = gdiBrushes.find(colour);
+	if (it != gdiBrushes.end()) {
+		return it->second.get();
+	}
+
+	// Make it
+	CFrameProfiler::CountAllocation();
+	unique_ptr<CBrush> brush(new CBrush(colour));
+	CBrush* result = brush.get();
+	gdiBrushes.insert(make_pair(colour, move(brush)));
+	return result;
+}
+
+void StyleCache::Release() {
+	pens.clear();
+	brushes.clear();
+	gdiPens.clear();
+	gdiBrushes.clear();
+	stylesInitialised = false;
+}
@@ -2,10 +2,14 @@
 #include "pch.h"
 #include "Constants.h"
 #include <iostream>
+#include <map>
+#include <memory>
+#include <tuple>
 #include <gdiplus.h>
 #include "Utils.h"
 #include "Logger.h"
 
+using namespace std;
 using namespace Gdiplus;
 
 // Colours for the program
@@ -158,4 +162,36 @@ public:
 		static CFont atcFont16;
 		static CFont atcFont18;
 		static bool fontsInitialised; // So that we don't try and re-initialise all the fonts
-};
\ No newline at end of file
+};
+
+// Pens and brushes, shared by every renderer instead of being made per call (UI thread only)
+// Built alongside the fonts, anything not in the palette is made the first time it is asked for
+// The cache owns them: never delete or change one (a dashed or capped pen is its own key)
+class StyleCache
+{
+	public:
+		// Make the palette the renderers use every frame
+		static void InitialiseStyles();
+
+		// GDI+ pen, dashes are round capped
+		static Pen* GetPen(const Color& colour, REAL width, DashStyle dash = DashStyleSolid, LineCap cap = LineCapFlat);
+
+		// GDI+ brush
+		static SolidBrush* GetBrush(const Color& colour);
+
+		// GDI pen
+		static CPen* GetGdiPen(COLORREF colour, int width = 1, int style = PS_SOLID);
+
+		// GDI brush
+		static CBrush* GetGdiBrush(COLORREF colour);
+
+		// Free everything, must happen before GDI+ shuts down
+		static void Release();
+
+	private:
+		static map<tuple<ARGB, REAL, int, int>, unique_ptr<Pen>> pens;
+		static map<ARGB, unique_ptr<SolidBrush>> brushes;
+		static map<tuple<COLORREF, int, int>, unique_ptr<CPen>> gdiPens;
+		static map<COLORREF, unique_ptr<CBrush>> gdiBrushes;
+		static bool stylesInitialised;
+};
@@ -0,0 +1,233 @@
+#include "pch.h"
+#include "TagDeclutter.h"
+#include <algorithm>
+
+// Candidate spots around a target
+static const int CANDIDATES = 6;
+
+// Cell a coordinate falls in (rounds down for negative coordinates too)
+static int CellOf(int value) {
+	return value >= 0 ? value / DECLUTTER_CELL : (value - DECLUTTER_CELL + 1) / DECLUTTER_CELL;
+}
+
+// Rectangle for a tag at an offset from its target
+static RECT TagRect(POINT target, POINT offset, bool isDetailed) {
+	int height = isDetailed ? TAG_HEIGHT_DETAILED : TAG_HEIGHT;
+	return { target.x + offset.x, target.y + offset.y, target.x + offset.x + TAG_WIDTH, target.y + offset.y + height };
+}
+
+void CTagDeclutter::BeginFrame() {
+	frame++;
+}
+
+POINT CTagDeclutter::Place(int id, POINT target, bool isDetailed, bool direction) {
+	CTagPlacement& tag = Get(id);
+	tag.Frame = frame;
+
+	// New, or the controller has let go of it, start on the default spot
+	bool isMoved = !tag.IsHashed || tag.IsPinned;
+	if (tag.Candidate < 0 || tag.IsPinned) {
+		tag.IsPinned = false;
+		tag.Candidate = 0;
+	}
+
+	// Target moved, or the tag changed shape, the tag follows on the same spot and is queued to be looked at again
+	isMoved = isMoved || target.x != tag.Target.x || target.y != tag.Target.y || isDetailed != tag.IsDetailed || direction != tag.Direction;
+	if (isMoved) {
+		tag.Target = target;
+		tag.IsDetailed = isDetailed;
+		tag.Direction = direction;
+		Remove(id);
+		tag.Rect = TagRect(target, CandidateOffset(tag.Candidate, isDetailed, direction), isDetailed);
+		Insert(id);
+		if (!tag.IsQueued) {
+			tag.IsQueued = true;
+			queue.push_back(id);
+		}
+	}
+
+	return CandidateOffset(tag.Candidate, isDetailed, direction);
+}
+
+void CTagDeclutter::Pin(int id, POINT target, POINT offset, bool isDetailed) {
+	CTagPlacement& tag = Get(id);
+	tag.Frame = frame;
+	tag.IsPinned = true;
+	tag.Candidate = -1;
+
+	// Only touch the hash if it has moved
+	RECT rect = TagRect(target, offset, isDetailed);
+	if (tag.IsHashed && EqualRect(&rect, &tag.Rect)) {
+		return;
+	}
+	Remove(id);
+	tag.Rect = rect;
+	tag.Target = target;
+	tag.IsDetailed = isDetailed;
+	Insert(id);
+}
+
+void CTagDeclutter::EndFrame() {
+	// Tags not drawn this frame (filtered, off screen or tags turned off)
+	for (size_t i = 0; i < active.size();) {
+		int id = active[i];
+		if (tags[id].Frame != frame) {
+			Remove(id); // Swaps the last id into this slot
+		}
+		else {
+			i++;
+		}
+	}
+
+	// Re-place the queued tags, oldest first, within the budget
+	int budget = DECLUTTER_BUDGET;
+	while (budget > 0 && !queue.empty()) {
+		int id = queue.front();
+		queue.pop_front();
+		CTagPlacement& tag = tags[id];
+		tag.IsQueued = false;
+		if (!tag.IsHashed || tag.IsPinned) {
+			continue;
+		}
+		Solve(id);
+		budget--;
+	}
+}
+
+void CTagDeclutter::Reset() {
+	tags.clear();
+	active.clear();
+	queue.clear();
+	cells.clear();
+	stamps.clear();
+}
+
+POINT CTagDeclutter::CandidateOffset(int candidate, bool isDetailed, bool direction) {
+	// Beside the target, the up spots line the callsign up with the target like the original tag did
+	const POINT rightUp = { 40, -25 };
+	const POINT rightDown = { 40, 10 };
+	const POINT leftUp = { -112, -25 };
+	const POINT leftDown = { -112, 10 };
+
+	// Above and below, centred
+	int height = isDetailed ? TAG_HEIGHT_DETAILED : TAG_HEIGHT;
+	const POINT above = { -TAG_WIDTH / 2, -height - 20 };
+	const POINT below = { -TAG_WIDTH / 2, 20 };
+
+	// Default first, then the same side, then the other
+	const POINT east[CANDIDATES] = { leftDown, leftUp, below, rightDown, above, rightUp };
+	const POINT west[CANDIDATES] = { rightUp, rightDown, above, leftUp, below, leftDown };
+	return direction ? east[candidate] : west[candidate];
+}
+
+int CTagDeclutter::Overlap(int id, const RECT& rect) {
+	// New query
+	query++;
+	if (stamps.size() < tags.size()) {
+		stamps.resize(tags.size(), 0);
+	}
+
+	// Every tag in the cells the rectangle touches
+	int overlap = 0;
+	for (int x = CellOf(rect.left); x <= CellOf(rect.right); x++) {
+		for (int y = CellOf(rect.top); y <= CellOf(rect.bottom); y++) {
+			auto cell = cells.find(CellKey(x, y));
+			if (cell == cells.end()) continue;
+
+			for (int other : cell->second) {
+				if (other == id || stamps[other] == query) continue;
+				stamps[other] = query;
+
+				// Area in common
+				const RECT& otherRect = tags[other].Rect;
+				int width = min(rect.right, otherRect.right) - max(rect.left, otherRect.left);
+				int height = min(rect.bottom, otherRect.bottom) - max(rect.top, otherRect.top);
+				if (width > 0 && height > 0) overlap += width * height;
+			}
+		}
+	}
+	return overlap;
+}
+
+void CTagDeclutter::Solve(int id) {
+	CTagPlacement& tag = tags[id];
+
+	// Happy where it is
+	int best = tag.Candidate;
+	int bestOverlap = Overlap(id, tag.Rect);
+	if (bestOverlap == 0) {
+		return;
+	}
+
+	// Only move for a real improvement so tags don't flick between spots
+	RECT bestRect = tag.Rect;
+	for (int candidate = 0; candidate < CANDIDATES && bestOverlap > 0; candidate++) {
+		if (candidate == tag.Candidate) continue;
+		RECT rect = TagRect(tag.Target, CandidateOffset(candidate, tag.IsDetailed, tag.Direction), tag.IsDetailed);
+		int overlap = Overlap(id, rect);
+		if (overlap < bestOverlap) {
+			best = candidate;
+			bestOverlap = overlap;
+			bestRect = rect;
+		}
+	}
+
+	// Move it
+	if (best != tag.Candidate) {
+		Remove(id);
+		tag.Candidate = best;
+		tag.Rect = bestRect;
+		Insert(id);
+	}
+}
+
+void CTagDeclutter::Insert(int id) {
+	CTagPlacement& tag = tags[id];
+	if (tag.IsHashed) return;
+
+	// Add to every cell it touches
+	for (int x = CellOf(tag.Rect.left); x <= CellOf(tag.Rect.right); x++) {
+		for (int y = CellOf(tag.Rect.top); y <= CellOf(tag.Rect.bottom); y++) {
+			cells[CellKey(x, y)].push_back(id);
+		}
+	}
+	tag.IsHashed = true;
+	tag.ActiveIndex = (int)active.size();
+	active.push_back(id);
+}
+
+void CTagDeclutter::Remove(int id) {
+	CTagPlacement& tag = tags[id];
+	if (!tag.IsHashed) return;
+
+	// Take out of every cell it touches
+	for (int x = CellOf(tag.Rect.left); x <= CellOf(tag.Rect.right); x++) {
+		for (int y = CellOf(tag.Rect.top); y <= CellOf(tag.Rect.bottom); y++) {
+			auto cell = cells.find(CellKey(x, y));
+			if (cell == cells.end()) continue;
+			vector<int>& ids = cell->second;
+			for (size_t i = 0; i < ids.size(); i++) {
+				if (ids[i] == id) {
+					ids[i] = ids.back();
+					ids.pop_back();
+					break;
+				}
+			}
+			if (ids.empty()) cells.erase(cell);
+		}
+	}
+
+	// Swap the last active id into its slot
+	int last = active.back();
+	active[tag.ActiveIndex] = last;
+	tags[last].ActiveIndex = tag.ActiveIndex;
+	active.pop_back();
+	tag.IsHashed = false;
+}
+
+CTagDeclutter::CTagPlacement& CTagDeclutter::Get(int id) {
+	if (id >= (int)tags.size()) {
+		tags.resize(id + 1);
+	}
+	return tags[id];
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include "EuroScopePlugIn.h"
+#include "Constants.h"
+
+using namespace std;
+using namespace EuroScopePlugIn;
+
+// Automatic tag placement for one display, indexed by callsign id (UI thread only)
+// Tag rectangles live in a screen space spatial hash. A tag that moves is queued and later re-placed on whichever candidate
+// spot around its target overlaps the fewest other tags. At most DECLUTTER_BUDGET tags are re-placed a frame, so the cost
+// stays flat however much traffic there is
+class CTagDeclutter
+{
+	public:
+		// Start a frame
+		void BeginFrame();
+
+		// Offset (tag top left from the target) for a tag that hasn't been moved by hand
+		POINT Place(int id, POINT target, bool isDetailed, bool direction);
+
+		// Register a tag the controller has placed so the others keep clear of it
+		void Pin(int id, POINT target, POINT offset, bool isDetailed);
+
+		// Drop tags that weren't drawn this frame and re-place the queued ones
+		void EndFrame();
+
+		// Forget everything
+		void Reset();
+
+		// Tags waiting to be re-placed
+		size_t Pending() const { return queue.size(); }
+
+	private:
+		// Where a tag is
+		struct CTagPlacement {
+			POINT Target = { 0, 0 }; // Target position it was placed against
+			RECT Rect = { 0, 0, 0, 0 };
+			int Candidate = -1; // -1 until placed, pinned tags don't have one
+			bool IsDetailed = false;
+			bool Direction = false;
+			bool IsPinned = false;
+			bool IsHashed = false;
+			int ActiveIndex = -1; // Slot in active while hashed
+			bool IsQueued = false;
+			int Frame = -1; // Last frame drawn
+		};
+
+		// Top left of a candidate spot relative to the target, 0 is the default for the direction of flight
+		static POINT CandidateOffset(int candidate, bool isDetailed, bool direction);
+
+		// Overlap (square pixels) of a rectangle with every other tag
+		int Overlap(int id, const RECT& rect);
+
+		// Pick the best spot for a tag
+		void Solve(int id);
+
+		// Spatial hash
+		void Insert(int id);
+		void Remove(int id);
+		static long long CellKey(int x, int y) { return (long long)(((unsigned long long)(unsigned int)x << 32) | (unsigned int)y); }
+
+		// Tag for an id, growing to fit
+		CTagPlacement& Get(int id);
+
+		vector<CTagPlacement> tags; // Indexed by callsign id
+		vector<int> active; // Ids in the hash
+		deque<int> queue; // Ids waiting to be re-placed
+		unordered_map<long long, vector<int>> cells; // Cell to the ids of the tags touching it
+		vector<int> stamps; // Last query each id was counted in, so a tag spanning cells counts once
+		int query = 0;
+		int frame = 0;
+};
@@ -0,0 +1,129 @@
+#include "pch.h"
+#include "TextCache.h"
+#include "Profiler.h"
+#include <ctime>
+
+unordered_map<HGDIOBJ, unordered_map<string, CSize>> CTextCache::extents;
+vector<CTextCache::CAircraftStrings> CTextCache::aircraft;
+vector<string> CTextCache::zuluTimes;
+vector<string> CTextCache::flightLevels;
+unordered_map<int, string> CTextCache::otherLevels;
+
+// Minutes in a day
+static const int DAY_MINUTES = 1440;
+
+// Levels in the flight level table (000 to 999)
+static const int LEVEL_COUNT = 1000;
+
+CSize CTextCache::GetTextExtent(CDC* dc, const string& text) {
+	// Strings measured in the selected font
+	unordered_map<string, CSize>& fontExtents = extents[::GetCurrentObject(dc->GetSafeHdc(), OBJ_FONT)];
+	auto it = fontExtents.find(text);
+	if (it != fontExtents.end()) {
+		return it->second;
+	}
+
+	// Free text (messages, notes) would grow it forever, so start again when it gets big
+	if (fontExtents.size() >= TEXT_EXTENT_MAX) {
+		fontExtents.clear();
+	}
+
+	// Measure it
+	CFrameProfiler::CountTextMiss();
+	CSize extent = dc->GetTextExtent(text.c_str(), (int)text.size());
+	fontExtents.insert(make_pair(text, extent));
+	return extent;
+}
+
+const string& CTextCache::ZuluTime(int deltaMinutes) {
+	// Every time of day, made once
+	if (zuluTimes.empty()) {
+		zuluTimes.reserve(DAY_MINUTES);
+		char time[5];
+		for (int minute = 0; minute < DAY_MINUTES; minute++) {
+			sprintf_s(time, "%02d%02d", minute / 60, minute % 60);
+			zuluTimes.push_back(time);
+		}
+	}
+
+	// Minute of the day now (epoch time is UTC), plus the delta
+	int minute = (int)((time(0) / 60) % DAY_MINUTES) + deltaMinutes;
+	minute = ((minute % DAY_MINUTES) + DAY_MINUTES) % DAY_MINUTES;
+	return zuluTimes[minute];
+}
+
+const string& CTextCache::FlightLevel(int altitude) {
+	// Every level, made once
+	if (flightLevels.empty()) {
+		flightLevels.reserve(LEVEL_COUNT);
+		for (int level = 0; level < LEVEL_COUNT; level++) {
+			flightLevels.push_back(to_string(level));
+		}
+	}
+
+	int level = altitude / 100;
+	if (level >= 0 && level < LEVEL_COUNT) {
+		return flightLevels[level];
+	}
+
+	// Anything else is made the first time it is seen
+	auto it = otherLevels.find(level);
+	if (it == otherLevels.end()) {
+		CFrameProfiler::CountTextMiss();
+		it = otherLevels.insert(make_pair(level, to_string(level))).first;
+	}
+	return it->second;
+}
+
+const string& CTextCache::GroundSpeed(int id, int groundSpeed) {
+	CCachedNumber& speed = Get(id).GroundSpeed;
+	if (speed.Value != groundSpeed) {
+		CFrameProfiler::CountTextMiss();
+		speed.Value = groundSpeed;
+		speed.Text = "N" + to_string(groundSpeed);
+	}
+	return speed.Text;
+}
+
+const string& CTextCache::Mach(int id, int mach) {
+	CCachedNumber& cached = Get(id).Mach;
+	if (cached.Value != mach) {
+		CFrameProfiler::CountTextMiss();
+		char text[16];
+		sprintf_s(text, "M%03d", mach);
+		cached.Value = mach;
+		cached.Text = text;
+	}
+	return cached.Text;
+}
+
+const string& CTextCache::Selcal(int id, const char* remarks) {
+	CAircraftStrings& strings = Get(id);
+	if (strings.HasSelcal && strings.Remarks == remarks) {
+		return strings.Selcal;
+	}
+
+	// Remarks changed, find the code again
+	CFrameProfiler::CountTextMiss();
+	strings.Remarks = remarks;
+	size_t found = strings.Remarks.find("SEL/");
+	strings.Selcal = found != string::npos ? strings.Remarks.substr(found + 4, 4) : "";
+	if (strings.Selcal == "") strings.Selcal = "N/A";
+	strings.HasSelcal = true;
+	return strings.Selcal;
+}
+
+void CTextCache::Release() {
+	extents.clear();
+	aircraft.clear();
+	zuluTimes.clear();
+	flightLevels.clear();
+	otherLevels.clear();
+}
+
+CTextCache::CAircraftStrings& CTextCache::Get(int id) {
+	if (id >= (int)aircraft.size()) {
+		aircraft.resize(id + 1);
+	}
+	return aircraft[id];
+}
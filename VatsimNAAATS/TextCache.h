@@ -0,0 +1,61 @@
+#pragma once
+#include "pch.h"
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <climits>
+#include "Constants.h"
+
+using namespace std;
+
+// Text measurements and formatted strings for the renderers, so a steady frame neither measures nor formats (UI thread only)
+// Extents are kept per font, times and levels per value, other aircraft strings per callsign id and are only remade when the value behind them changes
+class CTextCache
+{
+	public:
+		// Size of a string in the font selected into the context
+		static CSize GetTextExtent(CDC* dc, const string& text);
+
+		// Zulu time (HHMM) a number of minutes from now
+		static const string& ZuluTime(int deltaMinutes);
+
+		// Flight level from an altitude in feet (350)
+		static const string& FlightLevel(int altitude);
+
+		// Ground speed for the tag (N480)
+		static const string& GroundSpeed(int id, int groundSpeed);
+
+		// Mach for the windows (M082)
+		static const string& Mach(int id, int mach);
+
+		// SELCAL from the flight plan remarks, N/A if it doesn't have one
+		static const string& Selcal(int id, const char* remarks);
+
+		// Forget everything
+		static void Release();
+
+	private:
+		// A formatted number and the value it was made from
+		struct CCachedNumber {
+			int Value = INT_MIN;
+			string Text;
+		};
+
+		// Strings for one aircraft
+		struct CAircraftStrings {
+			CCachedNumber GroundSpeed;
+			CCachedNumber Mach;
+			string Remarks; // Remarks the SELCAL was found in
+			string Selcal;
+			bool HasSelcal = false;
+		};
+
+		// Strings for an id, growing to fit
+		static CAircraftStrings& Get(int id);
+
+		static unordered_map<HGDIOBJ, unordered_map<string, CSize>> extents; // Font to the strings measured in it
+		static vector<CAircraftStrings> aircraft; // Indexed by callsign id
+		static vector<string> zuluTimes; // Every minute of the day
+		static vector<string> flightLevels; // Every level up to FL999
+		static unordered_map<int, string> otherLevels; // Levels outside the table (below ground, bad data)
+};
@@ -27,9 +27,9 @@ void CTrackInfoWindow::RenderWindow(CDC* dc, Graphics* g, CRadarScreen* screen,
 	int iDC = dc->SaveDC();
 
 	// Create brushes
-	CBrush darkerBrush(ScreenBlue.ToCOLORREF());
-	CBrush lighterBrush(WindowBorder.ToCOLORREF());
-	CBrush evenDarkerBrush(ButtonPressed.ToCOLORREF());
+	CBrush* darkerBrush = StyleCache::GetGdiBrush(ScreenBlue.ToCOLORREF());
+	CBrush* lighterBrush = StyleCache::GetGdiBrush(WindowBorder.ToCOLORREF());
+	CBrush* evenDarkerBrush = StyleCache::GetGdiBrush(ButtonPressed.ToCOLORREF());
 
 	// Select title font
 	FontSelector::SelectNormalFont(16, dc);
@@ -38,17 +38,20 @@ void CTrackInfoWindow::RenderWindow(CDC* dc, Graphics* g, CRadarScreen* screen,
 
 	// Create base window rectangle
 	CRect windowRect(topLeft.x, topLeft.y, topLeft.x + WINSZ_TCKINFO_WIDTH, topLeft.y + WINSZ_TCKINFO_HEIGHT);
-	dc->FillRect(windowRect, &darkerBrush);
+	dc->FillRect(windowRect, darkerBrush);
 	
+	// Tracks (hold the snapshot for the whole render)
+	shared_ptr<const CTrackSet> tracks = CRoutesHelper::GetTracks();
+
 	// Create titlebar
 	CRect titleRect(windowRect.left, windowRect.top, windowRect.left + WINSZ_TCKINFO_WIDTH, windowRect.top + WINSZ_TITLEBAR_HEIGHT);
-	dc->FillRect(titleRect, &lighterBrush);
+	dc->FillRect(titleRect, lighterBrush);
 	dc->DrawEdge(titleRect, EDGE_RAISED, BF_BOTTOM);
-	dc->TextOutA(titleRect.left + (WINSZ_TCKINFO_WIDTH / 2), titleRect.top + (WINSZ_TITLEBAR_HEIGHT / 7), string("Track Info - TMI: " + CRoutesHelper::CurrentTMI).c_str());
+	dc->TextOutA(titleRect.left + (WINSZ_TCKINFO_WIDTH / 2), titleRect.top + (WINSZ_TITLEBAR_HEIGHT / 7), string("Track Info - TMI: " + tracks->TMI).c_str());
 
 	// Create button bar
 	CRect buttonBarRect(windowRect.left, windowRect.bottom - 50, windowRect.left + WINSZ_TCKINFO_WIDTH, windowRect.bottom);
-	dc->FillRect(buttonBarRect, &darkerBrush);
+	dc->FillRect(buttonBarRect, darkerBrush);
 	dc->Draw3dRect(buttonBarRect, BevelLight.ToCOLORREF(), ScreenBlue.ToCOLORREF());
 	InflateRect(buttonBarRect, -1, -1);
 	dc->Draw3dRect(buttonBarRect, BevelLight.ToCOLORREF(), ScreenBlue.ToCOLORREF());
@@ -70,7 +73,7 @@ void CTrackInfoWindow::RenderWindow(CDC* dc, Graphics* g, CRadarScreen* screen,
 
 	// Refresh NAT data if clicked
 	if (NATDataRefresh) {
-		int status = CDataHandler::PopulateLatestTrackData(screen->GetPlugIn());
+		int status = CDataHandler::PopulateLatestTrackData(screen);
 		// Set tracks in menu bar
 		menuBar->MakeDropDownItems(CMenuBar::DRP_TCKCTRL);
 		// Show data 
@@ -87,7 +90,7 @@ void CTrackInfoWindow::RenderWindow(CDC* dc, Graphics* g, CRadarScreen* screen,
 	dc->TextOutA(((windowRect.right + windowRect.left) / 2) + 10, buttonBarRect.top + 16, MsgDataRefresh.c_str());
 	
 	// Get a rectangle for the content
-	int contentSize = CRoutesHelper::CurrentTracks.size() * 45; // We minus 25 because 25 extra is always added on at the end of the loop
+	int contentSize = tracks->Tracks.size() * 45; // We minus 25 because 25 extra is always added on at the end of the loop
 	CRect scrollContent(windowRect.left, windowRect.top + WINSZ_TITLEBAR_HEIGHT, windowRect.right, windowRect.top + WINSZ_TITLEBAR_HEIGHT + contentSize);
 	/// Scroll bar mechanics
 	scrollWindowSize = WINSZ_TCKINFO_HEIGHT - (buttonBarRect.Height() + 3) -  (titleRect.Height() + 1); // Size of the window (which is also the size of the track for the scroll grip)
@@ -105,14 +108,14 @@ void CTrackInfoWindow::RenderWindow(CDC* dc, Graphics* g, CRadarScreen* screen,
 
 	// Now we draw the scroll track
 	CRect scrollBarTrack(windowRect.right - 13, windowRect.top + titleRect.Height(), windowRect.right, windowRect.bottom - (buttonBarRect.Height() + 2));
-	dc->FillRect(scrollBarTrack, &evenDarkerBrush);
+	dc->FillRect(scrollBarTrack, evenDarkerBrush);
 	dc->Draw3dRect(scrollBarTrack, BevelDark.ToCOLORREF(), BevelLight.ToCOLORREF());
 	InflateRect(scrollBarTrack, -1, -1);
 	dc->Draw3dRect(scrollBarTrack, BevelDark.ToCOLORREF(), BevelLight.ToCOLORREF());
 
 	// And then the actual scroll grip
 	CRect scrollGrip(scrollBarTrack.left, scrollBarTrack.top + gripPosOnTrack, scrollBarTrack.right, scrollBarTrack.top + gripPosOnTrack + gripSize);
-	dc->FillRect(scrollGrip, &darkerBrush);
+	dc->FillRect(scrollGrip, darkerBrush);
 	dc->Draw3dRect(scrollGrip, BevelLight.ToCOLORREF(), BevelDark.ToCOLORREF());
 	InflateRect(scrollGrip, -1, -1);
 	dc->Draw3dRect(scrollGrip, BevelLight.ToCOLORREF(), BevelDark.ToCOLORREF());
@@ -130,7 +133,7 @@ void CTrackInfoWindow::RenderWindow(CDC* dc, Graphics* g, CRadarScreen* screen,
 	int contentOffsetY = 25;
 	string spacer = "SPACER"; // To use GetTextExtent() for a consistent sized spacer
 	// Draw lines
-	for (auto kv : CRoutesHelper::CurrentTracks) {
+	for (const auto& kv : tracks->Tracks) {
 		int content = (int)scrollContent.top + contentOffsetY;
 		if (windowRect.top + contentOffsetY >= clipContent.top && windowRect.top + contentOffsetY <= clipContent.bottom) {
 			dc->TextOutA(windowRect.left + offsetX, windowRect.top + offsetY, "TCK");
@@ -168,10 +171,6 @@ void CTrackInfoWindow::RenderWindow(CDC* dc, Graphics* g, CRadarScreen* screen,
 	InflateRect(windowRect, 1, 1);
 	dc->DrawEdge(windowRect, EDGE_RAISED, BF_RECT);
 
-	// Cleanup
-	DeleteObject(darkerBrush);
-	DeleteObject(lighterBrush);
-
 	// Restore device context
 	dc->RestoreDC(iDC);
 }
@@ -0,0 +1,122 @@
+#include "pch.h"
+#include "TrackIngest.h"
+#include "RouteParser.h"
+#include "NetworkParser.h"
+#include "Logger.h"
+#include <cmath>
+
+int CTrackIngest::ParseTracks(const string& response, CTrackSet& staging, string& error) {
+	// Stream the tracks straight into the staging set
+	int status = CNetworkParser::ParseTracks(response, [&staging](CTrack& track, bool pointsValid) {
+		// Skip anything that doesn't make sense rather than losing the whole set
+		string trackError;
+		if (!pointsValid || !ValidateTrack(track, trackError)) {
+			CLogger::Log(CLogType::WARN, "Track " + track.Identifier + " rejected. " + (pointsValid ? trackError : "Invalid route point."), "CTrackIngest::ParseTracks");
+			return;
+		}
+
+		// Add to the staging set
+		staging.TMI = track.TMI;
+		string identifier = track.Identifier;
+		staging.Tracks[identifier] = move(track);
+	}, error);
+	if (status != 0) {
+		return 1;
+	}
+
+	// Nothing usable
+	if (staging.Tracks.empty()) {
+		error = "No valid tracks were found.";
+		return 1;
+	}
+
+	return 0;
+}
+
+bool CTrackIngest::MakeTrackPoint(const string& name, double lat, double lon, CPosition& position) {
+	// Coordinate names are exact (including half degrees) so use them over the numeric values
+	double parsedLat, parsedLon;
+	if (CRouteParser::ParseCoordinate(name, parsedLat, parsedLon)) {
+		position = CRouteParser::ToPosition(parsedLat, parsedLon);
+		return true;
+	}
+
+	// Numeric values, tracks are always west
+	if (!isfinite(lat) || !isfinite(lon)) {
+		return false;
+	}
+	lat = DecodeAngle(lat, 90.0);
+	lon = -abs(DecodeAngle(lon, 180.0));
+	if (abs(lat) > 90.0 || abs(lon) > 180.0) {
+		return false;
+	}
+
+	position = CRouteParser::ToPosition(lat, lon);
+	return true;
+}
+
+bool CTrackIngest::ValidateTrack(const CTrack& track, string& error) {
+	if (track.Identifier.empty()) {
+		error = "Missing identifier.";
+		return false;
+	}
+	if (track.Route.size() < 2) {
+		error = "Route has less than two points.";
+		return false;
+	}
+	if (track.Route.size() != track.RouteRaw.size()) {
+		error = "Route names and positions do not match.";
+		return false;
+	}
+
+	return true;
+}
+
+void CTrackIngest::DiffTracks(const CTrackSet& previous, const CTrackSet& current, CTrackChanges& changes) {
+	// Added or changed
+	for (const auto& kv : current.Tracks) {
+		auto old = previous.Tracks.find(kv.first);
+		if (old == previous.Tracks.end()) {
+			changes.Added.push_back(kv.first);
+		}
+		else if (!IsSameTrack(old->second, kv.second)) {
+			changes.Changed.push_back(kv.first);
+		}
+	}
+
+	// Removed
+	for (const auto& kv : previous.Tracks) {
+		if (current.Tracks.find(kv.first) == current.Tracks.end()) {
+			changes.Removed.push_back(kv.first);
+		}
+	}
+}
+
+bool CTrackIngest::IsSameTrack(const CTrack& a, const CTrack& b) {
+	// Definition (validity times and TMI don't change the route)
+	if (a.Direction != b.Direction || a.Route != b.Route || a.FlightLevels != b.FlightLevels || a.RouteRaw.size() != b.RouteRaw.size()) {
+		return false;
+	}
+
+	// Positions
+	for (int i = 0; i < a.RouteRaw.size(); i++) {
+		if (abs(a.RouteRaw[i].m_Latitude - b.RouteRaw[i].m_Latitude) > 1e-6 || abs(a.RouteRaw[i].m_Longitude - b.RouteRaw[i].m_Longitude) > 1e-6) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+double CTrackIngest::DecodeAngle(double value, double limit) {
+	// Within range so it is already decimal degrees
+	if (abs(value) <= limit) {
+		return value;
+	}
+
+	// DDMM style
+	double sign = value < 0 ? -1.0 : 1.0;
+	double degrees = floor(abs(value) / 100.0);
+	double minutes = abs(value) - (degrees * 100.0);
+	return sign * (degrees + (minutes / 60.0));
+}
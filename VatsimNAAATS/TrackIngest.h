@@ -0,0 +1,31 @@
+#pragma once
+#include <string>
+#include "EuroScopePlugIn.h"
+#include "Structures.h"
+
+using namespace std;
+using namespace EuroScopePlugIn;
+
+// NAT track ingestion, builds a complete track set off to the side so it can be published in one go
+class CTrackIngest
+{
+	public:
+		// Parse the tracks API response into a staging set (does not publish)
+		static int ParseTracks(const string& response, CTrackSet& staging, string& error);
+
+		// Make a track point position from the API values
+		static bool MakeTrackPoint(const string& name, double lat, double lon, CPosition& position);
+
+		// Validate a track before it is accepted
+		static bool ValidateTrack(const CTrack& track, string& error);
+
+		// Work out which tracks were added, removed or changed between two sets
+		static void DiffTracks(const CTrackSet& previous, const CTrackSet& current, CTrackChanges& changes);
+
+		// Check if two track definitions are the same
+		static bool IsSameTrack(const CTrack& a, const CTrack& b);
+
+	private:
+		// Decode a DDMM/DDDMM encoded angle if it is out of range as decimal degrees
+		static double DecodeAngle(double value, double limit);
+};
@@ -3,6 +3,7 @@
 #include<cmath>
 #include "Utils.h"
 #include "Constants.h"
+#include "RouteParser.h"
 #include "RadarDisplay.h"
 
 // Default values
@@ -100,16 +101,15 @@ bool CUtils::StringSplit(string str, char splitBy, vector<string>* ptrTokens) {
 		}
 	}
 
-	// String stream
-	stringstream stream(str);
-
-	// Intermediate value
-	string intermediate;
-
-	// Tokenise the string
-	while (getline(stream, intermediate, splitBy))
-	{
-		ptrTokens->push_back(intermediate);
+	// Tokenise the string in place (same semantics as getline, no trailing empty token)
+	size_t start = 0;
+	size_t next;
+	while ((next = str.find(splitBy, start)) != string::npos) {
+		ptrTokens->emplace_back(str, start, next - start);
+		start = next + 1;
+	}
+	if (start < str.size()) {
+		ptrTokens->emplace_back(str, start, string::npos);
 	}
 
 	return 0;
@@ -549,69 +549,23 @@ void CUtils::LoadPluginData(CRadarScreen* screen) {
 		screen->GetPlugIn()->DisplayUserMessage("Message", "vNAAATS Plugin", string("This is a BETA version. Please report any issues to a.ogden@vatcan.ca or submit them here: https://ganderoceanic.com/vnaaats-feedback.").c_str(), false, false, false, false, false);
 }
 
-// Returns the requested format, or returns the same string if the format was unchanged
+// Returns the requested format, or returns the same string if it is not a coordinate
 string CUtils::ConvertCoordinateFormat(string coordinateString, int format) { // format = 0 (slash format), 1 (xxxxN), 2 (xxNxxxW)
-	// Return var
-	string returnFormat;
-	try {
-		// First we make sure there are numbers
-		int isAllAlpha = true;
-		for (int j = 0; j < coordinateString.size(); j++) {
-			if (isdigit(coordinateString.at(j))) {
-				isAllAlpha = false;
-			}
-		}
-		// Check the current format of the input string
-		int currentFormat = -1;
-		if (coordinateString.find('/') != string::npos) {
-			currentFormat = 0;
-		}
-		else if (coordinateString.find('W') == string::npos && coordinateString.find('/') == string::npos && coordinateString.size() == 5) {
-			currentFormat = 1;
-		}
-		else if (coordinateString.find('W') != string::npos) {
-			currentFormat = 2;
-		}
-
-		// Check the current format, if -1 or matches, just return the input string
-		if (currentFormat == -1 || currentFormat == format || isAllAlpha || coordinateString.size() > 7) {
-			return coordinateString;
-		}
-
-		// Otherwise, change the format
-		if (format == 0) {
-			if (currentFormat == 1) {
-				returnFormat = coordinateString.substr(0, 2) + "/" + coordinateString.substr(2, 2);
-
-			}
-			else if (currentFormat == 2) {
-				returnFormat = coordinateString.substr(0, 2) + "/" + coordinateString.substr(4, 2);
-			}
-		}
-		else if (format == 1) {
-			if (currentFormat == 0) {
-				returnFormat = coordinateString.substr(0, 2) + coordinateString.substr(3, 2) + "N";
-			}
-			else if (currentFormat == 2) {
-				returnFormat = coordinateString.substr(0, 2) + coordinateString.substr(4, 2) + "N";
-			}
-		}
-		else {
-			if (currentFormat == 0) {
-				returnFormat = coordinateString.substr(0, 2) + "N0" + coordinateString.substr(3, 2) + "W";
-			}
-			else if (currentFormat == 1) {
-				returnFormat = coordinateString.substr(0, 2) + "N0" + coordinateString.substr(2, 2) + "W";
-			}
-		}
+	// Parse any of the recognised coordinate forms
+	double lat, lon;
+	if (!CRouteParser::ParseCoordinate(coordinateString, lat, lon)) {
+		return coordinateString;
 	}
-	catch (exception & ex) {
-		// Return the old one if an exception occurs
+
+	// Write the requested format
+	char buffer[16];
+	size_t length = CRouteParser::FormatCoordinate(lat, lon, format, buffer, sizeof(buffer));
+	if (length == 0) {
 		return coordinateString;
 	}
-	
+
 	// Return the string
-	return returnFormat;
+	return string(buffer, length);
 }
 
 
@@ -746,8 +700,8 @@ bool CUtils::IsAircraftRelevant(CRadarScreen* screen, CRadarTarget* target, bool
 	}	
 
 	/// However we should keep them on the screen if they aren't long out of the airspace
-	CAircraftFlightPlan* acFp = CDataHandler::GetFlightData(target->GetCallsign());
-	if (acFp->IsValid) {
+	shared_ptr<const CAircraftFlightPlan> acFp = CDataHandler::GetFlightSnapshot(target->GetCallsign());
+	if (acFp != nullptr && acFp->IsValid) {
 		// Current time
 		time_t now = time(0);
 
@@ -868,80 +822,8 @@ int CUtils::GetTargetModeInt(int radarFlags)
 }
 
 CPosition CUtils::PositionFromLatLon(double lat, double lon) {
-	// Latitude
-	int degrees = (int)floor(lat);
-	double minutes = (lat - (double)degrees) * 60;
-	double seconds = (minutes - floor(minutes)) * 60;
-	degrees = abs(degrees); // Get absolute value
-	string degreesFormatted;
-	string minutesFormatted;
-	string secondsFormatted;
-	if (degrees < 10) { // Format degrees
-		degreesFormatted = "N" + to_string(0) + to_string(0) + to_string(degrees);
-	}
-	else if (degrees < 100) {
-		degreesFormatted = "N" + to_string(0) + to_string(degrees);
-	}
-	else {
-		degreesFormatted = "N" + to_string(degrees);
-	}
-	if (minutes < 10) { // Format minutes
-		minutesFormatted = to_string(0) + to_string((int)minutes);
-	}
-	else if (minutes == 0) {
-		minutesFormatted = to_string(0) + to_string(0);
-	}
-	else {
-		minutesFormatted = to_string((int)minutes);
-	}
-	if (seconds < 10 && seconds > 0) { // Format seconds
-		secondsFormatted = to_string(0) + to_string(seconds);
-	}
-	else if (minutes == 0) {
-		secondsFormatted = to_string(0) + to_string(0);
-	}
-	else {
-		secondsFormatted = to_string(seconds);
-	}
-	string latitude = degreesFormatted + "." + minutesFormatted + "." + secondsFormatted;
-	// Longitude
-	degrees = (int)ceil(lon);
-	minutes = (lon - (double)degrees) * 60;
-	seconds = (minutes - floor(minutes)) * 60;
-	degrees = abs(degrees); // Get absolute value
-	if (degrees < 10) { // Format degrees
-		degreesFormatted = "W" + to_string(0) + to_string(0) + to_string(abs(degrees));
-	}
-	else if (degrees < 100) {
-		degreesFormatted = "W" + to_string(0) + to_string(abs(degrees));
-	}
-	else {
-		degreesFormatted = "W" + to_string(abs(degrees));
-	}
-	if (minutes < 10) { // Format minutes
-		minutesFormatted = to_string(0) + to_string((int)minutes);
-	}
-	else if (minutes == 0) {
-		minutesFormatted = to_string(0) + to_string(0);
-	}
-	else {
-		minutesFormatted = to_string((int)minutes);
-	}
-	if (seconds < 10 && seconds > 0) { // Format seconds
-		secondsFormatted = to_string(0) + to_string(seconds);
-	}
-	else if (seconds == 0) {
-		secondsFormatted = to_string(0) + to_string(0);
-	}
-	else {
-		secondsFormatted = to_string(seconds);
-	}
-	string longitude = degreesFormatted + "." + minutesFormatted + "." + secondsFormatted;
-
-	// Return
-	CPosition pos;
-	pos.LoadFromStrings(longitude.c_str(), latitude.c_str());
-	return pos;
+	// Build the position numerically (longitude is always west)
+	return CRouteParser::ToPosition(lat, -abs(lon));
 }
 
 int CUtils::GetMach(int groundSpeed, int speedSound) {
@@ -1163,48 +1045,6 @@ POINT CUtils::GetIntersectionFromPointBearing(POINT position1, POINT position2,
 	return POINT({ newX, newY });
 }
 
-HANDLE CUtils::GetESProcess()
-{
-	CString strProcessName = "EuroScope.exe";
-
-	DWORD aProcesses[1024], cbNeeded, cProcesses;
-	if (!EnumProcesses(aProcesses, sizeof(aProcesses), &cbNeeded))
-		return NULL;
-
-	// Calculate how many process identifiers were returned.
-	cProcesses = cbNeeded / sizeof(DWORD);
-
-	// Print the name and process identifier for each process.
-	for (unsigned int i = 0; i < cProcesses; i++)
-	{
-		DWORD dwProcessID = aProcesses[i];
-		// Get a handle to the process
-		HANDLE hProcess = OpenProcess(PROCESS_QUERY_INFORMATION | PROCESS_VM_READ, FALSE, dwProcessID);
-
-		// Get the process name
-		TCHAR szEachProcessName[MAX_PATH];
-		if (NULL != hProcess)
-		{
-			HMODULE hMod;
-			DWORD cbNeeded;
-
-			// Iterate
-			if (EnumProcessModules(hProcess, &hMod, sizeof(hMod), &cbNeeded))
-			{
-				GetModuleBaseName(hProcess, hMod, szEachProcessName, sizeof(szEachProcessName) / sizeof(TCHAR));
-			}
-		}
-
-		// Return
-		if (strProcessName.CompareNoCase(szEachProcessName) == 0)
-			return hProcess;
-
-		CloseHandle(hProcess);
-	}
-
-	return NULL;
-}
-
 string CUtils::GetLatLonString(CPosition* pos, bool space, int precision, bool showDecimal) { 
 	// Result string
 	string res;
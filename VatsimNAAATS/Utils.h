@@ -5,7 +5,6 @@
 #include <cmath>
 #include <iomanip>
 #include <sstream>
-#include <psapi.h>
 #include "Structures.h"
 
 using namespace std;
@@ -131,9 +130,6 @@ class CUtils { // TODO: refactor into namespace
 		// Get parsed lat lon string (i.e. with N/S or E/W)
 		static string GetLatLonString(CPosition* pos, bool space = true, int precision = -1, bool showDecimal = true);
 
-		// So we can stop running threads
-		static HANDLE GetESProcess();
-
 		// We need this struct for flight plan threading
 		struct CAsyncData {
 			CRadarScreen* Screen;
@@ -143,7 +139,7 @@ class CUtils { // TODO: refactor into namespace
 
 		// This is for asyncing vNAAATS API data
 		struct CNetworkAsyncData {
-			CRadarScreen* Screen;
+			CRadarScreen* Screen = nullptr;
 			string Callsign;
 			CPlugIn* plugin = nullptr;
 			CNetworkFlightPlan* FP = nullptr;
@@ -3,6 +3,9 @@
 #include "VatsimNAAATS.h"
 #include "EuroScopePlugIn.h"
 #include "NAAATS.h"
+#include "HttpClient.h"
+#include "Styles.h"
+#include "TextCache.h"
 #include <gdiplus.h>
 
 #ifdef _DEBUG
@@ -38,7 +41,8 @@ EuroScopePlugInInit(EuroScopePlugIn::CPlugIn** ppPlugInInstance)
 	// Initialize GDI+
 	GdiplusStartupInput gdiplusStartupInput;
 	GdiplusStartup(&m_gdiplusToken, &gdiplusStartupInput, nullptr);
-	* ppPlugInInstance = (CPlugIn*)new CNAAATSPlugin();
+	pNAAATS = new CNAAATSPlugin();
+	*ppPlugInInstance = pNAAATS;
 
 	// Get DLL path
 	GetModuleFileNameA(HINSTANCE(&__ImageBase), CUtils::DllPathFile, sizeof(CUtils::DllPathFile));
@@ -55,6 +59,12 @@ void __declspec (dllexport)
 EuroScopePlugInExit(void)
 {
 	AFX_MANAGE_STATE(AfxGetStaticModuleState())
-	GdiplusShutdown(m_gdiplusToken);
+
+	// HTTP client first so no response callback outlives the plugin, then the plugin (stops the workers), then what they were using
+	CHttpClient::Release();
 	delete pNAAATS;
+	pNAAATS = nullptr;
+	StyleCache::Release();
+	CTextCache::Release();
+	GdiplusShutdown(m_gdiplusToken);
 }
\ No newline at end of file
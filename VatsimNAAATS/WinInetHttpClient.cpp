@@ -0,0 +1,132 @@
+#include "pch.h"
+#include "WinInetHttpClient.h"
+#include "Logger.h"
+#pragma comment(lib,"WinInet.Lib")
+
+CHttpClient* CHttpClient::MakeClient() {
+	return new CWinInetHttpClient();
+}
+
+CWinInetHttpClient::CWinInetHttpClient(int workers) {
+	// One session for the lifetime of the client
+	session = InternetOpenA("vNAAATS", INTERNET_OPEN_TYPE_PRECONFIG, NULL, NULL, 0);
+	if (session == NULL) {
+		CLogger::Log(CLogType::ERR, "Could not open an internet session. Code: " + to_string(GetLastError()), "CWinInetHttpClient::CWinInetHttpClient");
+	}
+
+	// Start the workers
+	Start(workers);
+}
+
+CWinInetHttpClient::~CWinInetHttpClient() {
+	Shutdown();
+}
+
+CHttpResponse CWinInetHttpClient::Perform(const CHttpRequest& request) {
+	CHttpResponse response;
+
+	// Split the URL (lengths of 1 make WinInet point into the source string)
+	URL_COMPONENTSA parts;
+	ZeroMemory(&parts, sizeof(parts));
+	parts.dwStructSize = sizeof(parts);
+	parts.dwHostNameLength = 1;
+	parts.dwUrlPathLength = 1;
+	parts.dwExtraInfoLength = 1;
+	if (!InternetCrackUrlA(request.Url.c_str(), (DWORD)request.Url.size(), 0, &parts)) {
+		response.Error = "Invalid URL";
+		return response;
+	}
+	string host(parts.lpszHostName, parts.dwHostNameLength);
+	string path(parts.lpszUrlPath, parts.dwUrlPathLength);
+	path.append(parts.lpszExtraInfo, parts.dwExtraInfoLength);
+	bool isSecure = parts.nScheme == INTERNET_SCHEME_HTTPS;
+
+	// Connection
+	HINTERNET connection = (HINTERNET)GetConnection(host, parts.nPort);
+	if (connection == NULL) {
+		response.Error = "Could not connect to " + host + ". Code: " + to_string(GetLastError());
+		return response;
+	}
+
+	// Open the request, kept alive and never served from the cache
+	DWORD flags = INTERNET_FLAG_KEEP_CONNECTION | INTERNET_FLAG_RELOAD | INTERNET_FLAG_NO_CACHE_WRITE | INTERNET_FLAG_PRAGMA_NOCACHE;
+	if (isSecure) flags |= INTERNET_FLAG_SECURE;
+	HINTERNET handle = HttpOpenRequestA(connection, request.Method.c_str(), path.c_str(), NULL, NULL, NULL, flags, 0);
+	if (handle == NULL) {
+		response.Error = "Could not open request. Code: " + to_string(GetLastError());
+		return response;
+	}
+
+	// Timeouts
+	DWORD timeout = (DWORD)request.TimeoutMs;
+	InternetSetOptionA(handle, INTERNET_OPTION_CONNECT_TIMEOUT, &timeout, sizeof(timeout));
+	InternetSetOptionA(handle, INTERNET_OPTION_SEND_TIMEOUT, &timeout, sizeof(timeout));
+	InternetSetOptionA(handle, INTERNET_OPTION_RECEIVE_TIMEOUT, &timeout, sizeof(timeout));
+
+	// Headers
+	string headers;
+	if (request.ContentType != "") headers += "Content-Type: " + request.ContentType + "\r\n";
+	if (request.IfNoneMatch != "") headers += "If-None-Match: " + request.IfNoneMatch + "\r\n";
+	if (request.IfModifiedSince != "") headers += "If-Modified-Since: " + request.IfModifiedSince + "\r\n";
+
+	// Send
+	BOOL isSent = HttpSendRequestA(handle,
+		headers.empty() ? NULL : headers.c_str(), (DWORD)headers.size(),
+		request.Body.empty() ? NULL : (LPVOID)request.Body.data(), (DWORD)request.Body.size());
+	if (!isSent) {
+		response.Error = "Request failed. Code: " + to_string(GetLastError());
+		InternetCloseHandle(handle);
+		return response;
+	}
+
+	// Status
+	DWORD status = 0;
+	DWORD size = sizeof(status);
+	if (HttpQueryInfoA(handle, HTTP_QUERY_STATUS_CODE | HTTP_QUERY_FLAG_NUMBER, &status, &size, NULL)) {
+		response.Status = (int)status;
+	}
+	response.ETag = QueryHeader(handle, HTTP_QUERY_ETAG);
+	response.LastModified = QueryHeader(handle, HTTP_QUERY_LAST_MODIFIED);
+
+	// Size the body up front when the server says how big it is
+	DWORD length = 0;
+	size = sizeof(length);
+	if (HttpQueryInfoA(handle, HTTP_QUERY_CONTENT_LENGTH | HTTP_QUERY_FLAG_NUMBER, &length, &size, NULL)) {
+		response.Body.reserve(length);
+	}
+
+	// Read until the end of the response
+	char buffer[16384];
+	DWORD bytesRead = 0;
+	while (InternetReadFile(handle, buffer, sizeof(buffer), &bytesRead) && bytesRead > 0) {
+		response.Body.append(buffer, bytesRead);
+	}
+
+	InternetCloseHandle(handle);
+	return response;
+}
+
+string CWinInetHttpClient::QueryHeader(HINTERNET handle, DWORD header) {
+	char value[512];
+	DWORD size = sizeof(value);
+	if (!HttpQueryInfoA(handle, header, value, &size, NULL)) {
+		return "";
+	}
+	return string(value, size);
+}
+
+void* CWinInetHttpClient::OpenConnection(const string& host, int port) {
+	if (session == NULL) return nullptr;
+	return InternetConnectA(session, host.c_str(), (INTERNET_PORT)port, NULL, NULL, INTERNET_SERVICE_HTTP, 0, 0);
+}
+
+void CWinInetHttpClient::CloseConnection(void* connection) {
+	InternetCloseHandle((HINTERNET)connection);
+}
+
+void CWinInetHttpClient::OnStopped() {
+	if (session != NULL) {
+		InternetCloseHandle(session);
+		session = NULL;
+	}
+}
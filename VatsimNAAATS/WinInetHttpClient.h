@@ -0,0 +1,26 @@
+#pragma once
+#include <string>
+#include <WinInet.h>
+#include "HttpClient.h"
+
+using namespace std;
+
+// WinInet transport, the workers share one session so connections are kept alive between requests
+class CWinInetHttpClient : public CPooledHttpClient
+{
+	public:
+		CWinInetHttpClient(int workers = HTTP_WORKERS);
+		virtual ~CWinInetHttpClient();
+
+	protected:
+		CHttpResponse Perform(const CHttpRequest& request);
+		void* OpenConnection(const string& host, int port);
+		void CloseConnection(void* connection);
+		void OnStopped();
+
+	private:
+		// Read a response header, empty if it isn't there
+		static string QueryHeader(HINTERNET handle, DWORD header);
+
+		HINTERNET session = NULL;
+};
@@ -8,9 +8,11 @@
 #define PCH_H
 
 // add headers that you want to pre-compile here
+#ifdef _WIN32
 #include "framework.h"
 
 #include <gdiplus.h>
 #pragma comment(lib, "Gdiplus.lib")
+#endif
 
 #endif //PCH_H